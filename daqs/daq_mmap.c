@@ -0,0 +1,988 @@
+/*--------------------------------------------------------------------------
+// Copyright (C) 2020-2020 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+*/
+/* daq_mmap.c */
+
+/* replays pcap and pcapng files from a private memory mapping.  messages
+   point directly into the mapping so there is no copy per packet; the
+   mapping is writable copy-on-write so inline normalizations don't touch
+   the file.  since those edits stay in the mapping, a record may only be
+   handed out once in inline mode; looping is limited to passive mode and
+   replacement isn't supported. */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <daq_dlt.h>
+#include <daq_module_api.h>
+
+#define DAQ_MOD_VERSION 0
+#define DAQ_NAME "mmap"
+#define DAQ_TYPE (DAQ_TYPE_FILE_CAPABLE|DAQ_TYPE_MULTI_INSTANCE)
+
+/* descriptors are small since the data stays in the mapping */
+#define MMAP_DEFAULT_POOL_SIZE 1024
+#define MMAP_DEFAULT_SNAPLEN 65535
+
+/* longest single sleep while pacing so interrupts are seen promptly */
+#define MMAP_MAX_NAP_USEC 1000
+
+#define PCAP_MAGIC_USEC 0xa1b2c3d4
+#define PCAP_MAGIC_NSEC 0xa1b23c4d
+#define PCAP_HDR_LEN 24
+#define PCAP_REC_LEN 16
+
+#define PCAPNG_SHB 0x0A0D0D0A
+#define PCAPNG_IDB 0x00000001
+#define PCAPNG_PB  0x00000002
+#define PCAPNG_SPB 0x00000003
+#define PCAPNG_EPB 0x00000006
+#define PCAPNG_BOM 0x1A2B3C4D
+#define PCAPNG_OPT_TSRESOL 9
+
+#define LINKTYPE_RAW 101
+
+#define SET_ERROR(modinst, ...)    daq_base_api.set_errbuf(modinst, __VA_ARGS__)
+
+typedef struct _mmap_msg_desc
+{
+    DAQ_Msg_t msg;
+    DAQ_PktHdr_t pkthdr;
+    struct _mmap_msg_desc* next;
+} MmapMsgDesc;
+
+typedef struct
+{
+    MmapMsgDesc* pool;
+    MmapMsgDesc* freelist;
+    DAQ_MsgPoolInfo_t info;
+} MmapMsgPool;
+
+typedef struct
+{
+    int dlt;
+    uint32_t snaplen;
+    uint64_t tsres;     /* timestamp units per second */
+} MmapIntf;
+
+typedef struct
+{
+    const uint8_t* data;
+    uint32_t caplen;
+    uint32_t pktlen;
+    uint64_t ts;        /* usec */
+    int32_t intf;
+    size_t block;       /* offset of the record's own block */
+} MmapRecord;
+
+typedef struct
+{
+    /* Configuration */
+    char* filename;
+    unsigned snaplen;
+    unsigned timeout;   /* msec, 0 is forever */
+    unsigned loops;     /* passes over the file, 0 is forever */
+    double speed;       /* multiple of the capture rate, 0 is unpaced */
+    unsigned pps;       /* fixed rate, overrides speed */
+    bool populate;
+
+    /* State */
+    DAQ_ModuleInstance_h modinst;
+    MmapMsgPool pool;
+    volatile bool interrupted;
+
+    int fd;
+    uint8_t* base;
+    size_t size;
+    size_t off;
+    size_t first;       /* offset of the first record of a pass */
+
+    bool pcapng;
+    bool swapped;
+    uint64_t tsres;     /* classic pcap only */
+    int dlt;
+
+    MmapIntf* intfs;
+    unsigned num_intfs;
+    unsigned max_intfs;
+
+    unsigned pass;
+    uint64_t pass_packets;
+    bool have_first;
+    uint64_t first_ts;  /* raw timestamp of the first packet in the file */
+    uint64_t last_ts;   /* raw timestamp of the last packet seen */
+    uint64_t ts_offset; /* added to raw timestamps so looped time advances */
+
+    uint64_t start_wall;
+    uint64_t released;
+
+    DAQ_Stats_t stats;
+} MmapContext;
+
+static DAQ_VariableDesc_t mmap_variable_descriptions[] = {
+    { "loop", "Number of times to replay the file, 0 to loop until stopped (default 1)", DAQ_VAR_DESC_REQUIRES_ARGUMENT },
+    { "speed", "Pace packets by timestamp at this multiple of the capture rate (default unpaced)", DAQ_VAR_DESC_REQUIRES_ARGUMENT },
+    { "pps", "Pace packets at a fixed rate in packets per second (overrides speed)", DAQ_VAR_DESC_REQUIRES_ARGUMENT },
+    { "populate", "Fault the whole file into memory before starting", DAQ_VAR_DESC_FORBIDS_ARGUMENT },
+};
+
+static DAQ_BaseAPI_t daq_base_api;
+
+//-------------------------------------------------------------------------
+// utility functions
+//-------------------------------------------------------------------------
+
+static void destroy_message_pool(MmapContext* mc)
+{
+    MmapMsgPool* pool = &mc->pool;
+    if (pool->pool)
+    {
+        free(pool->pool);
+        pool->pool = NULL;
+    }
+    pool->freelist = NULL;
+    pool->info.size = 0;
+    pool->info.available = 0;
+    pool->info.mem_size = 0;
+}
+
+static int create_message_pool(MmapContext* mc, unsigned size)
+{
+    MmapMsgPool* pool = &mc->pool;
+    pool->pool = calloc(sizeof(MmapMsgDesc), size);
+    if (!pool->pool)
+    {
+        SET_ERROR(mc->modinst, "%s: Could not allocate %zu bytes for a packet descriptor pool!",
+                __func__, sizeof(MmapMsgDesc) * size);
+        return DAQ_ERROR_NOMEM;
+    }
+    pool->info.mem_size = sizeof(MmapMsgDesc) * size;
+    while (pool->info.size < size)
+    {
+        MmapMsgDesc *desc = &pool->pool[pool->info.size];
+
+        /* Initialize non-zero invariant packet header fields. */
+        DAQ_PktHdr_t *pkthdr = &desc->pkthdr;
+        pkthdr->address_space_id = 0;
+        pkthdr->ingress_index = DAQ_PKTHDR_UNKNOWN;
+        pkthdr->ingress_group = DAQ_PKTHDR_UNKNOWN;
+        pkthdr->egress_index = DAQ_PKTHDR_UNKNOWN;
+        pkthdr->egress_group = DAQ_PKTHDR_UNKNOWN;
+        pkthdr->flags = 0;
+
+        /* Initialize non-zero invariant message header fields. */
+        DAQ_Msg_t *msg = &desc->msg;
+        msg->type = DAQ_MSG_TYPE_PACKET;
+        msg->hdr_len = sizeof(*pkthdr);
+        msg->hdr = pkthdr;
+        msg->owner = mc->modinst;
+        msg->priv = desc;
+
+        /* Place it on the free list */
+        desc->next = pool->freelist;
+        pool->freelist = desc;
+
+        pool->info.size++;
+    }
+    pool->info.available = pool->info.size;
+    return DAQ_SUCCESS;
+}
+
+static uint64_t wall_usec(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000 + t.tv_nsec / 1000;
+}
+
+static uint16_t get16(const MmapContext* mc, size_t off)
+{
+    uint16_t v;
+    memcpy(&v, mc->base + off, sizeof(v));
+    return mc->swapped ? __builtin_bswap16(v) : v;
+}
+
+static uint32_t get32(const MmapContext* mc, size_t off)
+{
+    uint32_t v;
+    memcpy(&v, mc->base + off, sizeof(v));
+    return mc->swapped ? __builtin_bswap32(v) : v;
+}
+
+static uint64_t to_usec(uint64_t ts, uint64_t tsres)
+{
+    uint64_t sec = ts / tsres;
+    uint64_t frac = ts % tsres;
+
+    if (tsres > 1000000)
+        frac /= tsres / 1000000;
+    else
+        frac = frac * 1000000 / tsres;
+
+    return sec * 1000000 + frac;
+}
+
+static int to_dlt(uint32_t linktype)
+{
+    /* the upper bits carry fcs length and such */
+    linktype &= 0xffff;
+
+    if (linktype == LINKTYPE_RAW)
+        return DLT_RAW;
+
+    return (int)linktype;
+}
+
+//-------------------------------------------------------------------------
+// file functions
+//-------------------------------------------------------------------------
+
+static int add_interface(MmapContext* mc, size_t off, uint32_t len)
+{
+    if (len < 20)
+        return -1;
+
+    if (mc->num_intfs == mc->max_intfs)
+    {
+        unsigned max = mc->max_intfs ? 2 * mc->max_intfs : 4;
+        MmapIntf* intfs = realloc(mc->intfs, max * sizeof(*intfs));
+
+        if (!intfs)
+            return -1;
+
+        mc->intfs = intfs;
+        mc->max_intfs = max;
+    }
+    MmapIntf* intf = mc->intfs + mc->num_intfs++;
+
+    intf->dlt = to_dlt(get16(mc, off + 8));
+    intf->snaplen = get32(mc, off + 12);
+    intf->tsres = 1000000;
+
+    size_t opt = off + 16;
+    size_t end = off + len - 4;
+
+    while (opt + 4 <= end)
+    {
+        uint16_t code = get16(mc, opt);
+        uint16_t olen = get16(mc, opt + 2);
+
+        if (!code || opt + 4 + olen > end)
+            break;
+
+        if (code == PCAPNG_OPT_TSRESOL && olen == 1)
+        {
+            uint8_t r = mc->base[opt + 4];
+            unsigned exp = r & 0x7f;
+
+            if (exp < 64)
+            {
+                uint64_t res = 1;
+                while (exp--)
+                    res *= (r & 0x80) ? 2 : 10;
+                intf->tsres = res ? res : 1000000;
+            }
+        }
+        opt += 4 + ((olen + 3u) & ~3u);
+    }
+    return 0;
+}
+
+/* returns 1 with a packet record, 0 at the end of the data, -1 on error */
+static int next_pcap_record(MmapContext* mc, MmapRecord* rec)
+{
+    if (mc->off + PCAP_REC_LEN > mc->size)
+        return 0;
+
+    uint32_t caplen = get32(mc, mc->off + 8);
+
+    /* a truncated last record is treated like the end of the file */
+    if (caplen > mc->size - mc->off - PCAP_REC_LEN)
+        return 0;
+
+    uint64_t ts = (uint64_t)get32(mc, mc->off) * mc->tsres + get32(mc, mc->off + 4);
+
+    rec->ts = to_usec(ts, mc->tsres);
+    rec->data = mc->base + mc->off + PCAP_REC_LEN;
+    rec->caplen = caplen;
+    rec->pktlen = get32(mc, mc->off + 12);
+    rec->intf = DAQ_PKTHDR_UNKNOWN;
+    rec->block = mc->off;
+
+    mc->off += PCAP_REC_LEN + caplen;
+    return 1;
+}
+
+static int next_pcapng_record(MmapContext* mc, MmapRecord* rec)
+{
+    while (mc->off + 12 <= mc->size)
+    {
+        size_t off = mc->off;
+        uint32_t type;
+
+        memcpy(&type, mc->base + off, sizeof(type));
+
+        /* the section header type reads the same in either byte order
+           and sets the order for everything that follows it */
+        if (type == PCAPNG_SHB)
+        {
+            uint32_t bom;
+            memcpy(&bom, mc->base + off + 8, sizeof(bom));
+
+            if (bom == PCAPNG_BOM)
+                mc->swapped = false;
+            else if (bom == __builtin_bswap32(PCAPNG_BOM))
+                mc->swapped = true;
+            else
+            {
+                SET_ERROR(mc->modinst, "%s: bad pcapng byte order magic at offset %zu", DAQ_NAME, off);
+                return -1;
+            }
+            mc->num_intfs = 0;
+        }
+        else
+            type = get32(mc, off);
+
+        uint32_t len = get32(mc, off + 4);
+
+        if (len < 12 || (len & 3) || len > mc->size - off)
+            return 0;
+
+        mc->off += len;
+
+        switch (type)
+        {
+        case PCAPNG_IDB:
+            if (add_interface(mc, off, len))
+            {
+                SET_ERROR(mc->modinst, "%s: bad interface description at offset %zu", DAQ_NAME, off);
+                return -1;
+            }
+            break;
+
+        case PCAPNG_PB:
+        case PCAPNG_EPB:
+        {
+            if (len < 32)
+                break;
+
+            uint32_t intf = (type == PCAPNG_EPB) ? get32(mc, off + 8) : get16(mc, off + 8);
+            uint32_t caplen = get32(mc, off + 20);
+
+            if (intf >= mc->num_intfs || caplen > len - 32)
+                break;
+
+            uint64_t ts = ((uint64_t)get32(mc, off + 12) << 32) | get32(mc, off + 16);
+
+            rec->ts = to_usec(ts, mc->intfs[intf].tsres);
+            rec->data = mc->base + off + 28;
+            rec->caplen = caplen;
+            rec->pktlen = get32(mc, off + 24);
+            rec->intf = (int32_t)intf;
+            rec->block = off;
+            return 1;
+        }
+
+        case PCAPNG_SPB:
+        {
+            if (len < 16 || !mc->num_intfs)
+                break;
+
+            uint32_t pktlen = get32(mc, off + 8);
+            uint32_t caplen = len - 16;
+
+            if (caplen > pktlen)
+                caplen = pktlen;
+            if (mc->intfs[0].snaplen && caplen > mc->intfs[0].snaplen)
+                caplen = mc->intfs[0].snaplen;
+
+            /* simple packets have no timestamp; reuse the last one */
+            rec->ts = mc->last_ts;
+            rec->data = mc->base + off + 12;
+            rec->caplen = caplen;
+            rec->pktlen = pktlen;
+            rec->intf = 0;
+            rec->block = off;
+            return 1;
+        }
+
+        default:
+            break;
+        }
+    }
+    return 0;
+}
+
+static int next_record(MmapContext* mc, MmapRecord* rec)
+{
+    return mc->pcapng ? next_pcapng_record(mc, rec) : next_pcap_record(mc, rec);
+}
+
+static int parse_header(MmapContext* mc)
+{
+    uint32_t magic;
+
+    if (mc->size < sizeof(magic))
+    {
+        SET_ERROR(mc->modinst, "%s: file is too short for a pcap header", DAQ_NAME);
+        return -1;
+    }
+    memcpy(&magic, mc->base, sizeof(magic));
+
+    if (magic == PCAPNG_SHB)
+    {
+        mc->pcapng = true;
+        mc->first = 0;
+
+        /* walk up to the first interface to learn the datalink type
+           without consuming any packets */
+        MmapRecord rec;
+        mc->off = 0;
+
+        while (!mc->num_intfs)
+        {
+            if (next_pcapng_record(mc, &rec) <= 0)
+            {
+                SET_ERROR(mc->modinst, "%s: no interface description in pcapng file", DAQ_NAME);
+                return -1;
+            }
+        }
+        mc->dlt = mc->intfs[0].dlt;
+        mc->off = 0;
+        return 0;
+    }
+
+    if (magic == PCAP_MAGIC_USEC || magic == PCAP_MAGIC_NSEC)
+        mc->swapped = false;
+
+    else if (magic == __builtin_bswap32(PCAP_MAGIC_USEC) || magic == __builtin_bswap32(PCAP_MAGIC_NSEC))
+    {
+        mc->swapped = true;
+        magic = __builtin_bswap32(magic);
+    }
+    else
+    {
+        SET_ERROR(mc->modinst, "%s: unknown file format (magic 0x%08x)", DAQ_NAME, magic);
+        return -1;
+    }
+
+    if (mc->size < PCAP_HDR_LEN)
+    {
+        SET_ERROR(mc->modinst, "%s: file is too short for a pcap header", DAQ_NAME);
+        return -1;
+    }
+    mc->pcapng = false;
+    mc->tsres = (magic == PCAP_MAGIC_NSEC) ? 1000000000 : 1000000;
+    mc->dlt = to_dlt(get32(mc, 20));
+    mc->first = mc->off = PCAP_HDR_LEN;
+    return 0;
+}
+
+static int mmap_setup(MmapContext* mc)
+{
+    if (!mc->filename)
+    {
+        SET_ERROR(mc->modinst, "%s: a file name is required", DAQ_NAME);
+        return -1;
+    }
+
+    if ((mc->fd = open(mc->filename, O_RDONLY)) < 0)
+    {
+        char error_msg[1024] = {0};
+        if (strerror_r(errno, error_msg, sizeof(error_msg)) == 0)
+            SET_ERROR(mc->modinst, "%s: can't open file (%s)", DAQ_NAME, error_msg);
+        else
+            SET_ERROR(mc->modinst, "%s: can't open file: %d", DAQ_NAME, errno);
+        return -1;
+    }
+
+    struct stat st;
+
+    if (fstat(mc->fd, &st) || !S_ISREG(st.st_mode) || st.st_size == 0)
+    {
+        SET_ERROR(mc->modinst, "%s: %s is not a regular, non-empty file", DAQ_NAME, mc->filename);
+        return -1;
+    }
+    mc->size = (size_t)st.st_size;
+
+    int flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+    if (mc->populate)
+        flags |= MAP_POPULATE;
+#endif
+
+    void* p = mmap(NULL, mc->size, PROT_READ|PROT_WRITE, flags, mc->fd, 0);
+
+    if (p == MAP_FAILED)
+    {
+        char error_msg[1024] = {0};
+        if (strerror_r(errno, error_msg, sizeof(error_msg)) == 0)
+            SET_ERROR(mc->modinst, "%s: can't map file (%s)", DAQ_NAME, error_msg);
+        else
+            SET_ERROR(mc->modinst, "%s: can't map file: %d", DAQ_NAME, errno);
+        return -1;
+    }
+    mc->base = p;
+    madvise(mc->base, mc->size, MADV_SEQUENTIAL);
+
+    if (mc->populate)
+        madvise(mc->base, mc->size, MADV_WILLNEED);
+
+    mc->num_intfs = 0;
+
+    if (parse_header(mc))
+        return -1;
+
+    mc->pass = 0;
+    mc->pass_packets = 0;
+    mc->have_first = false;
+    mc->ts_offset = 0;
+    mc->released = 0;
+    mc->start_wall = 0;
+
+    return 0;
+}
+
+static void mmap_cleanup(MmapContext* mc)
+{
+    if (mc->base)
+        munmap(mc->base, mc->size);
+
+    if (mc->fd >= 0)
+        close(mc->fd);
+
+    mc->base = NULL;
+    mc->size = 0;
+    mc->fd = -1;
+}
+
+/* returns 0 if the record can be released now or else the usecs to wait */
+static uint64_t pace(MmapContext* mc, uint64_t ts)
+{
+    if (!mc->pps && mc->speed <= 0.0)
+        return 0;
+
+    uint64_t now = wall_usec();
+
+    if (!mc->start_wall)
+        mc->start_wall = now;
+
+    uint64_t due;
+
+    if (mc->pps)
+        due = mc->start_wall + mc->released * 1000000 / mc->pps;
+
+    /* records out of timestamp order can be earlier than the first one;
+       release them right away rather than waiting for a wrapped time */
+    else if (ts <= mc->first_ts)
+        due = mc->start_wall;
+
+    else
+        due = mc->start_wall + (uint64_t)((ts - mc->first_ts) / mc->speed);
+
+    return (due > now) ? due - now : 0;
+}
+
+static void nap(uint64_t usec)
+{
+    if (usec > MMAP_MAX_NAP_USEC)
+        usec = MMAP_MAX_NAP_USEC;
+
+    struct timespec t = { 0, (long)usec * 1000 };
+    nanosleep(&t, NULL);
+}
+
+//-------------------------------------------------------------------------
+// daq
+//-------------------------------------------------------------------------
+
+static int mmap_daq_module_load(const DAQ_BaseAPI_t* base_api)
+{
+    if (base_api->api_version != DAQ_BASE_API_VERSION || base_api->api_size != sizeof(DAQ_BaseAPI_t))
+        return DAQ_ERROR;
+
+    daq_base_api = *base_api;
+
+    return DAQ_SUCCESS;
+}
+
+static int mmap_daq_get_variable_descs(const DAQ_VariableDesc_t** var_desc_table)
+{
+    *var_desc_table = mmap_variable_descriptions;
+
+    return sizeof(mmap_variable_descriptions) / sizeof(DAQ_VariableDesc_t);
+}
+
+static int mmap_daq_instantiate(const DAQ_ModuleConfig_h modcfg, DAQ_ModuleInstance_h modinst, void** ctxt_ptr)
+{
+    MmapContext* mc;
+    int rval = DAQ_ERROR;
+
+    mc = calloc(1, sizeof(*mc));
+    if (!mc)
+    {
+        SET_ERROR(modinst, "%s: Couldn't allocate memory for the new Mmap context!", DAQ_NAME);
+        rval = DAQ_ERROR_NOMEM;
+        goto err;
+    }
+    mc->modinst = modinst;
+
+    mc->snaplen = daq_base_api.config_get_snaplen(modcfg) ? daq_base_api.config_get_snaplen(modcfg) : MMAP_DEFAULT_SNAPLEN;
+    mc->timeout = daq_base_api.config_get_timeout(modcfg);
+    mc->loops = 1;
+    mc->fd = -1;
+
+    const char* varKey, * varValue;
+    daq_base_api.config_first_variable(modcfg, &varKey, &varValue);
+    while (varKey)
+    {
+        char* end = NULL;
+
+        if (!strcmp(varKey, "loop"))
+            mc->loops = strtoul(varValue, &end, 10);
+
+        else if (!strcmp(varKey, "speed"))
+            mc->speed = strtod(varValue, &end);
+
+        else if (!strcmp(varKey, "pps"))
+            mc->pps = strtoul(varValue, &end, 10);
+
+        else if (!strcmp(varKey, "populate"))
+            mc->populate = true;
+
+        else
+        {
+            SET_ERROR(modinst, "%s: Unknown variable name: '%s'", DAQ_NAME, varKey);
+            rval = DAQ_ERROR_INVAL;
+            goto err;
+        }
+
+        if (end && (end == varValue || *end || mc->speed < 0.0))
+        {
+            SET_ERROR(modinst, "%s: Invalid value for %s: '%s'", DAQ_NAME, varKey, varValue);
+            rval = DAQ_ERROR_INVAL;
+            goto err;
+        }
+
+        daq_base_api.config_next_variable(modcfg, &varKey, &varValue);
+    }
+
+    /* a looped record would be seen again with the edits from the previous
+       pass and could be edited while an earlier message for it is out */
+    if (mc->loops != 1 && daq_base_api.config_get_mode(modcfg) == DAQ_MODE_INLINE)
+    {
+        SET_ERROR(modinst, "%s: loop is only supported in passive mode", DAQ_NAME);
+        rval = DAQ_ERROR_INVAL;
+        goto err;
+    }
+
+    const char* filename = daq_base_api.config_get_input(modcfg);
+    if (filename)
+    {
+        if (!(mc->filename = strdup(filename)))
+        {
+            SET_ERROR(modinst, "%s: Couldn't allocate memory for the filename!", DAQ_NAME);
+            rval = DAQ_ERROR_NOMEM;
+            goto err;
+        }
+    }
+
+    uint32_t pool_size = daq_base_api.config_get_msg_pool_size(modcfg);
+    rval = create_message_pool(mc, pool_size ? pool_size : MMAP_DEFAULT_POOL_SIZE);
+    if (rval != DAQ_SUCCESS)
+        goto err;
+
+    *ctxt_ptr = mc;
+
+    return DAQ_SUCCESS;
+
+err:
+    if (mc)
+    {
+        if (mc->filename)
+            free(mc->filename);
+        destroy_message_pool(mc);
+        free(mc);
+    }
+    return rval;
+}
+
+static void mmap_daq_destroy(void* handle)
+{
+    MmapContext* mc = (MmapContext*) handle;
+
+    mmap_cleanup(mc);
+
+    if (mc->filename)
+        free(mc->filename);
+    free(mc->intfs);
+    destroy_message_pool(mc);
+    free(mc);
+}
+
+static int mmap_daq_start(void* handle)
+{
+    MmapContext* mc = (MmapContext*) handle;
+
+    if (mmap_setup(mc))
+    {
+        mmap_cleanup(mc);
+        return DAQ_ERROR;
+    }
+
+    return DAQ_SUCCESS;
+}
+
+static int mmap_daq_interrupt(void* handle)
+{
+    MmapContext* mc = (MmapContext*) handle;
+    mc->interrupted = true;
+    return DAQ_SUCCESS;
+}
+
+static int mmap_daq_stop (void* handle)
+{
+    MmapContext* mc = (MmapContext*) handle;
+    mmap_cleanup(mc);
+    return DAQ_SUCCESS;
+}
+
+static int mmap_daq_get_stats(void* handle, DAQ_Stats_t* stats)
+{
+    MmapContext* mc = (MmapContext*) handle;
+    memcpy(stats, &mc->stats, sizeof(DAQ_Stats_t));
+    return DAQ_SUCCESS;
+}
+
+static void mmap_daq_reset_stats(void* handle)
+{
+    MmapContext* mc = (MmapContext*) handle;
+    memset(&mc->stats, 0, sizeof(mc->stats));
+}
+
+static int mmap_daq_get_snaplen (void* handle)
+{
+    MmapContext* mc = (MmapContext*) handle;
+    return mc->snaplen;
+}
+
+static uint32_t mmap_daq_get_capabilities(void* handle)
+{
+    (void) handle;
+    return DAQ_CAPA_BLOCK | DAQ_CAPA_INTERRUPT | DAQ_CAPA_UNPRIV_START;
+}
+
+static int mmap_daq_get_datalink_type(void *handle)
+{
+    MmapContext* mc = (MmapContext*) handle;
+    return mc->dlt;
+}
+
+static unsigned mmap_daq_msg_receive(void* handle, const unsigned max_recv, const DAQ_Msg_t* msgs[], DAQ_RecvStatus* rstat)
+{
+    MmapContext* mc = (MmapContext*) handle;
+    DAQ_RecvStatus status = DAQ_RSTAT_OK;
+    uint64_t waited = 0;
+    unsigned idx = 0;
+
+    while (idx < max_recv)
+    {
+        /* Check to see if the receive has been canceled.  If so, reset it and return appropriately. */
+        if (mc->interrupted)
+        {
+            mc->interrupted = false;
+            status = DAQ_RSTAT_INTERRUPTED;
+            break;
+        }
+
+        /* Make sure that we have a message descriptor available to populate. */
+        MmapMsgDesc* desc = mc->pool.freelist;
+        if (!desc)
+        {
+            status = (idx > 0) ? DAQ_RSTAT_OK : DAQ_RSTAT_NOBUF;
+            break;
+        }
+
+        /* Peek at the next record so pacing can hold it back. */
+        MmapRecord rec;
+        int rval = next_record(mc, &rec);
+
+        if (rval < 0)
+        {
+            status = DAQ_RSTAT_ERROR;
+            break;
+        }
+
+        if (rval == 0)
+        {
+            /* Start another pass unless this one was empty. */
+            if (mc->pass_packets && (!mc->loops || ++mc->pass < mc->loops))
+            {
+                if (mc->last_ts > mc->first_ts)
+                    mc->ts_offset += mc->last_ts - mc->first_ts;
+                mc->ts_offset++;
+                mc->off = mc->first;
+                mc->pass_packets = 0;
+                continue;
+            }
+            status = DAQ_RSTAT_EOF;
+            break;
+        }
+
+        if (mc->pcapng && mc->intfs[rec.intf].dlt != mc->dlt)
+        {
+            mc->stats.packets_filtered++;
+            continue;
+        }
+
+        if (!mc->have_first)
+        {
+            mc->first_ts = rec.ts;
+            mc->have_first = true;
+        }
+        mc->last_ts = rec.ts;
+
+        uint64_t ts = rec.ts + mc->ts_offset;
+        uint64_t wait = pace(mc, ts);
+
+        if (wait)
+        {
+            /* Deliver what is ready rather than holding a partial batch.
+               Rewind only to the held packet's block so any blocks ahead
+               of it, like interface descriptions, are not seen again. */
+            mc->off = rec.block;
+
+            if (idx > 0)
+                break;
+
+            if (mc->timeout && waited >= (uint64_t)mc->timeout * 1000)
+            {
+                status = DAQ_RSTAT_TIMEOUT;
+                break;
+            }
+            nap(wait);
+            waited += (wait > MMAP_MAX_NAP_USEC) ? MMAP_MAX_NAP_USEC : wait;
+            continue;
+        }
+
+        DAQ_PktHdr_t* pkthdr = &desc->pkthdr;
+        pkthdr->ts.tv_sec = ts / 1000000;
+        pkthdr->ts.tv_usec = ts % 1000000;
+        pkthdr->pktlen = rec.pktlen;
+        pkthdr->ingress_index = rec.intf;
+
+        desc->msg.data = (uint8_t*)rec.data;
+        desc->msg.data_len = (rec.caplen < mc->snaplen) ? rec.caplen : mc->snaplen;
+
+        /* Last, but not least, extract this descriptor from the free list and
+           place the message in the return vector. */
+        mc->pool.freelist = desc->next;
+        desc->next = NULL;
+        mc->pool.info.available--;
+        msgs[idx] = &desc->msg;
+
+        mc->pass_packets++;
+        mc->released++;
+        mc->stats.hw_packets_received++;
+        mc->stats.packets_received++;
+
+        idx++;
+    }
+
+    *rstat = status;
+
+    return idx;
+}
+
+static int mmap_daq_msg_finalize(void* handle, const DAQ_Msg_t* msg, DAQ_Verdict verdict)
+{
+    MmapContext* mc = (MmapContext*) handle;
+    MmapMsgDesc* desc = (MmapMsgDesc *) msg->priv;
+
+    if (verdict >= MAX_DAQ_VERDICT)
+        verdict = DAQ_VERDICT_PASS;
+    mc->stats.verdicts[verdict]++;
+
+    /* Toss the descriptor back on the free list for reuse. */
+    desc->next = mc->pool.freelist;
+    mc->pool.freelist = desc;
+    mc->pool.info.available++;
+
+    return DAQ_SUCCESS;
+}
+
+static int mmap_daq_get_msg_pool_info(void* handle, DAQ_MsgPoolInfo_t* info)
+{
+    MmapContext* mc = (MmapContext*) handle;
+
+    *info = mc->pool.info;
+
+    return DAQ_SUCCESS;
+}
+
+//-------------------------------------------------------------------------
+
+#ifdef BUILDING_SO
+DAQ_SO_PUBLIC const DAQ_ModuleAPI_t DAQ_MODULE_DATA =
+#else
+const DAQ_ModuleAPI_t mmap_daq_module_data =
+#endif
+{
+    /* .api_version = */ DAQ_MODULE_API_VERSION,
+    /* .api_size = */ sizeof(DAQ_ModuleAPI_t),
+    /* .module_version = */ DAQ_MOD_VERSION,
+    /* .name = */ DAQ_NAME,
+    /* .type = */ DAQ_TYPE,
+    /* .load = */ mmap_daq_module_load,
+    /* .unload = */ NULL,
+    /* .get_variable_descs = */ mmap_daq_get_variable_descs,
+    /* .instantiate = */ mmap_daq_instantiate,
+    /* .destroy = */ mmap_daq_destroy,
+    /* .set_filter = */ NULL,
+    /* .start = */ mmap_daq_start,
+    /* .inject = */ NULL,
+    /* .inject_relative = */ NULL,
+    /* .interrupt = */ mmap_daq_interrupt,
+    /* .stop = */ mmap_daq_stop,
+    /* .ioctl = */ NULL,
+    /* .get_stats = */ mmap_daq_get_stats,
+    /* .reset_stats = */ mmap_daq_reset_stats,
+    /* .get_snaplen = */ mmap_daq_get_snaplen,
+    /* .get_capabilities = */ mmap_daq_get_capabilities,
+    /* .get_datalink_type = */ mmap_daq_get_datalink_type,
+    /* .config_load = */ NULL,
+    /* .config_swap = */ NULL,
+    /* .config_free = */ NULL,
+    /* .msg_receive = */ mmap_daq_msg_receive,
+    /* .msg_finalize = */ mmap_daq_msg_finalize,
+    /* .get_msg_pool_info = */ mmap_daq_get_msg_pool_info,
+};
@@ -0,0 +1,242 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2020-2020 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// daq_mmap_test.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include <daq_module_api.h>
+
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness.h>
+
+extern "C" const DAQ_ModuleAPI_t mmap_daq_module_data;
+
+//-------------------------------------------------------------------------
+// base api
+//-------------------------------------------------------------------------
+
+static std::string input;
+static std::vector<std::pair<std::string, std::string>> vars;
+static unsigned var_idx = 0;
+
+static const char* get_input(DAQ_ModuleConfig_h) { return input.c_str(); }
+static int get_snaplen(DAQ_ModuleConfig_h) { return 1518; }
+static unsigned get_timeout(DAQ_ModuleConfig_h) { return 10; }
+static unsigned get_msg_pool_size(DAQ_ModuleConfig_h) { return 16; }
+static DAQ_Mode get_mode(DAQ_ModuleConfig_h) { return DAQ_MODE_READ_FILE; }
+
+static int next_variable(DAQ_ModuleConfig_h, const char** key, const char** value)
+{
+    if ( var_idx < vars.size() )
+    {
+        *key = vars[var_idx].first.c_str();
+        *value = vars[var_idx].second.c_str();
+        ++var_idx;
+    }
+    else
+        *key = *value = nullptr;
+
+    return 0;
+}
+
+static int first_variable(DAQ_ModuleConfig_h cfg, const char** key, const char** value)
+{
+    var_idx = 0;
+    return next_variable(cfg, key, value);
+}
+
+static void set_errbuf(DAQ_ModuleInstance_h, const char* fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    vfprintf(stderr, fmt, ap);
+    va_end(ap);
+    fputc('\n', stderr);
+}
+
+//-------------------------------------------------------------------------
+// pcapng file
+//-------------------------------------------------------------------------
+
+class Pcapng
+{
+public:
+    Pcapng()
+    {
+        put32(0x0A0D0D0A);
+        put32(28);
+        put32(0x1A2B3C4D);
+        put16(1);
+        put16(0);
+        put32(0xffffffff);
+        put32(0xffffffff);
+        put32(28);
+    }
+
+    void idb(uint16_t linktype)
+    {
+        put32(1);
+        put32(20);
+        put16(linktype);
+        put16(0);
+        put32(0);
+        put32(20);
+    }
+
+    void epb(uint32_t intf, uint64_t usec, uint8_t fill)
+    {
+        const uint32_t caplen = 64;
+        const uint32_t len = 32 + caplen;
+
+        put32(6);
+        put32(len);
+        put32(intf);
+        put32(usec >> 32);
+        put32(usec & 0xffffffff);
+        put32(caplen);
+        put32(caplen);
+        buf.insert(buf.end(), caplen, fill);
+        put32(len);
+    }
+
+    std::string write()
+    {
+        char path[] = "/tmp/daq_mmap_test.XXXXXX";
+        int fd = mkstemp(path);
+        CHECK(fd >= 0);
+        CHECK(::write(fd, buf.data(), buf.size()) == (ssize_t)buf.size());
+        close(fd);
+        return path;
+    }
+
+private:
+    void put16(uint16_t v)
+    { buf.insert(buf.end(), (uint8_t*)&v, (uint8_t*)&v + sizeof(v)); }
+
+    void put32(uint32_t v)
+    { buf.insert(buf.end(), (uint8_t*)&v, (uint8_t*)&v + sizeof(v)); }
+
+    std::vector<uint8_t> buf;
+};
+
+//-------------------------------------------------------------------------
+// tests
+//-------------------------------------------------------------------------
+
+TEST_GROUP(daq_mmap)
+{
+    const DAQ_ModuleAPI_t* api = &mmap_daq_module_data;
+    void* ctx = nullptr;
+
+    void setup() override
+    {
+        static DAQ_BaseAPI_t base;
+        memset(&base, 0, sizeof(base));
+
+        base.api_version = DAQ_BASE_API_VERSION;
+        base.api_size = sizeof(base);
+        base.config_get_input = get_input;
+        base.config_get_snaplen = get_snaplen;
+        base.config_get_timeout = get_timeout;
+        base.config_get_msg_pool_size = get_msg_pool_size;
+        base.config_get_mode = get_mode;
+        base.config_first_variable = first_variable;
+        base.config_next_variable = next_variable;
+        base.set_errbuf = set_errbuf;
+
+        CHECK(api->load(&base) == DAQ_SUCCESS);
+        vars.clear();
+    }
+
+    void teardown() override
+    {
+        if ( ctx )
+        {
+            api->stop(ctx);
+            api->destroy(ctx);
+        }
+        unlink(input.c_str());
+    }
+};
+
+// an interface description ahead of a packet held by pacing is only added
+// once so later interfaces keep their indices
+TEST(daq_mmap, paced_interface_descriptions)
+{
+    Pcapng file;
+    file.idb(1);
+    file.epb(0, 1000000, 1);
+    file.idb(1);
+    file.epb(1, 1050000, 2);
+    file.idb(101);
+    file.epb(2, 1050000, 3);  // raw ip, filtered
+    file.epb(0, 1050000, 4);
+
+    input = file.write();
+    vars.emplace_back("speed", "1");
+
+    CHECK(api->instantiate(nullptr, nullptr, &ctx) == DAQ_SUCCESS);
+    CHECK(api->start(ctx) == DAQ_SUCCESS);
+    CHECK(api->get_datalink_type(ctx) == 1);
+
+    std::vector<uint8_t> seen;
+    unsigned timeouts = 0;
+    DAQ_RecvStatus rstat;
+
+    do
+    {
+        const DAQ_Msg_t* msgs[16];
+        unsigned n = api->msg_receive(ctx, 16, msgs, &rstat);
+
+        for ( unsigned i = 0; i < n; ++i )
+        {
+            seen.push_back(msgs[i]->data[0]);
+            api->msg_finalize(ctx, msgs[i], DAQ_VERDICT_PASS);
+        }
+        if ( rstat == DAQ_RSTAT_TIMEOUT )
+            ++timeouts;
+    }
+    while ( rstat == DAQ_RSTAT_OK or rstat == DAQ_RSTAT_TIMEOUT );
+
+    CHECK(rstat == DAQ_RSTAT_EOF);
+    CHECK(timeouts > 0);
+
+    CHECK(seen.size() == 3);
+    CHECK(seen[0] == 1);
+    CHECK(seen[1] == 2);
+    CHECK(seen[2] == 4);
+
+    DAQ_Stats_t stats;
+    api->get_stats(ctx, &stats);
+    CHECK(stats.packets_filtered == 1);
+}
+
+int main(int argc, char** argv)
+{
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
@@ -43,6 +43,7 @@ const PegInfo pegs[]
 {
     { CountType::SUM, "bad_checksum", "non-zero icmp checksums" },
     { CountType::SUM, "checksum_bypassed", "checksum calculations bypassed" },
+    { CountType::SUM, "checksum_computed", "checksum calculations performed" },
     { CountType::END, nullptr, nullptr }
 };
 
@@ -50,6 +51,7 @@ struct Stats
 {
     PegCount bad_ip4_cksum;
     PegCount cksum_bypassed;
+    PegCount cksum_computed;
 };
 
 static THREAD_LOCAL Stats stats;
@@ -158,6 +160,7 @@ bool Icmp4Codec::decode(const RawData& raw, CodecData& codec,DecodeData& snort)
 
     if (snort::get_network_policy()->icmp_checksums() && !valid_checksum_from_daq(raw))
     {
+        stats.cksum_computed++;
         uint16_t csum = checksum::cksum_add((const uint16_t*)icmph, raw.len);
 
         if (csum && !codec.is_cooked())
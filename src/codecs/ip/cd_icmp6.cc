@@ -45,6 +45,7 @@ const PegInfo pegs[]
 {
     { CountType::SUM, "bad_icmp6_checksum", "nonzero icmp6 checksums" },
     { CountType::SUM, "checksum_bypassed", "checksum calculations bypassed" },
+    { CountType::SUM, "checksum_computed", "checksum calculations performed" },
     { CountType::END, nullptr, nullptr }
 };
 
@@ -52,6 +53,7 @@ struct Stats
 {
     PegCount bad_ip6_cksum;
     PegCount cksum_bypassed;
+    PegCount cksum_computed;
 };
 
 static THREAD_LOCAL Stats stats;
@@ -158,6 +160,7 @@ bool Icmp6Codec::decode(const RawData& raw, CodecData& codec, DecodeData& snort)
         ph6.hdr.protocol = codec.ip6_csum_proto;
         ph6.hdr.len = htons((uint16_t)raw.len);
 
+        stats.cksum_computed++;
         uint16_t csum = checksum::icmp_cksum((const uint16_t*)(icmp6h), raw.len, ph6);
 
         if (csum && !codec.is_cooked())
@@ -41,6 +41,10 @@
 
 #include "checksum.h"
 
+#ifdef UNIT_TEST
+#include "catch/snort_catch.h"
+#endif
+
 using namespace snort;
 
 #define CD_IPV4_NAME "ipv4"
@@ -53,6 +57,7 @@ const PegInfo pegs[]
 {
     { CountType::SUM, "bad_checksum", "nonzero ip checksums" },
     { CountType::SUM, "checksum_bypassed", "checksum calculations bypassed" },
+    { CountType::SUM, "checksum_computed", "checksum calculations performed" },
     { CountType::END, nullptr, nullptr }
 };
 
@@ -60,6 +65,7 @@ struct Stats
 {
     PegCount bad_cksum;
     PegCount cksum_bypassed;
+    PegCount cksum_computed;
 };
 
 static THREAD_LOCAL Stats stats;
@@ -259,6 +265,7 @@ bool Ipv4Codec::decode(const RawData& raw, CodecData& codec, DecodeData& snort)
     if (snort::get_network_policy()->ip_checksums() && !valid_checksum_from_daq(raw))
     {
         // routers drop packets with bad IP checksums, we don't really need to check them...
+        stats.cksum_computed++;
         int16_t csum = checksum::ip_cksum((const uint16_t*)iph, hlen);
         if (csum && !codec.is_cooked())
         {
@@ -792,3 +799,52 @@ const BaseApi* cd_ipv4[] =
     nullptr
 };
 
+#ifdef UNIT_TEST
+static uint16_t ref_cksum(const uint8_t* p, std::size_t len)
+{
+    uint32_t sum = 0;
+
+    for ( ; len > 1; p += 2, len -= 2 )
+        sum += *(const uint16_t*)p;
+
+    if ( len )
+        sum += *p;
+
+    while ( sum >> 16 )
+        sum = (sum >> 16) + (sum & 0xffff);
+
+    return (uint16_t)~sum;
+}
+
+TEST_CASE("checksum matches scalar reference", "[cd_ipv4]")
+{
+    alignas(32) uint8_t buf[IP_MAXPACKET + 1];
+    std::mt19937 gen(1);
+
+    for ( auto& b : buf )
+        b = (uint8_t)gen();
+
+    SECTION("all ones")
+    {
+        uint8_t ff[4096];
+        memset(ff, 0xff, sizeof(ff));
+        CHECK(checksum::cksum_add((const uint16_t*)ff, sizeof(ff)) == ref_cksum(ff, sizeof(ff)));
+    }
+    SECTION("lengths and alignments")
+    {
+        for ( std::size_t off = 0; off < 4; ++off )
+        {
+            for ( std::size_t len : { 0, 1, 20, 63, 64, 65, 97, 1500, 9001 } )
+            {
+                const uint8_t* p = buf + off;
+                CHECK(checksum::cksum_add((const uint16_t*)p, len) == ref_cksum(p, len));
+            }
+        }
+    }
+    SECTION("max packet")
+    {
+        CHECK(checksum::cksum_add((const uint16_t*)buf, IP_MAXPACKET) ==
+            ref_cksum(buf, IP_MAXPACKET));
+    }
+}
+#endif
@@ -59,6 +59,7 @@ const PegInfo pegs[]
     { CountType::SUM, "bad_tcp4_checksum", "nonzero tcp over ip checksums" },
     { CountType::SUM, "bad_tcp6_checksum", "nonzero tcp over ipv6 checksums" },
     { CountType::SUM, "checksum_bypassed", "checksum calculations bypassed" },
+    { CountType::SUM, "checksum_computed", "checksum calculations performed" },
     { CountType::END, nullptr, nullptr }
 };
 
@@ -67,6 +68,7 @@ struct Stats
     PegCount bad_ip4_cksum;
     PegCount bad_ip6_cksum;
     PegCount cksum_bypassed;
+    PegCount cksum_computed;
 };
 
 static THREAD_LOCAL Stats stats;
@@ -178,6 +180,7 @@ bool TcpCodec::valid_checksum4(const RawData& raw, DecodeData& snort)
     ph.hdr.protocol = ip4h->proto();
     ph.hdr.len = htons((uint16_t) raw.len);
 
+    stats.cksum_computed++;
     return (checksum::tcp_cksum((const uint16_t*) raw.data, raw.len, ph) == 0);
 }
 
@@ -192,6 +195,7 @@ bool TcpCodec::valid_checksum6(const RawData& raw, const CodecData& codec, Decod
     ph6.hdr.protocol = codec.ip6_csum_proto;
     ph6.hdr.len = htons((uint16_t) raw.len);
 
+    stats.cksum_computed++;
     return (checksum::tcp_cksum((const uint16_t*) raw.data, raw.len, ph6) == 0);
 }
 
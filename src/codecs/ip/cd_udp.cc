@@ -47,6 +47,7 @@ const PegInfo pegs[]
     { CountType::SUM, "bad_udp4_checksum", "nonzero udp over ipv4 checksums" },
     { CountType::SUM, "bad_udp6_checksum", "nonzero udp over ipv6 checksums" },
     { CountType::SUM, "checksum_bypassed", "checksum calculations bypassed" },
+    { CountType::SUM, "checksum_computed", "checksum calculations performed" },
     { CountType::END, nullptr, nullptr }
 };
 
@@ -55,6 +56,7 @@ struct Stats
     PegCount bad_ip4_cksum;
     PegCount bad_ip6_cksum;
     PegCount cksum_bypassed;
+    PegCount cksum_computed;
 };
 
 static THREAD_LOCAL Stats stats;
@@ -264,6 +266,7 @@ bool UdpCodec::valid_checksum4(const RawData& raw, const DecodeData& snort)
     ph.hdr.protocol = ip4h->proto();
     ph.hdr.len = htons((uint16_t) raw.len);
 
+    stats.cksum_computed++;
     return (checksum::udp_cksum((const uint16_t*) raw.data, raw.len, ph) == 0);
 }
 
@@ -278,6 +281,7 @@ bool UdpCodec::valid_checksum6(const RawData& raw, const CodecData& codec, const
     ph6.hdr.protocol = codec.ip6_csum_proto;
     ph6.hdr.len = htons((uint16_t) raw.len);
 
+    stats.cksum_computed++;
     return (checksum::udp_cksum((const uint16_t*) raw.data, raw.len, ph6) == 0);
 }
 
@@ -21,6 +21,12 @@
 #define CODECS_CHECKSUM_H
 
 #include <cstddef>
+#include <cstdint>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define CHECKSUM_SIMD
+#endif
 
 #include <protocols/protocol_ids.h>
 
@@ -79,10 +85,102 @@ inline uint16_t ip_cksum(const uint16_t* buf, std::size_t len);
  */
 namespace detail
 {
+#ifdef CHECKSUM_SIMD
+// the ones' complement sum is independent of word order, so 16 bit words
+// are widened into 32 bit lanes and summed in parallel.  lanes are drained
+// into a 64 bit total before they can overflow.
+const unsigned simd_drain = 0x4000;
+const std::size_t simd_min_len = 64;
+
+inline uint64_t sum_sse2(const uint16_t*& sp, std::size_t& len)
+{
+    const __m128i zero = _mm_setzero_si128();
+    uint64_t sum = 0;
+
+    while ( len >= 16 )
+    {
+        __m128i acc = zero;
+
+        for ( unsigned n = 0; n < simd_drain and len >= 16; ++n )
+        {
+            __m128i v = _mm_loadu_si128((const __m128i*)sp);
+            acc = _mm_add_epi32(acc, _mm_unpacklo_epi16(v, zero));
+            acc = _mm_add_epi32(acc, _mm_unpackhi_epi16(v, zero));
+            sp += 8;
+            len -= 16;
+        }
+        uint32_t lanes[4];
+        _mm_storeu_si128((__m128i*)lanes, acc);
+        sum += (uint64_t)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    }
+    return sum;
+}
+
+__attribute__((target("avx2")))
+inline uint64_t sum_avx2(const uint16_t*& sp, std::size_t& len)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    uint64_t sum = 0;
+
+    while ( len >= 32 )
+    {
+        __m256i acc = zero;
+
+        for ( unsigned n = 0; n < simd_drain and len >= 32; ++n )
+        {
+            __m256i v = _mm256_loadu_si256((const __m256i*)sp);
+            acc = _mm256_add_epi32(acc, _mm256_unpacklo_epi16(v, zero));
+            acc = _mm256_add_epi32(acc, _mm256_unpackhi_epi16(v, zero));
+            sp += 16;
+            len -= 32;
+        }
+        uint32_t lanes[8];
+        _mm256_storeu_si256((__m256i*)lanes, acc);
+
+        for ( auto l : lanes )
+            sum += l;
+    }
+    return sum;
+}
+
+inline bool have_avx2()
+{
+    static const bool avx2 = []()
+    {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") != 0;
+    }();
+    return avx2;
+}
+
+// sums whole vectors and advances sp and len past them; the caller
+// handles the tail.  sp only moves by an even number of bytes so the
+// alignment checks in cksum_add still hold.
+inline uint32_t simd_sum(const uint16_t*& sp, std::size_t& len, uint32_t cksum)
+{
+    uint64_t sum = cksum;
+
+    if ( have_avx2() )
+        sum += sum_avx2(sp, len);
+
+    sum += sum_sse2(sp, len);
+
+    while ( sum >> 16 )
+        sum = (sum >> 16) + (sum & 0xffff);
+
+    return (uint32_t)sum;
+}
+#endif
+
 inline uint16_t cksum_add(const uint16_t* buf, std::size_t len, uint32_t cksum)
 {
     const uint16_t* sp = buf;
 
+#ifdef CHECKSUM_SIMD
+    if ( len >= simd_min_len )
+        cksum = simd_sum(sp, len, cksum);
+#endif
+
     // if pointer is 16 bit aligned calculate checksum in tight loop...
     // gcc 5.4 -O3 generates unaligned quadword instructions that crash; fixed in gcc 8.0.1
     if ( !( reinterpret_cast<std::uintptr_t>(sp) & 0x01 ) )
@@ -0,0 +1,78 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2020-2020 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// decompress_module.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "decompress_module.h"
+
+#include "inflate_pool.h"
+
+using namespace snort;
+
+// -----------------------------------------------------------------------------
+// decompress attributes
+// -----------------------------------------------------------------------------
+
+#define s_name "decompress"
+#define s_help \
+    "configure resources shared by the decompression engines"
+
+static const Parameter s_params[] =
+{
+    { "inflate_pool_size", Parameter::PT_INT, "0:max32", "32",
+      "maximum number of released zlib inflate contexts kept for reuse per packet thread" },
+
+    { nullptr, Parameter::PT_MAX, nullptr, nullptr, nullptr }
+};
+
+static const PegInfo decompress_pegs[] =
+{
+    { CountType::SUM, "inflate_pool_hits", "zlib inflate contexts reused from the pool" },
+    { CountType::SUM, "inflate_pool_misses", "zlib inflate contexts initialized from scratch" },
+    { CountType::END, nullptr, nullptr }
+};
+
+// -----------------------------------------------------------------------------
+// decompress module
+// -----------------------------------------------------------------------------
+
+DecompressModule::DecompressModule() :
+    Module(s_name, s_help, s_params)
+{ }
+
+bool DecompressModule::set(const char*, Value& v, SnortConfig*)
+{
+    if ( v.is("inflate_pool_size") )
+        InflatePool::set_max(v.get_uint32());
+
+    else
+        return false;
+
+    return true;
+}
+
+const PegInfo* DecompressModule::get_pegs() const
+{ return decompress_pegs; }
+
+PegCount* DecompressModule::get_counts() const
+{ return (PegCount*)&inflate_pool_stats; }
+
@@ -26,6 +26,8 @@
 
 #include "utils/util.h"
 
+#include "inflate_pool.h"
+
 #ifdef UNIT_TEST
 #include "catch/snort_catch.h"
 #endif
@@ -100,7 +102,7 @@ static fd_status_t Decomp(fd_session_t* SessionPtr)
     case FILE_COMPRESSION_TYPE_ZLIB:
     {
         int z_ret;
-        z_stream* z_s = &(SessionPtr->SWF->StreamZLIB);
+        z_stream* z_s = SessionPtr->SWF->StreamZLIB;
 
         SYNC_IN(z_s)
 
@@ -163,17 +165,17 @@ fd_status_t File_Decomp_End_SWF(fd_session_t* SessionPtr)
     {
     case FILE_COMPRESSION_TYPE_ZLIB:
     {
-        int z_ret;
-        z_stream* z_s = &(SessionPtr->SWF->StreamZLIB);
+        z_stream* z_s = SessionPtr->SWF->StreamZLIB;
 
-        z_ret = inflateEnd(z_s);
-
-        if ( z_ret != Z_OK )
+        if ( z_s == nullptr )
         {
             SessionPtr->Error_Event = FILE_DECOMP_ERR_SWF_ZLIB_FAILURE;
             return( File_Decomp_DecompError );
         }
 
+        InflatePool::release(z_s);
+        SessionPtr->SWF->StreamZLIB = nullptr;
+
         break;
     }
 #ifdef HAVE_LZMA
@@ -209,28 +211,22 @@ fd_status_t File_Decomp_Init_SWF(fd_session_t* SessionPtr)
     {
     case FILE_COMPRESSION_TYPE_ZLIB:
     {
-        int z_ret;
         z_stream* z_s;
 
         SessionPtr->SWF->Header_Len =
             SWF_VER_LEN + SWF_UCL_LEN;
 
-        z_s = &(SessionPtr->SWF->StreamZLIB);
-
-        memset( (char*)z_s, 0, sizeof(z_stream));
+        z_s = InflatePool::acquire(MAX_WBITS);
 
-        z_s->zalloc = (alloc_func)nullptr;
-        z_s->zfree = (free_func)nullptr;
-        SYNC_IN(z_s)
-
-        z_ret = inflateInit(z_s);
-
-        if ( z_ret != Z_OK )
+        if ( z_s == nullptr )
         {
             SessionPtr->Error_Event = FILE_DECOMP_ERR_SWF_ZLIB_FAILURE;
             return( File_Decomp_DecompError );
         }
 
+        SYNC_IN(z_s)
+        SessionPtr->SWF->StreamZLIB = z_s;
+
         break;
     }
 #ifdef HAVE_LZMA
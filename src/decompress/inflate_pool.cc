@@ -0,0 +1,204 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2020-2020 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// inflate_pool.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "inflate_pool.h"
+
+#include <cstring>
+#include <vector>
+
+#ifdef UNIT_TEST
+#include "catch/snort_catch.h"
+#endif
+
+using namespace snort;
+
+#define INFLATE_POOL_DEFAULT_MAX 32
+
+THREAD_LOCAL InflatePoolStats snort::inflate_pool_stats;
+
+static unsigned pool_max = INFLATE_POOL_DEFAULT_MAX;
+
+static THREAD_LOCAL std::vector<z_stream*>* pool = nullptr;
+static THREAD_LOCAL unsigned thread_max = 0;
+
+static void end_stream(z_stream* zs)
+{
+    inflateEnd(zs);
+    delete zs;
+}
+
+z_stream* InflatePool::acquire(int window_bits)
+{
+    while ( pool and !pool->empty() )
+    {
+        z_stream* zs = pool->back();
+        pool->pop_back();
+
+        // only fails if the window bits are invalid, in which case a fresh
+        // context would fail inflateInit2() as well
+        if ( inflateReset2(zs, window_bits) == Z_OK )
+        {
+            zs->next_in = Z_NULL;
+            zs->avail_in = 0;
+            inflate_pool_stats.hits++;
+            return zs;
+        }
+        end_stream(zs);
+    }
+
+    inflate_pool_stats.misses++;
+
+    z_stream* zs = new z_stream;
+    zs->zalloc = Z_NULL;
+    zs->zfree = Z_NULL;
+    zs->opaque = Z_NULL;
+    zs->next_in = Z_NULL;
+    zs->avail_in = 0;
+
+    if ( inflateInit2(zs, window_bits) != Z_OK )
+    {
+        delete zs;
+        return nullptr;
+    }
+    return zs;
+}
+
+void InflatePool::release(z_stream* zs)
+{
+    if ( !zs )
+        return;
+
+    if ( pool and pool->size() < thread_max )
+        pool->emplace_back(zs);
+    else
+        end_stream(zs);
+}
+
+void InflatePool::set_max(unsigned n)
+{ pool_max = n; }
+
+void InflatePool::tinit()
+{
+    thread_max = pool_max;
+    pool = new std::vector<z_stream*>;
+    pool->reserve(thread_max);
+}
+
+void InflatePool::tterm()
+{
+    if ( !pool )
+        return;
+
+    for ( auto zs : *pool )
+        end_stream(zs);
+
+    delete pool;
+    pool = nullptr;
+}
+
+//--------------------------------------------------------------------------
+// unit tests
+//--------------------------------------------------------------------------
+
+#ifdef UNIT_TEST
+
+static const uint8_t hello_gz[] =
+{
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0xcb, 0x48,
+    0xcd, 0xc9, 0xc9, 0x07, 0x00, 0x86, 0xa6, 0x10, 0x36, 0x05, 0x00, 0x00,
+    0x00
+};
+
+static int inflate_all(z_stream* zs, const uint8_t* in, unsigned len, uint8_t* out, unsigned max)
+{
+    zs->next_in = const_cast<Bytef*>(in);
+    zs->avail_in = len;
+    zs->next_out = out;
+    zs->avail_out = max;
+    return inflate(zs, Z_SYNC_FLUSH);
+}
+
+TEST_CASE("inflate_pool-no_thread_pool", "[inflate_pool]")
+{
+    inflate_pool_stats = { };
+    z_stream* zs = InflatePool::acquire(31);
+    REQUIRE(zs != nullptr);
+    InflatePool::release(zs);
+    CHECK(inflate_pool_stats.misses == 1);
+    CHECK(inflate_pool_stats.hits == 0);
+}
+
+TEST_CASE("inflate_pool-bad_window_bits", "[inflate_pool]")
+{
+    CHECK(InflatePool::acquire(99) == nullptr);
+}
+
+TEST_CASE("inflate_pool-reuse", "[inflate_pool]")
+{
+    InflatePool::tinit();
+    inflate_pool_stats = { };
+
+    uint8_t out[16];
+    z_stream* zs = InflatePool::acquire(31);
+    REQUIRE(zs != nullptr);
+    CHECK(inflate_all(zs, hello_gz, sizeof(hello_gz), out, sizeof(out)) == Z_STREAM_END);
+    InflatePool::release(zs);
+
+    // recycled context must start over cleanly, even with other window bits
+    z_stream* zs2 = InflatePool::acquire(47);
+    CHECK(zs2 == zs);
+    CHECK(inflate_all(zs2, hello_gz, sizeof(hello_gz), out, sizeof(out)) == Z_STREAM_END);
+    CHECK(!memcmp(out, "hello", 5));
+    InflatePool::release(zs2);
+
+    CHECK(inflate_pool_stats.misses == 1);
+    CHECK(inflate_pool_stats.hits == 1);
+    InflatePool::tterm();
+}
+
+TEST_CASE("inflate_pool-max", "[inflate_pool]")
+{
+    InflatePool::set_max(1);
+    InflatePool::tinit();
+    inflate_pool_stats = { };
+
+    z_stream* zs1 = InflatePool::acquire(15);
+    z_stream* zs2 = InflatePool::acquire(15);
+    InflatePool::release(zs1);
+    InflatePool::release(zs2);
+
+    z_stream* zs3 = InflatePool::acquire(15);
+    z_stream* zs4 = InflatePool::acquire(15);
+    CHECK(zs3 == zs1);
+    CHECK(inflate_pool_stats.hits == 1);
+    CHECK(inflate_pool_stats.misses == 3);
+    InflatePool::release(zs3);
+    InflatePool::release(zs4);
+
+    InflatePool::tterm();
+    InflatePool::set_max(INFLATE_POOL_DEFAULT_MAX);
+}
+
+#endif
+
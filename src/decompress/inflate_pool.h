@@ -0,0 +1,62 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2020-2020 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// inflate_pool.h
+
+#ifndef INFLATE_POOL_H
+#define INFLATE_POOL_H
+
+// per packet thread cache of zlib inflate contexts.  inflateInit2() costs a
+// state allocation and the first inflate() another 32K window; released
+// contexts keep both and are recycled with inflateReset2().
+
+#include <zlib.h>
+
+#include "framework/counts.h"
+#include "main/snort_types.h"
+#include "main/thread.h"
+
+namespace snort
+{
+struct InflatePoolStats
+{
+    PegCount hits;
+    PegCount misses;
+};
+
+extern THREAD_LOCAL InflatePoolStats inflate_pool_stats;
+
+class SO_PUBLIC InflatePool
+{
+public:
+    // returns a context ready for inflate() with the given window bits
+    // or nullptr if zlib could not be initialized
+    static z_stream* acquire(int window_bits);
+
+    // returns the context to the pool or ends it if the pool is full
+    static void release(z_stream*);
+
+    // contexts retained per packet thread; takes effect at thread start
+    static void set_max(unsigned);
+
+    static void tinit();
+    static void tterm();
+};
+}
+#endif
+
@@ -24,10 +24,14 @@
 
 #include "detection_engine.h"
 
+#include <vector>
+
 #include "events/sfeventq.h"
 #include "filters/sfthreshold.h"
 #include "framework/endianness.h"
+#include "framework/mpse_batch.h"
 #include "helpers/ring.h"
+#include "latency/latency_histogram.h"
 #include "latency/packet_latency.h"
 #include "main/analyzer.h"
 #include "main/snort_config.h"
@@ -40,6 +44,7 @@
 #include "profiler/profiler_defs.h"
 #include "protocols/packet.h"
 #include "stream/stream.h"
+#include "time/clock_defs.h"
 #include "utils/stats.h"
 
 #include "context_switcher.h"
@@ -57,6 +62,20 @@ static THREAD_LOCAL RegexOffload* offloader = nullptr;
 
 using namespace snort;
 
+// fast pattern searches deferred from several packets so they can be
+// submitted to the search engine together
+struct SearchBatch
+{
+    std::vector<Packet*> packets;
+    std::vector<MpseBatch*> searches;
+
+    hr_time start;
+    hr_duration max_time;
+    unsigned max_depth;
+};
+
+static THREAD_LOCAL SearchBatch* search_batch = nullptr;
+
 //--------------------------------------------------------------------------
 // basic de
 //--------------------------------------------------------------------------
@@ -93,10 +112,26 @@ void DetectionEngine::thread_init()
             offloader = RegexOffload::get_offloader(sc->offload_threads, true);
         }
     }
+
+    if ( sc->batch_search_depth )
+    {
+        search_batch = new SearchBatch;
+        search_batch->max_depth = sc->batch_search_depth;
+        search_batch->max_time = TO_DURATION(
+            search_batch->max_time, clock_ticks(sc->batch_search_latency));
+        search_batch->packets.reserve(sc->batch_search_depth);
+        search_batch->searches.reserve(sc->batch_search_depth);
+    }
 }
 
 void DetectionEngine::thread_term()
-{ delete offloader; }
+{
+    delete offloader;
+
+    assert(!search_batch or search_batch->packets.empty());
+    delete search_batch;
+    search_batch = nullptr;
+}
 
 DetectionEngine::DetectionEngine()
 {
@@ -389,6 +424,90 @@ bool DetectionEngine::do_offload(Packet* p)
 #endif
 }
 
+// the packet's searches are queued with those of other suspended contexts
+// and the context is resumed when the batch is flushed by onload()
+bool DetectionEngine::do_batch(Packet* p)
+{
+    ContextSwitcher* sw = Analyzer::get_switcher();
+
+    assert(p == p->context->packet);
+    assert(p->context == sw->get_context());
+
+    debug_logf(detection_trace, TRACE_DETECTION_ENGINE, p,
+        "%" PRIu64 " de::batch %" PRIu64 " (b=%zu)\n",
+        p->context->packet_number, p->context->context_num, search_batch->packets.size());
+
+    sw->suspend();
+    p->set_offloaded();
+
+    if ( search_batch->packets.empty() )
+        search_batch->start = SnortClock::now();
+
+    search_batch->packets.emplace_back(p);
+    search_batch->searches.emplace_back(&p->context->searches);
+    pc.batched_searches++;
+
+#ifdef REG_TEST
+    flush_batch();
+    return false;
+#else
+    return true;
+#endif
+}
+
+bool DetectionEngine::batch_due()
+{
+    if ( search_batch->packets.empty() )
+        return false;
+
+    if ( search_batch->packets.size() >= search_batch->max_depth )
+        return true;
+
+    if ( SnortClock::now() - search_batch->start >= search_batch->max_time )
+    {
+        pc.batch_timeouts++;
+        return true;
+    }
+    return false;
+}
+
+void DetectionEngine::flush_batch()
+{
+    if ( !search_batch or search_batch->packets.empty() )
+        return;
+
+    debug_logf(detection_trace, TRACE_DETECTION_ENGINE, nullptr,
+        "(wire) %" PRIu64 " de::flush (b=%zu)\n", get_packet_number(),
+        search_batch->packets.size());
+
+    {
+        Profile profile(mpsePerfStats);
+        MpseBatch::search_sync(search_batch->searches);
+        search_batch->searches.clear();
+        pc.search_batches++;
+    }
+
+    // resuming may queue new searches so work from a copy
+    std::vector<Packet*> ready;
+    ready.swap(search_batch->packets);
+
+    for ( auto* p : ready )
+    {
+        p->clear_offloaded();
+
+        IpsContextChain& chain = p->flow ? p->flow->context_chain :
+            Analyzer::get_switcher()->non_flow_chain;
+
+        resume_ready_suspends(chain);
+    }
+
+    if ( search_batch->packets.empty() )
+    {
+        ready.clear();
+        search_batch->packets.swap(ready);
+    }
+}
+
 bool DetectionEngine::offload(Packet* p)
 {
     ContextSwitcher* sw = Analyzer::get_switcher();
@@ -403,6 +522,9 @@ bool DetectionEngine::offload(Packet* p)
         pc.offload_busy++;
     }
 
+    if ( search_batch and p->context->searches.items.size() > 0 )
+        return do_batch(p);
+
     if ( p->flow ? p->flow->context_chain.front() : sw->non_flow_chain.front() )
     {
         Profile profile(mpsePerfStats);
@@ -419,6 +541,8 @@ bool DetectionEngine::offload(Packet* p)
 
 void DetectionEngine::idle()
 {
+    flush_batch();
+
     if (offloader)
     {
         while ( offloader->count() )
@@ -439,7 +563,10 @@ void DetectionEngine::idle()
 void DetectionEngine::onload(Flow* flow)
 {
     if ( flow->is_suspended() )
+    {
         pc.onload_waits++;
+        flush_batch();
+    }
 
     while ( flow->is_suspended() )
     {
@@ -454,6 +581,9 @@ void DetectionEngine::onload(Flow* flow)
 
 void DetectionEngine::onload()
 {
+    if ( search_batch and batch_due() )
+        flush_batch();
+
     Profile profile(mpsePerfStats);
     Packet* p;
 
@@ -520,6 +650,8 @@ void DetectionEngine::wait_for_context()
     if ( !sw->idle_count() )
     {
         pc.context_stalls++;
+        flush_batch();
+
         do
         {
             onload();
@@ -572,6 +704,7 @@ bool DetectionEngine::inspect(Packet* p)
     bool inspected = false;
     {
         PacketLatency::Context pkt_latency_ctx { p };
+        LatencyHistogram::Context pkt_hist_ctx { LatencyHistograms::get_packet() };
 
         if ( p->ptrs.decode_flags & DECODE_ERR_FLAGS )
         {
@@ -107,6 +107,9 @@ public:
 private:
     static struct SF_EVENTQ* get_event_queue();
     static bool do_offload(snort::Packet*);
+    static bool do_batch(snort::Packet*);
+    static bool batch_due();
+    static void flush_batch();
     static void offload_thread(IpsContext*);
     static void complete(snort::Packet*);
     static void resume(snort::Packet*);
@@ -29,7 +29,6 @@
 
 #include "log/messages.h"
 #include "main/snort_config.h"
-#include "main/thread_config.h"
 #include "trace/trace.h"
 
 #include "detect_trace.h"
@@ -57,6 +56,12 @@ static const Parameter detection_params[] =
     { "asn1", Parameter::PT_INT, "0:65535", "0",
       "maximum decode nodes" },
 
+    { "batch_search_depth", Parameter::PT_INT, "0:64", "0",
+      "maximum number of packets whose fast pattern searches are submitted together (0 = disabled)" },
+
+    { "batch_search_latency", Parameter::PT_INT, "0:max32", "500",
+      "maximum usecs a fast pattern search may wait for its batch to be submitted" },
+
     { "global_default_rule_state", Parameter::PT_BOOL, nullptr, "true",
       "enable or disable rules by default (overridden by ips policy settings)" },
 
@@ -72,7 +77,7 @@ static const Parameter detection_params[] =
       "minimum sizeof PDU to offload fast pattern search (defaults to disabled)" },
 
     { "offload_threads", Parameter::PT_INT, "0:max32", "0",
-      "maximum number of simultaneous offloads (defaults to disabled)" },
+      "maximum number of simultaneous offloads per packet thread and offload threads shared by all packet threads (defaults to disabled)" },
 
     { "pcre_enable", Parameter::PT_BOOL, nullptr, "true",
       "enable pcre pattern matching" },
@@ -112,19 +117,17 @@ void DetectionModule::set_trace(const Trace* trace) const
 const TraceOption* DetectionModule::get_trace_options() const
 { return detection_trace_options; }
 
-bool DetectionModule::end(const char*, int, SnortConfig* sc)
-{
-    if ( sc->offload_threads and ThreadConfig::get_instance_max() != 1 )
-        ParseError("You can not enable experimental offload with more than one packet thread.");
-
-    return true;
-}
-
 bool DetectionModule::set(const char*, Value& v, SnortConfig* sc)
 {
     if ( v.is("asn1") )
         sc->asn1_mem = v.get_uint16();
 
+    else if ( v.is("batch_search_depth") )
+        sc->batch_search_depth = v.get_uint32();
+
+    else if ( v.is("batch_search_latency") )
+        sc->batch_search_latency = v.get_uint32();
+
     else if ( v.is("global_default_rule_state") )
         sc->global_default_rule_state = v.get_bool();
 
@@ -687,8 +687,8 @@ int detection_option_node_evaluate(
             continue_loop = false;
 
         // We're essentially checking this node again and it potentially
-        // might match again
-        if ( continue_loop )
+        // might match again; counted like other checks only when sampled
+        if ( continue_loop and profile.is_on() )
             state.checks++;
 
         loop_count++;
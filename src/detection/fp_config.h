@@ -98,6 +98,12 @@ public:
     bool get_split_any_any() const
     { return split_any_any; }
 
+    void set_fuse_any_any(bool enable)
+    { fuse_any_any = enable; }
+
+    bool get_fuse_any_any() const
+    { return fuse_any_any; }
+
     void set_single_rule_group()
     { portlists_flags |= PL_SINGLE_RULE_GROUP; }
 
@@ -149,6 +155,7 @@ private:
 
     bool inspect_stream_insert = true;
     bool split_any_any = false;
+    bool fuse_any_any = false;
     bool debug_print_fast_pattern = false;
     bool debug = false;
     bool search_opt = false;
@@ -1107,6 +1107,120 @@ static void fpCreatePortTablePortGroups(SnortConfig* sc, PortTable* p, PortObjec
     }
 }
 
+/*
+ *  Build combined matchers for a port group and the any-any group so that
+ *  buffers searched by both are scanned once.  The fused matchers have
+ *  their own PMXs and trees, so matches are processed as if the two groups
+ *  had been searched separately.
+ */
+static void fpCreateFusedPortGroup(
+    SnortConfig* sc, PortObject2* po, PortObject2* poaa, PortGroup* any)
+{
+    PortGroup* pg = po->group;
+
+    if ( !pg or !any )
+        return;
+
+    FastPatternConfig* fp = sc->fast_pattern_config;
+    PortGroup* both = PortGroup::alloc();
+    s_group = "fused";
+
+    for ( PortObject2* pox : { po, poaa } )
+    {
+        if ( !pox->rule_hash )
+            continue;
+
+        for (GHashNode* node = pox->rule_hash->find_first();
+             node;
+             node = pox->rule_hash->find_next())
+        {
+            unsigned sid, gid;
+            int* prindex = (int*)node->data;
+
+            if (prindex == nullptr)
+                continue;
+
+            parser_get_rule_ids(*prindex, gid, sid);
+
+            OptTreeNode* otn = OtnLookup(sc->otn_map, gid, sid);
+            assert(otn);
+
+            if ( is_network_protocol(otn->snort_protocol_id) )
+                fpAddPortGroupRule(sc, both, otn, fp, false);
+        }
+    }
+
+    for (int i = PM_TYPE_PKT; i < PM_TYPE_MAX; i++)
+    {
+        MpseGroup* fused = both->mpsegrp[i];
+        both->mpsegrp[i] = nullptr;
+
+        if ( !fused )
+            continue;
+
+        // only worth keeping where both groups search this buffer type
+        if ( !pg->mpsegrp[i] or !any->mpsegrp[i] )
+        {
+            delete fused;
+            continue;
+        }
+
+        // as with the port groups, empty engines are dropped rather than queued
+        if ( fused->normal_mpse and !fused->normal_mpse->get_pattern_count() )
+        {
+            MpseManager::delete_search_engine(fused->normal_mpse);
+            fused->normal_mpse = nullptr;
+        }
+
+        if ( fused->offload_mpse and !fused->offload_mpse->get_pattern_count() )
+        {
+            MpseManager::delete_search_engine(fused->offload_mpse);
+            fused->offload_mpse = nullptr;
+        }
+
+        if ( !fused->normal_mpse )
+        {
+            delete fused;
+            continue;
+        }
+
+        queue_mpse(fused->normal_mpse);
+
+        if ( fused->offload_mpse )
+            queue_mpse(fused->offload_mpse);
+
+        pg->mpsegrp[i]->set_fused(any->mpsegrp[i], fused);
+    }
+
+    // nfp rules are still evaluated by the original groups
+    PortGroup::free(both);
+}
+
+static void fpCreateFusedPortGroups(
+    SnortConfig* sc, PortTable* p, PortObject2* poaa, PortGroup* any)
+{
+    for (GHashNode* node = p->pt_mpo_hash->find_first();
+         node;
+         node = p->pt_mpo_hash->find_next())
+    {
+        PortObject2* po = (PortObject2*)node->data;
+
+        if ( po and po->port_cnt )
+            fpCreateFusedPortGroup(sc, po, poaa, any);
+    }
+}
+
+static void fpCreateFusedPortGroups(
+    SnortConfig* sc, PortProto& proto, PortObject2* poaa)
+{
+    if ( !sc->fast_pattern_config->get_split_any_any() or
+        !sc->fast_pattern_config->get_fuse_any_any() )
+        return;
+
+    fpCreateFusedPortGroups(sc, proto.src, poaa, proto.any->group);
+    fpCreateFusedPortGroups(sc, proto.dst, poaa, proto.any->group);
+}
+
 /*
  *  Create port group objects for all port tables
  *
@@ -1141,6 +1255,7 @@ static int fpCreatePortGroups(SnortConfig* sc, RulePortTables* p)
     fpCreatePortObject2PortGroup(sc, po2, nullptr);
     p->ip.any->group = po2->group;
     po2->group = nullptr;
+    fpCreateFusedPortGroups(sc, p->ip, po2);
     PortObject2Free(po2);
 
     /* ICMP */
@@ -1163,6 +1278,7 @@ static int fpCreatePortGroups(SnortConfig* sc, RulePortTables* p)
     fpCreatePortObject2PortGroup(sc, po2, nullptr);
     p->icmp.any->group = po2->group;
     po2->group = nullptr;
+    fpCreateFusedPortGroups(sc, p->icmp, po2);
     PortObject2Free(po2);
 
     po2 = PortObject2Dup(*p->tcp.any);
@@ -1184,6 +1300,7 @@ static int fpCreatePortGroups(SnortConfig* sc, RulePortTables* p)
     fpCreatePortObject2PortGroup(sc, po2, nullptr);
     p->tcp.any->group = po2->group;
     po2->group = nullptr;
+    fpCreateFusedPortGroups(sc, p->tcp, po2);
     PortObject2Free(po2);
 
     /* UDP */
@@ -1206,6 +1323,7 @@ static int fpCreatePortGroups(SnortConfig* sc, RulePortTables* p)
     fpCreatePortObject2PortGroup(sc, po2, nullptr);
     p->udp.any->group = po2->group;
     po2->group = nullptr;
+    fpCreateFusedPortGroups(sc, p->udp, po2);
     PortObject2Free(po2);
 
     /* SVC */
@@ -1571,6 +1689,17 @@ int fpCreateFastPacketDetection(SnortConfig* sc)
     assert(port_tables);
     assert(fp);
 
+    if ( sc->offload_threads and ThreadConfig::get_instance_max() != 1 )
+    {
+        // offload threads are shared by all packet threads but async
+        // engines poll for responses per engine, not per packet thread
+        const MpseApi* offload_api = fp->get_offload_search_api();
+
+        if ( (offload_api and MpseManager::is_async_capable(offload_api)) or
+            MpseManager::is_async_capable(fp->get_search_api()) )
+            ParseError("You can not enable async offload with more than one packet thread.");
+    }
+
     if ( !get_rule_count() )
     {
         sc->sopgTable = new sopg_table_t(sc->proto_ref->get_count());
@@ -44,6 +44,7 @@
 #include "filters/sfthreshold.h"
 #include "framework/cursor.h"
 #include "framework/mpse.h"
+#include "latency/latency_histogram.h"
 #include "latency/packet_latency.h"
 #include "latency/rule_latency.h"
 #include "log/messages.h"
@@ -235,6 +236,26 @@ int fpLogEvent(const RuleTreeNode* rtn, const OptTreeNode* otn, Packet* p)
     return 0;
 }
 
+// event order predicates; true if otn1 should be logged before otn2.
+// sid breaks ties to improve stability of repeated tests.
+static bool precedesByPriority(const OptTreeNode* otn1, const OptTreeNode* otn2)
+{
+    if ( otn1->sigInfo.priority != otn2->sigInfo.priority )
+        return otn1->sigInfo.priority < otn2->sigInfo.priority;
+
+    return otn1->sigInfo.sid < otn2->sigInfo.sid;
+}
+
+// FIXIT-L pattern length is not a valid event sort criterion for
+// non-literals
+static bool precedesByContentLength(const OptTreeNode* otn1, const OptTreeNode* otn2)
+{
+    if ( otn1->longestPatternLen != otn2->longestPatternLen )
+        return otn1->longestPatternLen > otn2->longestPatternLen;
+
+    return otn1->sigInfo.sid > otn2->sigInfo.sid;
+}
+
 /*
 **  DESCRIPTION
 **    Add an Event to the appropriate Match Queue: Alert, Pass, or Log.
@@ -242,6 +263,11 @@ int fpLogEvent(const RuleTreeNode* rtn, const OptTreeNode* otn, Packet* p)
 **    one.  This function also allows us to change the order of alert,
 **    pass, and log signatures by caching them for decision later.
 **
+**    Each queue is kept sorted in event order as matches are added so
+**    no sort is needed at final selection.  When a queue is full, a
+**    match that ranks ahead of the last entry displaces it; otherwise
+**    the match is dropped.  Either way match_limit is counted.
+**
 **  IMPORTANT NOTE:
 **    fpAddMatch must be called even when the queue has been maxed
 **    out.  This is because there are three different queues (alert,
@@ -272,26 +298,47 @@ int fpAddMatch(OtnxMatchData* omd, const OptTreeNode* otn)
     }
     MatchInfo* pmi = &omd->matchInfo[evalIndex];
 
+    // don't store the same otn again
+    for ( unsigned i = 0; i < pmi->iMatchCount; i++ )
+    {
+        if ( pmi->MatchArray[i] == otn )
+            return 0;
+    }
+
+    unsigned max = sc->fast_pattern_config->get_max_queue_events();
+
+    if ( max > MAX_EVENT_MATCH )
+        max = MAX_EVENT_MATCH;
+
+    bool (* precedes)(const OptTreeNode*, const OptTreeNode*) =
+        ( sc->event_queue_config->order == SNORT_EVENTQ_PRIORITY )
+        ? precedesByPriority : precedesByContentLength;
+
+    // find the insertion point, scanning from the lowest ranked end
+    unsigned pos = pmi->iMatchCount;
+
+    while ( pos > 0 and precedes(otn, pmi->MatchArray[pos - 1]) )
+        --pos;
+
     /*
     **  If we hit the max number of unique events for any rule type alert,
-    **  log or pass, then we don't add it to the list.
+    **  log or pass, then we either drop this event or the last one.
     */
-    if ( pmi->iMatchCount >= sc->fast_pattern_config->get_max_queue_events() ||
-        pmi->iMatchCount >= MAX_EVENT_MATCH)
+    if ( pmi->iMatchCount >= max )
     {
         pc.match_limit++;
-        return 1;
-    }
 
-    // don't store the same otn again
-    for ( unsigned i = 0; i < pmi->iMatchCount; i++ )
-    {
-        if ( pmi->MatchArray[i] == otn )
-            return 0;
+        if ( pos >= max )
+            return 1;
+
+        pmi->iMatchCount = max - 1;
     }
 
-    //  add the event to the appropriate list
-    pmi->MatchArray[ pmi->iMatchCount ] = otn;
+    //  add the event to the appropriate list in order
+    for ( unsigned i = pmi->iMatchCount; i > pos; --i )
+        pmi->MatchArray[i] = pmi->MatchArray[i - 1];
+
+    pmi->MatchArray[pos] = otn;
     pmi->iMatchCount++;
     omd->have_match = true;
     return 0;
@@ -324,6 +371,7 @@ static int detection_option_tree_evaluate(detection_option_tree_root_t* root,
         return 0;
 
     RuleLatency::Context rule_latency_ctx(root, eval_data.p);
+    LatencyHistogram::Context rule_hist_ctx(LatencyHistograms::get_rule());
 
     if ( RuleLatency::suspended() )
         return 0;
@@ -432,62 +480,6 @@ static int rule_tree_match(
     return 0;
 }
 
-static int sortOrderByPriority(const void* e1, const void* e2)
-{
-    const OptTreeNode* otn1;
-    const OptTreeNode* otn2;
-
-    if (!e1 || !e2)
-        return 0;
-
-    otn1 = *(OptTreeNode* const*)e1;
-    otn2 = *(OptTreeNode* const*)e2;
-
-    if ( otn1->sigInfo.priority < otn2->sigInfo.priority )
-        return -1;
-
-    if ( otn1->sigInfo.priority > otn2->sigInfo.priority )
-        return +1;
-
-    /* This improves stability of repeated tests */
-    if ( otn1->sigInfo.sid < otn2->sigInfo.sid )
-        return -1;
-
-    if ( otn1->sigInfo.sid > otn2->sigInfo.sid )
-        return +1;
-
-    return 0;
-}
-
-// FIXIT-L pattern length is not a valid event sort criterion for
-// non-literals
-static int sortOrderByContentLength(const void* e1, const void* e2)
-{
-    const OptTreeNode* otn1;
-    const OptTreeNode* otn2;
-
-    if (!e1 || !e2)
-        return 0;
-
-    otn1 = *(OptTreeNode* const*)e1;
-    otn2 = *(OptTreeNode* const*)e2;
-
-    if (otn1->longestPatternLen < otn2->longestPatternLen)
-        return +1;
-
-    if (otn1->longestPatternLen > otn2->longestPatternLen)
-        return -1;
-
-    /* This improves stability of repeated tests */
-    if ( otn1->sigInfo.sid < otn2->sigInfo.sid )
-        return +1;
-
-    if ( otn1->sigInfo.sid > otn2->sigInfo.sid )
-        return -1;
-
-    return 0;
-}
-
 /*
 **  DESCRIPTION
 **    This function flags an alert per session.
@@ -609,9 +601,6 @@ static inline int fpFinalSelectEvent(OtnxMatchData* omd, Packet* p)
 
     unsigned tcnt = 0;
     EventQueueConfig* eq = p->context->conf->event_queue_config;
-    int (*compar)(const void *, const void *);
-    compar = ( eq->order == SNORT_EVENTQ_PRIORITY )
-        ? &sortOrderByPriority : sortOrderByContentLength;
 
     for ( unsigned i = 0; i < p->context->conf->num_rule_types; i++ )
     {
@@ -623,9 +612,9 @@ static inline int fpFinalSelectEvent(OtnxMatchData* omd, Packet* p)
         if ( omd->matchInfo[i].iMatchCount )
         {
             /*
-             * We must always sort so if we que 8 and log 3 and they are
-             * all from the same action group we want them sorted so we get
-             * the highest 3 in priority, priority and length sort do NOT
+             * Each action group was kept sorted by fpAddMatch so if we
+             * queue 8 and log 3 from the same group we get the highest 3
+             * in priority (or length) order.  Priority and length do NOT
              * take precedence over 'alert drop pass ...' ordering.  If
              * order is 'drop alert', and we log 3 for drop alerts do not
              * get logged.  IF order is 'alert drop', and we log 3 for
@@ -633,10 +622,6 @@ static inline int fpFinalSelectEvent(OtnxMatchData* omd, Packet* p)
              * built in drop/block/reset comes before alert/pass/log as
              * part of the natural ordering....Jan '06..
              */
-            /* Sort the rules in this action group */
-            qsort(omd->matchInfo[i].MatchArray, omd->matchInfo[i].iMatchCount,
-                sizeof(void*), compar);
-
             /* Process each event in the action (alert,drop,log,...) groups */
             for (unsigned j = 0; j < omd->matchInfo[i].iMatchCount; j++)
             {
@@ -650,16 +635,6 @@ static inline int fpFinalSelectEvent(OtnxMatchData* omd, Packet* p)
                         return 1;
                 }
 
-                //  Loop here so we don't log the same event multiple times.
-                for (unsigned k = 0; k < j; k++)
-                {
-                    if ( omd->matchInfo[i].MatchArray[k] == otn )
-                    {
-                        otn = nullptr;
-                        break;
-                    }
-                }
-
                 if ( otn && !fpSessionAlerted(p, otn) )
                 {
                     if ( DetectionEngine::queue_event(otn) )
@@ -29,6 +29,7 @@
 #include <atomic>
 #include <chrono>
 #include <condition_variable>
+#include <deque>
 #include <mutex>
 #include <vector>
 #include <thread>
@@ -50,10 +51,6 @@ struct RegexRequest
 {
     Packet* packet = nullptr;
 
-    std::thread* thread;
-    std::mutex mutex;
-    std::condition_variable cond;
-
 #ifdef REG_TEST
     // used to make main thread wait for results to get predictable behavior
     std::mutex sync_mutex;
@@ -61,8 +58,6 @@ struct RegexRequest
 #endif
 
     std::atomic<bool> offload { false };
-
-    bool go = true;
 };
 
 RegexOffload* RegexOffload::get_offloader(unsigned max, bool async)
@@ -176,39 +171,242 @@ bool MpseRegexOffload::get(Packet*& p)
 }
 
 //--------------------------------------------------------------------------
-// async (threads) offload implementation
+// offload worker pool shared by all packet threads
 //--------------------------------------------------------------------------
 
-ThreadRegexOffload::ThreadRegexOffload(unsigned max) : RegexOffload(max)
+// each packet thread queues requests to its home worker and a worker that
+// runs dry steals the newest request from another worker.  completion order
+// doesn't matter; contexts are resumed in order from their context chains.
+
+class OffloadPool
 {
-    unsigned i = ThreadConfig::get_instance_max();
-    const SnortConfig* sc = SnortConfig::get_conf();
+public:
+    static OffloadPool* acquire(unsigned workers);
+    static void release();
 
-    for ( auto* req : idle )
-        req->thread = new std::thread(worker, req, sc, i++);
+    void put(RegexRequest*);
+
+private:
+    struct Worker
+    {
+        std::deque<RegexRequest*> queue;
+        std::mutex mutex;
+        std::thread* thread = nullptr;
+    };
+
+    OffloadPool(unsigned workers, const SnortConfig*);
+    ~OffloadPool();
+
+    RegexRequest* get(unsigned idx);
+    void work(unsigned idx, const SnortConfig*, unsigned id);
+
+    static void search(RegexRequest*);
+
+private:
+    std::vector<Worker*> workers;
+
+    std::mutex mutex;
+    std::condition_variable cond;
+    unsigned pending = 0;
+    bool go = true;
+
+    static std::mutex pool_mutex;
+    static OffloadPool* pool;
+    static unsigned users;
+};
+
+std::mutex OffloadPool::pool_mutex;
+OffloadPool* OffloadPool::pool = nullptr;
+unsigned OffloadPool::users = 0;
+
+OffloadPool* OffloadPool::acquire(unsigned max)
+{
+    std::lock_guard<std::mutex> lock(pool_mutex);
+
+    if ( !pool )
+        pool = new OffloadPool(max, SnortConfig::get_conf());
+
+    ++users;
+    return pool;
 }
 
-ThreadRegexOffload::~ThreadRegexOffload()
+void OffloadPool::release()
+{
+    std::lock_guard<std::mutex> lock(pool_mutex);
+    assert(users);
+
+    if ( --users )
+        return;
+
+    delete pool;
+    pool = nullptr;
+}
+
+OffloadPool::OffloadPool(unsigned max, const SnortConfig* sc)
+{
+    unsigned id = ThreadConfig::get_instance_max();
+
+    for ( unsigned i = 0; i < max; ++i )
+        workers.emplace_back(new Worker);
+
+    for ( unsigned i = 0; i < max; ++i )
+        workers[i]->thread = new std::thread(&OffloadPool::work, this, i, sc, id++);
+}
+
+OffloadPool::~OffloadPool()
 {
-    for ( auto* req : idle )
     {
-        req->thread->join();
-        delete req->thread;
+        std::lock_guard<std::mutex> lock(mutex);
+        go = false;
+    }
+    cond.notify_all();
+
+    for ( auto* w : workers )
+    {
+        w->thread->join();
+        delete w->thread;
+
+        assert(w->queue.empty());
+        delete w;
     }
 }
 
-void ThreadRegexOffload::stop()
+void OffloadPool::put(RegexRequest* req)
 {
-    RegexOffload::stop();
+    Worker* w = workers[get_instance_id() % workers.size()];
+    PegCount depth;
 
-    for ( auto* req : idle )
     {
-        std::unique_lock<std::mutex> lock(req->mutex);
-        req->go = false;
-        req->cond.notify_one();
+        std::lock_guard<std::mutex> lock(w->mutex);
+        w->queue.emplace_back(req);
+        depth = w->queue.size();
+    }
+
+    if ( depth > pc.offload_queue_max )
+        pc.offload_queue_max = depth;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++pending;
+    }
+    cond.notify_one();
+}
+
+RegexRequest* OffloadPool::get(unsigned idx)
+{
+    RegexRequest* req = nullptr;
+
+    {
+        Worker* w = workers[idx];
+        std::lock_guard<std::mutex> lock(w->mutex);
+
+        if ( !w->queue.empty() )
+        {
+            req = w->queue.front();
+            w->queue.pop_front();
+            return req;
+        }
+    }
+
+    for ( unsigned i = 1; i < workers.size(); ++i )
+    {
+        Worker* w = workers[(idx + i) % workers.size()];
+        std::lock_guard<std::mutex> lock(w->mutex);
+
+        if ( !w->queue.empty() )
+        {
+            req = w->queue.back();
+            w->queue.pop_back();
+            pc.offload_steals++;
+            break;
+        }
+    }
+    return req;
+}
+
+void OffloadPool::work(unsigned idx, const SnortConfig* initial_config, unsigned id)
+{
+    set_instance_id(id);
+    SnortConfig::set_conf(initial_config);
+
+    while ( true )
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cond.wait(lock, [this]() { return pending or !go; });
+
+            if ( !pending )
+                break;
+
+            // claim one of the queued requests
+            --pending;
+        }
+
+        RegexRequest* req;
+
+        // another worker may have taken the one we saw but one remains
+        while ( !(req = get(idx)) )
+            std::this_thread::yield();
+
+        search(req);
+    }
+    ModuleManager::accumulate_offload("search_engine");
+    ModuleManager::accumulate_offload("detection");
+
+    // FIXIT-M break this over-coupling. In reality we shouldn't be evaluating latency in offload.
+    PacketLatency::tterm();
+    RuleLatency::tterm();
+}
+
+void OffloadPool::search(RegexRequest* req)
+{
+    assert(req->packet);
+    assert(req->packet->is_offloaded());
+    assert(req->packet->context->searches.items.size() > 0);
+
+    SnortConfig::set_conf(req->packet->context->conf);
+    IpsContext* c = req->packet->context;
+    Mpse::MpseRespType resp_ret;
+
+    c->searches.offload_search();
+
+    do
+    {
+        resp_ret = c->searches.receive_offload_responses();
+    }
+    while (resp_ret == Mpse::MPSE_RESP_NOT_COMPLETE);
+
+    if (resp_ret == Mpse::MPSE_RESP_COMPLETE_FAIL)
+    {
+        if (c->searches.can_fallback())
+        {
+            c->searches.search_sync();
+            pc.offload_fallback++;
+        }
+        pc.offload_failures++;
+    }
+
+    c->searches.items.clear();
+    req->offload = false;
+
+#ifdef REG_TEST
+    {
+        std::unique_lock<std::mutex> lock(req->sync_mutex);
+        req->sync_cond.notify_one();
     }
+#endif
 }
 
+//--------------------------------------------------------------------------
+// async (threads) offload implementation
+//--------------------------------------------------------------------------
+
+ThreadRegexOffload::ThreadRegexOffload(unsigned max) : RegexOffload(max)
+{ pool = OffloadPool::acquire(max); }
+
+ThreadRegexOffload::~ThreadRegexOffload()
+{ OffloadPool::release(); }
+
 void ThreadRegexOffload::put(Packet* p)
 {
     Profile profile(mpsePerfStats);
@@ -223,13 +421,9 @@ void ThreadRegexOffload::put(Packet* p)
     busy.emplace_back(req);
     p->context->regex_req_it = std::prev(busy.end());
 
-    {
-        std::unique_lock<std::mutex> lock(req->mutex);
-        req->packet = p;
-
-        req->offload = true;
-        req->cond.notify_one();
-    }
+    req->packet = p;
+    req->offload = true;
+    pool->put(req);
 
 #ifdef REG_TEST
     {
@@ -265,67 +459,3 @@ bool ThreadRegexOffload::get(Packet*& p)
     p = nullptr;
     return false;
 }
-
-void ThreadRegexOffload::worker(
-    RegexRequest* req, const SnortConfig* initial_config, unsigned id)
-{
-    set_instance_id(id);
-    SnortConfig::set_conf(initial_config);
-
-    while ( true )
-    {
-        {
-            std::unique_lock<std::mutex> lock(req->mutex);
-            req->cond.wait_for(lock, std::chrono::seconds(1));
-
-            if ( !req->go )
-                break;
-
-            if ( !req->offload )
-                continue;
-        }
-
-        assert(req->packet);
-        assert(req->packet->is_offloaded());
-        assert(req->packet->context->searches.items.size() > 0);
-
-        SnortConfig::set_conf(req->packet->context->conf);
-        IpsContext* c = req->packet->context;
-        Mpse::MpseRespType resp_ret;
-
-        c->searches.offload_search();
-
-        do
-        {
-            resp_ret = c->searches.receive_offload_responses();
-        }
-        while (resp_ret == Mpse::MPSE_RESP_NOT_COMPLETE);
-
-        if (resp_ret == Mpse::MPSE_RESP_COMPLETE_FAIL)
-        {
-            if (c->searches.can_fallback())
-            {
-                c->searches.search_sync();
-                pc.offload_fallback++;
-            }
-            pc.offload_failures++;
-        }
-
-        c->searches.items.clear();
-        req->offload = false;
-
-#ifdef REG_TEST
-        {
-            std::unique_lock<std::mutex> lock(req->sync_mutex);
-            req->sync_cond.notify_one();
-        }
-#endif
-    }
-    ModuleManager::accumulate_offload("search_engine");
-    ModuleManager::accumulate_offload("detection");
-
-    // FIXIT-M break this over-coupling. In reality we shouldn't be evaluating latency in offload.
-    PacketLatency::tterm();
-    RuleLatency::tterm();
-}
-
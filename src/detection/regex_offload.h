@@ -25,13 +25,10 @@
 // There are two flavors: MPSE and thread.  The MpseRegexOffload interfaces to
 // an MPSE that is capable of regex offload such as the RXP whereas
 // ThreadRegexOffload implements the regex search in auxiliary threads w/o
-// requiring extra MPSE instances.  presently all offload is per packet thread;
-// packet threads do not share offload resources.
+// requiring extra MPSE instances.  request slots are per packet thread but
+// the auxiliary threads are a single pool shared by all packet threads.
 
-#include <condition_variable>
 #include <list>
-#include <mutex>
-#include <thread>
 
 namespace snort
 {
@@ -39,6 +36,7 @@ class Flow;
 struct Packet;
 struct SnortConfig;
 }
+class OffloadPool;
 struct RegexRequest;
 
 class RegexOffload
@@ -83,13 +81,11 @@ public:
     ThreadRegexOffload(unsigned max);
     ~ThreadRegexOffload() override;
 
-    void stop() override;
-
     void put(snort::Packet*) override;
     bool get(snort::Packet*&) override;
 
 private:
-    static void worker(RegexRequest*, const snort::SnortConfig*, unsigned id);
+    OffloadPool* pool;
 };
 
 #endif
@@ -55,7 +55,8 @@ class SO_PUBLIC FileFlows : public FlowData
 {
 public:
 
-    FileFlows(Flow* f, FileInspect* inspect) : FlowData(file_flow_data_id, inspect), flow(f) { }
+    FileFlows(Flow* f, FileInspect* inspect) : FlowData(file_flow_data_id, inspect), flow(f)
+    { set_memory_tag(memory::MemoryTag::FILE); }
     ~FileFlows() override;
     static void init()
     { file_flow_data_id = FlowData::create_flow_data_id(); }
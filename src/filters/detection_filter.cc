@@ -23,7 +23,6 @@
 
 #include "detection_filter.h"
 
-#include "hash/xhash.h"
 #include "log/messages.h"
 #include "main/thread.h"
 #include "utils/util.h"
@@ -32,7 +31,7 @@
 
 using namespace snort;
 
-static THREAD_LOCAL XHash* detection_filter_hash = nullptr;
+static THREAD_LOCAL ThdLocalHash* detection_filter_hash = nullptr;
 
 DetectionFilterConfig* DetectionFilterConfigNew()
 {
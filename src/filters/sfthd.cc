@@ -37,7 +37,6 @@
 
 #include "hash/ghash.h"
 #include "hash/hash_defs.h"
-#include "hash/xhash.h"
 #include "main/thread.h"
 #include "sfip/sf_ipvar.h"
 #include "utils/dyn_array.h"
@@ -51,9 +50,10 @@ using namespace snort;
 
 THREAD_LOCAL EventFilterStats event_filter_stats;
 
-XHash* sfthd_new_hash(unsigned nbytes, size_t key, size_t data)
+template<typename Key>
+static XHashT<Key, THD_IP_NODE>* sfthd_new_hash(unsigned nbytes)
 {
-    size_t size = key + data;
+    size_t size = sizeof(Key) + sizeof(THD_IP_NODE);
     int nrows;
 
     /* Calc max ip nodes for this memory */
@@ -61,7 +61,7 @@ XHash* sfthd_new_hash(unsigned nbytes, size_t key, size_t data)
         nbytes = size;
     nrows = nbytes / size;
 
-    return new XHash(nrows, key, data, nbytes);
+    return new XHashT<Key, THD_IP_NODE>(nrows, nbytes);
 }
 
 /*!
@@ -75,12 +75,9 @@ XHash* sfthd_new_hash(unsigned nbytes, size_t key, size_t data)
   @retval !0 valid THD_STRUCT
 */
 
-XHash* sfthd_local_new(unsigned bytes)
+ThdLocalHash* sfthd_local_new(unsigned bytes)
 {
-    XHash* local_hash =
-        sfthd_new_hash(bytes,
-        sizeof(THD_IP_NODE_KEY),
-        sizeof(THD_IP_NODE));
+    ThdLocalHash* local_hash = sfthd_new_hash<THD_IP_NODE_KEY>(bytes);
 
 #ifdef THD_DEBUG
     if (local_hash == NULL)
@@ -90,12 +87,9 @@ XHash* sfthd_local_new(unsigned bytes)
     return local_hash;
 }
 
-XHash* sfthd_global_new(unsigned bytes)
+ThdGlobalHash* sfthd_global_new(unsigned bytes)
 {
-    XHash* global_hash =
-        sfthd_new_hash(bytes,
-        sizeof(THD_IP_GNODE_KEY),
-        sizeof(THD_IP_NODE));
+    ThdGlobalHash* global_hash = sfthd_new_hash<THD_IP_GNODE_KEY>(bytes);
 
 #ifdef THD_DEBUG
     if (global_hash == NULL)
@@ -623,7 +617,7 @@ static char* printIP(unsigned u, char* buf, unsigned len)
 
 #endif
 
-int sfthd_test_rule(XHash* rule_hash, THD_NODE* sfthd_node,
+int sfthd_test_rule(ThdLocalHash* rule_hash, THD_NODE* sfthd_node,
     const SfIp* sip, const SfIp* dip, long curtime, PolicyId policy_id)
 {
     if ((rule_hash == nullptr) || (sfthd_node == nullptr))
@@ -812,7 +806,7 @@ static inline int sfthd_test_non_suppress(
  *
  */
 int sfthd_test_local(
-    XHash* local_hash,
+    ThdLocalHash* local_hash,
     THD_NODE* sfthd_node,
     const SfIp* sip,
     const SfIp* dip,
@@ -880,11 +874,11 @@ int sfthd_test_local(
     /*
      * Check for any Permanent sig_id objects for this gen_id  or add this one ...
      */
-    int status = local_hash->insert((void*)&key, &data);
+    int status = local_hash->insert(key, &data);
     if (status == HASH_INTABLE)
     {
         /* Already in the table */
-        sfthd_ip_node = (THD_IP_NODE*)local_hash->get_user_data();
+        sfthd_ip_node = local_hash->get_user_data();
 
         /* Increment the event count */
         sfthd_ip_node->count++;
@@ -912,7 +906,7 @@ int sfthd_test_local(
  *   Test a global thresholding object
  */
 static inline int sfthd_test_global(
-    XHash* global_hash,
+    ThdGlobalHash* global_hash,
     THD_NODE* sfthd_node,
     unsigned sig_id,     /* from current event */
     const SfIp* sip,        /* " */
@@ -977,11 +971,11 @@ static inline int sfthd_test_global(
     data.tstart = data.tlast = curtime; /* Event time */
 
     /* Check for any Permanent sig_id objects for this gen_id  or add this one ...  */
-    int status = global_hash->insert((void*)&key, &data);
+    int status = global_hash->insert(key, &data);
     if (status == HASH_INTABLE)
     {
         /* Already in the table */
-        sfthd_ip_node = (THD_IP_NODE*)global_hash->get_user_data();
+        sfthd_ip_node = global_hash->get_user_data();
 
         /* Increment the event count */
         sfthd_ip_node->count++;
@@ -24,6 +24,7 @@
 #define SFTHD_H
 
 #include "framework/counts.h"
+#include "hash/xhash_t.h"
 #include "main/policy.h"
 #include "sfip/sf_ip.h"
 #include "utils/cpp_macros.h"
@@ -31,7 +32,6 @@
 namespace snort
 {
 class GHash;
-class XHash;
 struct SnortConfig;
 }
 
@@ -118,6 +118,9 @@ struct THD_IP_GNODE_KEY
 };
 PADDING_GUARD_END
 
+typedef snort::XHashT<THD_IP_NODE_KEY, THD_IP_NODE> ThdLocalHash;
+typedef snort::XHashT<THD_IP_GNODE_KEY, THD_IP_NODE> ThdGlobalHash;
+
 /*!
     A Thresholding Object
     These are created at program startup, and remain static.
@@ -188,8 +191,8 @@ struct tThdItemKey
  */
 struct THD_STRUCT
 {
-    snort::XHash* ip_nodes;   /* Global hash of active IP's key=THD_IP_NODE_KEY, data=THD_IP_NODE */
-    snort::XHash* ip_gnodes;  /* Global hash of active IP's key=THD_IP_GNODE_KEY, data=THD_IP_GNODE */
+    ThdLocalHash* ip_nodes;   /* Global hash of active IP's key=THD_IP_NODE_KEY, data=THD_IP_NODE */
+    ThdGlobalHash* ip_gnodes; /* Global hash of active IP's key=THD_IP_GNODE_KEY, data=THD_IP_NODE */
 };
 
 struct ThresholdObjects
@@ -221,13 +224,13 @@ struct EventFilterStats
 // lbytes = local threshold memcap
 // gbytes = global threshold memcap (0 to disable global)
 THD_STRUCT* sfthd_new(unsigned lbytes, unsigned gbytes);
-snort::XHash* sfthd_local_new(unsigned bytes);
-snort::XHash* sfthd_global_new(unsigned bytes);
+ThdLocalHash* sfthd_local_new(unsigned bytes);
+ThdGlobalHash* sfthd_global_new(unsigned bytes);
 void sfthd_free(THD_STRUCT*);
 ThresholdObjects* sfthd_objs_new();
 void sfthd_objs_free(ThresholdObjects*);
 
-int sfthd_test_rule(snort::XHash* rule_hash, THD_NODE* sfthd_node,
+int sfthd_test_rule(ThdLocalHash* rule_hash, THD_NODE* sfthd_node,
     const snort::SfIp* sip, const snort::SfIp* dip, long curtime, PolicyId policy_id);
 
 THD_NODE* sfthd_create_rule_threshold(
@@ -249,9 +252,7 @@ int sfthd_create_threshold(snort::SnortConfig*, ThresholdObjects*, unsigned gen_
 int sfthd_test_threshold(ThresholdObjects*, THD_STRUCT*, unsigned gen_id, unsigned sig_id,
     const snort::SfIp* sip, const snort::SfIp* dip, long curtime, PolicyId policy_id);
 
-snort::XHash* sfthd_new_hash(unsigned, size_t, size_t);
-
-int sfthd_test_local(snort::XHash* local_hash, THD_NODE* sfthd_node, const snort::SfIp* sip,
+int sfthd_test_local(ThdLocalHash* local_hash, THD_NODE* sfthd_node, const snort::SfIp* sip,
     const snort::SfIp* dip, time_t curtime, PolicyId policy_id);
 
 #ifdef THD_DEBUG
@@ -24,7 +24,6 @@
 
 #include "catch/snort_catch.h"
 #include "main/snort_config.h"
-#include "hash/xhash.h"
 #include "parser/parse_ip.h"
 #include "sfip/sf_ip.h"
 
@@ -92,7 +91,7 @@ typedef struct
 
 static THD_STRUCT* pThd = nullptr;
 static ThresholdObjects* pThdObjs = nullptr;
-static XHash* dThd = nullptr;
+static ThdLocalHash* dThd = nullptr;
 
 //---------------------------------------------------------------
 
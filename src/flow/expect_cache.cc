@@ -42,6 +42,9 @@ using namespace snort;
 #define MAX_DATA    4
 #define MAX_WAIT  300
 
+// nodes released per call once their deadline passes
+#define MAX_EXPIRE  8
+
 static THREAD_LOCAL std::vector<ExpectFlow*>* packet_expect_flows = nullptr;
 
 ExpectFlow::~ExpectFlow()
@@ -106,6 +109,10 @@ struct ExpectNode
     ExpectFlow* head = nullptr;
     ExpectFlow* tail = nullptr;
 
+    ZHash* table = nullptr;
+    FlowKey key;
+    TimerNode timer { };
+
     void clear(ExpectFlow*&);
 };
 
@@ -127,20 +134,73 @@ void ExpectNode::clear(ExpectFlow*& list)
 // private ExpectCache methods
 //-------------------------------------------------------------------------
 
-void ExpectCache::prune_lru()
+ExpectStats& ExpectCache::get_stats(unsigned id)
 {
-    ExpectNode* node = static_cast<ExpectNode*>( hash_table->lru_first() );
-    assert(node);
+    if ( id >= fd_stats.size() )
+        fd_stats.resize(id + 1, { });
+
+    return fd_stats[id];
+}
+
+void ExpectCache::release(ExpectNode* node)
+{
+    timers.cancel(&node->timer);
+    node->table->release_node(&node->key);
+}
+
+// discard a node that was never realized
+void ExpectCache::drop(ExpectNode* node, bool timed_out)
+{
+    for ( ExpectFlow* ef = node->head; ef; ef = ef->next )
+    {
+        for ( FlowData* fd = ef->data; fd; fd = fd->next )
+        {
+            ExpectStats& stats = get_stats(fd->get_id());
+
+            if ( timed_out )
+                ++stats.expected_expired;
+            else
+                ++stats.expected_pruned;
+        }
+    }
+    if ( timed_out )
+        ++expired;
+    else
+        ++prunes;
+
     node->clear(free_list);
-    hash_table->release();
-    ++prunes;
+    release(node);
+}
+
+void ExpectCache::prune_lru(ZHash* table)
+{
+    ExpectNode* node = static_cast<ExpectNode*>( table->lru_first() );
+    assert(node);
+    drop(node, false);
+}
+
+void ExpectCache::expire(time_t now)
+{
+    timers.advance(now);
+
+    for ( unsigned i = 0; i < MAX_EXPIRE; ++i )
+    {
+        TimerNode* t = timers.pop();
+
+        if ( !t )
+            break;
+
+        drop(static_cast<ExpectNode*>(t->owner), true);
+    }
 }
 
 ExpectNode* ExpectCache::find_node_by_packet(Packet* p, FlowKey &key)
 {
-    if (!hash_table->get_num_nodes())
+    if ( !exact_table->get_num_nodes() and !wild_table->get_num_nodes() )
         return nullptr;
 
+    expire(p->pkth->ts.tv_sec);
+
     const SfIp* srcIP = p->ptrs.ip_api.get_src();
     const SfIp* dstIP = p->ptrs.ip_api.get_dst();
     uint16_t vlanId = (p->proto_bits & PROTO_BIT__VLAN) ? layer::get_vlan_layer(p)->vid() : 0;
@@ -158,12 +218,15 @@ ExpectNode* ExpectCache::find_node_by_packet(Packet* p, FlowKey &key)
             2. Unknown (zeroed) source port.
             3. Unknown (zeroed) destination port.
         If the client/server addresses were reversed during key creation, the
-        source port will be in port_l.
+        source port will be in port_l.  Full keys are only in the exact table
+        and partial keys only in the wild table; empty tables are skipped.
     */
-    // FIXIT-P X This should be optimized to only do full matches when full keys
-    //      are present, likewise for partial keys.
-    ExpectNode* node = static_cast<ExpectNode*>( hash_table->get_user_data(&key) );
-    if (!node)
+    ExpectNode* node = nullptr;
+
+    if ( exact_table->get_num_nodes() )
+        node = static_cast<ExpectNode*>( exact_table->get_user_data(&key) );
+
+    if ( !node and wild_table->get_num_nodes() )
     {
         // FIXIT-M X This logic could fail if IPs were equal because the original key
         // would always have been created with a 0 for src or dst port and put the
@@ -183,21 +246,23 @@ ExpectNode* ExpectCache::find_node_by_packet(Packet* p, FlowKey &key)
             port2 = key.port_h;
             key.port_h = 0;
         }
-        node = static_cast<ExpectNode*> ( hash_table->get_user_data(&key) );
+        node = static_cast<ExpectNode*> ( wild_table->get_user_data(&key) );
         if (!node)
         {
             key.port_l = port1;
             key.port_h = port2;
-            node = static_cast<ExpectNode*> ( hash_table->get_user_data(&key) );
-            if (!node)
-                return nullptr;
+            node = static_cast<ExpectNode*> ( wild_table->get_user_data(&key) );
         }
     }
+    if ( !node )
+        return nullptr;
+
     if (!node->head || (p->pkth->ts.tv_sec > node->expires))
     {
         if (node->head)
-            node->clear(free_list);
-        hash_table->release_node(&key);
+            drop(node, true);
+        else
+            release(node);
         return nullptr;
     }
     /* Make sure the packet direction is correct */
@@ -216,7 +281,7 @@ ExpectNode* ExpectCache::find_node_by_packet(Packet* p, FlowKey &key)
     return node;
 }
 
-bool ExpectCache::process_expected(ExpectNode* node, FlowKey& key, Packet* p, Flow* lws)
+bool ExpectCache::process_expected(ExpectNode* node, Packet* p, Flow* lws)
 {
     ExpectFlow* head;
     FlowData* fd;
@@ -236,6 +301,7 @@ bool ExpectCache::process_expected(ExpectNode* node, FlowKey& key, Packet* p, Fl
         head->data = fd->next;
         lws->set_flow_data(fd);
         ++realized;
+        ++get_stats(fd->get_id()).expected_realized;
         fd->handle_expected(p);
     }
     head->next = free_list;
@@ -248,7 +314,10 @@ bool ExpectCache::process_expected(ExpectNode* node, FlowKey& key, Packet* p, Fl
         lws->ssn_state.snort_protocol_id = node->snort_protocol_id;
 
     if (!node->count)
-        hash_table->release_node(&key);
+    {
+        node->tail = nullptr;
+        release(node);
+    }
 
     return ignoring;
 }
@@ -260,15 +329,26 @@ bool ExpectCache::process_expected(ExpectNode* node, FlowKey& key, Packet* p, Fl
 ExpectCache::ExpectCache(uint32_t max)
 {
     // -size forces use of abs(size) ie w/o bumping up
-    hash_table = new ZHash(-MAX_HASH, sizeof(FlowKey));
-    nodes = new ExpectNode[max];
+    exact_table = new ZHash(-MAX_HASH, sizeof(FlowKey));
+    wild_table = new ZHash(-MAX_HASH, sizeof(FlowKey));
+
+    // each table gets its own max nodes so one kind can't starve the other
+    nodes = new ExpectNode[2 * max];
     for (unsigned i = 0; i < max; ++i)
-        hash_table->push(nodes + i);
+    {
+        nodes[i].table = exact_table;
+        exact_table->push(nodes + i);
+
+        nodes[max + i].table = wild_table;
+        wild_table->push(nodes + max + i);
+    }
+    for (unsigned i = 0; i < 2 * max; ++i)
+        nodes[i].timer.owner = nodes + i;
 
     /* Preallocate a pool of ExpectFlows big enough to handle the worst case
         requirement (max number of nodes * max flows per node) and add them all
         to an initial free list. */
-    max *= MAX_LIST;
+    max *= 2 * MAX_LIST;
     pool = new ExpectFlow[max];
     free_list = nullptr;
     for (unsigned i = 0; i < max; ++i)
@@ -285,13 +365,30 @@ ExpectCache::ExpectCache(uint32_t max)
 
 ExpectCache::~ExpectCache()
 {
-    delete hash_table;
+    delete exact_table;
+    delete wild_table;
     delete[] nodes;
     delete[] pool;
     delete packet_expect_flows;
     packet_expect_flows = nullptr;
 }
 
+void ExpectCache::move_stats(unsigned id, ExpectStats& stats)
+{
+    if ( id >= fd_stats.size() )
+        return;
+
+    ExpectStats& mine = fd_stats[id];
+
+    stats.expected_flows += mine.expected_flows;
+    stats.expected_realized += mine.expected_realized;
+    stats.expected_pruned += mine.expected_pruned;
+    stats.expected_expired += mine.expected_expired;
+    stats.expected_overflows += mine.expected_overflows;
+
+    mine = { };
+}
+
 /**Either expect or expect future session.
  *
  * Preprocessors may add sessions to be expected altogether or to be associated
@@ -324,20 +421,26 @@ int ExpectCache::add_flow(const Packet *ctrlPkt, PktType type, IpProtocol ip_pro
     bool reversed_key = key.init(ctrlPkt->context->conf, type, ip_proto, cliIP, cliPort,
         srvIP, srvPort, vlanId, mplsId, addressSpaceId);
 
+    expire(packet_time());
+
+    ZHash* table = (key.port_l and key.port_h) ? exact_table : wild_table;
+    ExpectNode* node = static_cast<ExpectNode*> ( table->get_user_data(&key) );
+
+    if ( node and packet_time() > node->expires )
+    {
+        // node is past its expiration date, whack it and start over.
+        drop(node, true);
+        node = nullptr;
+    }
+
     bool new_node = false;
-    ExpectNode* node = static_cast<ExpectNode*> ( hash_table->get_user_data(&key) );
     if ( !node )
     {
-        if ( hash_table->full() )
-            prune_lru();
-        node = static_cast<ExpectNode*> ( hash_table->get(&key) );
+        if ( table->full() )
+            prune_lru(table);
+        node = static_cast<ExpectNode*> ( table->get(&key) );
         assert(node);
-        new_node = true;
-    }
-    else if ( packet_time() > node->expires )
-    {
-        // node is past its expiration date, whack it and reuse it.
-        node->clear(free_list);
+        node->key = key;
         new_node = true;
     }
 
@@ -388,6 +491,7 @@ int ExpectCache::add_flow(const Packet *ctrlPkt, PktType type, IpProtocol ip_pro
         {
             // fail when maxed out
             ++overflows;
+            ++get_stats(fd->get_id()).expected_overflows;
             return -1;
         }
         last = free_list;
@@ -405,7 +509,9 @@ int ExpectCache::add_flow(const Packet *ctrlPkt, PktType type, IpProtocol ip_pro
     }
     last->add_flow_data(fd);
     node->expires = packet_time() + MAX_WAIT;
+    timers.schedule(&node->timer, node->expires + 1);
     ++expects;
+    ++get_stats(fd->get_id()).expected_flows;
     if ( new_expect_flow )
     {
         // chain all expected flows created by this packet
@@ -431,6 +537,6 @@ bool ExpectCache::check(Packet* p, Flow* lws)
     if (!node)
         return false;
 
-    return process_expected(node, key, p, lws);
+    return process_expected(node, p, lws);
 }
 
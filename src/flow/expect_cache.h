@@ -27,9 +27,12 @@
 
 //-------------------------------------------------------------------------
 // data structs
-// -- key has IP address and port pairs; one port must be zero (wild card)
+// -- key has IP address and port pairs; one port may be zero (wild card)
 //    forming a 3-tuple
-// -- node struct is stored in hash table by key
+// -- the cache is split into two shards, one for keys with both ports and
+//    one for wild card keys; each shard is a hash table of node structs by
+//    key with its own node pool and LRU so a lookup only probes the shards
+//    that hold anything and each probe only touches its own tuple
 // -- each node struct has one or more list structs linked together
 // -- each list struct has a list of flow data
 // -- when a new expect is added, a new list struct is created if a new
@@ -39,9 +42,12 @@
 //    given preproc id is not already in the flow data list
 // -- nodes are preallocated and stored in hash table; if there is no node
 //    available when an expect is added, LRU nodes are pruned
-// -- list structs are also preallocated and stored in free list; if there
-//    is no list struct available when an expect is added, LRU nodes are
-//    pruned freeing up both nodes and list structs
+// -- list structs are also preallocated and stored in free list, sized for
+//    the worst case of both shards
+// -- each node is scheduled on a timer wheel at its deadline so expired
+//    nodes are released in O(1) without scanning; a bounded number are
+//    released per lookup and a node found past its deadline is released
+//    on the spot
 // -- the number of list structs per node is capped at MAX_LIST; once
 //    reached, requests to add new expects requiring new list structs fail
 // -- the number of data structs per list struct is not capped
@@ -54,17 +60,21 @@
 // -- new list structs are appended to node's list struct chain
 // -- matching expected sessions are pulled off from the head of the node's
 //    list struct chain
+// -- counts are also kept by flow data id so inspectors can peg the
+//    expected flows they add
 //
 // FIXIT-M expiration is by node struct but should be by list struct, ie
 //    individual sessions, not all sessions to a given 3-tuple
-//    (this would make pruning a little harder unless we add linkage
-//    a la FlowCache)
 //-------------------------------------------------------------------------
 #include <vector>
+
 #include "flow/flow_key.h"
+#include "flow/timer_wheel.h"
+#include "framework/counts.h"
 #include "target_based/snort_protocols.h"
 
 struct ExpectNode;
+class ZHash;
 
 namespace snort
 {
@@ -84,6 +94,16 @@ struct SO_PUBLIC ExpectFlow
     static std::vector<ExpectFlow*>* get_expect_flows();
     static void reset_expect_flows();
 };
+
+// pegs for the expected flows added with one flow data id
+struct ExpectStats
+{
+    PegCount expected_flows;
+    PegCount expected_realized;
+    PegCount expected_pruned;
+    PegCount expected_expired;
+    PegCount expected_overflows;
+};
 }
 
 class ExpectCache
@@ -106,28 +126,39 @@ public:
     unsigned long get_expects() { return expects; }
     unsigned long get_realized() { return realized; }
     unsigned long get_prunes() { return prunes; }
+    unsigned long get_expired() { return expired; }
     unsigned long get_overflows() { return overflows; }
 
+    // add the counts for the given flow data id to the stats and clear them
+    void move_stats(unsigned id, snort::ExpectStats&);
+
 private:
-    void prune_lru();
+    void prune_lru(ZHash*);
+    void expire(time_t now);
+    void release(ExpectNode*);
+    void drop(ExpectNode*, bool timed_out);
 
+    snort::ExpectStats& get_stats(unsigned id);
     ExpectNode* get_node(snort::FlowKey&, bool&);
     snort::ExpectFlow* get_flow(ExpectNode*, uint32_t, int16_t);
     bool set_data(ExpectNode*, snort::ExpectFlow*&, snort::FlowData*);
     ExpectNode* find_node_by_packet(snort::Packet*, snort::FlowKey&);
-    bool process_expected(ExpectNode*, snort::FlowKey&, snort::Packet*, snort::Flow*);
+    bool process_expected(ExpectNode*, snort::Packet*, snort::Flow*);
 
 private:
-    class ZHash* hash_table;
+    ZHash* exact_table;
+    ZHash* wild_table;
     ExpectNode* nodes;
     snort::ExpectFlow* pool;
     snort::ExpectFlow* free_list;
+    snort::TimerWheel timers;
+    std::vector<snort::ExpectStats> fd_stats;
 
     unsigned long expects = 0;
     unsigned long realized = 0;
     unsigned long prunes = 0;
+    unsigned long expired = 0;
     unsigned long overflows = 0;
 };
 
 #endif
-
@@ -39,13 +39,15 @@ using namespace snort;
 
 Flow::Flow()
 {
-    memory::MemoryCap::update_allocations(sizeof(*this) + sizeof(FlowStash));
+    memory::MemoryCap::update_allocations(sizeof(*this) + sizeof(FlowStash),
+        memory::MemoryTag::FLOW);
     memset(this, 0, sizeof(*this));
 }
 
 Flow::~Flow()
 {
-    memory::MemoryCap::update_deallocations(sizeof(*this) + sizeof(FlowStash));
+    memory::MemoryCap::update_deallocations(sizeof(*this) + sizeof(FlowStash),
+        memory::MemoryTag::FLOW);
     term();
 }
 
@@ -255,6 +257,21 @@ int Flow::set_flow_data(FlowData* fd)
     return 0;
 }
 
+size_t Flow::get_memory_in_use(memory::MemoryTag tag) const
+{
+    size_t n = 0;
+
+    if ( tag == memory::MemoryTag::STREAM and session )
+        n += session->get_memory_in_use();
+
+    for ( const FlowData* fd = flow_data; fd; fd = fd->next )
+    {
+        if ( fd->get_memory_tag() == tag )
+            n += fd->get_memory_in_use();
+    }
+    return n;
+}
+
 FlowData* Flow::get_flow_data(unsigned id) const
 {
     FlowData* fd = flow_data;
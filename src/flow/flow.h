@@ -32,6 +32,7 @@
 #include "detection/ips_context_chain.h"
 #include "flow/flow_data.h"
 #include "flow/flow_stash.h"
+#include "flow/timer_wheel.h"
 #include "framework/data_bus.h"
 #include "framework/decode_data.h"
 #include "framework/inspector.h"
@@ -189,6 +190,9 @@ public:
     void free_flow_data(FlowData*);
     void free_flow_data();
 
+    // flow data (and for stream, session) memory accounted to the given subsystem
+    size_t get_memory_in_use(memory::MemoryTag) const;
+
     void call_handlers(Packet* p, bool eof = false);
     void markup_packet_flags(Packet*);
     void set_direction(Packet*);
@@ -391,6 +395,7 @@ public:  // FIXIT-M privatize if possible
 
     // these fields are always set; not zeroed
     Flow* prev, * next;
+    TimerNode timer;  // idle or hard expiration, owned by the cache
     Session* session;
     Inspector* ssn_client;
     Inspector* ssn_server;
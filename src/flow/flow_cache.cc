@@ -24,6 +24,8 @@
 
 #include "flow/flow_cache.h"
 
+#include <algorithm>
+
 #include "hash/hash_defs.h"
 #include "hash/zhash.h"
 #include "helpers/flag_context.h"
@@ -35,9 +37,11 @@
 
 #include "flow.h"
 #include "flow_key.h"
+#include "flow_pool.h"
 #include "flow_uni_list.h"
 #include "ha.h"
 #include "session.h"
+#include "timer_wheel.h"
 
 using namespace snort;
 
@@ -53,18 +57,34 @@ static const unsigned ALL_FLOWS = 3;
 
 FlowCache::FlowCache(const FlowCacheConfig& cfg) : config(cfg)
 {
-    hash_table = new ZHash(config.max_flows, sizeof(FlowKey));
+    hash_table = new ZHash(config.max_flows, sizeof(FlowKey), memory::TableUser::FLOW);
     uni_flows = new FlowUniList;
     uni_ip_flows = new FlowUniList;
+    timers = new TimerWheel;
     flags = 0x0;
 
     assert(prune_stats.get_total() == 0);
+
+    // build every flow up front so connection setup never allocates
+    if ( config.preallocate )
+    {
+        pool = new FlowPool(config.max_flows);
+
+        while ( Flow* flow = pool->get() )
+        {
+            push(flow);
+            memory::MemoryCap::update_allocations(sizeof(HashNode) + sizeof(FlowKey),
+                memory::MemoryTag::FLOW);
+        }
+    }
 }
 
 FlowCache::~FlowCache()
 {
     delete hash_table;
+    delete timers;
     delete_uni();
+    delete pool;
 }
 
 void FlowCache::delete_uni()
@@ -76,6 +96,26 @@ void FlowCache::delete_uni()
     uni_ip_flows = nullptr;
 }
 
+// flows beyond the pool's capacity, as after a reload raises max_flows,
+// come from the heap
+Flow* FlowCache::new_flow()
+{
+    if ( pool )
+    {
+        if ( Flow* flow = pool->get() )
+            return flow;
+    }
+    return new Flow();
+}
+
+void FlowCache::delete_flow(Flow* flow)
+{
+    if ( pool and pool->owns(flow) )
+        pool->put(flow);
+    else
+        delete flow;
+}
+
 void FlowCache::push(Flow* flow)
 {
     void* key = hash_table->push(flow);
@@ -129,9 +169,9 @@ Flow* FlowCache::allocate(const FlowKey* key)
     {
         if ( flows_allocated < config.max_flows )
         {
-            Flow* new_flow = new Flow();
-            push(new_flow);
-            memory::MemoryCap::update_allocations(sizeof(HashNode) + sizeof(FlowKey));
+            push(new_flow());
+            memory::MemoryCap::update_allocations(sizeof(HashNode) + sizeof(FlowKey),
+                memory::MemoryTag::FLOW);
         }
         else if ( !prune_stale(timestamp, nullptr) )
         {
@@ -152,22 +192,52 @@ Flow* FlowCache::allocate(const FlowKey* key)
     if ( flow->session && flow->pkt_type != key->pkt_type )
         flow->term();
 
-    memory::MemoryCap::update_allocations(config.proto[to_utype(key->pkt_type)].cap_weight);
+    memory::MemoryCap::update_allocations(config.proto[to_utype(key->pkt_type)].cap_weight,
+        memory::MemoryTag::FLOW);
     flow->last_data_seen = timestamp;
 
+    timers->advance(timestamp);
+    flow->timer.owner = flow;
+    timers->schedule(&flow->timer, get_deadline(flow));
+
     return flow;
 }
 
+uint64_t FlowCache::get_deadline(Flow* flow) const
+{
+    if ( flow->is_hard_expiration() )
+        return flow->expire_time;
+
+    return flow->last_data_seen + config.proto[to_utype(flow->key->pkt_type)].nominal_timeout;
+}
+
+// idle deadlines only grow as packets arrive and are pushed out lazily when
+// the timer fires; a deadline that got shorter (hard expiration, session
+// close) is rescheduled here so it isn't missed
+void FlowCache::update_timer(Flow* flow)
+{
+    if ( !flow->timer.is_scheduled() )
+        return;
+
+    uint64_t deadline = get_deadline(flow);
+
+    if ( deadline < flow->timer.deadline )
+        timers->schedule(&flow->timer, deadline);
+}
+
 void FlowCache::remove(Flow* flow)
 {
     if ( flow->next )
         unlink_uni(flow);
 
+    timers->cancel(&flow->timer);
+
     // FIXIT-M This check is added for offload case where both Flow::reset
     // and Flow::retire try remove the flow from hash. Flow::reset should
     // just mark the flow as pending instead of trying to remove it.
     if ( !hash_table->release_node(flow->key) )
-        memory::MemoryCap::update_deallocations(config.proto[to_utype(flow->key->pkt_type)].cap_weight);
+        memory::MemoryCap::update_deallocations(config.proto[to_utype(flow->key->pkt_type)].cap_weight,
+            memory::MemoryTag::FLOW);
 }
 
 void FlowCache::release(Flow* flow, PruneReason reason, bool do_cleanup)
@@ -306,46 +376,81 @@ unsigned FlowCache::prune_excess(const Flow* save_me)
     return pruned;
 }
 
-bool FlowCache::prune_one(PruneReason reason, bool do_cleanup)
+// when a subsystem's flow data holds the most memory, prune whichever of
+// the oldest few flows holds the most of it instead of strictly the oldest
+static const unsigned max_prune_candidates = 8;
+
+bool FlowCache::prune_one(PruneReason reason, bool do_cleanup, memory::MemoryTag tag)
 {
     // so we don't prune the current flow (assume current == MRU)
-    if ( hash_table->get_num_nodes() <= 1 )
+    unsigned num_nodes = hash_table->get_num_nodes();
+
+    if ( num_nodes <= 1 )
         return false;
 
     // ZHash returns in LRU order, which is updated per packet via find --> move_to_front call
     auto flow = static_cast<Flow*>(hash_table->lru_first());
     assert(flow);
 
+    if ( tag != memory::MemoryTag::FLOW and tag != memory::MemoryTag::OTHER )
+    {
+        unsigned n = std::min(num_nodes - 1, max_prune_candidates);
+        size_t most = flow->get_memory_in_use(tag);
+
+        while ( --n )
+        {
+            auto f = static_cast<Flow*>(hash_table->lru_next());
+
+            if ( !f )
+                break;
+
+            size_t use = f->get_memory_in_use(tag);
+
+            if ( use > most )
+            {
+                most = use;
+                flow = f;
+            }
+        }
+    }
+
     flow->ssn_state.session_flags |= SSNFLAG_PRUNED;
     release(flow, reason, do_cleanup);
 
     return true;
 }
 
+// flows come due in deadline order no matter their protocol or position
+// in the LRU; the number of timers looked at per call is bounded
 unsigned FlowCache::timeout(unsigned num_flows, time_t thetime)
 {
     ActiveSuspendContext act_susp;
     unsigned retired = 0;
+    unsigned checked = 0;
 
-    auto flow = static_cast<Flow*>(hash_table->lru_current());
+    timers->advance(thetime);
 
-    if ( !flow )
-        flow = static_cast<Flow*>(hash_table->lru_first());
-
-    while ( flow and (retired < num_flows) )
+    while ( retired < num_flows and checked++ < max_timer_checks )
     {
-        if ( flow->is_hard_expiration() )
+        TimerNode* timer = timers->pop();
+
+        if ( !timer )
+            break;
+
+        auto flow = static_cast<Flow*>(timer->owner);
+        uint64_t deadline = get_deadline(flow);
+
+        if ( deadline > (uint64_t)thetime )
         {
-            if ( flow->expire_time > (uint64_t) thetime )
-                break;
+            timers->schedule(timer, deadline);
+            continue;
         }
-        else if ( flow->last_data_seen + config.proto[to_utype(flow->key->pkt_type)].nominal_timeout > thetime )
-            break;
 
+        // try again on the next tick
         if ( HighAvailabilityManager::in_standby(flow) or
             flow->is_suspended() )
         {
-            flow = static_cast<Flow*>(hash_table->lru_next());
+            timers->schedule(timer, thetime + 1);
             continue;
         }
 
@@ -353,8 +458,6 @@ unsigned FlowCache::timeout(unsigned num_flows, time_t thetime)
         release(flow, PruneReason::IDLE);
 
         ++retired;
-
-        flow = static_cast<Flow*>(hash_table->lru_current());
     }
 
     return retired;
@@ -379,6 +482,8 @@ unsigned FlowCache::delete_active_flows(unsigned mode, unsigned num_to_delete, u
         if ( flow->next )
             unlink_uni(flow);
 
+        timers->cancel(&flow->timer);
+
         if ( flow->was_blocked() )
             delete_stats.update(FlowDeleteState::BLOCKED);
         else if ( flow->is_suspended() )
@@ -386,8 +491,9 @@ unsigned FlowCache::delete_active_flows(unsigned mode, unsigned num_to_delete, u
         else
             delete_stats.update(FlowDeleteState::ALLOWED);
 
-        delete flow;
-        memory::MemoryCap::update_deallocations(sizeof(HashNode) + sizeof(FlowKey));
+        delete_flow(flow);
+        memory::MemoryCap::update_deallocations(sizeof(HashNode) + sizeof(FlowKey),
+            memory::MemoryTag::FLOW);
         --flows_allocated;
         ++deleted;
         --num_to_delete;
@@ -409,9 +515,10 @@ unsigned FlowCache::delete_flows(unsigned num_to_delete)
         if ( !flow )
             break;
 
-        delete flow;
+        delete_flow(flow);
         delete_stats.update(FlowDeleteState::FREELIST);
-        memory::MemoryCap::update_deallocations(sizeof(HashNode) + sizeof(FlowKey));
+        memory::MemoryCap::update_deallocations(sizeof(HashNode) + sizeof(FlowKey),
+            memory::MemoryTag::FLOW);
 
         --flows_allocated;
         ++deleted;
@@ -441,8 +548,9 @@ unsigned FlowCache::purge()
 
     while ( Flow* flow = (Flow*)hash_table->pop() )
     {
-        delete flow;
-        memory::MemoryCap::update_deallocations(sizeof(HashNode) + sizeof(FlowKey));
+        delete_flow(flow);
+        memory::MemoryCap::update_deallocations(sizeof(HashNode) + sizeof(FlowKey),
+            memory::MemoryTag::FLOW);
         --flows_allocated;
     }
 
@@ -24,11 +24,14 @@
 
 // there is a FlowCache instance for each protocol.
 // Flows are stored in a ZHash instance by FlowKey.
+// Flow expiration is driven by a TimerWheel keyed on each flow's own
+// deadline; the ZHash LRU is only used for pruning.
 
 #include <ctime>
 #include <type_traits>
 
 #include "framework/counts.h"
+#include "memory/memory_cap.h"
 
 #include "flow_config.h"
 #include "prune_stats.h"
@@ -37,8 +40,10 @@ namespace snort
 {
 class Flow;
 struct FlowKey;
+class TimerWheel;
 }
 
+class FlowPool;
 class FlowUniList;
 
 class FlowCache
@@ -57,7 +62,8 @@ public:
 
     unsigned prune_stale(uint32_t thetime, const snort::Flow* save_me);
     unsigned prune_excess(const snort::Flow* save_me);
-    bool prune_one(PruneReason, bool do_cleanup);
+    bool prune_one(PruneReason, bool do_cleanup,
+        memory::MemoryTag = memory::MemoryTag::FLOW);
     unsigned timeout(unsigned num_flows, time_t cur_time);
     unsigned delete_flows(unsigned num_to_delete);
 
@@ -86,6 +92,7 @@ public:
     }
 
     void unlink_uni(snort::Flow*);
+    void update_timer(snort::Flow*);
 
     void set_flow_cache_config(const FlowCacheConfig& cfg)
     { config = cfg; }
@@ -98,20 +105,26 @@ public:
 
 private:
     void delete_uni();
+    snort::Flow* new_flow();
+    void delete_flow(snort::Flow*);
     void push(snort::Flow*);
     void link_uni(snort::Flow*);
     void remove(snort::Flow*);
     void retire(snort::Flow*);
+    uint64_t get_deadline(snort::Flow*) const;
     unsigned prune_unis(PktType);
     unsigned delete_active_flows
         (unsigned mode, unsigned num_to_delete, unsigned &deleted);
 
 private:
     static const unsigned cleanup_flows = 1;
+    static const unsigned max_timer_checks = 64;
     FlowCacheConfig config;
     uint32_t flags;
 
     class ZHash* hash_table;
+    snort::TimerWheel* timers;
+    FlowPool* pool = nullptr;
     unsigned flows_allocated = 0;
     FlowUniList* uni_flows;
     FlowUniList* uni_ip_flows;
@@ -34,6 +34,7 @@ struct FlowCacheConfig
 {
     unsigned max_flows = 0;
     unsigned pruning_timeout = 0;
+    bool preallocate = false;
     FlowTypeConfig proto[to_utype(PktType::MAX)];
 };
 
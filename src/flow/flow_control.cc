@@ -115,8 +115,8 @@ unsigned FlowControl::delete_flows(unsigned num_to_delete)
 { return cache->delete_flows(num_to_delete); }
 
 // hole for memory manager/prune handler
-bool FlowControl::prune_one(PruneReason reason, bool do_cleanup)
-{ return cache->prune_one(reason, do_cleanup); }
+bool FlowControl::prune_one(PruneReason reason, bool do_cleanup, memory::MemoryTag tag)
+{ return cache->prune_one(reason, do_cleanup, tag); }
 
 void FlowControl::timeout_flows(time_t cur_time)
 {
@@ -382,6 +382,7 @@ bool FlowControl::process(PktType type, Packet* p, bool* new_flow)
     }
 
     num_flows += process(flow, p);
+    cache->update_timer(flow);
 
     // FIXIT-M refactor to unlink_uni immediately after session
     // is processed by inspector manager (all flows)
@@ -32,6 +32,7 @@
 #include "framework/counts.h"
 #include "framework/decode_data.h"
 #include "framework/inspector.h"
+#include "memory/memory_cap.h"
 
 namespace snort
 {
@@ -65,7 +66,8 @@ public:
     void release_flow(snort::Flow*, PruneReason);
     void purge_flows();
     unsigned delete_flows(unsigned num_to_delete);
-    bool prune_one(PruneReason, bool do_cleanup);
+    bool prune_one(PruneReason, bool do_cleanup,
+        memory::MemoryTag = memory::MemoryTag::FLOW);
     snort::Flow* stale_flow_cleanup(FlowCache*, snort::Flow*, snort::Packet*);
     void timeout_flows(time_t cur_time);
     bool expected_flow(snort::Flow*, snort::Packet*);
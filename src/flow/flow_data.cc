@@ -55,14 +55,14 @@ FlowData::~FlowData()
 void FlowData::update_allocations(size_t n)
 {
     memory::MemoryCap::free_space(n);
-    memory::MemoryCap::update_allocations(n);
+    memory::MemoryCap::update_allocations(n, mem_tag);
     mem_in_use += n;
 }
 
 void FlowData::update_deallocations(size_t n)
 {
     assert(mem_in_use >= n);
-    memory::MemoryCap::update_deallocations(n);
+    memory::MemoryCap::update_deallocations(n, mem_tag);
     mem_in_use -= n;
 }
 
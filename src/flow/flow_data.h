@@ -21,6 +21,7 @@
 #define FLOW_DATA_H
 
 #include "main/snort_types.h"
+#include "memory/memory_cap.h"
 
 namespace snort
 {
@@ -43,6 +44,12 @@ public:
     void update_deallocations(size_t);
     Inspector* get_handler() { return handler; }
 
+    memory::MemoryTag get_memory_tag() const
+    { return mem_tag; }
+
+    size_t get_memory_in_use() const
+    { return mem_in_use; }
+
     // return fixed size (could be an approx avg)
     // this must be fixed for life of flow data instance
     // track significant supplemental allocations with the above updaters
@@ -56,11 +63,17 @@ public:  // FIXIT-L privatize
     FlowData* next;
     FlowData* prev;
 
+protected:
+    // account the above updates to the owning subsystem
+    void set_memory_tag(memory::MemoryTag t)
+    { mem_tag = t; }
+
 private:
     static unsigned flow_data_id;
     Inspector* handler;
     size_t mem_in_use = 0;
     unsigned id;
+    memory::MemoryTag mem_tag = memory::MemoryTag::OTHER;
 };
 
 // The flow data created from SO rules must use RuleFlowData
@@ -0,0 +1,88 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2020-2020 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// flow_pool.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "flow_pool.h"
+
+#include <cassert>
+#include <new>
+
+#include "main/thread_config.h"
+
+#include "flow.h"
+
+using namespace snort;
+
+static_assert(sizeof(Flow) >= sizeof(void*), "free slots hold a link");
+
+FlowPool::FlowPool(unsigned n) : capacity(n)
+{
+    size = (size_t)capacity * sizeof(Flow);
+    base = (unsigned char*)ThreadConfig::alloc_local(size);
+
+    // link back to front so flows are handed out in address order
+    for ( unsigned i = capacity; i > 0; --i )
+    {
+        Slot* s = (Slot*)(base + (size_t)(i - 1) * sizeof(Flow));
+        s->next = free_list;
+        free_list = s;
+    }
+}
+
+// flows still in use are abandoned with the memory, as unpurged heap
+// flows are at exit
+FlowPool::~FlowPool()
+{
+    ThreadConfig::free_local(base, size);
+}
+
+Flow* FlowPool::get()
+{
+    if ( !free_list )
+        return nullptr;
+
+    Slot* s = free_list;
+    free_list = s->next;
+    ++in_use;
+
+    return new(s) Flow;
+}
+
+void FlowPool::put(Flow* flow)
+{
+    assert(owns(flow));
+    assert(in_use);
+
+    flow->~Flow();
+
+    Slot* s = (Slot*)flow;
+    s->next = free_list;
+    free_list = s;
+    --in_use;
+}
+
+bool FlowPool::owns(const Flow* flow) const
+{
+    const unsigned char* p = (const unsigned char*)flow;
+    return p >= base and p < base + size;
+}
+
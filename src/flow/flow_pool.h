@@ -0,0 +1,69 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2020-2020 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// flow_pool.h
+
+#ifndef FLOW_POOL_H
+#define FLOW_POOL_H
+
+// fixed capacity store of Flow objects in one contiguous block of memory
+// bound to the NUMA node of the packet thread that creates it.  flows are
+// constructed in place by get and destroyed by put; the slots of destroyed
+// flows are kept on an intrusive free list so nothing is allocated after
+// construction.
+
+#include <cstddef>
+
+namespace snort
+{
+class Flow;
+}
+
+class FlowPool
+{
+public:
+    FlowPool(unsigned capacity);
+    ~FlowPool();
+
+    FlowPool(const FlowPool&) = delete;
+    FlowPool& operator=(const FlowPool&) = delete;
+
+    // nullptr when all slots are in use
+    snort::Flow* get();
+    void put(snort::Flow*);
+
+    bool owns(const snort::Flow*) const;
+
+    unsigned get_capacity() const
+    { return capacity; }
+
+    unsigned get_in_use() const
+    { return in_use; }
+
+private:
+    struct Slot
+    { Slot* next; };
+
+    size_t size;
+    unsigned capacity;
+    unsigned in_use = 0;
+    unsigned char* base;
+    Slot* free_list = nullptr;
+};
+
+#endif
+
@@ -23,6 +23,8 @@
 
 #include "ha.h"
 
+#include <vector>
+
 #include "framework/counts.h"
 #include "log/messages.h"
 #include "packet_io/active.h"
@@ -42,7 +44,8 @@ using namespace snort;
 enum HAEvent
 {
     HA_DELETE_EVENT = 1,
-    HA_UPDATE_EVENT = 2
+    HA_UPDATE_EVENT = 2,
+    HA_BATCH_EVENT = 3
 };
 
 struct __attribute__((__packed__)) HAMessageHeader
@@ -64,17 +67,39 @@ struct __attribute__((__packed__)) HAClientHeader
 //   session client has handle of 0 and index of 0
 static constexpr uint8_t MAX_CLIENTS = 17;
 
+// Side channel messages waiting to be sent together in one frame.  Each
+// message is serialized into the buffer when queued; entries replaced by a
+// later message for the same flow are skipped when the frame is built.
+struct HABatch
+{
+    struct Entry
+    {
+        uint16_t offset;
+        uint16_t length;
+        bool live;
+    };
+
+    std::vector<uint8_t> buffer;
+    std::vector<Entry> entries;
+    struct timeval first = { };    // packet time of the first queued message
+    uint32_t id = 0;
+    uint16_t used = 0;
+    uint16_t live_bytes = 0;
+    uint16_t live_msgs = 0;
+};
+
 // HighAvailability is the thread-local state/configuration instantiated for each packet thread.
 typedef std::array<FlowHAClient*, MAX_CLIENTS> ClientMap;
 class HighAvailability
 {
 public:
-    HighAvailability(PortBitSet*,bool);
+    HighAvailability(PortBitSet*, bool, uint16_t, const struct timeval&);
     ~HighAvailability();
 
     void process_update(Flow*, Packet*);
     void process_deletion(Flow&);
     void process_receive();
+    void flush_batch();
 
     Flow* process_daq_import(Packet&, FlowKey&);
 
@@ -85,12 +110,29 @@ public:
     bool shutting_down = false;
 
 private:
+    void send_sc_update_message(Flow&);
+    void send_sc_deletion_message(Flow&);
+
+    bool batch_pending(Flow&);
+    bool batch_expired();
+    uint8_t* batch_reserve(Flow&, uint32_t len);
+    void batch_commit(Flow&, uint16_t len, bool replaceable);
+    void batch_reset();
+
     SideChannel* sc = nullptr;
     bool use_daq_channel;
+
+    HABatch batch;
+    struct timeval batch_timeout;
 };
 
 static constexpr uint8_t HA_MESSAGE_VERSION = 3;
 
+// A batched frame starts with a header of this version whose total_length
+// covers the whole frame, followed by version 3 messages.  Receivers that
+// don't know it count a version mismatch rather than misparse the frame.
+static constexpr uint8_t HA_BATCH_VERSION = 0x80 | HA_MESSAGE_VERSION;
+
 // define message size and content constants.
 static constexpr uint8_t KEY_SIZE_IP6 = sizeof(FlowKey);
 // ip4 key is smaller by 2*(ip6_addr_size - ip4_addr_size) or 2 * (16 - 4) = 24
@@ -107,12 +149,18 @@ static constexpr uint8_t SESSION_HA_CLIENT_INDEX = 0;
 
 PortBitSet* HighAvailabilityManager::ports = nullptr;
 bool HighAvailabilityManager::use_daq_channel = false;
+uint16_t HighAvailabilityManager::batch_size = 0;
+struct timeval HighAvailabilityManager::batch_timeout = { };
 
 struct timeval FlowHAState::min_session_lifetime;
 struct timeval FlowHAState::min_sync_interval;
 
 static THREAD_LOCAL HighAvailability* ha;
 
+// Batch ids outlive a HighAvailability instance so that a flow's stale slot
+// can never match a later batch.  Zero means no batch.
+static THREAD_LOCAL uint32_t ha_batch_seq = 0;
+
 static inline bool is_ip6_key(const FlowKey* key)
 {
     return (key->ip_l[0] || key->ip_l[1] || key->ip_l[2] != htonl(0xFFFF) ||
@@ -124,6 +172,8 @@ FlowHAState::FlowHAState()
     state = INITIAL_STATE;
     state |= (NEW | NEW_SESSION);
     pending = NONE_PENDING;
+    batch_id = 0;
+    batch_slot = 0;
 
     // Set the initial update time to now+min_session_lifetime
     packet_gettimeofday(&next_update);
@@ -197,9 +247,26 @@ void FlowHAState::reset()
 {
     state = INITIAL_STATE;
     pending = NONE_PENDING;
+    batch_id = 0;
+    batch_slot = 0;
     init_next_update();
 }
 
+void FlowHAState::set_batch_slot(uint32_t batch, uint16_t slot)
+{
+    batch_id = batch;
+    batch_slot = slot;
+}
+
+bool FlowHAState::get_batch_slot(uint32_t batch, uint16_t& slot)
+{
+    if ( !batch or batch != batch_id )
+        return false;
+
+    slot = batch_slot;
+    return true;
+}
+
 FlowHAClient::FlowHAClient(uint8_t length, bool session_client)
 {
     if (!ha)
@@ -507,13 +574,51 @@ static void ha_sc_receive_handler(SCMessage* sc_msg)
     // SC received messages must have reference back to SideChannel object
     assert(sc_msg->sc);
 
-    HAMessage ha_msg(sc_msg->content, sc_msg->content_length);
-    consume_ha_message(ha_msg);
+    uint8_t* content = sc_msg->content;
+    uint32_t remaining = sc_msg->content_length;
+    const HAMessageHeader* frame = (HAMessageHeader*) content;
+
+    // Only frames marked as batched are walked.  Unbatched senders may leave
+    // unwritten bytes after the message, so anything else is one message.
+    if ( remaining < sizeof(HAMessageHeader) or frame->event != HA_BATCH_EVENT or
+        frame->version != HA_BATCH_VERSION or frame->total_length != remaining )
+    {
+        HAMessage ha_msg(content, remaining);
+        consume_ha_message(ha_msg);
+        sc_msg->sc->discard_message(sc_msg);
+        return;
+    }
+
+    // Messages that can't be walked by their header go to consume_ha_message
+    // whole so the usual error counts apply.
+    content += sizeof(HAMessageHeader);
+    remaining -= sizeof(HAMessageHeader);
+
+    while ( remaining )
+    {
+        uint32_t len = remaining;
+
+        if ( remaining > sizeof(HAMessageHeader) )
+        {
+            const HAMessageHeader* hdr = (HAMessageHeader*) content;
+
+            if ( hdr->version == HA_MESSAGE_VERSION and
+                hdr->total_length >= sizeof(HAMessageHeader) and hdr->total_length < remaining )
+                len = hdr->total_length;
+        }
+
+        HAMessage ha_msg(content, len);
+        consume_ha_message(ha_msg);
+
+        content += len;
+        remaining -= len;
+    }
 
     sc_msg->sc->discard_message(sc_msg);
 }
 
-HighAvailability::HighAvailability(PortBitSet* ports, bool daq_channel)
+HighAvailability::HighAvailability(
+    PortBitSet* ports, bool daq_channel, uint16_t batch_size, const struct timeval& timeout)
 {
     using namespace std::placeholders;
 
@@ -541,27 +646,185 @@ HighAvailability::HighAvailability(PortBitSet* ports, bool daq_channel)
         }
     }
     use_daq_channel = daq_channel;
+
+    if ( sc and batch_size )
+        batch.buffer.resize(batch_size);
+
+    batch_timeout = timeout;
+    batch_reset();
 }
 
 HighAvailability::~HighAvailability()
 {
+    flush_batch();
+
     if (sc)
         sc->unregister_receive_handler();
 }
 
-static void send_sc_update_message(Flow& flow, SideChannel& sc)
+void HighAvailability::batch_reset()
+{
+    batch.entries.clear();
+    batch.used = batch.live_bytes = batch.live_msgs = 0;
+
+    if ( !++ha_batch_seq )
+        ++ha_batch_seq;
+
+    batch.id = ha_batch_seq;
+}
+
+// true if the flow has a message queued in the current batch
+bool HighAvailability::batch_pending(Flow& flow)
+{
+    uint16_t slot;
+    return !batch.buffer.empty() and flow.ha_state->get_batch_slot(batch.id, slot) and
+        slot < batch.entries.size() and batch.entries[slot].live;
+}
+
+bool HighAvailability::batch_expired()
+{
+    struct timeval now, deadline;
+    packet_gettimeofday(&now);
+    timeradd(&batch.first, &batch_timeout, &deadline);
+    return !timercmp(&now, &deadline, <);
+}
+
+// Return where the next len byte message should be written or nullptr if it
+// must be sent on its own.  Any message already queued for the flow is dropped
+// since the new one supersedes it.
+uint8_t* HighAvailability::batch_reserve(Flow& flow, uint32_t len)
+{
+    if ( batch.buffer.empty() )
+        return nullptr;
+
+    if ( len > batch.buffer.size() )
+    {
+        // keep messages for the same flow in order
+        flush_batch();
+        return nullptr;
+    }
+
+    if ( batch_pending(flow) )
+    {
+        uint16_t slot;
+        flow.ha_state->get_batch_slot(batch.id, slot);
+
+        HABatch::Entry& e = batch.entries[slot];
+        batch.live_bytes -= e.length;
+        batch.live_msgs--;
+        ha_stats.coalesced_msgs++;
+
+        // reclaim the space when the flow sent the most recent message
+        if ( slot + 1u == batch.entries.size() )
+        {
+            batch.used = e.offset;
+            batch.entries.pop_back();
+        }
+        else
+            e.live = false;
+    }
+
+    if ( !batch.entries.empty() and (batch.used + len > batch.buffer.size() or batch_expired()) )
+        flush_batch();
+
+    if ( batch.entries.empty() )
+        packet_gettimeofday(&batch.first);
+
+    return batch.buffer.data() + batch.used;
+}
+
+void HighAvailability::batch_commit(Flow& flow, uint16_t len, bool replaceable)
+{
+    assert(batch.used + len <= batch.buffer.size());
+    assert(batch.entries.size() < UINT16_MAX);
+
+    if ( replaceable )
+        flow.ha_state->set_batch_slot(batch.id, (uint16_t) batch.entries.size());
+    else
+        flow.ha_state->set_batch_slot(0, 0);
+
+    batch.entries.push_back({ batch.used, len, true });
+    batch.used += len;
+    batch.live_bytes += len;
+    batch.live_msgs++;
+}
+
+void HighAvailability::flush_batch()
+{
+    if ( !batch.live_msgs )
+    {
+        if ( !batch.entries.empty() )
+            batch_reset();
+        return;
+    }
+
+    const uint32_t frame_len = sizeof(HAMessageHeader) + batch.live_bytes;
+    SCMessage* sc_msg = sc->alloc_transmit_message(frame_len);
+    assert(sc_msg);
+
+    HAMessageHeader* frame = (HAMessageHeader*) sc_msg->content;
+    frame->event = HA_BATCH_EVENT;
+    frame->version = HA_BATCH_VERSION;
+    frame->total_length = (uint16_t) frame_len;
+    frame->key_type = 0;
+
+    uint8_t* cursor = sc_msg->content + sizeof(HAMessageHeader);
+
+    for ( const auto& e : batch.entries )
+    {
+        if ( e.live )
+        {
+            memcpy(cursor, batch.buffer.data() + e.offset, e.length);
+            cursor += e.length;
+        }
+    }
+    sc->transmit_message(sc_msg);
+
+    struct timeval now, delay;
+    packet_gettimeofday(&now);
+
+    if ( timercmp(&now, &batch.first, >) )
+    {
+        timersub(&now, &batch.first, &delay);
+        ha_stats.batch_delay_usecs += (PegCount) delay.tv_sec * 1000000 + delay.tv_usec;
+    }
+
+    ha_stats.batches_sent++;
+    ha_stats.batched_msgs += batch.live_msgs;
+
+    if ( batch.live_msgs > ha_stats.max_batch_msgs )
+        ha_stats.max_batch_msgs = batch.live_msgs;
+
+    batch_reset();
+}
+
+void HighAvailability::send_sc_update_message(Flow& flow)
 {
+    // An update that replaces one still in the batch must carry the state of
+    // every client, not just those pending since the replaced message.
+    const bool full = batch_pending(flow);
     const uint16_t header_len = calculate_msg_header_length(flow);
-    const uint16_t content_len = calculate_update_msg_content_length(flow, false);
+    const uint16_t content_len = calculate_update_msg_content_length(flow, full);
+    const uint32_t msg_len = header_len + content_len;
 
-    SCMessage* sc_msg = sc.alloc_transmit_message((uint32_t) (header_len + content_len));
+    if ( uint8_t* buf = batch_reserve(flow, msg_len) )
+    {
+        HAMessage ha_msg(buf, msg_len);
+
+        write_msg_header(flow, HA_UPDATE_EVENT, msg_len, ha_msg);
+        write_update_msg_content(flow, ha_msg, full);
+        batch_commit(flow, update_msg_header_length(ha_msg), true);
+        return;
+    }
+
+    SCMessage* sc_msg = sc->alloc_transmit_message(msg_len);
     assert(sc_msg);
     HAMessage ha_msg(sc_msg->content, sc_msg->content_length);
 
-    write_msg_header(flow, HA_UPDATE_EVENT, header_len + content_len, ha_msg);
+    write_msg_header(flow, HA_UPDATE_EVENT, msg_len, ha_msg);
     write_update_msg_content(flow, ha_msg, false);
-    update_msg_header_length(ha_msg);
-    sc.transmit_message(sc_msg);
+    sc_msg->content_length = update_msg_header_length(ha_msg);
+    sc->transmit_message(sc_msg);
 }
 
 static void send_daq_update_message(Flow& flow, Packet& p)
@@ -598,7 +861,7 @@ void HighAvailability::process_update(Flow* flow, Packet* p)
         return;
 
     if (sc)
-        send_sc_update_message(*flow, *sc);
+        send_sc_update_message(*flow);
 
     if (use_daq_channel && p && p->daq_msg)
         send_daq_update_message(*flow, *p);
@@ -609,16 +872,25 @@ void HighAvailability::process_update(Flow* flow, Packet* p)
     flow->ha_state->set_next_update();
 }
 
-static void send_sc_deletion_message(Flow& flow, SideChannel& sc)
+void HighAvailability::send_sc_deletion_message(Flow& flow)
 {
     const uint32_t msg_len = calculate_msg_header_length(flow);
-    SCMessage* sc_msg = sc.alloc_transmit_message(msg_len);
+
+    if ( uint8_t* buf = batch_reserve(flow, msg_len) )
+    {
+        HAMessage ha_msg(buf, msg_len);
+        write_msg_header(flow, HA_DELETE_EVENT, msg_len, ha_msg);
+        batch_commit(flow, msg_len, false);
+        return;
+    }
+
+    SCMessage* sc_msg = sc->alloc_transmit_message(msg_len);
     HAMessage ha_msg(sc_msg->content, sc_msg->content_length);
 
     // No content, only header+key
     write_msg_header(flow, HA_DELETE_EVENT, msg_len, ha_msg);
 
-    sc.transmit_message(sc_msg);
+    sc->transmit_message(sc_msg);
 }
 
 void HighAvailability::process_deletion(Flow& flow)
@@ -630,15 +902,20 @@ void HighAvailability::process_deletion(Flow& flow)
 
     // Only produce deletion messages when using a side channel
     if (sc)
-        send_sc_deletion_message(flow, *sc);
+        send_sc_deletion_message(flow);
 
     flow.ha_state->add(FlowHAState::DELETED);
 }
 
 void HighAvailability::process_receive()
 {
-    if (sc)
-        sc->process(DISPATCH_ALL_RECEIVE);
+    if (!sc)
+        return;
+
+    if ( batch.live_msgs and batch_expired() )
+        flush_batch();
+
+    sc->process(DISPATCH_ALL_RECEIVE);
 }
 
 Flow* HighAvailability::process_daq_import(Packet& p, FlowKey& key)
@@ -713,6 +990,8 @@ void HighAvailabilityManager::configure(HighAvailabilityConfig* config)
     FlowHAState::config_timers(config->min_session_lifetime, config->min_sync_interval);
 
     use_daq_channel = config->daq_channel;
+    batch_size = config->batch_size;
+    batch_timeout = config->batch_timeout;
 }
 
 // Called within the packet thread prior to packet processing
@@ -720,7 +999,7 @@ void HighAvailabilityManager::thread_init()
 {
     // create a a thread local instance iff we are configured to operate.
     if (ports || use_daq_channel)
-        ha = new HighAvailability(ports, use_daq_channel);
+        ha = new HighAvailability(ports, use_daq_channel, batch_size, batch_timeout);
     else
         ha = nullptr;
 }
@@ -728,7 +1007,10 @@ void HighAvailabilityManager::thread_init()
 void HighAvailabilityManager::thread_term_beginning()
 {
     if (ha)
+    {
         ha->shutting_down = true;
+        ha->flush_batch();
+    }
 }
 
 // Called in the packet thread at run-down
@@ -76,6 +76,10 @@ public:
     void set_next_update();
     void reset();
 
+    // Locate this flow's message in the current side channel batch
+    void set_batch_slot(uint32_t batch, uint16_t slot);
+    bool get_batch_slot(uint32_t batch, uint16_t& slot);
+
 private:
     static constexpr uint8_t INITIAL_STATE = 0x00;
     static constexpr uint16_t NONE_PENDING = 0x0000;
@@ -83,6 +87,8 @@ private:
     static struct timeval min_sync_interval;
 
     struct timeval next_update;
+    uint32_t batch_id;
+    uint16_t batch_slot;
     uint16_t pending;
     uint8_t state;
 };
@@ -171,6 +177,8 @@ private:
     HighAvailabilityManager() = delete;
     static bool use_daq_channel;
     static PortBitSet* ports;
+    static uint16_t batch_size;
+    static struct timeval batch_timeout;
 };
 }
 
@@ -53,6 +53,13 @@ static const Parameter ha_params[] =
     { "min_sync", Parameter::PT_INT, "0:max32", "0",
       "minimum interval in milliseconds between HA updates" },
 
+    // frames must fit the 16 bit connector length along with the side channel header
+    { "batch_size", Parameter::PT_INT, "0:65000", "0",
+      "maximum bytes of side channel messages sent per frame; 0 sends each message alone" },
+
+    { "batch_timeout", Parameter::PT_INT, "0:max32", "1",
+      "maximum milliseconds a side channel message waits in a batch" },
+
     { nullptr, Parameter::PT_MAX, nullptr, nullptr, nullptr }
 };
 
@@ -71,6 +78,11 @@ static const PegInfo ha_pegs[] =
     { CountType::SUM, "unknown_key_type", "messages received with an unknown flow key type" },
     { CountType::SUM, "unknown_client_idx", "messages received with an unknown client index" },
     { CountType::SUM, "client_consume_errors", "client data consume failure count" },
+    { CountType::SUM, "batches_sent", "side channel batches sent" },
+    { CountType::SUM, "batched_msgs", "messages sent in side channel batches" },
+    { CountType::SUM, "coalesced_msgs", "batched messages replaced by a later message for the same flow" },
+    { CountType::MAX, "max_batch_msgs", "maximum messages sent in one batch" },
+    { CountType::SUM, "batch_delay_usecs", "total microseconds from first message to send of each batch" },
     { CountType::END, nullptr, nullptr }
 };
 
@@ -144,6 +156,14 @@ bool HighAvailabilityModule::set(const char*, Value& v, SnortConfig*)
     {
         convert_milliseconds_to_timeval(v.get_uint32(), &config->min_sync_interval);
     }
+    else if ( v.is("batch_size") )
+    {
+        config->batch_size = v.get_uint16();
+    }
+    else if ( v.is("batch_timeout") )
+    {
+        convert_milliseconds_to_timeval(v.get_uint32(), &config->batch_timeout);
+    }
     else
         return false;
 
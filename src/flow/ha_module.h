@@ -38,6 +38,8 @@ struct HighAvailabilityConfig
     PortBitSet* ports = nullptr;
     struct timeval min_session_lifetime;
     struct timeval min_sync_interval;
+    uint16_t batch_size = 0;
+    struct timeval batch_timeout = { };
 };
 
 class HighAvailabilityModule : public snort::Module
@@ -77,6 +79,11 @@ struct HAStats
     PegCount unknown_key_type;
     PegCount unknown_client_idx;
     PegCount client_consume_errors;
+    PegCount batches_sent;
+    PegCount batched_msgs;
+    PegCount coalesced_msgs;
+    PegCount max_batch_msgs;
+    PegCount batch_delay_usecs;
 };
 
 extern THREAD_LOCAL HAStats ha_stats;
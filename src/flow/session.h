@@ -24,6 +24,7 @@
 // the subclasses do the actual work of tracking, reassembly, etc.
 
 #include <cassert>
+#include <cstddef>
 #include "stream/stream.h"
 
 namespace snort
@@ -78,6 +79,9 @@ public:
 
     virtual bool set_packet_action_to_hold(snort::Packet*) { return false; }
 
+    // memory queued by the session beyond its own size, eg segments
+    virtual size_t get_memory_in_use() const { return 0; }
+
 protected:
     Session(snort::Flow* f) { flow = f; }
 
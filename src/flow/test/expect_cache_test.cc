@@ -0,0 +1,295 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2020-2020 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// expect_cache_test.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <arpa/inet.h>
+#include <daq_common.h>
+
+#include <vector>
+
+#include "flow/expect_cache.h"
+
+#include "detection/ips_context.h"
+#include "flow/flow.h"
+#include "flow/flow_data.h"
+#include "main/snort_config.h"
+#include "memory/huge_pages.h"
+#include "packet_io/sfdaq_instance.h"
+#include "protocols/packet.h"
+#include "stream/stream.h"
+#include "utils/util.h"
+
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness.h>
+
+using namespace snort;
+
+static time_t test_time = 100;
+static unsigned fd_deleted = 0;
+static unsigned fd_realized = 0;
+static std::vector<FlowData*> flow_data_set;
+
+namespace snort
+{
+FlowData::FlowData(unsigned u, Inspector* ph)
+{
+    next = prev = nullptr;
+    handler = ph;
+    id = u;
+}
+FlowData::~FlowData() = default;
+
+Flow::Flow() { memset(this, 0, sizeof(*this)); }
+Flow::~Flow() = default;
+
+int Flow::set_flow_data(FlowData* fd)
+{
+    flow_data_set.emplace_back(fd);
+    return 0;
+}
+
+SfIpRet SfIp::set(const void* src, int fam)
+{
+    family = fam;
+    ip32[0] = ip32[1] = 0;
+    ip16[4] = 0;
+    ip16[5] = 0xffff;
+    ip32[3] = *(const uint32_t*)src;
+    return SFIP_SUCCESS;
+}
+
+namespace ip
+{
+void IpApi::set(const SfIp& sip, const SfIp& dip)
+{
+    type = IAT_DATA;
+    src = sip;
+    dst = dip;
+    iph = nullptr;
+}
+}
+
+namespace layer
+{
+const vlan::VlanTagHdr* get_vlan_layer(const Packet* const) { return nullptr; }
+}
+
+Packet::Packet(bool) { }
+Packet::~Packet() = default;
+IpsContext::IpsContext(unsigned) { }
+IpsContext::~IpsContext() = default;
+SnortConfig::SnortConfig(const SnortConfig* const) { }
+SnortConfig::~SnortConfig() = default;
+const SnortConfig* SnortConfig::get_conf() { return nullptr; }
+void DataBus::publish(const char*, DataEvent&, Flow*) { }
+int SFDAQInstance::add_expected(const Packet*, const SfIp*, uint16_t, const SfIp*, uint16_t,
+    IpProtocol, unsigned, unsigned) { return 0; }
+time_t packet_time() { return test_time; }
+}
+
+namespace memory
+{
+void* HugePages::calloc(size_t n, TableUser) { return snort_calloc(n); }
+void HugePages::free(void* p) { snort_free(p); }
+}
+
+class TestFlowData : public FlowData
+{
+public:
+    TestFlowData(unsigned id) : FlowData(id) { }
+    ~TestFlowData() override
+    { ++fd_deleted; }
+
+    size_t size_of() override
+    { return sizeof(*this); }
+
+    void handle_expected(Packet*) override
+    { ++fd_realized; }
+};
+
+static const unsigned FTP_ID = 7;
+static const unsigned SIP_ID = 9;
+
+struct TestPacket
+{
+    TestPacket(const char* src, uint16_t sp, const char* dst, uint16_t dp) : pkt(false)
+    {
+        SfIp sip;
+        SfIp dip;
+        uint32_t a = inet_addr(src);
+        uint32_t b = inet_addr(dst);
+
+        sip.set(&a, AF_INET);
+        dip.set(&b, AF_INET);
+        pkt.ptrs.ip_api.set(sip, dip);
+        pkt.ptrs.sp = sp;
+        pkt.ptrs.dp = dp;
+        pkt.ptrs.set_pkt_type(PktType::TCP);
+        pkt.ip_proto_next = IpProtocol::TCP;
+        pkt.proto_bits = 0;
+        pkt.daq_instance = nullptr;
+        pkt.flow = nullptr;
+
+        hdr.ts.tv_sec = test_time;
+        hdr.address_space_id = 0;
+        pkt.pkth = &hdr;
+
+        context.conf = &conf;
+        pkt.context = &context;
+    }
+
+    int expect(ExpectCache& ec, uint16_t cp, uint16_t sp, FlowData* fd)
+    {
+        return ec.add_flow(&pkt, PktType::TCP, IpProtocol::TCP, pkt.ptrs.ip_api.get_src(), cp,
+            pkt.ptrs.ip_api.get_dst(), sp, SSN_DIR_BOTH, fd);
+    }
+
+    Packet pkt;
+    DAQ_PktHdr_t hdr = { };
+    IpsContext context;
+    SnortConfig conf;
+};
+
+TEST_GROUP(expect_cache)
+{
+    void setup() override
+    {
+        test_time = 100;
+        fd_deleted = fd_realized = 0;
+    }
+
+    void teardown() override
+    {
+        for ( auto* fd : flow_data_set )
+            delete fd;
+        flow_data_set.clear();
+    }
+};
+
+TEST(expect_cache, wild_card_realized_once)
+{
+    ExpectCache ec(4);
+    TestPacket ctrl("10.0.0.1", 1025, "10.0.0.2", 21);
+    CHECK(ctrl.expect(ec, 0, 2000, new TestFlowData(FTP_ID)) == 0);
+
+    TestPacket data("10.0.0.1", 4000, "10.0.0.2", 2000);
+    Flow flow;
+    CHECK(ec.is_expected(&data.pkt));
+    CHECK(ec.check(&data.pkt, &flow));
+    CHECK(fd_realized == 1);
+    CHECK(!ec.is_expected(&data.pkt));
+
+    ExpectStats stats = { };
+    ec.move_stats(FTP_ID, stats);
+    CHECK(stats.expected_flows == 1);
+    CHECK(stats.expected_realized == 1);
+
+    ec.move_stats(FTP_ID, stats);
+    CHECK(stats.expected_flows == 1);
+}
+
+TEST(expect_cache, exact_needs_full_tuple)
+{
+    ExpectCache ec(4);
+    TestPacket ctrl("10.0.0.1", 1025, "10.0.0.2", 21);
+    CHECK(ctrl.expect(ec, 4000, 2000, new TestFlowData(FTP_ID)) == 0);
+
+    TestPacket other("10.0.0.1", 4001, "10.0.0.2", 2000);
+    CHECK(!ec.is_expected(&other.pkt));
+
+    TestPacket data("10.0.0.1", 4000, "10.0.0.2", 2000);
+    CHECK(ec.is_expected(&data.pkt));
+}
+
+TEST(expect_cache, deadline_expires)
+{
+    ExpectCache ec(4);
+    TestPacket ctrl("10.0.0.1", 5060, "10.0.0.2", 5060);
+    CHECK(ctrl.expect(ec, 0, 3000, new TestFlowData(SIP_ID)) == 0);
+
+    test_time += 300;
+    TestPacket early("10.0.0.1", 4000, "10.0.0.2", 3000);
+    CHECK(ec.is_expected(&early.pkt));
+
+    // an unrelated lookup retires the node from the timer wheel
+    test_time += 2;
+    TestPacket other("10.0.0.3", 4000, "10.0.0.4", 3000);
+    CHECK(!ec.is_expected(&other.pkt));
+    CHECK(fd_deleted == 1);
+    CHECK(ec.get_expired() == 1);
+
+    ExpectStats stats = { };
+    ec.move_stats(SIP_ID, stats);
+    CHECK(stats.expected_expired == 1);
+    CHECK(stats.expected_realized == 0);
+}
+
+TEST(expect_cache, lru_pruned_per_table)
+{
+    ExpectCache ec(2);
+    TestPacket ctrl("10.0.0.1", 1025, "10.0.0.2", 21);
+
+    CHECK(ctrl.expect(ec, 0, 2000, new TestFlowData(FTP_ID)) == 0);
+    CHECK(ctrl.expect(ec, 0, 2001, new TestFlowData(FTP_ID)) == 0);
+    CHECK(ctrl.expect(ec, 4000, 2002, new TestFlowData(FTP_ID)) == 0);
+    CHECK(ec.get_prunes() == 0);
+
+    CHECK(ctrl.expect(ec, 0, 2003, new TestFlowData(FTP_ID)) == 0);
+    CHECK(ec.get_prunes() == 1);
+    CHECK(fd_deleted == 1);
+
+    TestPacket first("10.0.0.1", 4000, "10.0.0.2", 2000);
+    CHECK(!ec.is_expected(&first.pkt));
+
+    TestPacket exact("10.0.0.1", 4000, "10.0.0.2", 2002);
+    CHECK(ec.is_expected(&exact.pkt));
+
+    ExpectStats stats = { };
+    ec.move_stats(FTP_ID, stats);
+    CHECK(stats.expected_flows == 4);
+    CHECK(stats.expected_pruned == 1);
+}
+
+TEST(expect_cache, overflow)
+{
+    ExpectCache ec(2);
+    TestPacket ctrl("10.0.0.1", 1025, "10.0.0.2", 21);
+
+    for ( unsigned i = 0; i < 8; ++i )
+        CHECK(ctrl.expect(ec, 0, 2000, new TestFlowData(FTP_ID)) == 0);
+
+    TestFlowData* fd = new TestFlowData(FTP_ID);
+    CHECK(ctrl.expect(ec, 0, 2000, fd) == -1);
+    delete fd;
+
+    ExpectStats stats = { };
+    ec.move_stats(FTP_ID, stats);
+    CHECK(stats.expected_flows == 8);
+    CHECK(stats.expected_overflows == 1);
+    CHECK(ec.get_overflows() == 1);
+}
+
+int main(int argc, char** argv)
+{
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
@@ -28,7 +28,9 @@
 
 #include "detection/detection_engine.h"
 #include "main/snort_config.h"
+#include "main/thread_config.h"
 #include "managers/inspector_manager.h"
+#include "memory/huge_pages.h"
 #include "memory/memory_cap.h"
 #include "packet_io/active.h"
 #include "packet_tracer/packet_tracer.h"
@@ -71,6 +73,10 @@ void Flow::init(PktType) { }
 void Flow::term() { }
 void Flow::reset(bool) { }
 void Flow::free_flow_data() { }
+static const Flow* heavy_flow = nullptr;
+static memory::MemoryTag heavy_tag = memory::MemoryTag::HTTP;
+size_t Flow::get_memory_in_use(memory::MemoryTag t) const
+{ return (this == heavy_flow and t == heavy_tag) ? 1024 : 0; }
 void set_network_policy(const SnortConfig*, unsigned) { }
 void DataBus::publish(const char*, const uint8_t*, unsigned, Flow*) { }
 void DataBus::publish(const char*, Packet*, Flow*) { }
@@ -86,13 +92,18 @@ ExpectCache::ExpectCache(uint32_t) { }
 bool ExpectCache::check(Packet*, Flow*) { return true; }
 bool ExpectCache::is_expected(Packet*) { return true; }
 Flow* HighAvailabilityManager::import(Packet&, FlowKey&) { return nullptr; }
-bool HighAvailabilityManager::in_standby(Flow*) { return true; }
+static bool ha_standby = true;
+bool HighAvailabilityManager::in_standby(Flow*) { return ha_standby; }
 SfIpRet SfIp::set(void const*, int) { return SFIP_SUCCESS; }
+void* ThreadConfig::alloc_local(size_t n) { return malloc(n); }
+void ThreadConfig::free_local(void* p, size_t) { free(p); }
 namespace memory
 {
-void MemoryCap::update_allocations(size_t) { }
-void MemoryCap::update_deallocations(size_t) { }
+void MemoryCap::update_allocations(size_t, memory::MemoryTag) { }
+void MemoryCap::update_deallocations(size_t, memory::MemoryTag) { }
 bool MemoryCap::over_threshold() { return true; }
+void* HugePages::calloc(size_t n, TableUser) { return snort_calloc(n); }
+void HugePages::free(void* p) { snort_free(p); }
 }
 
 namespace snort
@@ -136,6 +147,37 @@ TEST(flow_prune, empty_cache_prune_flows)
     delete cache;
 }
 
+// All flows are built with the cache and recycled through the pool
+TEST(flow_prune, preallocated_flows)
+{
+    FlowCacheConfig fcg;
+    fcg.max_flows = 3;
+    fcg.preallocate = true;
+    FlowCache *cache = new FlowCache(fcg);
+
+    CHECK(cache->get_flows_allocated() == fcg.max_flows);
+    CHECK(cache->get_count() == 0);
+
+    FlowKey flow_key;
+    memset(&flow_key, 0, sizeof(FlowKey));
+    flow_key.pkt_type = PktType::TCP;
+
+    for ( unsigned i = 0; i < fcg.max_flows; i++ )
+    {
+        flow_key.port_l = i + 1;
+        CHECK(cache->allocate(&flow_key) != nullptr);
+    }
+
+    CHECK(cache->get_count() == fcg.max_flows);
+    CHECK(cache->get_flows_allocated() == fcg.max_flows);
+    CHECK(cache->delete_flows(1) == 1);
+    CHECK(cache->get_flows_allocated() == fcg.max_flows - 1);
+
+    cache->purge();
+    CHECK(cache->get_flows_allocated() == 0);
+    delete cache;
+}
+
 // Do not delete blocked flow
 TEST(flow_prune, blocked_flow_prune_flows)
 {
@@ -204,6 +246,79 @@ TEST(flow_prune, prune_flows)
 }
 
 
+// Add 3 flows in flow cache and prune the one holding the most http memory
+TEST(flow_prune, prune_top_consumer)
+{
+    FlowCacheConfig fcg;
+    fcg.max_flows = 3;
+    FlowCache *cache = new FlowCache(fcg);
+    FlowKey flow_key[3];
+    int port = 1;
+
+    for ( unsigned i = 0; i < fcg.max_flows; i++ )
+    {
+        flow_key[i].port_l = port++;
+        flow_key[i].pkt_type = PktType::TCP;
+        Flow* flow = cache->allocate(&flow_key[i]);
+
+        if ( i == 1 )
+            heavy_flow = flow;
+    }
+
+    CHECK(cache->prune_one(PruneReason::MEMCAP, true, memory::MemoryTag::HTTP));
+    CHECK(cache->get_count() == fcg.max_flows-1);
+    CHECK(cache->find(&flow_key[1]) == nullptr);
+    CHECK(cache->find(&flow_key[0]) != nullptr);
+
+    // without a subsystem preference the oldest flow goes; find made 0 the newest
+    CHECK(cache->prune_one(PruneReason::MEMCAP, true));
+    CHECK(cache->find(&flow_key[2]) == nullptr);
+    CHECK(cache->find(&flow_key[0]) != nullptr);
+
+    heavy_flow = nullptr;
+    cache->purge();
+    CHECK(cache->get_flows_allocated() == 0);
+    delete cache;
+}
+
+// stream memory is held by sessions rather than flow data
+TEST(flow_prune, prune_stream_consumer)
+{
+    FlowCacheConfig fcg;
+    fcg.max_flows = 3;
+    FlowCache *cache = new FlowCache(fcg);
+    FlowKey flow_key[3];
+    int port = 1;
+
+    for ( unsigned i = 0; i < fcg.max_flows; i++ )
+    {
+        flow_key[i].port_l = port++;
+        flow_key[i].pkt_type = PktType::TCP;
+        Flow* flow = cache->allocate(&flow_key[i]);
+
+        if ( i == 1 )
+            heavy_flow = flow;
+    }
+    heavy_tag = memory::MemoryTag::STREAM;
+
+    CHECK(cache->prune_one(PruneReason::MEMCAP, true, memory::MemoryTag::STREAM));
+    CHECK(cache->get_count() == fcg.max_flows-1);
+
+    // nothing holds http memory so the oldest flow goes
+    CHECK(cache->prune_one(PruneReason::MEMCAP, true, memory::MemoryTag::HTTP));
+    CHECK(cache->get_count() == fcg.max_flows-2);
+
+    CHECK(cache->find(&flow_key[0]) == nullptr);
+    CHECK(cache->find(&flow_key[1]) == nullptr);
+    CHECK(cache->find(&flow_key[2]) != nullptr);
+
+    heavy_flow = nullptr;
+    heavy_tag = memory::MemoryTag::HTTP;
+    cache->purge();
+    CHECK(cache->get_flows_allocated() == 0);
+    delete cache;
+}
+
 // Add 3 flows in flow cache, delete all
 TEST(flow_prune, prune_all_flows)
 {
@@ -254,6 +369,119 @@ TEST(flow_prune, prune_all_blocked_flows)
     delete cache;
 }
 
+TEST_GROUP(flow_timeout)
+{
+    void setup() override
+    { ha_standby = false; }
+
+    void teardown() override
+    { ha_standby = true; }
+};
+
+// a long lived flow ahead of a short lived one doesn't hold it back
+TEST(flow_timeout, per_protocol_deadlines)
+{
+    FlowCacheConfig fcg;
+    fcg.max_flows = 3;
+    fcg.proto[to_utype(PktType::TCP)].nominal_timeout = 3600;
+    fcg.proto[to_utype(PktType::UDP)].nominal_timeout = 30;
+    FlowCache *cache = new FlowCache(fcg);
+
+    FlowKey flow_key;
+    memset(&flow_key, 0, sizeof(FlowKey));
+    flow_key.pkt_type = PktType::TCP;
+    cache->allocate(&flow_key);
+
+    flow_key.pkt_type = PktType::UDP;
+    flow_key.port_l = 1;
+    cache->allocate(&flow_key);
+
+    CHECK(cache->get_count() == 2);
+    CHECK(cache->timeout(10, 29) == 0);
+    CHECK(cache->timeout(10, 30) == 1);
+    CHECK(cache->get_count() == 1);
+    CHECK(cache->find(&flow_key) == nullptr);
+
+    CHECK(cache->timeout(10, 3599) == 0);
+    CHECK(cache->timeout(10, 3600) == 1);
+    CHECK(cache->get_count() == 0);
+
+    cache->purge();
+    CHECK(cache->get_flows_allocated() == 0);
+    delete cache;
+}
+
+// idle deadlines move out as packets arrive
+TEST(flow_timeout, activity_extends_deadline)
+{
+    FlowCacheConfig fcg;
+    fcg.max_flows = 2;
+    fcg.proto[to_utype(PktType::UDP)].nominal_timeout = 30;
+    FlowCache *cache = new FlowCache(fcg);
+
+    FlowKey flow_key;
+    memset(&flow_key, 0, sizeof(FlowKey));
+    flow_key.pkt_type = PktType::UDP;
+    Flow* flow = cache->allocate(&flow_key);
+
+    flow->last_data_seen = 20;
+    CHECK(cache->timeout(10, 30) == 0);
+    CHECK(cache->timeout(10, 49) == 0);
+    CHECK(cache->timeout(10, 50) == 1);
+
+    cache->purge();
+    delete cache;
+}
+
+// a hard expiration sooner than the idle deadline is honored
+TEST(flow_timeout, hard_expiration)
+{
+    FlowCacheConfig fcg;
+    fcg.max_flows = 2;
+    fcg.proto[to_utype(PktType::TCP)].nominal_timeout = 3600;
+    FlowCache *cache = new FlowCache(fcg);
+
+    FlowKey flow_key;
+    memset(&flow_key, 0, sizeof(FlowKey));
+    flow_key.pkt_type = PktType::TCP;
+    Flow* flow = cache->allocate(&flow_key);
+
+    flow->set_hard_expiration();
+    flow->expire_time = 10;
+    cache->update_timer(flow);
+
+    CHECK(cache->timeout(10, 9) == 0);
+    CHECK(cache->timeout(10, 10) == 1);
+
+    cache->purge();
+    delete cache;
+}
+
+// flows in HA standby are not timed out but are checked again next tick
+TEST(flow_prune, standby_flow_timeout)
+{
+    FlowCacheConfig fcg;
+    fcg.max_flows = 2;
+    fcg.proto[to_utype(PktType::UDP)].nominal_timeout = 30;
+    FlowCache *cache = new FlowCache(fcg);
+
+    FlowKey flow_key;
+    memset(&flow_key, 0, sizeof(FlowKey));
+    flow_key.pkt_type = PktType::UDP;
+    cache->allocate(&flow_key);
+
+    CHECK(cache->timeout(10, 30) == 0);
+    CHECK(cache->get_count() == 1);
+
+    ha_standby = false;
+    CHECK(cache->timeout(10, 31) == 1);
+    CHECK(cache->get_count() == 0);
+    ha_standby = true;
+
+    cache->purge();
+    delete cache;
+}
+
 int main(int argc, char** argv)
 {
     return CommandLineTestRunner::RunAllTests(argc, argv);
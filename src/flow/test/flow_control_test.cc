@@ -73,7 +73,7 @@ unsigned FlowCache::purge() { return 1; }
 Flow* FlowCache::find(const FlowKey*) { return nullptr; }
 Flow* FlowCache::allocate(const FlowKey*) { return nullptr; }
 void FlowCache::push(Flow*) { }
-bool FlowCache::prune_one(PruneReason, bool) { return true; }
+bool FlowCache::prune_one(PruneReason, bool, memory::MemoryTag) { return true; }
 unsigned FlowCache::delete_flows(unsigned) { return 0; }
 unsigned FlowCache::timeout(unsigned, time_t) { return 1; }
 void Flow::init(PktType) { }
@@ -82,6 +82,7 @@ void DataBus::publish(const char*, const uint8_t*, unsigned, Flow*) { }
 void DataBus::publish(const char*, Packet*, Flow*) { }
 const SnortConfig* SnortConfig::get_conf() { return nullptr; }
 void FlowCache::unlink_uni(Flow*) { }
+void FlowCache::update_timer(Flow*) { }
 void Flow::set_direction(Packet*) { }
 void set_inspection_policy(const SnortConfig*, unsigned) { }
 void set_ips_policy(const SnortConfig*, unsigned) { }
@@ -89,6 +90,7 @@ void Flow::set_mpls_layer_per_dir(Packet*) { }
 void DetectionEngine::disable_all(Packet*) { }
 void Stream::drop_traffic(const Packet*, char) { }
 bool Stream::blocked_flow(Packet*) { return true; }
+TimerWheel::TimerWheel(uint64_t) { }
 ExpectCache::ExpectCache(uint32_t) { }
 bool ExpectCache::check(Packet*, Flow*) { return true; }
 bool ExpectCache::is_expected(Packet*) { return true; }
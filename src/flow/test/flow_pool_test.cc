@@ -0,0 +1,91 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2020-2020 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// flow_pool_test.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "flow/flow_pool.h"
+
+#include <cstdlib>
+
+#include "flow/flow.h"
+#include "main/thread_config.h"
+
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness.h>
+
+using namespace snort;
+
+static unsigned flows_built = 0;
+static unsigned flows_destroyed = 0;
+
+Flow::Flow() { memset(this, 0, sizeof(*this)); ++flows_built; }
+Flow::~Flow() { ++flows_destroyed; }
+
+void* ThreadConfig::alloc_local(size_t n) { return malloc(n); }
+void ThreadConfig::free_local(void* p, size_t) { free(p); }
+
+TEST_GROUP(flow_pool)
+{
+    void setup() override
+    { flows_built = flows_destroyed = 0; }
+};
+
+TEST(flow_pool, contiguous)
+{
+    FlowPool pool(3);
+    Flow* a = pool.get();
+    Flow* b = pool.get();
+    Flow* c = pool.get();
+
+    CHECK(b == a + 1);
+    CHECK(c == b + 1);
+    CHECK(pool.owns(a) and pool.owns(c));
+    CHECK(!pool.owns(c + 1));
+    CHECK(pool.get() == nullptr);
+    CHECK(pool.get_in_use() == 3);
+    CHECK(flows_built == 3);
+
+    pool.put(a);
+    pool.put(b);
+    pool.put(c);
+    CHECK(pool.get_in_use() == 0);
+    CHECK(flows_destroyed == 3);
+}
+
+TEST(flow_pool, reuse)
+{
+    FlowPool pool(2);
+    Flow* a = pool.get();
+    Flow* b = pool.get();
+
+    pool.put(a);
+    CHECK(pool.get() == a);
+    CHECK(flows_built == 3);
+    CHECK(flows_destroyed == 1);
+
+    pool.put(a);
+    pool.put(b);
+}
+
+int main(int argc, char** argv)
+{
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
@@ -26,6 +26,7 @@
 #include "detection/detection_engine.h"
 #include "flow/flow.h"
 #include "flow/flow_stash.h"
+#include "flow/session.h"
 #include "flow/ha.h"
 #include "framework/inspector.h"
 #include "framework/data_bus.h"
@@ -47,9 +48,9 @@ void Inspector::rem_ref() {}
 
 void Inspector::add_ref() {}
 
-void memory::MemoryCap::update_allocations(size_t) {}
+void memory::MemoryCap::update_allocations(size_t, memory::MemoryTag) {}
 
-void memory::MemoryCap::update_deallocations(size_t) {}
+void memory::MemoryCap::update_deallocations(size_t, memory::MemoryTag) {}
 
 bool memory::MemoryCap::free_space(size_t) { return false; }
 
@@ -84,6 +85,27 @@ void DataBus::publish(const char*, Packet*, Flow*) {}
 
 const SnortConfig* SnortConfig::get_conf() { return nullptr; }
 
+class QueuingSession : public Session
+{
+public:
+    QueuingSession(Flow* f) : Session(f) { }
+    void clear() override { }
+    size_t get_memory_in_use() const override { return 2048; }
+};
+
+TEST_GROUP(memory_in_use) { };
+
+TEST(memory_in_use, session_is_stream)
+{
+    Flow* flow = new Flow();
+    flow->session = new QueuingSession(flow);
+
+    CHECK( flow->get_memory_in_use(memory::MemoryTag::STREAM) == 2048 );
+    CHECK( flow->get_memory_in_use(memory::MemoryTag::HTTP) == 0 );
+
+    delete flow;
+}
+
 TEST_GROUP(nondefault_timeout)
 {
     void setup() override
@@ -30,7 +30,7 @@
 
 using namespace snort;
 
-#define MSG_SIZE 100
+#define MSG_SIZE 200
 #define TEST_KEY 0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,18,19,20,21,22,23,24,25,26,27,28,29,30,31,32,33,34,35,36,37,38,39,40,41,42,43,44,45,46,47
 
 class StreamHAClient;
@@ -101,7 +101,7 @@ static bool s_transmit_message_called = false;
 static bool s_stream_update_required = false;
 static bool s_other_update_required = false;
 static uint8_t* s_message_content = nullptr;
-static uint8_t s_message_length = 0;
+static uint16_t s_message_length = 0;
 static Flow s_flow;
 static FlowKey s_flowkey;
 static Packet s_pkt;
@@ -593,6 +593,192 @@ TEST(high_availability_test, produce_error_client_produce)
     CHECK(msg.cursor == msg.buffer);
 }
 
+static void set_key(Flow& flow, uint16_t port)
+{
+    FlowKey* key = new FlowKey(s_test_key);
+    key->port_l = port;
+    delete flow.key;
+    flow.key = key;
+}
+
+TEST_GROUP(high_availability_batch_test)
+{
+    Flow flow_a;
+    Flow flow_b;
+
+    void setup() override
+    {
+        memset(&ha_stats, 0, sizeof(ha_stats));
+        s_packet_time = { 100, 0 };
+
+        HighAvailabilityConfig hac;
+        hac.enabled = true;
+        hac.daq_channel = false;
+        hac.ports = new PortBitSet();
+        hac.ports->set(1);
+        hac.min_session_lifetime = { 0, 0 };
+        hac.min_sync_interval = { 0, 0 };
+        hac.batch_size = 150;
+        hac.batch_timeout = { 0, 1000 };
+
+        HighAvailabilityManager::configure(&hac);
+        HighAvailabilityManager::thread_init();
+        s_ha_client = new StreamHAClient;
+        s_other_ha_client = new OtherHAClient;
+
+        set_key(flow_a, s_test_key.port_l);
+        set_key(flow_b, 42);
+
+        s_stream_update_required = true;
+        s_other_update_required = false;
+        s_pkt.active = &active;
+        s_transmit_message_called = false;
+        s_message_content = nullptr;
+        s_message_length = 0;
+    }
+
+    void teardown() override
+    {
+        delete s_other_ha_client;
+        delete s_ha_client;
+        HighAvailabilityManager::thread_term();
+        HighAvailabilityManager::term();
+        s_message_content = nullptr;
+        s_message_length = 0;
+    }
+};
+
+TEST(high_availability_batch_test, send_on_shutdown)
+{
+    HighAvailabilityManager::process_update(&flow_a, &s_pkt);
+    HighAvailabilityManager::process_update(&flow_b, &s_pkt);
+    CHECK(s_transmit_message_called == false);
+
+    HighAvailabilityManager::thread_term_beginning();
+    CHECK(s_transmit_message_called == true);
+    CHECK(s_message_length == sizeof(HAMessageHeader) + 2 * sizeof(s_update_stream_message));
+    CHECK(ha_stats.batches_sent == 1);
+    CHECK(ha_stats.batched_msgs == 2);
+    CHECK(ha_stats.max_batch_msgs == 2);
+}
+
+TEST(high_availability_batch_test, send_when_full)
+{
+    Flow flow_c;
+    set_key(flow_c, 43);
+
+    HighAvailabilityManager::process_update(&flow_a, &s_pkt);
+    HighAvailabilityManager::process_update(&flow_b, &s_pkt);
+    CHECK(s_transmit_message_called == false);
+    HighAvailabilityManager::process_update(&flow_c, &s_pkt);
+    CHECK(s_transmit_message_called == true);
+    CHECK(s_message_length == sizeof(HAMessageHeader) + 2 * sizeof(s_update_stream_message));
+    CHECK(ha_stats.batches_sent == 1);
+}
+
+TEST(high_availability_batch_test, send_after_timeout)
+{
+    HighAvailabilityManager::process_update(&flow_a, &s_pkt);
+    HighAvailabilityManager::process_receive();
+    CHECK(s_transmit_message_called == false);
+
+    s_packet_time.tv_usec = 1500;
+    HighAvailabilityManager::process_receive();
+    CHECK(s_transmit_message_called == true);
+    CHECK(s_message_length == sizeof(HAMessageHeader) + sizeof(s_update_stream_message));
+    CHECK(ha_stats.batch_delay_usecs == 1500);
+}
+
+TEST(high_availability_batch_test, coalesce_updates)
+{
+    HighAvailabilityManager::process_update(&flow_a, &s_pkt);
+    flow_a.ha_state->set_pending(s_other_ha_client->handle);
+    HighAvailabilityManager::process_update(&flow_a, &s_pkt);
+    HighAvailabilityManager::thread_term_beginning();
+
+    // the replacement carries every client since the first update was dropped
+    CHECK(ha_stats.coalesced_msgs == 1);
+    CHECK(ha_stats.batched_msgs == 1);
+    CHECK(s_message_length == sizeof(HAMessageHeader) + sizeof(s_update_stream_message) +
+        sizeof(HAClientHeader) + 5);
+}
+
+TEST(high_availability_batch_test, coalesce_deletion)
+{
+    HighAvailabilityManager::process_update(&flow_a, &s_pkt);
+    HighAvailabilityManager::process_deletion(flow_a);
+    HighAvailabilityManager::process_update(&flow_b, &s_pkt);
+    HighAvailabilityManager::thread_term_beginning();
+
+    CHECK(ha_stats.coalesced_msgs == 1);
+    CHECK(ha_stats.batched_msgs == 2);
+    CHECK(s_message_length == sizeof(HAMessageHeader) + sizeof(s_delete_message) +
+        sizeof(s_update_stream_message));
+    CHECK(((HAMessageHeader*) s_message_content)->event == HA_BATCH_EVENT);
+    CHECK(((HAMessageHeader*) s_message_content)->version == HA_BATCH_VERSION);
+    CHECK(((HAMessageHeader*) (s_message_content + sizeof(HAMessageHeader)))->event ==
+        HA_DELETE_EVENT);
+}
+
+TEST(high_availability_batch_test, receive_batch)
+{
+    HighAvailabilityManager::process_update(&flow_a, &s_pkt);
+    HighAvailabilityManager::process_deletion(flow_b);
+    HighAvailabilityManager::process_update(&flow_b, &s_pkt);
+    HighAvailabilityManager::process_deletion(flow_b);
+    HighAvailabilityManager::thread_term_beginning();
+    CHECK(ha_stats.batched_msgs == 2);
+
+    s_delete_session_called = false;
+    s_stream_consume_called = false;
+    HighAvailabilityManager::process_receive();
+    CHECK(ha_stats.msgs_recv == 2);
+    CHECK(ha_stats.update_msgs_consumed == 1);
+    CHECK(ha_stats.delete_msgs_consumed == 1);
+    CHECK(s_stream_consume_called == true);
+    CHECK(s_delete_session_called == true);
+    CHECK(ha_stats.msg_length_mismatch == 0);
+}
+
+TEST(high_availability_batch_test, receive_truncated_batch)
+{
+    uint8_t frame[sizeof(HAMessageHeader) + sizeof(s_update_stream_message) +
+        sizeof(s_delete_message) / 2];
+    HAMessageHeader hdr = { HA_BATCH_EVENT, HA_BATCH_VERSION, sizeof(frame), 0 };
+    uint8_t* cursor = frame;
+
+    memcpy(cursor, &hdr, sizeof(hdr));
+    cursor += sizeof(hdr);
+    memcpy(cursor, &s_update_stream_message, sizeof(s_update_stream_message));
+    cursor += sizeof(s_update_stream_message);
+    memcpy(cursor, &s_delete_message, sizeof(s_delete_message) / 2);
+
+    s_message_content = frame;
+    s_message_length = sizeof(frame);
+    HighAvailabilityManager::process_receive();
+    CHECK(ha_stats.msgs_recv == 2);
+    CHECK(ha_stats.update_msgs_consumed == 1);
+    CHECK(ha_stats.msg_length_mismatch == 1);
+}
+
+// an unbatched sender may leave stale bytes after its message; they must
+// not be taken for another message
+TEST(high_availability_batch_test, receive_unbatched_trailer)
+{
+    uint8_t frame[sizeof(s_update_stream_message) + sizeof(s_delete_message)];
+    memcpy(frame, &s_update_stream_message, sizeof(s_update_stream_message));
+    memcpy(frame + sizeof(s_update_stream_message), &s_delete_message, sizeof(s_delete_message));
+
+    s_delete_session_called = false;
+    s_message_content = frame;
+    s_message_length = sizeof(frame);
+    HighAvailabilityManager::process_receive();
+    CHECK(ha_stats.msgs_recv == 1);
+    CHECK(ha_stats.msg_length_mismatch == 1);
+    CHECK(ha_stats.delete_msgs_consumed == 0);
+    CHECK(s_delete_session_called == false);
+}
+
 int main(int argc, char** argv)
 {
     return CommandLineTestRunner::RunAllTests(argc, argv);
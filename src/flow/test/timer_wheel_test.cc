@@ -0,0 +1,198 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2020-2020 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// timer_wheel_test.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <vector>
+
+#include "flow/timer_wheel.h"
+
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness.h>
+
+using namespace snort;
+
+static std::vector<TimerNode*> expire(TimerWheel& tw, uint64_t now)
+{
+    std::vector<TimerNode*> v;
+    tw.advance(now);
+
+    while ( TimerNode* t = tw.pop() )
+        v.push_back(t);
+
+    return v;
+}
+
+TEST_GROUP(timer_wheel) { };
+
+TEST(timer_wheel, due_now)
+{
+    TimerWheel tw(100);
+    TimerNode t = { };
+
+    tw.schedule(&t, 50);
+    CHECK(t.is_scheduled());
+    CHECK(tw.get_due() == 1);
+    CHECK(tw.pop() == &t);
+    CHECK(!t.is_scheduled());
+    CHECK(tw.get_count() == 0);
+}
+
+// each timer fires exactly at its own deadline regardless of level
+TEST(timer_wheel, exact_expiry)
+{
+    const uint64_t start = 1000003;
+    const uint64_t deltas[] = { 1, 2, 63, 64, 65, 127, 4095, 4096, 4097, 300000,
+        TimerWheel::max_delta - 1, TimerWheel::max_delta + 12345 };
+    const unsigned num = sizeof(deltas) / sizeof(deltas[0]);
+
+    TimerWheel tw(start);
+    TimerNode nodes[num] = { };
+
+    for ( unsigned i = 0; i < num; ++i )
+    {
+        nodes[i].owner = &nodes[i];
+        tw.schedule(nodes + i, start + deltas[i]);
+    }
+    CHECK(tw.get_count() == num);
+
+    for ( unsigned i = 0; i < num; ++i )
+    {
+        CHECK(expire(tw, start + deltas[i] - 1).empty());
+
+        auto v = expire(tw, start + deltas[i]);
+        CHECK(v.size() == 1);
+        CHECK(v[0] == nodes + i);
+    }
+    CHECK(tw.get_count() == 0);
+}
+
+// a short timer scheduled after a long one is not held back by it
+TEST(timer_wheel, no_head_of_line_blocking)
+{
+    TimerWheel tw(0);
+    TimerNode tcp = { }, udp = { };
+
+    tw.schedule(&tcp, 3600);
+    tw.schedule(&udp, 30);
+
+    auto v = expire(tw, 30);
+    CHECK(v.size() == 1);
+    CHECK(v[0] == &udp);
+    CHECK(tcp.is_scheduled());
+}
+
+TEST(timer_wheel, cancel_and_reschedule)
+{
+    TimerWheel tw(10);
+    TimerNode a = { }, b = { }, c = { };
+
+    tw.schedule(&a, 20);
+    tw.schedule(&b, 20);
+    tw.schedule(&c, 20);
+
+    tw.cancel(&b);
+    tw.cancel(&b);
+    CHECK(!b.is_scheduled());
+
+    tw.schedule(&c, 5000);
+    CHECK(tw.get_count() == 2);
+
+    auto v = expire(tw, 4999);
+    CHECK(v.size() == 1);
+    CHECK(v[0] == &a);
+
+    v = expire(tw, 5000);
+    CHECK(v.size() == 1);
+    CHECK(v[0] == &c);
+}
+
+// pop hands out due timers one at a time and leaves the rest queued
+TEST(timer_wheel, bounded_pop)
+{
+    TimerWheel tw(0);
+    TimerNode nodes[100] = { };
+
+    for ( auto& n : nodes )
+        tw.schedule(&n, 7);
+
+    tw.advance(7);
+    CHECK(tw.get_due() == 100);
+    CHECK(tw.pop() != nullptr);
+    CHECK(tw.get_due() == 99);
+
+    // canceling a due timer takes it off the ready list
+    TimerNode* t = tw.pop();
+    tw.schedule(t, 9);
+    CHECK(tw.get_due() == 98);
+    tw.cancel(nodes + 50);
+    CHECK(tw.get_due() == 97);
+    CHECK(tw.get_count() == 98);
+}
+
+TEST(timer_wheel, time_jumps)
+{
+    TimerWheel tw(0);
+    TimerNode t = { };
+
+    // empty wheel skips straight ahead
+    tw.advance(1600000000);
+    CHECK(tw.get_time() == 1600000000);
+
+    tw.schedule(&t, 1600000000 + 180);
+    tw.advance(1500000000);
+    CHECK(tw.get_time() == 1600000000);
+
+    auto v = expire(tw, 1700000000);
+    CHECK(v.size() == 1);
+}
+
+TEST(timer_wheel, random)
+{
+    TimerWheel tw(12345);
+    const unsigned num = 5000;
+    TimerNode nodes[num] = { };
+    uint64_t seed = 42;
+
+    for ( auto& n : nodes )
+    {
+        seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+        tw.schedule(&n, 12345 + (seed >> 33) % 20000);
+    }
+
+    unsigned fired = 0;
+
+    for ( uint64_t now = 12345; now < 12345 + 20000; now += 7 )
+    {
+        for ( auto t : expire(tw, now) )
+        {
+            CHECK(t->deadline <= now);
+            CHECK(t->deadline + 7 > now);
+            ++fired;
+        }
+    }
+    CHECK(fired == num);
+}
+
+int main(int argc, char** argv)
+{
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
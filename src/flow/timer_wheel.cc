@@ -0,0 +1,224 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2020-2020 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// timer_wheel.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "timer_wheel.h"
+
+#include <cassert>
+#include <cstring>
+
+using namespace snort;
+
+static_assert(TimerWheel::num_slots == 64, "occupancy is tracked in a 64 bit word per level");
+
+TimerWheel::TimerWheel(uint64_t t) : now(t)
+{
+    memset(heads, 0, sizeof(heads));
+    memset(occupied, 0, sizeof(occupied));
+    tail = nullptr;
+    count = due = 0;
+}
+
+void TimerWheel::link(TimerNode* t, unsigned slot)
+{
+    t->slot = slot + 1;
+
+    if ( slot == ready_slot )
+    {
+        t->next = nullptr;
+        t->prev = tail;
+
+        if ( tail )
+            tail->next = t;
+        else
+            heads[slot] = t;
+
+        tail = t;
+        ++due;
+        return;
+    }
+
+    t->prev = nullptr;
+    t->next = heads[slot];
+
+    if ( t->next )
+        t->next->prev = t;
+
+    heads[slot] = t;
+    occupied[slot / num_slots] |= (uint64_t)1 << (slot % num_slots);
+}
+
+void TimerWheel::unlink(TimerNode* t)
+{
+    unsigned slot = t->slot - 1;
+
+    if ( t->prev )
+        t->prev->next = t->next;
+    else
+        heads[slot] = t->next;
+
+    if ( t->next )
+        t->next->prev = t->prev;
+
+    else if ( slot == ready_slot )
+        tail = t->prev;
+
+    if ( slot == ready_slot )
+        --due;
+
+    else if ( !heads[slot] )
+        occupied[slot / num_slots] &= ~((uint64_t)1 << (slot % num_slots));
+
+    t->prev = t->next = nullptr;
+    t->slot = 0;
+}
+
+// the level is picked by distance and the slot by absolute time so a timer
+// is cascaded down exactly when its slot comes around, never early or late
+void TimerWheel::insert(TimerNode* t)
+{
+    if ( t->deadline <= now )
+    {
+        link(t, ready_slot);
+        return;
+    }
+
+    uint64_t delta = t->deadline - now;
+    unsigned level = 0;
+
+    while ( level < num_levels - 1 and delta >= (uint64_t)1 << (slot_bits * (level + 1)) )
+        ++level;
+
+    uint64_t when = (delta < max_delta) ? t->deadline : now + max_delta - 1;
+    unsigned slot = (when >> (slot_bits * level)) & (num_slots - 1);
+
+    link(t, level * num_slots + slot);
+}
+
+void TimerWheel::schedule(TimerNode* t, uint64_t deadline)
+{
+    if ( t->is_scheduled() )
+        unlink(t);
+    else
+        ++count;
+
+    t->deadline = deadline;
+    insert(t);
+}
+
+void TimerWheel::cancel(TimerNode* t)
+{
+    if ( !t->is_scheduled() )
+        return;
+
+    unlink(t);
+    --count;
+}
+
+TimerNode* TimerWheel::pop()
+{
+    TimerNode* t = heads[ready_slot];
+
+    if ( t )
+    {
+        unlink(t);
+        --count;
+    }
+    return t;
+}
+
+void TimerWheel::cascade(unsigned level)
+{
+    unsigned slot = level * num_slots + ((now >> (slot_bits * level)) & (num_slots - 1));
+    TimerNode* t = heads[slot];
+
+    heads[slot] = nullptr;
+    occupied[level] &= ~((uint64_t)1 << (slot % num_slots));
+
+    while ( t )
+    {
+        TimerNode* next = t->next;
+        insert(t);
+        t = next;
+    }
+}
+
+// the earliest time after now at which some occupied slot comes around
+uint64_t TimerWheel::next_tick() const
+{
+    uint64_t tick = UINT64_MAX;
+
+    for ( unsigned level = 0; level < num_levels; ++level )
+    {
+        uint64_t bits = occupied[level];
+
+        if ( !bits )
+            continue;
+
+        unsigned shift = slot_bits * level;
+        uint64_t cur = now >> shift;
+        unsigned pos = (cur + 1) & (num_slots - 1);
+
+        // rotate so the slot after the current one is bit 0
+        uint64_t rot = pos ? (bits >> pos) | (bits << (num_slots - pos)) : bits;
+        uint64_t t = (cur + 1 + __builtin_ctzll(rot)) << shift;
+
+        if ( t < tick )
+            tick = t;
+    }
+    return tick;
+}
+
+void TimerWheel::advance(uint64_t t)
+{
+    if ( t <= now )
+        return;
+
+    // only idle time passes; skip it in one step
+    if ( count == due )
+    {
+        now = t;
+        return;
+    }
+
+    while ( true )
+    {
+        uint64_t tick = next_tick();
+
+        if ( tick > t )
+        {
+            now = t;
+            break;
+        }
+        now = tick;
+
+        // higher levels first so timers can fall through to level 0 in one tick
+        for ( unsigned level = num_levels; level-- > 0; )
+        {
+            uint64_t mask = ((uint64_t)1 << (slot_bits * level)) - 1;
+
+            if ( !(now & mask) )
+                cascade(level);
+        }
+    }
+}
+
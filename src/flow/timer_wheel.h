@@ -0,0 +1,101 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2020-2020 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// timer_wheel.h
+
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+// hierarchical timing wheel for deadlines in whole seconds (packet time).
+// scheduling and canceling are O(1) and the work done to advance the
+// wheel only depends on the number of occupied slots crossed, not on
+// the number of scheduled timers.  timers are intrusive so the owner
+// (a flow, an expected flow, a stream session) embeds a TimerNode and
+// nothing is allocated here after construction.
+
+#include <cstdint>
+
+#include "main/snort_types.h"
+
+namespace snort
+{
+struct SO_PUBLIC TimerNode
+{
+    TimerNode* prev;
+    TimerNode* next;
+    void* owner;
+    uint64_t deadline;
+    uint16_t slot;  // 0 when not scheduled
+
+    bool is_scheduled() const
+    { return slot != 0; }
+};
+
+class SO_PUBLIC TimerWheel
+{
+public:
+    TimerWheel(uint64_t now = 0);
+
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    // (re)schedule; deadlines at or before the current time are due at once
+    void schedule(TimerNode*, uint64_t deadline);
+    void cancel(TimerNode*);
+
+    // move the wheel forward; timers that come due are queued in order of
+    // their slots and handed out one at a time by pop so callers can bound
+    // the work done per call.  time never moves backwards.
+    void advance(uint64_t now);
+    TimerNode* pop();
+
+    uint64_t get_time() const
+    { return now; }
+
+    unsigned get_count() const
+    { return count; }
+
+    unsigned get_due() const
+    { return due; }
+
+    static constexpr unsigned slot_bits = 6;
+    static constexpr unsigned num_slots = 1 << slot_bits;
+    static constexpr unsigned num_levels = 4;
+
+    // about 194 days; anything further out is parked in the top level
+    static constexpr uint64_t max_delta = (uint64_t)1 << (slot_bits * num_levels);
+
+private:
+    static constexpr unsigned ready_slot = num_slots * num_levels;
+
+    void insert(TimerNode*);
+    void link(TimerNode*, unsigned slot);
+    void unlink(TimerNode*);
+    void cascade(unsigned level);
+    uint64_t next_tick() const;
+
+private:
+    TimerNode* heads[ready_slot + 1];
+    TimerNode* tail;  // of the ready list so due timers stay in order
+    uint64_t occupied[num_levels];
+    uint64_t now;
+    unsigned count;
+    unsigned due;
+};
+}
+#endif
+
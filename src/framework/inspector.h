@@ -147,6 +147,13 @@ public:
     const char* get_alias_name() const
     { return alias_name; }
 
+    // latency histogram id of the alias name, set with it at configuration
+    void set_latency_id(unsigned id)
+    { latency_id = id; }
+
+    unsigned get_latency_id() const
+    { return latency_id; }
+
     virtual bool is_control_channel() const
     { return false; }
 
@@ -170,6 +177,7 @@ private:
     SnortProtocolId snort_protocol_id = 0;
     // FIXIT-E Use std::string to avoid storing a pointer to external std::string buffers
     const char* alias_name = nullptr;
+    unsigned latency_id = 0;
 };
 
 // at present there is no sequencing among like types except that appid
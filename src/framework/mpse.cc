@@ -66,14 +66,63 @@ int Mpse::search_all(
     return _search(T, n, match, context, current_state);
 }
 
+// set by the base batch search which is the one that knows about fused
+// groups; engines overriding it search each group separately
+static THREAD_LOCAL bool fusing = false;
+
+static void count_bypassed(const MpseBatch& batch)
+{
+    for ( auto& item : batch.items )
+    {
+        const std::vector<MpseGroup*>& groups = item.second.so;
+
+        for ( unsigned i = 0; i < groups.size(); ++i )
+        {
+            for ( unsigned j = i + 1; j < groups.size(); ++j )
+            {
+                if ( groups[i]->get_fused(groups[j]) or groups[j]->get_fused(groups[i]) )
+                    pmqs.fused_bypassed++;
+            }
+        }
+    }
+}
+
 void Mpse::search(MpseBatch& batch, MpseType mpse_type)
 {
+    fusing = false;
     _search(batch, mpse_type);
+
+    if ( !fusing )
+        count_bypassed(batch);
+}
+
+// A group may have a combined matcher with another group queued for the
+// same buffer; if so the pair is searched once and the other is skipped.
+static MpseGroup* find_fused(std::vector<MpseGroup*>& so, unsigned i, uint32_t& skip)
+{
+    for ( unsigned j = i + 1; j < so.size() and j < 32; ++j )
+    {
+        if ( skip & (1u << j) )
+            continue;
+
+        MpseGroup* fused = so[i]->get_fused(so[j]);
+
+        if ( !fused )
+            fused = so[j]->get_fused(so[i]);
+
+        if ( fused )
+        {
+            skip |= (1u << j);
+            return fused;
+        }
+    }
+    return nullptr;
 }
 
 void Mpse::_search(MpseBatch& batch, MpseType mpse_type)
 {
     int start_state;
+    fusing = true;
 
     for ( auto& item : batch.items )
     {
@@ -83,8 +132,26 @@ void Mpse::_search(MpseBatch& batch, MpseType mpse_type)
         item.second.error = false;
         item.second.matches = 0;
 
-        for ( auto& so : item.second.so )
+        std::vector<MpseGroup*>& groups = item.second.so;
+        uint32_t skip = 0;
+
+        for ( unsigned i = 0; i < groups.size(); ++i )
         {
+            if ( i < 32 and (skip & (1u << i)) )
+                continue;
+
+            MpseGroup* so = groups[i];
+
+            if ( groups.size() > 1 )
+            {
+                if ( MpseGroup* fused = find_fused(groups, i, skip) )
+                {
+                    so = fused;
+                    pmqs.fused_searches++;
+                    pmqs.fused_bytes += item.first.len;
+                }
+            }
+
             start_state = 0;
 
             Mpse* mpse = (mpse_type == MPSE_TYPE_OFFLOAD) ?
@@ -97,6 +164,24 @@ void Mpse::_search(MpseBatch& batch, MpseType mpse_type)
     }
 }
 
+void Mpse::search(std::vector<MpseBatch*>& batches, MpseType mpse_type)
+{
+    fusing = false;
+    _search(batches, mpse_type);
+
+    if ( !fusing )
+    {
+        for ( auto* batch : batches )
+            count_bypassed(*batch);
+    }
+}
+
+void Mpse::_search(std::vector<MpseBatch*>& batches, MpseType mpse_type)
+{
+    for ( auto* batch : batches )
+        _search(*batch, mpse_type);
+}
+
 Mpse::MpseRespType Mpse::poll_responses(MpseBatch*& batch, MpseType mpse_type)
 {
     // FIXIT-L validate for reload during offload
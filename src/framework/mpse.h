@@ -27,6 +27,7 @@
 
 #include <cassert>
 #include <string>
+#include <vector>
 
 #include "framework/base_api.h"
 #include "main/snort_types.h"
@@ -36,7 +37,7 @@
 namespace snort
 {
 // this is the current version of the api
-#define SEAPI_VERSION ((BASE_API_VERSION << 16) | 0)
+#define SEAPI_VERSION ((BASE_API_VERSION << 16) | 1)
 
 struct SnortConfig;
 class Mpse;
@@ -87,6 +88,9 @@ public:
 
     void search(MpseBatch&, MpseType);
 
+    // search batches from several contexts with a single submission
+    void search(std::vector<MpseBatch*>&, MpseType);
+
     virtual MpseRespType receive_responses(MpseBatch&, MpseType)
     { return MPSE_RESP_COMPLETE_SUCCESS; }
 
@@ -110,6 +114,10 @@ protected:
 
     virtual void _search(MpseBatch&, MpseType);
 
+    // the default searches each batch in turn; engines with significant
+    // per call overhead (scratch setup, offload submission) can override
+    virtual void _search(std::vector<MpseBatch*>&, MpseType);
+
 private:
     std::string method;
     int verbose;
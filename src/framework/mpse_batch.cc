@@ -64,12 +64,38 @@ bool MpseBatch::search_sync()
     return searches;
 }
 
+bool MpseBatch::search_sync(std::vector<MpseBatch*>& batches)
+{
+    if ( batches.empty() )
+        return false;
+
+    // all groups use the same search method so any of them can submit
+    Mpse* mpse = batches[0]->items.begin()->second.so[0]->get_normal_mpse();
+    mpse->search(batches, Mpse::MPSE_TYPE_NORMAL);
+
+    for ( auto* batch : batches )
+    {
+        Mpse::MpseRespType resp_ret;
+
+        do
+        {
+            resp_ret = batch->receive_responses();
+        }
+        while (resp_ret == Mpse::MPSE_RESP_NOT_COMPLETE);
+
+        batch->items.clear();
+    }
+    return true;
+}
+
 //-------------------------------------------------------------------------
 // group stuff
 //-------------------------------------------------------------------------
 
 MpseGroup::~MpseGroup()
 {
+    delete fused;
+
     if (normal_mpse)
     {
         MpseManager::delete_search_engine(normal_mpse);
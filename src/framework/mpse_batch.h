@@ -32,10 +32,10 @@ class SO_PUBLIC MpseGroup
 {
 public:
     MpseGroup()
-    { normal_mpse = nullptr; offload_mpse = nullptr; }
+    { normal_mpse = nullptr; offload_mpse = nullptr; fuse_with = nullptr; fused = nullptr; }
 
     MpseGroup(Mpse* normal)
-    { normal_mpse = normal; offload_mpse = nullptr; }
+    { normal_mpse = normal; offload_mpse = nullptr; fuse_with = nullptr; fused = nullptr; }
 
     ~MpseGroup();
 
@@ -59,9 +59,21 @@ public:
     inline bool can_fallback() const
     { return get_offload_mpse() != normal_mpse; }
 
+    // when this group and fuse_with are queued for the same buffer,
+    // fused (which has the patterns of both) is searched instead
+    void set_fused(MpseGroup* with, MpseGroup* both)
+    { fuse_with = with; fused = both; }
+
+    MpseGroup* get_fused(const MpseGroup* with) const
+    { return (fused and with == fuse_with) ? fused : nullptr; }
+
 public:  // FIXIT-L privatize
         Mpse* normal_mpse;
         Mpse* offload_mpse;
+
+private:
+        MpseGroup* fuse_with;
+        MpseGroup* fused;
 };
 
 template<typename BUF = const uint8_t*, typename LEN = unsigned>
@@ -120,6 +132,9 @@ struct MpseBatch
     bool search_sync();
     bool can_fallback() const;
 
+    // search several batches, each with its own context, as one submission
+    static bool search_sync(std::vector<MpseBatch*>&);
+
     static Mpse::MpseRespType poll_responses(MpseBatch*& batch)
     { return Mpse::poll_responses(batch, snort::Mpse::MPSE_TYPE_NORMAL); }
 
@@ -24,6 +24,7 @@
 #include "hash_key_operations.h"
 
 #include <cassert>
+#include <cstring>
 
 #include "main/snort_config.h"
 #include "utils/util.h"
@@ -32,6 +33,15 @@
 
 using namespace snort;
 
+static uint64_t rand64()
+{
+    // rand() only gives 31 bits
+    uint64_t r = (uint64_t)rand() << 62;
+    r ^= (uint64_t)rand() << 31;
+    r ^= (uint64_t)rand();
+    return r;
+}
+
 HashKeyOperations::HashKeyOperations(int rows)
 {
     static bool one = true;
@@ -47,26 +57,21 @@ HashKeyOperations::HashKeyOperations(int rows)
         seed = 3193;
         scale = 719;
         hardener = 133824503;
+        secret[0] = 0xa0761d6478bd642f;
+        secret[1] = 0xe7037ed1a0b428db;
     }
     else
     {
         seed = nearest_prime( (rand() % rows) + 3191);
         scale = nearest_prime( (rand() % rows) + 709);
         hardener = ((unsigned) rand() * rand()) + 133824503;
+        secret[0] = rand64();
+        secret[1] = rand64();
     }
 }
 
 unsigned HashKeyOperations::do_hash(const unsigned char* key, int len)
-{
-    unsigned hash = seed;
-    while ( len )
-    {
-        hash *= scale;
-        hash += *key++;
-        len--;
-    }
-    return hash ^ hardener;
-}
+{ return keyed_hash(key, len, secret); }
 
 bool HashKeyOperations::key_compare(const void* key1, const void* key2, size_t len)
 {
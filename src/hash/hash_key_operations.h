@@ -20,6 +20,8 @@
 #ifndef HASH_KEY_OPERATIONS_H
 #define HASH_KEY_OPERATIONS_H
 
+#include <cstring>
+
 #include "main/snort_types.h"
 
 namespace
@@ -44,6 +46,46 @@ namespace
         b ^= a; b -= rot(a,14);
         c ^= b; c -= rot(b,24);
     }
+
+    inline uint64_t load64(const unsigned char* p)
+    {
+        uint64_t w;
+        memcpy(&w, p, sizeof(w));
+#ifdef WORDS_BIGENDIAN
+        w = __builtin_bswap64(w);
+#endif
+        return w;
+    }
+
+    inline uint64_t load32(const unsigned char* p)
+    {
+        uint32_t w;
+        memcpy(&w, p, sizeof(w));
+#ifdef WORDS_BIGENDIAN
+        w = __builtin_bswap32(w);
+#endif
+        return w;
+    }
+
+    // 64 x 64 -> 128 bit multiply with the halves folded together; every input
+    // bit reaches every output bit in one step
+    inline uint64_t fold_mul(uint64_t a, uint64_t b)
+    {
+#ifdef __SIZEOF_INT128__
+        __uint128_t r = (__uint128_t)a * b;
+        return (uint64_t)r ^ (uint64_t)(r >> 64);
+#else
+        uint64_t al = (uint32_t)a, ah = a >> 32;
+        uint64_t bl = (uint32_t)b, bh = b >> 32;
+
+        uint64_t ll = al * bl, lh = al * bh, hl = ah * bl, hh = ah * bh;
+        uint64_t mid = (ll >> 32) + (uint32_t)lh + (uint32_t)hl;
+
+        uint64_t lo = (mid << 32) | (uint32_t)ll;
+        uint64_t hi = hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+        return lo ^ hi;
+#endif
+    }
 }
 
 namespace snort
@@ -55,6 +97,47 @@ SO_PUBLIC void mix_str(
 
 SO_PUBLIC uint32_t str_to_hash(const uint8_t *str, size_t length);
 
+// keyed hash taking 8 bytes per step.  the length is folded in up front
+// so zero padding of the tail can't make keys of different lengths collide.
+// inline so callers with a compile time length get the loops unrolled.
+inline unsigned keyed_hash(const unsigned char* key, int len, const uint64_t* secret)
+{
+    const uint64_t k0 = secret[0];
+    const uint64_t k1 = secret[1];
+
+    uint64_t h = k0 ^ ((uint64_t)len * k1);
+
+    while ( len >= 16 )
+    {
+        h = fold_mul(load64(key) ^ k0, load64(key + 8) ^ k1 ^ h);
+        key += 16;
+        len -= 16;
+    }
+
+    if ( len >= 8 )
+    {
+        h = fold_mul(load64(key) ^ k0, h ^ k1);
+        key += 8;
+        len -= 8;
+    }
+
+    if ( len > 0 )
+    {
+        // 1-7 bytes from at most two overlapping reads
+        uint64_t w;
+
+        if ( len >= 4 )
+            w = ((uint64_t)load32(key) << 32) | load32(key + len - 4);
+        else
+            w = ((uint64_t)key[0] << 16) | ((uint64_t)key[len >> 1] << 8) | key[len - 1];
+
+        h = fold_mul(w ^ k1, h ^ k0);
+    }
+
+    h = fold_mul(h ^ k0, h ^ k1);
+    return (unsigned)(h ^ (h >> 32));
+}
+
 static inline int hash_nearest_power_of_2(int nrows)
 {
     nrows -= 1;
@@ -76,9 +159,13 @@ public:
     virtual bool key_compare(const void* key1, const void* key2, size_t len);
 
 protected:
+    // used by subclasses that hash their keys a byte at a time
     unsigned seed;
     unsigned scale;
     unsigned hardener;
+
+    // keys the default do_hash so collisions can't be precomputed
+    uint64_t secret[2];
 };
 }
 
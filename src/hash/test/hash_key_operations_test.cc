@@ -0,0 +1,239 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2020-2020 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// hash_key_operations_test.cc
+// hash quality checks and a throughput benchmark for HashKeyOperations
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "hash/hash_key_operations.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <set>
+#include <vector>
+
+#include "main/snort_config.h"
+
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness.h>
+
+using namespace snort;
+
+// Stubs whose sole purpose is to make the test code link
+static SnortConfig my_config;
+THREAD_LOCAL SnortConfig* snort_conf = &my_config;
+
+SnortConfig::SnortConfig(const SnortConfig* const)
+{ snort_conf->run_flags = 0;}
+
+SnortConfig::~SnortConfig() = default;
+
+const SnortConfig* SnortConfig::get_conf()
+{ return snort_conf; }
+
+// the byte at a time hash this replaced, for comparison
+class LegacyHashKeyOps : public HashKeyOperations
+{
+public:
+    LegacyHashKeyOps() : HashKeyOperations(1024)
+    { }
+
+    unsigned do_hash(const unsigned char* key, int len) override
+    {
+        unsigned hash = seed;
+        while ( len )
+        {
+            hash *= scale;
+            hash += *key++;
+            len--;
+        }
+        return hash ^ hardener;
+    }
+};
+
+// keys shaped like the ones hashed at runtime: small ints, 5 tuples
+// with incrementing ports, and longer mostly zero records
+static void make_key(unsigned i, unsigned len, uint8_t* key)
+{
+    memset(key, 0, len);
+
+    if ( len >= 40 )
+    {
+        key[12] = 10;
+        key[15] = 1;
+        key[28] = 192;
+        key[29] = 168;
+        memcpy(key + 30, &i, 2);
+        memcpy(key + 36, &i, 4);
+    }
+    else
+        memcpy(key, &i, len < sizeof(i) ? len : sizeof(i));
+}
+
+// chi square of the low bits as used for the row index
+static double chi_square(HashKeyOperations& hk, unsigned len, unsigned rows, unsigned num)
+{
+    std::vector<unsigned> counts(rows);
+    uint8_t key[64];
+
+    for ( unsigned i = 0; i < num; ++i )
+    {
+        make_key(i, len, key);
+        ++counts[hk.do_hash(key, len) & (rows - 1)];
+    }
+
+    double expected = (double)num / rows;
+    double chi = 0;
+
+    for ( auto c : counts )
+        chi += (c - expected) * (c - expected) / expected;
+
+    return chi;
+}
+
+TEST_GROUP(hash_key_operations)
+{
+    void teardown() override
+    { snort_conf->run_flags = 0; }
+};
+
+TEST(hash_key_operations, static_hash_is_repeatable)
+{
+    snort_conf->run_flags |= RUN_FLAG__STATIC_HASH;
+    HashKeyOperations a(1024), b(4096);
+    const unsigned char key[] = "the quick brown fox jumps over the lazy dog";
+
+    for ( int len = 0; len < (int)sizeof(key); ++len )
+        CHECK(a.do_hash(key, len) == b.do_hash(key, len));
+}
+
+TEST(hash_key_operations, random_seeds_differ)
+{
+    HashKeyOperations a(1024), b(1024);
+    const unsigned char key[16] = { 1, 2, 3, 4 };
+    unsigned same = 0;
+
+    for ( int len = 1; len <= 16; ++len )
+        same += (a.do_hash(key, len) == b.do_hash(key, len));
+
+    CHECK(same < 2);
+}
+
+// zero padding of the tail doesn't make keys of different lengths collide
+TEST(hash_key_operations, lengths_differ)
+{
+    HashKeyOperations hk(1024);
+    const unsigned char zeros[64] = { };
+    std::set<unsigned> seen;
+
+    for ( int len = 0; len <= 64; ++len )
+        seen.insert(hk.do_hash(zeros, len));
+
+    CHECK(seen.size() == 65);
+}
+
+TEST(hash_key_operations, distribution)
+{
+    HashKeyOperations hk(4096);
+    const unsigned rows = 1024;
+    const unsigned num = 64 * rows;
+
+    // mean is rows - 1 and deviation about sqrt(2 * rows)
+    const double limit = rows + 6 * sqrt(2.0 * rows);
+
+    for ( unsigned len : { 4u, 8u, 13u, 16u, 40u, 64u } )
+        CHECK(chi_square(hk, len, rows, num) < limit);
+}
+
+// flipping any input bit flips each output bit about half the time
+TEST(hash_key_operations, avalanche)
+{
+    HashKeyOperations hk(1024);
+    const unsigned len = 16;
+    const unsigned trials = 200;
+    std::vector<unsigned> flips(32);
+    uint8_t key[len];
+
+    for ( unsigned t = 0; t < trials; ++t )
+    {
+        make_key(t * 2654435761u, len, key);
+        unsigned base = hk.do_hash(key, len);
+
+        for ( unsigned bit = 0; bit < len * 8; ++bit )
+        {
+            key[bit / 8] ^= 1 << (bit % 8);
+            unsigned diff = base ^ hk.do_hash(key, len);
+            key[bit / 8] ^= 1 << (bit % 8);
+
+            for ( unsigned i = 0; i < 32; ++i )
+                flips[i] += (diff >> i) & 1;
+        }
+    }
+
+    const double total = trials * len * 8;
+
+    for ( auto f : flips )
+    {
+        CHECK(f / total > 0.45);
+        CHECK(f / total < 0.55);
+    }
+}
+
+// run with -ri to include the benchmark
+IGNORE_TEST(hash_key_operations, throughput)
+{
+    LegacyHashKeyOps legacy;
+    HashKeyOperations current(1024);
+    const unsigned iters = 4000000;
+    const unsigned num_keys = 4096;
+    std::vector<uint8_t> keys(num_keys * 64);
+    volatile unsigned sink = 0;
+
+    printf("\n%8s %12s %12s %10s %10s\n", "len", "legacy ns", "current ns", "legacy chi", "chi");
+
+    for ( unsigned len : { 4u, 8u, 16u, 40u, 64u } )
+    {
+        for ( unsigned i = 0; i < num_keys; ++i )
+            make_key(i, len, &keys[i * 64]);
+
+        double ns[2];
+        HashKeyOperations* hk[2] = { &legacy, &current };
+
+        for ( unsigned j = 0; j < 2; ++j )
+        {
+            auto start = std::chrono::steady_clock::now();
+
+            for ( unsigned i = 0; i < iters; ++i )
+                sink += hk[j]->do_hash(&keys[(i % num_keys) * 64], len);
+
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            ns[j] = std::chrono::duration<double, std::nano>(elapsed).count() / iters;
+        }
+        printf("%8u %12.2f %12.2f %10.0f %10.0f\n", len, ns[0], ns[1],
+            chi_square(legacy, len, 1024, 65536), chi_square(current, len, 1024, 65536));
+    }
+}
+
+int main(int argc, char** argv)
+{
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
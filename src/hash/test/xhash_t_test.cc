@@ -0,0 +1,258 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2020-2020 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// xhash_t_test.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "hash/xhash_t.h"
+
+#include "main/snort_config.h"
+
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness.h>
+
+using namespace snort;
+
+// Stubs whose sole purpose is to make the test code link
+static SnortConfig my_config;
+THREAD_LOCAL SnortConfig* snort_conf = &my_config;
+
+SnortConfig::SnortConfig(const SnortConfig* const)
+{ snort_conf->run_flags = 0;}
+
+SnortConfig::~SnortConfig() = default;
+
+const SnortConfig* SnortConfig::get_conf()
+{ return snort_conf; }
+
+void* memory::HugePages::calloc(size_t n, memory::TableUser)
+{ return snort_calloc(n); }
+
+void memory::HugePages::free(void* p)
+{ snort_free(p); }
+
+struct TestKey
+{
+    int key;
+};
+
+struct TestValue
+{
+    int value;
+    bool pinned;
+};
+
+typedef XHashT<TestKey, TestValue> TestHash;
+
+// only unpinned nodes may be recovered
+class PinHash : public TestHash
+{
+public:
+    PinHash(int rows, unsigned long memcap) : TestHash(rows, memcap)
+    { }
+
+    unsigned freed = 0;
+
+protected:
+    bool is_node_recovery_ok(Node* node) override
+    { return !node->data.pinned; }
+
+    void free_user_data(Node*) override
+    { ++freed; }
+};
+
+static const unsigned long node_size = sizeof(TestHash::Node);
+
+TEST_GROUP(xhash_t)
+{ };
+
+TEST(xhash_t, insert_find_release)
+{
+    TestHash table(4, 0);
+    CHECK(!table.get_mru_user_data());
+
+    for ( int i = 1; i <= 8; i++ )
+    {
+        TestKey k { i };
+        TestValue v { 10 * i, false };
+        CHECK(table.insert(k, &v) == HASH_OK);
+        CHECK(table.get_user_data()->value == 10 * i);
+    }
+    CHECK(table.get_num_nodes() == 8);
+
+    TestKey k { 3 };
+    TestValue v { 0, false };
+    CHECK(table.insert(k, &v) == HASH_INTABLE);
+    CHECK(table.get_user_data()->value == 30);
+    CHECK(table.get_mru_user_data()->value == 30);
+    CHECK(table.get_lru_user_data()->value == 10);
+
+    k.key = 5;
+    CHECK(table.release_node(k) == HASH_OK);
+    CHECK(!table.get_user_data(k));
+    CHECK(table.release_node(k) == HASH_NOT_FOUND);
+    CHECK(table.get_num_nodes() == 7);
+
+    unsigned n = 0;
+    int sum = 0;
+    for ( auto node = table.find_first_node(); node; node = table.find_next_node() )
+    {
+        CHECK(node->data.value == 10 * node->key.key);
+        sum += node->key.key;
+        ++n;
+    }
+    CHECK(n == 7);
+    CHECK(sum == 36 - 5);
+}
+
+TEST(xhash_t, new_value_is_zeroed)
+{
+    TestHash table(4, 0);
+    TestKey k { 1 };
+    TestValue v { 42, true };
+
+    CHECK(table.insert(k, &v) == HASH_OK);
+    CHECK(table.release_node(k) == HASH_OK);
+
+    // the recycled node must not leak the old value
+    CHECK(table.insert(k) == HASH_OK);
+    CHECK(table.get_user_data()->value == 0);
+    CHECK(!table.get_user_data()->pinned);
+    CHECK(table.get_stats().release_recycles == 1);
+}
+
+TEST(xhash_t, anr_recycles_lru)
+{
+    TestHash table(4, 4 * node_size);
+
+    for ( int i = 1; i <= 4; i++ )
+    {
+        TestKey k { i };
+        CHECK(table.insert(k) == HASH_OK);
+    }
+    CHECK(table.get_mem_used() == 4 * node_size);
+
+    // touch 1 so 2 is the lru
+    TestKey k { 1 };
+    CHECK(table.find_node(k));
+
+    k.key = 5;
+    CHECK(table.insert(k) == HASH_OK);
+    CHECK(table.get_num_nodes() == 4);
+    CHECK(table.get_stats().memcap_prunes == 1);
+    CHECK(table.get_mem_used() == 4 * node_size);
+
+    k.key = 2;
+    CHECK(!table.find_node(k));
+    k.key = 1;
+    CHECK(table.find_node(k));
+}
+
+TEST(xhash_t, anr_skips_pinned)
+{
+    PinHash table(4, 2 * node_size);
+    TestKey k { 1 };
+    TestValue v { 1, true };
+
+    CHECK(table.insert(k, &v) == HASH_OK);
+    k.key = 2;
+    v.pinned = false;
+    CHECK(table.insert(k, &v) == HASH_OK);
+
+    // 1 is the lru but pinned so 2 goes
+    k.key = 3;
+    CHECK(table.insert(k) == HASH_OK);
+    CHECK(table.freed == 1);
+    k.key = 2;
+    CHECK(!table.find_node(k));
+
+    // everything pinned
+    k.key = 3;
+    table.find_node(k)->data.pinned = true;
+    k.key = 4;
+    CHECK(table.insert(k) == HASH_NOMEM);
+    CHECK(!table.get_user_data());
+}
+
+TEST(xhash_t, delete_lru_frees_memory)
+{
+    TestHash table(4, node_size);
+    table.set_max_nodes(1);
+
+    TestKey k { 1 };
+    CHECK(table.insert(k) == HASH_OK);
+    CHECK(table.delete_lru_node());
+    CHECK(!table.delete_lru_node());
+    CHECK(table.get_mem_used() == 0);
+}
+
+TEST(xhash_t, tune_memory)
+{
+    PinHash table(8, 0);
+
+    for ( int i = 1; i <= 8; i++ )
+    {
+        TestKey k { i };
+        CHECK(table.insert(k) == HASH_OK);
+    }
+    TestKey k { 8 };
+    CHECK(table.release_node(k) == HASH_OK);
+    CHECK(table.get_mem_used() == 8 * node_size);
+
+    table.set_memcap(4 * node_size);
+
+    // free list goes first, then lru
+    unsigned freed = 0;
+    CHECK(table.tune_memory_resources(2, freed) == HASH_PENDING);
+    CHECK(freed == 2);
+    CHECK(table.get_mem_used() == 6 * node_size);
+    k.key = 1;
+    CHECK(!table.find_node(k));
+
+    CHECK(table.tune_memory_resources(8, freed) == HASH_OK);
+    CHECK(freed == 4);
+    CHECK(table.get_mem_used() == 4 * node_size);
+    CHECK(table.get_num_nodes() == 4);
+    CHECK(table.get_stats().memcap_deletes == 4);
+}
+
+TEST(xhash_t, clear)
+{
+    PinHash table(8, 0);
+
+    for ( int i = 1; i <= 8; i++ )
+    {
+        TestKey k { i };
+        CHECK(table.insert(k) == HASH_OK);
+    }
+    table.clear_hash();
+
+    CHECK(table.get_num_nodes() == 0);
+    CHECK(table.freed == 8);
+    CHECK(!table.find_first_node());
+    CHECK(!table.get_mru_user_data());
+    CHECK(!table.get_lru_user_data());
+}
+
+int main(int argc, char** argv)
+{
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
@@ -47,6 +47,12 @@ SnortConfig::~SnortConfig() = default;
 const SnortConfig* SnortConfig::get_conf()
 { return snort_conf; }
 
+void* memory::HugePages::calloc(size_t n, memory::TableUser)
+{ return snort_calloc(n); }
+
+void memory::HugePages::free(void* p)
+{ snort_free(p); }
+
 struct xhash_test_key
 {
     int key;
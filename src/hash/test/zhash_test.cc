@@ -30,6 +30,7 @@
 
 #include "flow/flow_key.h"
 #include "main/snort_config.h"
+#include "utils/util.h"
 
 #include <CppUTest/CommandLineTestRunner.h>
 #include <CppUTest/TestHarness.h>
@@ -72,6 +73,12 @@ SnortConfig::~SnortConfig() = default;
 const SnortConfig* SnortConfig::get_conf()
 { return snort_conf; }
 
+void* memory::HugePages::calloc(size_t n, memory::TableUser)
+{ return snort_calloc(n); }
+
+void memory::HugePages::free(void* p)
+{ snort_free(p); }
+
 const unsigned ZHASH_ROWS = 1000;
 const unsigned ZHASH_KEY_SIZE = 100;
 const unsigned MAX_ZHASH_NODES = 100;
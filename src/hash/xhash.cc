@@ -107,7 +107,7 @@ namespace snort
 void XHash::initialize(HashKeyOperations* hk_ops)
 {
     hashkey_ops = hk_ops;
-    table = (HashNode**)snort_calloc(sizeof(HashNode*) * nrows);
+    table = (HashNode**)memory::HugePages::calloc(sizeof(HashNode*) * nrows, table_user);
     lru_cache = new HashLruCache();
     mem_allocator = new MemCapAllocator(mem_cap, sizeof(HashNode) + keysize + datasize);
 }
@@ -152,7 +152,7 @@ XHash::~XHash()
                 mem_allocator->free(xnode);
             }
 
-        snort_free(table);
+        memory::HugePages::free(table);
     }
 
     purge_free_list();
@@ -175,7 +175,7 @@ void XHash::delete_hash_table()
             mem_allocator->free(xnode);
         }
 
-    snort_free(table);
+    memory::HugePages::free(table);
     table = nullptr;
 }
 
@@ -27,6 +27,7 @@
 
 #include "framework/counts.h"
 #include "main/snort_types.h"
+#include "memory/huge_pages.h"
 #include "utils/memcap_allocator.h"
 
 class HashLruCache;
@@ -115,6 +116,7 @@ protected:
     unsigned num_nodes = 0;
     bool recycle_nodes = true;
     bool anr_enabled = true;
+    memory::TableUser table_user = memory::TableUser::NONE;
 
 private:
     HashNode** table = nullptr;
@@ -0,0 +1,511 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2020-2020 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// xhash_t.h
+
+#ifndef XHASH_T_H
+#define XHASH_T_H
+
+// XHashT -- XHash with the key and value types known at compile time.
+// Same lru, memcap, and automatic node recovery (anr) semantics as XHash
+// but hash and compare are statically dispatched through Hasher and the
+// key and value are stored inline in each node.  Key and Value must be
+// trivially copyable; nodes come from a MemCapAllocator and are never
+// constructed.  A new value is zero filled unless data is given to insert.
+
+#include <cassert>
+#include <cstring>
+#include <type_traits>
+
+#include "hash/hash_defs.h"
+#include "hash/hash_key_operations.h"
+#include "hash/xhash.h"
+#include "utils/memcap_allocator.h"
+#include "utils/util.h"
+
+namespace snort
+{
+// default Hasher: keyed hash and memcmp over the key bytes so any padding
+// must be zeroed by the caller, just as with XHash
+template<typename Key>
+class XHashKeyOps : public HashKeyOperations
+{
+public:
+    XHashKeyOps(int rows) : HashKeyOperations(rows)
+    { }
+
+    unsigned hash(const Key& key) const
+    { return keyed_hash((const unsigned char*)&key, sizeof(Key), secret); }
+
+    bool equal(const Key& k1, const Key& k2) const
+    { return !memcmp(&k1, &k2, sizeof(Key)); }
+};
+
+template<typename Key, typename Value, typename Hasher = XHashKeyOps<Key>>
+class XHashT
+{
+    static_assert(std::is_trivially_copyable<Key>::value, "Key must be trivially copyable");
+    static_assert(std::is_trivially_copyable<Value>::value, "Value must be trivially copyable");
+
+public:
+    struct Node
+    {
+        Node* gnext; // lru or free node list
+        Node* gprev;
+        Node* next;  // hash row node list
+        Node* prev;
+        unsigned rindex;
+        Key key;
+        Value data;
+    };
+
+    XHashT(int rows, unsigned long memcap, memory::TableUser = memory::TableUser::NONE);
+    virtual ~XHashT();
+
+    XHashT(const XHashT&) = delete;
+    XHashT& operator=(const XHashT&) = delete;
+
+    // HASH_OK if added, HASH_INTABLE if already there, HASH_NOMEM if full;
+    // either way get_user_data() then returns the entry
+    int insert(const Key&, const Value* data = nullptr);
+
+    Node* find_node(const Key&);
+    Node* find_first_node();
+    Node* find_next_node();
+
+    Value* get_user_data()
+    { return cursor ? &cursor->data : nullptr; }
+
+    Value* get_user_data(const Key& key)
+    {
+        Node* node = find_node(key);
+        return node ? &node->data : nullptr;
+    }
+
+    int release_node(const Key&);
+    int release_node(Node*);
+
+    Value* get_mru_user_data()
+    { return lru_head ? &lru_head->data : nullptr; }
+
+    Value* get_lru_user_data()
+    { return lru_tail ? &lru_tail->data : nullptr; }
+
+    bool delete_lru_node();
+    void clear_hash();
+    bool full() const { return !fhead; }
+
+    // set max hash nodes, 0 == no limit
+    void set_max_nodes(int max)
+    { max_nodes = max; }
+
+    unsigned get_num_nodes()
+    { return num_nodes; }
+
+    void set_memcap(unsigned long memcap)
+    { mem_allocator.set_mem_capacity(memcap); }
+
+    unsigned long get_memcap()
+    { return mem_allocator.get_mem_capacity(); }
+
+    unsigned long get_mem_used()
+    { return mem_allocator.get_mem_allocated(); }
+
+    const XHashStats& get_stats() const
+    { return stats; }
+
+    int tune_memory_resources(unsigned work_limit, unsigned& num_freed);
+
+protected:
+    virtual bool is_node_recovery_ok(Node*)
+    { return true; }
+
+    virtual void free_user_data(Node*)
+    { }
+
+    bool recycle_nodes = true;
+    bool anr_enabled = true;
+
+private:
+    Node* find_node_row(const Key&, unsigned& rindex);
+    Node* allocate_node(const Key&, const Value*, unsigned rindex);
+    Node* release_lru_node();
+    bool delete_a_node();
+
+    void link_node(Node*);
+    void unlink_node(Node*);
+    void lru_insert(Node*);
+    void lru_remove(Node*);
+    void update_cursor();
+
+    void save_free_node(Node* node)
+    {
+        node->gnext = fhead;
+        fhead = node;
+    }
+
+    Node* get_free_node()
+    {
+        Node* node = fhead;
+        if ( fhead )
+            fhead = fhead->gnext;
+        return node;
+    }
+
+    Hasher hasher;
+    MemCapAllocator mem_allocator;
+    Node** table = nullptr;
+    Node* lru_head = nullptr;
+    Node* lru_tail = nullptr;
+    Node* fhead = nullptr;
+    Node* cursor = nullptr;
+    unsigned nrows;
+    unsigned num_nodes = 0;
+    unsigned max_nodes = 0;
+    unsigned crow = 0;
+    XHashStats stats;
+};
+
+// rows > 0 is rounded up to a power of 2; rows < 0 is used as is (-rows)
+inline unsigned xhash_rows(int rows)
+{ return rows > 0 ? hash_nearest_power_of_2(rows) : -rows; }
+
+template<typename Key, typename Value, typename Hasher>
+XHashT<Key, Value, Hasher>::XHashT(int rows, unsigned long memcap, memory::TableUser user) :
+    hasher(xhash_rows(rows)), mem_allocator(memcap, sizeof(Node)), nrows(xhash_rows(rows))
+{
+    assert(nrows);
+    table = (Node**)memory::HugePages::calloc(sizeof(Node*) * nrows, user);
+}
+
+template<typename Key, typename Value, typename Hasher>
+XHashT<Key, Value, Hasher>::~XHashT()
+{
+    for ( unsigned i = 0; i < nrows; i++ )
+    {
+        for ( Node* node = table[i]; node; )
+        {
+            Node* xnode = node;
+            node = node->next;
+            mem_allocator.free(xnode);
+        }
+    }
+    memory::HugePages::free(table);
+
+    while ( Node* node = get_free_node() )
+        mem_allocator.free(node);
+}
+
+template<typename Key, typename Value, typename Hasher>
+void XHashT<Key, Value, Hasher>::link_node(Node* node)
+{
+    Node*& row = table[node->rindex];
+
+    node->prev = nullptr;
+    node->next = row;
+
+    if ( row )
+        row->prev = node;
+
+    row = node;
+}
+
+template<typename Key, typename Value, typename Hasher>
+void XHashT<Key, Value, Hasher>::unlink_node(Node* node)
+{
+    if ( node->prev )
+        node->prev->next = node->next;
+    else
+        table[node->rindex] = node->next;
+
+    if ( node->next )
+        node->next->prev = node->prev;
+}
+
+template<typename Key, typename Value, typename Hasher>
+void XHashT<Key, Value, Hasher>::lru_insert(Node* node)
+{
+    node->gprev = nullptr;
+    node->gnext = lru_head;
+
+    if ( lru_head )
+        lru_head->gprev = node;
+    else
+        lru_tail = node;
+
+    lru_head = node;
+}
+
+template<typename Key, typename Value, typename Hasher>
+void XHashT<Key, Value, Hasher>::lru_remove(Node* node)
+{
+    if ( node->gprev )
+        node->gprev->gnext = node->gnext;
+    else
+        lru_head = node->gnext;
+
+    if ( node->gnext )
+        node->gnext->gprev = node->gprev;
+    else
+        lru_tail = node->gprev;
+}
+
+template<typename Key, typename Value, typename Hasher>
+typename XHashT<Key, Value, Hasher>::Node*
+XHashT<Key, Value, Hasher>::find_node_row(const Key& key, unsigned& rindex)
+{
+    rindex = hasher.hash(key) & (nrows - 1);
+
+    for ( Node* node = table[rindex]; node; node = node->next )
+    {
+        if ( hasher.equal(node->key, key) )
+        {
+            if ( table[rindex] != node )
+            {
+                unlink_node(node);
+                link_node(node);
+            }
+            if ( lru_head != node )
+            {
+                lru_remove(node);
+                lru_insert(node);
+            }
+            return node;
+        }
+    }
+    return nullptr;
+}
+
+template<typename Key, typename Value, typename Hasher>
+typename XHashT<Key, Value, Hasher>::Node*
+XHashT<Key, Value, Hasher>::allocate_node(const Key& key, const Value* data, unsigned rindex)
+{
+    // use a free one if available...
+    Node* node = get_free_node();
+
+    // if no free nodes, try to allocate a new one...
+    if ( !node and (!max_nodes or num_nodes < max_nodes) )
+        node = (Node*)mem_allocator.allocate();
+
+    // if still no node then try to reuse one...
+    if ( !node and anr_enabled )
+        node = release_lru_node();
+
+    if ( !node )
+        return nullptr;
+
+    node->key = key;
+
+    if ( data )
+        node->data = *data;
+    else
+        memset(&node->data, 0, sizeof(node->data));
+
+    node->rindex = rindex;
+    link_node(node);
+    lru_insert(node);
+
+    ++num_nodes;
+    ++stats.nodes_created;
+    return node;
+}
+
+template<typename Key, typename Value, typename Hasher>
+int XHashT<Key, Value, Hasher>::insert(const Key& key, const Value* data)
+{
+    unsigned rindex;
+    Node* node = find_node_row(key, rindex);
+
+    if ( node )
+    {
+        cursor = node;
+        return HASH_INTABLE;
+    }
+
+    node = allocate_node(key, data, rindex);
+    cursor = node;
+    return node ? HASH_OK : HASH_NOMEM;
+}
+
+template<typename Key, typename Value, typename Hasher>
+typename XHashT<Key, Value, Hasher>::Node*
+XHashT<Key, Value, Hasher>::find_node(const Key& key)
+{
+    unsigned rindex;
+    return find_node_row(key, rindex);
+}
+
+template<typename Key, typename Value, typename Hasher>
+void XHashT<Key, Value, Hasher>::update_cursor()
+{
+    if ( !cursor )
+        return;
+
+    cursor = cursor->next;
+    if ( cursor )
+        return;
+
+    for ( crow++; crow < nrows; crow++ )
+    {
+        cursor = table[crow];
+        if ( cursor )
+            return;
+    }
+}
+
+template<typename Key, typename Value, typename Hasher>
+typename XHashT<Key, Value, Hasher>::Node* XHashT<Key, Value, Hasher>::find_first_node()
+{
+    for ( crow = 0; crow < nrows; crow++ )
+    {
+        cursor = table[crow];
+        if ( cursor )
+        {
+            Node* node = cursor;
+            update_cursor();
+            return node;
+        }
+    }
+    return nullptr;
+}
+
+template<typename Key, typename Value, typename Hasher>
+typename XHashT<Key, Value, Hasher>::Node* XHashT<Key, Value, Hasher>::find_next_node()
+{
+    Node* node = cursor;
+
+    if ( node )
+        update_cursor();
+
+    return node;
+}
+
+template<typename Key, typename Value, typename Hasher>
+int XHashT<Key, Value, Hasher>::release_node(Node* node)
+{
+    assert(node);
+
+    free_user_data(node);
+    unlink_node(node);
+    lru_remove(node);
+    num_nodes--;
+
+    if ( recycle_nodes )
+    {
+        save_free_node(node);
+        ++stats.release_recycles;
+    }
+    else
+    {
+        mem_allocator.free(node);
+        ++stats.release_deletes;
+    }
+    return HASH_OK;
+}
+
+template<typename Key, typename Value, typename Hasher>
+int XHashT<Key, Value, Hasher>::release_node(const Key& key)
+{
+    unsigned rindex = hasher.hash(key) & (nrows - 1);
+
+    for ( Node* node = table[rindex]; node; node = node->next )
+    {
+        if ( hasher.equal(node->key, key) )
+            return release_node(node);
+    }
+    return HASH_NOT_FOUND;
+}
+
+template<typename Key, typename Value, typename Hasher>
+typename XHashT<Key, Value, Hasher>::Node* XHashT<Key, Value, Hasher>::release_lru_node()
+{
+    for ( Node* node = lru_tail; node; node = node->gprev )
+    {
+        if ( is_node_recovery_ok(node) )
+        {
+            lru_remove(node);
+            free_user_data(node);
+            unlink_node(node);
+            --num_nodes;
+            ++stats.memcap_prunes;
+            return node;
+        }
+    }
+    return nullptr;
+}
+
+template<typename Key, typename Value, typename Hasher>
+bool XHashT<Key, Value, Hasher>::delete_lru_node()
+{
+    Node* node = lru_tail;
+
+    if ( !node )
+        return false;
+
+    lru_remove(node);
+    unlink_node(node);
+    free_user_data(node);
+    mem_allocator.free(node);
+    --num_nodes;
+    return true;
+}
+
+template<typename Key, typename Value, typename Hasher>
+bool XHashT<Key, Value, Hasher>::delete_a_node()
+{
+    if ( Node* node = get_free_node() )
+    {
+        mem_allocator.free(node);
+        return true;
+    }
+    return delete_lru_node();
+}
+
+template<typename Key, typename Value, typename Hasher>
+void XHashT<Key, Value, Hasher>::clear_hash()
+{
+    for ( unsigned i = 0; i < nrows; i++ )
+    {
+        for ( Node* node = table[i]; node; )
+        {
+            Node* xnode = node;
+            node = node->next;
+            release_node(xnode);
+        }
+    }
+    max_nodes = 0;
+    num_nodes = 0;
+    crow = 0;
+    cursor = nullptr;
+}
+
+template<typename Key, typename Value, typename Hasher>
+int XHashT<Key, Value, Hasher>::tune_memory_resources(unsigned work_limit, unsigned& num_freed)
+{
+    while ( work_limit-- and mem_allocator.is_over_capacity() )
+    {
+        if ( !delete_a_node() )
+            break;
+
+        ++stats.memcap_deletes;
+        ++num_freed;
+    }
+    return mem_allocator.is_over_capacity() ? HASH_PENDING : HASH_OK;
+}
+} // namespace snort
+
+#endif
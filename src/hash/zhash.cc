@@ -41,9 +41,10 @@ using namespace snort;
 //-------------------------------------------------------------------------
 
 
-ZHash::ZHash(int rows, int key_len)
+ZHash::ZHash(int rows, int key_len, memory::TableUser user)
     : XHash(rows, key_len)
 {
+    table_user = user;
     initialize(new FlowHashKeyOps(nrows));
     anr_enabled = false;
 }
@@ -0,0 +1,132 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2020-2020 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// spsc_ring.h
+
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+// Lock free ring for exactly one producer thread and one consumer thread.
+// The size is rounded up to a power of 2.  Each side keeps a cached copy
+// of the other side's index so the shared cache lines are only touched
+// when the ring looks full or empty.
+
+#include <atomic>
+#include <cstddef>
+
+template <typename T>
+class SpscRing
+{
+public:
+    SpscRing<T>(size_t size);
+    ~SpscRing<T>();
+
+    SpscRing<T>(const SpscRing<T>&) = delete;
+    SpscRing<T>& operator=(const SpscRing<T>&) = delete;
+
+    // producer only; false if full
+    bool put(const T&);
+
+    // consumer only; false if empty
+    bool get(T&);
+
+    // approximate unless called from the producer or consumer
+    size_t count() const;
+    bool empty() const
+    { return count() == 0; }
+
+    size_t capacity() const
+    { return mask + 1; }
+
+private:
+    static constexpr size_t line_size = 64;
+
+    T* store;
+    size_t mask;
+    char pad0[line_size];
+
+    // producer side
+    std::atomic<size_t> tail;
+    size_t head_cache = 0;
+    char pad1[line_size];
+
+    // consumer side
+    std::atomic<size_t> head;
+    size_t tail_cache = 0;
+    char pad2[line_size];
+};
+
+template <typename T>
+SpscRing<T>::SpscRing(size_t size) : tail(0), head(0)
+{
+    size_t cap = 1;
+
+    while ( cap < size )
+        cap <<= 1;
+
+    store = new T[cap];
+    mask = cap - 1;
+}
+
+template <typename T>
+SpscRing<T>::~SpscRing()
+{
+    delete[] store;
+}
+
+template <typename T>
+bool SpscRing<T>::put(const T& v)
+{
+    const size_t t = tail.load(std::memory_order_relaxed);
+
+    if ( t - head_cache > mask )
+    {
+        head_cache = head.load(std::memory_order_acquire);
+
+        if ( t - head_cache > mask )
+            return false;
+    }
+    store[t & mask] = v;
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename T>
+bool SpscRing<T>::get(T& v)
+{
+    const size_t h = head.load(std::memory_order_relaxed);
+
+    if ( h == tail_cache )
+    {
+        tail_cache = tail.load(std::memory_order_acquire);
+
+        if ( h == tail_cache )
+            return false;
+    }
+    v = store[h & mask];
+    head.store(h + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename T>
+size_t SpscRing<T>::count() const
+{
+    return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+}
+
+#endif
+
@@ -0,0 +1,108 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2020-2020 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// spsc_ring_test.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <thread>
+
+#include "catch/catch.hpp"
+
+#include "../spsc_ring.h"
+
+TEST_CASE( "spsc_ring", "[spsc_ring]" )
+{
+    SpscRing<unsigned> ring(5);
+    unsigned v = 0;
+
+    SECTION( "rounded size" )
+    {
+        CHECK( ring.capacity() == 8 );
+        CHECK( ring.empty() );
+        CHECK( !ring.get(v) );
+    }
+    SECTION( "fifo" )
+    {
+        for ( unsigned i = 0; i < 8; ++i )
+            CHECK( ring.put(i) );
+
+        CHECK( !ring.put(8) );
+        CHECK( ring.count() == 8 );
+
+        for ( unsigned i = 0; i < 8; ++i )
+        {
+            CHECK( ring.get(v) );
+            CHECK( v == i );
+        }
+        CHECK( !ring.get(v) );
+    }
+    SECTION( "wrap" )
+    {
+        for ( unsigned i = 0; i < 100; ++i )
+        {
+            CHECK( ring.put(i) );
+            CHECK( ring.put(i + 1000) );
+            CHECK( ring.get(v) );
+            CHECK( v == i );
+            CHECK( ring.get(v) );
+            CHECK( v == i + 1000 );
+        }
+        CHECK( ring.empty() );
+    }
+}
+
+TEST_CASE( "spsc_ring threads", "[spsc_ring]" )
+{
+    const unsigned max = 1000000;
+    SpscRing<unsigned> ring(64);
+
+    std::thread producer([&ring]()
+    {
+        for ( unsigned i = 0; i < max; )
+        {
+            if ( ring.put(i) )
+                ++i;
+            else
+                std::this_thread::yield();
+        }
+    });
+
+    unsigned expected = 0;
+    bool ordered = true;
+
+    while ( expected < max )
+    {
+        unsigned v;
+
+        if ( !ring.get(v) )
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        if ( v != expected )
+            ordered = false;
+        ++expected;
+    }
+    producer.join();
+
+    CHECK( ordered );
+    CHECK( ring.empty() );
+}
+
@@ -35,6 +35,7 @@ struct LatencyConfig
 {
     PacketLatencyConfig packet_latency;
     RuleLatencyConfig rule_latency;
+    bool histograms = false;
 };
 
 #endif
@@ -0,0 +1,383 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2020-2020 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// latency_histogram.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "latency_histogram.h"
+
+#include <cinttypes>
+#include <cmath>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+
+#include "log/messages.h"
+#include "main/snort_config.h"
+#include "main/thread.h"
+#include "utils/stats.h"
+
+#include "latency_config.h"
+
+#ifdef UNIT_TEST
+#include "catch/snort_catch.h"
+#endif
+
+using namespace snort;
+
+// -----------------------------------------------------------------------------
+// histogram
+// -----------------------------------------------------------------------------
+
+uint64_t LatencyHistogram::get_upper(unsigned index)
+{
+    if ( index < (1u << sub_bits) )
+        return index;
+
+    unsigned shift = (index >> (sub_bits - 1)) - 1;
+    uint64_t base = index - (shift << (sub_bits - 1));
+
+    return ((base + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record_time(hr_duration d)
+{
+#ifdef USE_TSC_CLOCK
+    record(TO_TICKS(d) * 1000 / clock_scale());
+#else
+    record(std::chrono::duration_cast<std::chrono::nanoseconds>(d).count());
+#endif
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& that)
+{
+    for ( unsigned i = 0; i < num_buckets; ++i )
+        buckets[i] += that.buckets[i];
+
+    count += that.count;
+
+    if ( that.max > max )
+        max = that.max;
+}
+
+// leaves the values recorded since that was copied from this; the max is
+// then only known to within the top bucket
+void LatencyHistogram::subtract(const LatencyHistogram& that)
+{
+    uint64_t top = 0;
+
+    for ( unsigned i = 0; i < num_buckets; ++i )
+    {
+        buckets[i] -= that.buckets[i];
+
+        if ( buckets[i] )
+            top = get_upper(i);
+    }
+
+    count -= that.count;
+
+    if ( top < max )
+        max = top;
+}
+
+void LatencyHistogram::reset()
+{ *this = LatencyHistogram(); }
+
+uint64_t LatencyHistogram::get_percentile(double pct) const
+{
+    if ( !count )
+        return 0;
+
+    uint64_t rank = (uint64_t)std::ceil(count * pct / 100.0);
+
+    if ( rank < 1 )
+        rank = 1;
+
+    else if ( rank > count )
+        rank = count;
+
+    uint64_t sum = 0;
+
+    for ( unsigned i = 0; i < num_buckets; ++i )
+    {
+        sum += buckets[i];
+
+        if ( sum >= rank )
+        {
+            uint64_t upper = get_upper(i);
+            return upper < max ? upper : max;
+        }
+    }
+    return max;
+}
+
+// -----------------------------------------------------------------------------
+// thread histograms
+// -----------------------------------------------------------------------------
+
+namespace
+{
+struct ThreadHistograms
+{
+    LatencyHistogram packet;
+    LatencyHistogram rule;
+    std::vector<LatencyHistogram*> inspectors;
+
+    ~ThreadHistograms()
+    {
+        for ( auto* h : inspectors )
+            delete h;
+    }
+};
+}
+
+static THREAD_LOCAL ThreadHistograms* hists = nullptr;
+
+static std::mutex names_mutex;
+static std::vector<std::string> names;
+static std::unordered_map<std::string, unsigned> name_ids;
+
+static std::mutex totals_mutex;
+static LatencyHistogram packet_total;
+static LatencyHistogram rule_total;
+static std::vector<LatencyHistogram> inspector_totals;
+
+unsigned LatencyHistograms::get_inspector_id(const char* name)
+{
+    std::lock_guard<std::mutex> lock(names_mutex);
+    auto it = name_ids.find(name);
+
+    if ( it != name_ids.end() )
+        return it->second;
+
+    unsigned id = names.size();
+    names.emplace_back(name);
+    name_ids[name] = id;
+    return id;
+}
+
+std::vector<std::string> LatencyHistograms::get_inspector_names()
+{
+    std::lock_guard<std::mutex> lock(names_mutex);
+    return names;
+}
+
+void LatencyHistograms::tinit(const SnortConfig* sc)
+{
+    if ( sc->latency->histograms )
+        hists = new ThreadHistograms;
+}
+
+void LatencyHistograms::tterm()
+{
+    if ( !hists )
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(totals_mutex);
+
+        packet_total.merge(hists->packet);
+        rule_total.merge(hists->rule);
+
+        if ( inspector_totals.size() < hists->inspectors.size() )
+            inspector_totals.resize(hists->inspectors.size());
+
+        for ( unsigned i = 0; i < hists->inspectors.size(); ++i )
+        {
+            if ( hists->inspectors[i] )
+                inspector_totals[i].merge(*hists->inspectors[i]);
+        }
+    }
+    delete hists;
+    hists = nullptr;
+}
+
+LatencyHistogram* LatencyHistograms::get_packet()
+{ return hists ? &hists->packet : nullptr; }
+
+LatencyHistogram* LatencyHistograms::get_rule()
+{ return hists ? &hists->rule : nullptr; }
+
+LatencyHistogram* LatencyHistograms::get_inspector(unsigned id)
+{
+    if ( !hists )
+        return nullptr;
+
+    if ( id >= hists->inspectors.size() )
+        hists->inspectors.resize(id + 1, nullptr);
+
+    if ( !hists->inspectors[id] )
+        hists->inspectors[id] = new LatencyHistogram;
+
+    return hists->inspectors[id];
+}
+
+static void show_histogram(const char* name, const LatencyHistogram& h)
+{
+    if ( !h.get_count() )
+        return;
+
+    LogMessage("%25.25s: %12" PRIu64 " %10" PRIu64 " %10" PRIu64 " %10" PRIu64
+        " %10" PRIu64 " %10" PRIu64 "\n", name, h.get_count(),
+        h.get_percentile(50.0), h.get_percentile(90.0), h.get_percentile(99.0),
+        h.get_percentile(99.9), h.get_max());
+}
+
+void LatencyHistograms::show()
+{
+    std::lock_guard<std::mutex> lock(totals_mutex);
+
+    if ( !packet_total.get_count() and !rule_total.get_count() and inspector_totals.empty() )
+        return;
+
+    LogLabel("latency histograms (nsec)");
+    LogMessage("%25.25s  %12s %10s %10s %10s %10s %10s\n", "",
+        "count", "p50", "p90", "p99", "p99.9", "max");
+
+    show_histogram("packet", packet_total);
+    show_histogram("rule_tree", rule_total);
+
+    std::vector<std::string> insp_names = get_inspector_names();
+
+    for ( unsigned i = 0; i < inspector_totals.size() and i < insp_names.size(); ++i )
+        show_histogram(insp_names[i].c_str(), inspector_totals[i]);
+}
+
+// -----------------------------------------------------------------------------
+// unit tests
+// -----------------------------------------------------------------------------
+
+#ifdef UNIT_TEST
+
+TEST_CASE ( "latency histogram buckets", "[latency]" )
+{
+    SECTION( "exact below sub range" )
+    {
+        for ( uint64_t v = 0; v < 64; ++v )
+        {
+            CHECK( LatencyHistogram::get_index(v) == v );
+            CHECK( LatencyHistogram::get_upper(v) == v );
+        }
+    }
+
+    SECTION( "contiguous and bounded" )
+    {
+        unsigned last = LatencyHistogram::get_index(63);
+
+        for ( uint64_t v = 64; v < 100000; ++v )
+        {
+            unsigned i = LatencyHistogram::get_index(v);
+            CHECK( (i == last or i == last + 1) );
+            CHECK( v <= LatencyHistogram::get_upper(i) );
+            CHECK( LatencyHistogram::get_upper(i) - v <= v / 32 );
+            last = i;
+        }
+    }
+
+    SECTION( "clamped at top" )
+    {
+        CHECK( LatencyHistogram::get_index(UINT64_MAX) == LatencyHistogram::num_buckets - 1 );
+        CHECK( LatencyHistogram::get_upper(LatencyHistogram::num_buckets - 1) ==
+            (uint64_t(1) << LatencyHistogram::max_bits) - 1 );
+    }
+}
+
+TEST_CASE ( "latency histogram percentiles", "[latency]" )
+{
+    LatencyHistogram h;
+
+    CHECK( h.get_percentile(99.0) == 0 );
+
+    for ( uint64_t v = 1; v <= 1000; ++v )
+        h.record(v * 1000);
+
+    CHECK( h.get_count() == 1000 );
+    CHECK( h.get_max() == 1000000 );
+
+    uint64_t p50 = h.get_percentile(50.0);
+    CHECK( p50 >= 500000 );
+    CHECK( p50 <= 500000 + 500000 / 32 );
+
+    uint64_t p99 = h.get_percentile(99.0);
+    CHECK( p99 >= 990000 );
+    CHECK( p99 <= 1000000 );
+
+    CHECK( h.get_percentile(100.0) == 1000000 );
+}
+
+TEST_CASE ( "latency histogram merge and subtract", "[latency]" )
+{
+    LatencyHistogram a, b;
+
+    for ( uint64_t v = 0; v < 100; ++v )
+    {
+        a.record(v);
+        b.record(v + 1000);
+    }
+
+    LatencyHistogram sum = a;
+    sum.merge(b);
+
+    CHECK( sum.get_count() == 200 );
+    CHECK( sum.get_max() == 1099 );
+    CHECK( sum.get_percentile(50.0) == 99 );
+
+    sum.subtract(a);
+    CHECK( sum.get_count() == 100 );
+    CHECK( sum.get_percentile(1.0) >= 1000 );
+    CHECK( sum.get_max() >= 1099 );
+
+    sum.subtract(b);
+    CHECK( sum.get_count() == 0 );
+    CHECK( sum.get_max() == 0 );
+
+    a.reset();
+    CHECK( a.get_count() == 0 );
+    CHECK( a.get_percentile(50.0) == 0 );
+}
+
+TEST_CASE ( "latency histogram inspector ids", "[latency]" )
+{
+    SnortConfig sc;
+    sc.latency->histograms = true;
+    LatencyHistograms::tinit(&sc);
+
+    // same storage, different inspector after a reload
+    char name[32] = "insp_a";
+    unsigned a_id = LatencyHistograms::get_inspector_id(name);
+    strcpy(name, "insp_b");
+    unsigned b_id = LatencyHistograms::get_inspector_id(name);
+
+    CHECK( a_id != b_id );
+    CHECK( LatencyHistograms::get_inspector_id("insp_a") == a_id );
+
+    LatencyHistogram* a = LatencyHistograms::get_inspector(a_id);
+    LatencyHistogram* b = LatencyHistograms::get_inspector(b_id);
+    CHECK( a );
+    CHECK( b );
+    CHECK( b != a );
+    CHECK( LatencyHistograms::get_inspector(a_id) == a );
+
+    LatencyHistograms::tterm();
+}
+
+#endif
+
@@ -0,0 +1,142 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2020-2020 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// latency_histogram.h
+
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+// LatencyHistogram is a log-linear (HDR style) histogram of nanosecond
+// latencies. Values below 2^sub_bits are counted exactly; above that each
+// power of 2 is split into 2^(sub_bits - 1) linear buckets so percentiles
+// are within ~3% over the whole range. Histograms are merged by adding
+// buckets so per-thread instances can be combined at any time.
+//
+// LatencyHistograms holds the packet thread's packet, rule tree, and
+// per-inspector histograms when latency.histograms is enabled. The accessors
+// return nullptr otherwise so callers can time a scope with Context at the
+// cost of a null check.
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "main/snort_types.h"
+#include "time/clock_defs.h"
+
+namespace snort
+{
+struct SnortConfig;
+}
+
+class SO_PUBLIC LatencyHistogram
+{
+public:
+    static constexpr unsigned sub_bits = 6;
+    static constexpr unsigned max_bits = 36;  // ~68 seconds
+    static constexpr unsigned num_buckets = (max_bits - sub_bits + 2) << (sub_bits - 1);
+
+    void record(uint64_t nsecs)
+    {
+        ++buckets[get_index(nsecs)];
+        ++count;
+
+        if ( nsecs > max )
+            max = nsecs;
+    }
+
+    void record_time(hr_duration);
+
+    void merge(const LatencyHistogram&);
+    void subtract(const LatencyHistogram&);
+    void reset();
+
+    uint64_t get_count() const
+    { return count; }
+
+    uint64_t get_max() const
+    { return max; }
+
+    // pct is in percent, eg 99.9
+    uint64_t get_percentile(double pct) const;
+
+    static unsigned get_index(uint64_t);
+    static uint64_t get_upper(unsigned index);
+
+    class Context
+    {
+    public:
+        Context(LatencyHistogram* h) : hist(h)
+        {
+            if ( hist )
+                start = SnortClock::now();
+        }
+
+        ~Context()
+        {
+            if ( hist )
+                hist->record_time(SnortClock::now() - start);
+        }
+
+    private:
+        LatencyHistogram* hist;
+        hr_time start;
+    };
+
+private:
+    uint64_t count = 0;
+    uint64_t max = 0;
+    uint64_t buckets[num_buckets] = { };
+};
+
+inline unsigned LatencyHistogram::get_index(uint64_t v)
+{
+    constexpr uint64_t top = (uint64_t(1) << max_bits) - 1;
+
+    if ( v > top )
+        v = top;
+
+    if ( v < (1u << sub_bits) )
+        return (unsigned)v;
+
+    unsigned shift = 63 - __builtin_clzll(v) - (sub_bits - 1);
+    return (shift << (sub_bits - 1)) + (unsigned)(v >> shift);
+}
+
+class SO_PUBLIC LatencyHistograms
+{
+public:
+    // main thread: map an inspector instance name to an id that is stable
+    // across policies and reloads
+    static unsigned get_inspector_id(const char*);
+    static std::vector<std::string> get_inspector_names();
+
+    // packet thread
+    static void tinit(const snort::SnortConfig*);
+    static void tterm();
+
+    static LatencyHistogram* get_packet();
+    static LatencyHistogram* get_rule();
+    static LatencyHistogram* get_inspector(unsigned id);
+
+    // main thread: totals of the terminated packet threads
+    static void show();
+};
+
+#endif
+
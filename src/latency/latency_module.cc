@@ -30,6 +30,7 @@
 #include "trace/trace.h"
 
 #include "latency_config.h"
+#include "latency_histogram.h"
 #include "latency_rules.h"
 #include "latency_stats.h"
 
@@ -93,6 +94,9 @@ static const Parameter s_params[] =
     { "rule", Parameter::PT_TABLE, s_rule_params, nullptr,
       "rule latency" },
 
+    { "histograms", Parameter::PT_BOOL, nullptr, "false",
+      "collect packet, inspector, and rule tree latency histograms per thread" },
+
     { nullptr, Parameter::PT_MAX, nullptr, nullptr, nullptr }
 };
 
@@ -194,6 +198,9 @@ bool LatencyModule::set(const char* fqn, Value& v, SnortConfig* sc)
     else if ( !strncmp(fqn, slr, strlen(slr)) )
         return latency_set(v, sc->latency->rule_latency);
 
+    else if ( v.is("histograms") )
+        sc->latency->histograms = v.get_bool();
+
     return true;
 }
 
@@ -208,3 +215,9 @@ const PegInfo* LatencyModule::get_pegs() const
 
 PegCount* LatencyModule::get_counts() const
 { return reinterpret_cast<PegCount*>(&latency_stats); }
+
+void LatencyModule::show_stats()
+{
+    Module::show_stats();
+    LatencyHistograms::show();
+}
@@ -35,6 +35,7 @@ public:
 
     const PegInfo* get_pegs() const override;
     PegCount* get_counts() const override;
+    void show_stats() override;
 
     Usage get_usage() const override
     { return CONTEXT; }
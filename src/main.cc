@@ -34,6 +34,7 @@
 #include "lua/lua.h"
 #include "main/analyzer.h"
 #include "main/analyzer_command.h"
+#include "main/dispatcher.h"
 #include "main/request.h"
 #include "main/shell.h"
 #include "main/snort.h"
@@ -132,7 +133,7 @@ public:
 
     void set_index(unsigned index) { idx = index; }
 
-    bool prep(const char* source);
+    bool prep(const char* source, Dispatcher* = nullptr);
     void start();
     void stop();
 
@@ -150,15 +151,22 @@ private:
     unsigned idx = (unsigned)-1;
 };
 
-bool Pig::prep(const char* source)
+bool Pig::prep(const char* source, Dispatcher* dispatcher)
 {
     const SnortConfig* sc = SnortConfig::get_conf();
-    SFDAQInstance *instance = new SFDAQInstance(source, idx, sc->daq_config);
+    SFDAQInstance *instance;
 
-    if (!SFDAQ::init_instance(instance, sc->bpf_filter))
+    if (dispatcher)
+        instance = dispatcher->get_lane(idx);
+    else
     {
-        delete instance;
-        return false;
+        instance = new SFDAQInstance(source, idx, sc->daq_config);
+
+        if (!SFDAQ::init_instance(instance, sc->bpf_filter))
+        {
+            delete instance;
+            return false;
+        }
     }
     requires_privileged_start = instance->can_start_unprivileged();
     analyzer = new Analyzer(instance, idx, source, sc->pkt_cnt);
@@ -279,6 +287,25 @@ static Pig* get_lazy_pig(unsigned max)
     return nullptr;
 }
 
+// one dispatcher feeds every pig from a single input
+static unsigned prep_dispatch(const char* source)
+{
+    const SnortConfig* sc = SnortConfig::get_conf();
+    auto dispatcher = Dispatcher::create(source, max_pigs, sc->daq_config, sc->bpf_filter);
+
+    if ( !dispatcher )
+        return 0;
+
+    unsigned swine = 0;
+
+    for ( unsigned i = 0; i < max_pigs; ++i )
+    {
+        if ( pigs[i].prep(source, dispatcher.get()) )
+            ++swine;
+    }
+    return swine;
+}
+
 //-------------------------------------------------------------------------
 // main commands
 //-------------------------------------------------------------------------
@@ -924,13 +951,20 @@ static void main_loop()
     if (SnortConfig::get_conf()->change_privileges())
         pending_privileges = max_pigs;
 
+    const bool dispatch = SnortConfig::get_conf()->daq_config->dispatch;
+
     // Preemptively prep all pigs in live traffic mode
     if (!SnortConfig::get_conf()->read_mode())
     {
-        for (unsigned i = 0; i < max_pigs; i++)
+        if (dispatch)
+            swine = prep_dispatch(SFDAQ::get_input_spec(SnortConfig::get_conf()->daq_config, 0));
+        else
         {
-            if (pigs[i].prep(SFDAQ::get_input_spec(SnortConfig::get_conf()->daq_config, i)))
-                swine++;
+            for (unsigned i = 0; i < max_pigs; i++)
+            {
+                if (pigs[i].prep(SFDAQ::get_input_spec(SnortConfig::get_conf()->daq_config, i)))
+                    swine++;
+            }
         }
     }
 
@@ -974,8 +1008,16 @@ static void main_loop()
 #endif
         }
 
-        if ( !exit_requested and (swine < max_pigs) and (src = Trough::get_next()) )
+        // dispatched inputs are read one at a time by all pigs
+        const bool can_prep = dispatch ? !swine : (swine < max_pigs);
+
+        if ( !exit_requested and can_prep and (src = Trough::get_next()) )
         {
+            if ( dispatch )
+            {
+                swine = prep_dispatch(src);
+                continue;
+            }
             Pig* pig = get_lazy_pig(max_pigs);
             if (pig->prep(src))
                 ++swine;
@@ -28,6 +28,7 @@
 
 #include <thread>
 
+#include "decompress/inflate_pool.h"
 #include "detection/context_switcher.h"
 #include "detection/detect.h"
 #include "detection/detection_engine.h"
@@ -41,6 +42,7 @@
 #include "flow/flow.h"
 #include "flow/ha.h"
 #include "framework/data_bus.h"
+#include "latency/latency_histogram.h"
 #include "latency/packet_latency.h"
 #include "latency/rule_latency.h"
 #include "log/messages.h"
@@ -51,6 +53,7 @@
 #include "managers/ips_manager.h"
 #include "managers/event_manager.h"
 #include "managers/module_manager.h"
+#include "memory/memory_cap.h"
 #include "packet_io/active.h"
 #include "packet_io/sfdaq.h"
 #include "packet_io/sfdaq_config.h"
@@ -410,6 +413,7 @@ void Analyzer::process_daq_pkt_msg(DAQ_Msg_h msg, bool retry)
     const DAQ_PktHdr_t* pkthdr = daq_msg_get_pkthdr(msg);
 
     pc.analyzed_pkts++;
+    Profiler::sample();
 
     if (!retry)
         packet_time_update(&pkthdr->ts);
@@ -453,10 +457,12 @@ void Analyzer::process_daq_msg(DAQ_Msg_h msg, bool retry)
             return;
         case DAQ_MSG_TYPE_SOF:
         case DAQ_MSG_TYPE_EOF:
+            Profiler::sample_other();
             process_daq_sof_eof_msg(msg, verdict);
             break;
         default:
             {
+                Profiler::sample_other();
                 daq_stats.other_messages++;
                 DaqMessageEvent event(msg, verdict);
                 DataBus::publish(DAQ_OTHER_MSG_EVENT, event);
@@ -482,6 +488,7 @@ void Analyzer::process_retry_queue()
             process_daq_msg(msg, true);
             daq_stats.retries_processed++;
         }
+        Profiler::sample_other();
     }
 }
 
@@ -566,6 +573,7 @@ const char* Analyzer::get_state_string()
 void Analyzer::idle()
 {
     idling = true;
+    Profiler::sample_other();
 
     // FIXIT-L this whole thing could be pub-sub
     daq_stats.idle++;
@@ -633,8 +641,10 @@ void Analyzer::init_unprivileged()
     IpsManager::setup_options(sc);
     ActionManager::thread_init(sc);
     FileService::thread_init();
+    InflatePool::tinit();
     SideChannelManager::thread_init();
     HighAvailabilityManager::thread_init(); // must be before InspectorManager::thread_init();
+    LatencyHistograms::tinit(sc);  // must be before InspectorManager::thread_init();
     InspectorManager::thread_init(sc);
     PacketTracer::thread_init();
 
@@ -659,6 +669,7 @@ void Analyzer::term()
     const SnortConfig* sc = SnortConfig::get_conf();
 
     HighAvailabilityManager::thread_term_beginning();
+    Profiler::sample_other();
 
     if ( !sc->dirty_pig )
         Stream::purge_flows();
@@ -682,6 +693,7 @@ void Analyzer::term()
     CodecManager::thread_term();
     HighAvailabilityManager::thread_term();
     SideChannelManager::thread_term();
+    memory::MemoryCap::thread_term();
 
     oops_handler->set_current_message(nullptr);
 
@@ -690,6 +702,7 @@ void Analyzer::term()
 
     PacketLatency::tterm();
     RuleLatency::tterm();
+    LatencyHistograms::tterm();
 
     Profiler::consolidate_stats();
 
@@ -698,6 +711,7 @@ void Analyzer::term()
     EventTrace_Term();
     CleanupTag();
     FileService::thread_term();
+    InflatePool::tterm();
     PacketTracer::thread_term();
     PacketManager::thread_term();
 
@@ -854,6 +868,7 @@ DAQ_RecvStatus Analyzer::process_messages()
         max_recv = pause_after_cnt;
 
     DAQ_RecvStatus rstat;
+    Profiler::sample_other();
     {
         Profile profile(daqPerfStats);
         rstat = daq_instance->receive_messages(max_recv);
@@ -880,6 +895,7 @@ DAQ_RecvStatus Analyzer::process_messages()
         num_recv++;
         // IMPORTANT: process_daq_msg() is responsible for finalizing the messages.
         process_daq_msg(msg, false);
+        Profiler::sample_other();
         DetectionEngine::onload();
         process_retry_queue();
         handle_uncompleted_commands();
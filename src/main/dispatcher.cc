@@ -0,0 +1,712 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2020-2020 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// dispatcher.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "dispatcher.h"
+
+#include <daq.h>
+#include <daq_dlt.h>
+
+#include <cassert>
+#include <chrono>
+#include <cinttypes>
+#include <cstring>
+
+#include "log/messages.h"
+#include "main/snort_config.h"
+#include "packet_io/sfdaq.h"
+#include "packet_io/sfdaq_config.h"
+
+#include "thread.h"
+
+#ifdef UNIT_TEST
+#include <utility>
+
+#include "catch/snort_catch.h"
+#endif
+
+using namespace snort;
+
+//-------------------------------------------------------------------------
+// flow hash
+//-------------------------------------------------------------------------
+
+static inline uint32_t mix(uint32_t h)
+{
+    h ^= h >> 16;
+    h *= 0x85ebca6b;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35;
+    h ^= h >> 16;
+    return h;
+}
+
+// addresses are 16 bytes with ip4 in mapped form so that packets and flow
+// stats hash alike
+static uint32_t hash_endpoint(const uint8_t* ip, uint16_t port)
+{
+    uint32_t h = port;
+
+    for ( unsigned i = 0; i < 16; i += 4 )
+    {
+        uint32_t w;
+        memcpy(&w, ip + i, sizeof(w));
+        h = mix(h ^ w) + i;
+    }
+    return h;
+}
+
+static inline void map_ip4(const uint8_t* ip4, uint8_t* ip6)
+{
+    memset(ip6, 0, 10);
+    ip6[10] = ip6[11] = 0xff;
+    memcpy(ip6 + 12, ip4, 4);
+}
+
+static inline uint16_t get_u16(const uint8_t* p)
+{ return (p[0] << 8) | p[1]; }
+
+static inline bool has_ports(uint8_t proto)
+{ return proto == 6 or proto == 17 or proto == 132; }  // tcp, udp, sctp
+
+uint32_t Dispatcher::hash_flow(const uint8_t* cip, uint16_t cport,
+    const uint8_t* sip, uint16_t sport, uint8_t proto, bool ports)
+{
+    if ( !ports or !has_ports(proto) )
+        cport = sport = 0;
+
+    // the sum is symmetric so both directions land on the same lane
+    return mix(hash_endpoint(cip, cport) + hash_endpoint(sip, sport) + proto);
+}
+
+// returns 0 for anything that isn't ip
+uint32_t Dispatcher::hash_packet(const uint8_t* data, uint32_t len, int dlt, bool ports)
+{
+    uint32_t off = 0;
+
+    if ( dlt == DLT_EN10MB )
+    {
+        if ( len < 14 )
+            return 0;
+
+        uint16_t type = get_u16(data + 12);
+        off = 14;
+
+        // 802.1q, 802.1ad, and the older qinq ethertypes
+        while ( (type == 0x8100 or type == 0x88a8 or type == 0x9100 or type == 0x9200)
+            and off + 4 <= len )
+        {
+            type = get_u16(data + off + 2);
+            off += 4;
+        }
+        if ( type != 0x0800 and type != 0x86dd )
+            return 0;
+    }
+    else if ( dlt != DLT_RAW and dlt != DLT_IPV4 and dlt != DLT_IPV6 )
+        return 0;
+
+    if ( off >= len )
+        return 0;
+
+    const uint8_t* ip = data + off;
+    len -= off;
+
+    uint8_t cip[16], sip[16];
+    const uint8_t* pc;
+    const uint8_t* ps;
+    uint8_t proto;
+    uint32_t l4;
+    bool frag;
+
+    switch ( ip[0] >> 4 )
+    {
+    case 4:
+        if ( len < 20 )
+            return 0;
+
+        map_ip4(ip + 12, cip);
+        map_ip4(ip + 16, sip);
+        pc = cip;
+        ps = sip;
+        proto = ip[9];
+        l4 = (ip[0] & 0x0f) * 4;
+        frag = (get_u16(ip + 6) & 0x3fff) != 0;
+        break;
+
+    case 6:
+        if ( len < 40 )
+            return 0;
+
+        pc = ip + 8;
+        ps = ip + 24;
+        proto = ip[6];
+        l4 = 40;
+        frag = false;
+
+        // hash on the transport protocol, not the first extension header
+        for ( unsigned n = 0; n < 8 and l4 + 8 <= len; ++n )
+        {
+            const uint8_t* ext = ip + l4;
+
+            if ( proto == 0 or proto == 43 or proto == 60 )  // hop, routing, dst opts
+                l4 += (ext[1] + 1) * 8;
+
+            else if ( proto == 44 )  // fragment
+            {
+                frag = (get_u16(ext + 2) & 0xfff9) != 0;
+                l4 += 8;
+            }
+            else if ( proto == 51 )  // ah
+                l4 += (ext[1] + 2) * 4;
+
+            else
+                break;
+
+            proto = ext[0];
+        }
+        break;
+
+    default:
+        return 0;
+    }
+
+    uint16_t cport = 0, sport = 0;
+
+    if ( ports and !frag and has_ports(proto) and l4 + 4 <= len )
+    {
+        memcpy(&cport, ip + l4, 2);
+        memcpy(&sport, ip + l4 + 2, 2);
+    }
+    return hash_flow(pc, cport, ps, sport, proto, ports);
+}
+
+//-------------------------------------------------------------------------
+// lane - the daq instance seen by a packet thread
+//-------------------------------------------------------------------------
+
+class DispatchLane : public SFDAQInstance
+{
+public:
+    DispatchLane(std::shared_ptr<Dispatcher>, unsigned idx, const char* input,
+        const SFDAQConfig*);
+    ~DispatchLane() override;
+
+    bool start() override;
+    bool was_started() const override
+    { return started; }
+    bool stop() override;
+    void reload() override;
+
+    DAQ_RecvStatus receive_messages(unsigned max_recv) override;
+    int finalize_message(DAQ_Msg_h, DAQ_Verdict) override;
+    const DAQ_Stats_t* get_stats() override;
+
+    int inject(DAQ_Msg_h, int rev, const uint8_t* buf, uint32_t len) override;
+    bool interrupt() override;
+    int ioctl(DAQ_IoctlCmd, void* arg, size_t arglen) override;
+
+private:
+    std::shared_ptr<Dispatcher> dispatcher;
+    Dispatcher::Lane& lane;
+    unsigned idx;
+    bool started = false;
+    bool stopped = false;
+};
+
+DispatchLane::DispatchLane(
+    std::shared_ptr<Dispatcher> d, unsigned i, const char* input, const SFDAQConfig* cfg) :
+    SFDAQInstance(input, i, cfg), dispatcher(d), lane(*d->lanes[i]), idx(i)
+{
+    // capabilities and errors are read from the shared instance
+    share_instance(*dispatcher->source);
+}
+
+DispatchLane::~DispatchLane()
+{
+    if ( !stopped )
+        dispatcher->lane_stopped();
+
+    // the instance belongs to the dispatcher
+    instance = nullptr;
+}
+
+bool DispatchLane::start()
+{
+    if ( !dispatcher->start() )
+        return false;
+
+    share_instance(*dispatcher->source);
+
+    pool_size = dispatcher->source->get_pool_size() / dispatcher->lanes.size();
+
+    if ( pool_size < batch_size )
+        pool_size = batch_size;
+
+    pool_available = pool_size;
+    started = true;
+    return true;
+}
+
+bool DispatchLane::stop()
+{
+    assert(pool_size == pool_available);
+
+    if ( !stopped )
+    {
+        stopped = true;
+        started = false;
+        dispatcher->lane_stopped();
+    }
+    return true;
+}
+
+void DispatchLane::reload()
+{
+    if ( idx )
+        return;
+
+    std::lock_guard<std::mutex> lock(dispatcher->api_mutex);
+    dispatcher->source->reload();
+}
+
+DAQ_RecvStatus DispatchLane::receive_messages(unsigned max_recv)
+{
+    assert(max_recv <= batch_size);
+
+    if ( max_recv > pool_available )
+        max_recv = pool_available;
+
+    curr_batch_size = 0;
+    curr_batch_idx = 0;
+
+    if ( !max_recv )
+        return DAQ_RSTAT_WOULD_BLOCK;
+
+    auto deadline = std::chrono::steady_clock::now() +
+        std::chrono::milliseconds(dispatcher->timeout_ms);
+
+    for ( unsigned spins = 0; ; ++spins )
+    {
+        if ( lane.interrupted.exchange(false) )
+            return DAQ_RSTAT_INTERRUPTED;
+
+        // check before draining so nothing queued ahead of eof is missed
+        bool eof = dispatcher->eof.load(std::memory_order_acquire);
+
+        while ( curr_batch_size < max_recv and lane.msgs.get(daq_msgs[curr_batch_size]) )
+            ++curr_batch_size;
+
+        if ( curr_batch_size )
+        {
+            pool_available -= curr_batch_size;
+            return DAQ_RSTAT_OK;
+        }
+
+        if ( eof )
+            return dispatcher->final_status;
+
+        if ( spins < 64 )
+            std::this_thread::yield();
+
+        else if ( std::chrono::steady_clock::now() >= deadline )
+            return DAQ_RSTAT_TIMEOUT;
+
+        else
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+}
+
+int DispatchLane::finalize_message(DAQ_Msg_h msg, DAQ_Verdict verdict)
+{
+    while ( !lane.verdicts.put({ msg, verdict }) )
+        std::this_thread::yield();
+
+    pool_available++;
+    return DAQ_SUCCESS;
+}
+
+const DAQ_Stats_t* DispatchLane::get_stats()
+{
+    // the shared instance counts for all lanes so report it once
+    if ( !idx )
+    {
+        std::lock_guard<std::mutex> lock(dispatcher->api_mutex);
+        daq_instance_stats = *dispatcher->source->get_stats();
+    }
+    return &daq_instance_stats;
+}
+
+int DispatchLane::inject(DAQ_Msg_h msg, int rev, const uint8_t* buf, uint32_t len)
+{
+    std::lock_guard<std::mutex> lock(dispatcher->api_mutex);
+    return dispatcher->source->inject(msg, rev, buf, len);
+}
+
+bool DispatchLane::interrupt()
+{
+    lane.interrupted = true;
+    return true;
+}
+
+int DispatchLane::ioctl(DAQ_IoctlCmd cmd, void* arg, size_t arglen)
+{
+    std::lock_guard<std::mutex> lock(dispatcher->api_mutex);
+    return dispatcher->source->ioctl(cmd, arg, arglen);
+}
+
+//-------------------------------------------------------------------------
+// dispatcher
+//-------------------------------------------------------------------------
+
+std::shared_ptr<Dispatcher> Dispatcher::create(
+    const char* source, unsigned num_lanes, const SFDAQConfig* cfg, const std::string& bpf)
+{
+    std::shared_ptr<Dispatcher> d(new Dispatcher(num_lanes, cfg));
+    d->source = new SFDAQInstance(source, 0, cfg);
+
+    if ( !SFDAQ::init_instance(d->source, bpf) )
+        return nullptr;
+
+    return d;
+}
+
+Dispatcher::Dispatcher(unsigned num_lanes, const SFDAQConfig* cfg)
+{
+    const size_t ring_size = cfg->get_batch_size() * 4;
+
+    for ( unsigned i = 0; i < num_lanes; ++i )
+        lanes.emplace_back(new Lane(ring_size));
+
+    timeout_ms = cfg->timeout;
+    hash_ports = cfg->dispatch_ports;
+}
+
+Dispatcher::~Dispatcher()
+{
+    if ( thread )
+    {
+        thread->join();
+        delete thread;
+    }
+    if ( started and SnortConfig::get_conf()->log_verbose() )
+    {
+        for ( unsigned i = 0; i < lanes.size(); ++i )
+            LogMessage("dispatch lane %u: %" PRIu64 " messages\n", i, lanes[i]->dispatched);
+
+        LogMessage("dispatch stalls: %" PRIu64 "\n", stalls);
+    }
+    for ( auto* l : lanes )
+        delete l;
+
+    delete source;
+}
+
+SFDAQInstance* Dispatcher::get_lane(unsigned idx)
+{
+    assert(idx < lanes.size());
+    running++;
+    return new DispatchLane(shared_from_this(), idx, source->get_input_spec(),
+        SnortConfig::get_conf()->daq_config);
+}
+
+// the first lane to start starts the shared instance and the thread
+bool Dispatcher::start()
+{
+    std::lock_guard<std::mutex> lock(start_mutex);
+
+    if ( !started and !failed )
+    {
+        if ( source->start() )
+        {
+            started = true;
+            thread = new std::thread(&Dispatcher::run, this);
+        }
+        else
+            failed = true;
+    }
+    return started;
+}
+
+void Dispatcher::lane_stopped()
+{
+    std::lock_guard<std::mutex> lock(start_mutex);
+
+    // break out of a blocking receive so the thread can finish
+    if ( --running == 0 and started )
+        source->interrupt();
+}
+
+unsigned Dispatcher::select_lane(DAQ_Msg_h msg)
+{
+    uint32_t h;
+
+    switch ( daq_msg_get_type(msg) )
+    {
+    case DAQ_MSG_TYPE_PACKET:
+        h = hash_packet(daq_msg_get_data(msg), daq_msg_get_data_len(msg),
+            source->get_base_protocol(), hash_ports);
+        break;
+
+    case DAQ_MSG_TYPE_SOF:
+    case DAQ_MSG_TYPE_EOF:
+    {
+        const Flow_Stats_t* fs = (const Flow_Stats_t*)daq_msg_get_hdr(msg);
+        h = hash_flow(fs->initiatorIp, fs->initiatorPort, fs->responderIp, fs->responderPort,
+            fs->protocol, hash_ports);
+        break;
+    }
+    default:
+        h = 0;
+    }
+    return ((uint64_t)h * lanes.size()) >> 32;
+}
+
+void Dispatcher::dispatch(DAQ_Msg_h msg)
+{
+    Lane& l = *lanes[select_lane(msg)];
+
+    while ( !l.stopped.load(std::memory_order_acquire) )
+    {
+        if ( l.msgs.put(msg) )
+        {
+            l.dispatched++;
+            return;
+        }
+        stalls++;
+        drain(false);
+        std::this_thread::yield();
+    }
+    std::lock_guard<std::mutex> lock(api_mutex);
+    source->finalize_message(msg, DAQ_VERDICT_PASS);
+}
+
+// finalize returned verdicts.  once a lane has stopped its message ring has
+// no reader so anything left there is passed.  returns true if any work was
+// done.
+bool Dispatcher::drain(bool all)
+{
+    bool work = false;
+    std::lock_guard<std::mutex> lock(api_mutex);
+
+    for ( auto* l : lanes )
+    {
+        Verdict v;
+
+        while ( l->verdicts.get(v) )
+        {
+            source->finalize_message(v.msg, v.verdict);
+            work = true;
+        }
+        if ( all or l->stopped.load(std::memory_order_acquire) )
+        {
+            DAQ_Msg_h msg;
+
+            while ( l->msgs.get(msg) )
+            {
+                source->finalize_message(msg, DAQ_VERDICT_PASS);
+                work = true;
+            }
+        }
+    }
+    return work;
+}
+
+void Dispatcher::run()
+{
+    set_thread_type(STHREAD_TYPE_OTHER);
+
+    const unsigned batch = source->get_batch_size();
+
+    while ( running )
+    {
+        bool work = drain(false);
+
+        if ( !eof and source->get_pool_available() )
+        {
+            DAQ_RecvStatus rstat;
+            {
+                std::lock_guard<std::mutex> lock(api_mutex);
+                rstat = source->receive_messages(batch);
+            }
+            DAQ_Msg_h msg;
+
+            while ( (msg = source->next_message()) )
+            {
+                dispatch(msg);
+                work = true;
+            }
+
+            if ( rstat == DAQ_RSTAT_ERROR )
+                ErrorMessage("Dispatcher: error receiving from the DAQ instance: %s\n",
+                    source->get_error());
+
+            if ( rstat == DAQ_RSTAT_EOF or rstat == DAQ_RSTAT_ERROR or
+                rstat == DAQ_RSTAT_INVALID )
+            {
+                final_status = rstat;
+                eof.store(true, std::memory_order_release);
+            }
+        }
+
+        if ( !work )
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+
+    for ( auto* l : lanes )
+        l->stopped = true;
+
+    drain(true);
+    source->stop();
+}
+
+//-------------------------------------------------------------------------
+// tests
+//-------------------------------------------------------------------------
+
+#ifdef UNIT_TEST
+static const uint8_t eth_ip4_tcp[] =
+{
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 0x08, 0x00,
+    0x45, 0x00, 0x00, 0x28, 0x00, 0x01, 0x00, 0x00, 0x40, 0x06, 0x00, 0x00,
+    10, 1, 2, 3, 192, 168, 4, 5,
+    0x04, 0xd2, 0x00, 0x50
+};
+
+static void swap_ip4(uint8_t* pkt)
+{
+    for ( unsigned i = 0; i < 4; ++i )
+        std::swap(pkt[26 + i], pkt[30 + i]);
+
+    std::swap(pkt[34], pkt[36]);
+    std::swap(pkt[35], pkt[37]);
+}
+
+TEST_CASE("dispatch hash", "[dispatcher]")
+{
+    uint8_t pkt[sizeof(eth_ip4_tcp)];
+    memcpy(pkt, eth_ip4_tcp, sizeof(pkt));
+
+    const uint32_t fwd = Dispatcher::hash_packet(pkt, sizeof(pkt), DLT_EN10MB, true);
+    CHECK(fwd != 0);
+
+    SECTION("symmetric")
+    {
+        swap_ip4(pkt);
+        CHECK(Dispatcher::hash_packet(pkt, sizeof(pkt), DLT_EN10MB, true) == fwd);
+    }
+    SECTION("ports")
+    {
+        pkt[35] = 0x51;
+        CHECK(Dispatcher::hash_packet(pkt, sizeof(pkt), DLT_EN10MB, true) != fwd);
+        CHECK(Dispatcher::hash_packet(pkt, sizeof(pkt), DLT_EN10MB, false) ==
+            Dispatcher::hash_packet(eth_ip4_tcp, sizeof(pkt), DLT_EN10MB, false));
+    }
+    SECTION("fragment")
+    {
+        pkt[20] = 0x20;  // more fragments
+        CHECK(Dispatcher::hash_packet(pkt, sizeof(pkt), DLT_EN10MB, true) ==
+            Dispatcher::hash_packet(eth_ip4_tcp, sizeof(pkt), DLT_EN10MB, false));
+    }
+    SECTION("raw")
+    {
+        CHECK(Dispatcher::hash_packet(pkt + 14, sizeof(pkt) - 14, DLT_RAW, true) == fwd);
+    }
+    SECTION("flow stats")
+    {
+        uint8_t cip[16], sip[16];
+        uint16_t cport, sport;
+
+        map_ip4(pkt + 26, cip);
+        map_ip4(pkt + 30, sip);
+        memcpy(&cport, pkt + 34, 2);
+        memcpy(&sport, pkt + 36, 2);
+
+        CHECK(Dispatcher::hash_flow(sip, sport, cip, cport, 6, true) == fwd);
+    }
+    SECTION("not ip")
+    {
+        pkt[12] = 0x08;
+        pkt[13] = 0x06;
+        CHECK(Dispatcher::hash_packet(pkt, sizeof(pkt), DLT_EN10MB, true) == 0);
+        CHECK(Dispatcher::hash_packet(pkt, 10, DLT_EN10MB, true) == 0);
+    }
+}
+
+TEST_CASE("dispatch hash ip6", "[dispatcher]")
+{
+    // raw ip6, hop by hop options, fragment header, then tcp ports
+    uint8_t pkt[40 + 8 + 8 + 4] = { };
+
+    pkt[0] = 0x60;
+    pkt[6] = 0;
+    pkt[23] = 1;
+    pkt[39] = 2;
+    pkt[40] = 44;
+    pkt[48] = 6;
+    pkt[56] = 0x04;
+    pkt[57] = 0xd2;
+    pkt[59] = 0x50;
+
+    uint8_t cip[16] = { }, sip[16] = { };
+    cip[15] = 1;
+    sip[15] = 2;
+
+    const uint32_t flow = Dispatcher::hash_flow(cip, 0, sip, 0, 6, false);
+
+    SECTION("extension headers")
+    {
+        CHECK(Dispatcher::hash_packet(pkt, sizeof(pkt), DLT_RAW, false) == flow);
+        uint16_t cport, sport;
+        memcpy(&cport, pkt + 56, 2);
+        memcpy(&sport, pkt + 58, 2);
+
+        CHECK(Dispatcher::hash_packet(pkt, sizeof(pkt), DLT_RAW, true) ==
+            Dispatcher::hash_flow(cip, cport, sip, sport, 6, true));
+    }
+    SECTION("fragment")
+    {
+        pkt[51] = 1;  // more fragments
+        CHECK(Dispatcher::hash_packet(pkt, sizeof(pkt), DLT_RAW, false) == flow);
+        CHECK(Dispatcher::hash_packet(pkt, sizeof(pkt), DLT_RAW, true) == flow);
+    }
+    SECTION("truncated")
+    {
+        CHECK(Dispatcher::hash_packet(pkt, 44, DLT_RAW, false) != 0);
+    }
+}
+
+TEST_CASE("dispatch hash fragments", "[dispatcher]")
+{
+    uint8_t pkt[sizeof(eth_ip4_tcp)];
+    memcpy(pkt, eth_ip4_tcp, sizeof(pkt));
+
+    const uint32_t whole = Dispatcher::hash_packet(pkt, sizeof(pkt), DLT_EN10MB, false);
+
+    pkt[20] = 0x20;  // first fragment
+    CHECK(Dispatcher::hash_packet(pkt, sizeof(pkt), DLT_EN10MB, false) == whole);
+
+    pkt[21] = 0x10;  // later fragment, no ports
+    pkt[34] = pkt[35] = pkt[36] = pkt[37] = 0xee;
+    CHECK(Dispatcher::hash_packet(pkt, sizeof(pkt), DLT_EN10MB, false) == whole);
+}
+#endif
+
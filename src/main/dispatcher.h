@@ -0,0 +1,110 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2020-2020 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// dispatcher.h
+
+#ifndef DISPATCHER_H
+#define DISPATCHER_H
+
+// Dispatcher reads from a single DAQ instance and spreads the messages over
+// all packet threads by a symmetric flow hash.  Each packet thread is given
+// a DispatchLane in place of its own DAQ instance.  Messages reach a lane
+// over one SPSC ring and verdicts return over another; only the dispatcher
+// thread receives from or finalizes on the real instance.  Other calls the
+// lanes make on the instance (inject, ioctl, stats) are serialized.
+
+#include <daq_common.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "helpers/spsc_ring.h"
+#include "packet_io/sfdaq_instance.h"
+
+struct SFDAQConfig;
+
+class Dispatcher : public std::enable_shared_from_this<Dispatcher>
+{
+public:
+    static std::shared_ptr<Dispatcher> create(
+        const char* source, unsigned num_lanes, const SFDAQConfig*, const std::string& bpf);
+
+    ~Dispatcher();
+
+    // the returned instance belongs to the caller
+    snort::SFDAQInstance* get_lane(unsigned idx);
+
+    // exposed for testing
+    static uint32_t hash_packet(const uint8_t* data, uint32_t len, int dlt, bool ports);
+    static uint32_t hash_flow(const uint8_t* cip, uint16_t cport,
+        const uint8_t* sip, uint16_t sport, uint8_t proto, bool ports);
+
+private:
+    friend class DispatchLane;
+
+    struct Verdict
+    {
+        DAQ_Msg_h msg;
+        DAQ_Verdict verdict;
+    };
+
+    struct Lane
+    {
+        Lane(size_t size) : msgs(size), verdicts(size) { }
+
+        SpscRing<DAQ_Msg_h> msgs;
+        SpscRing<Verdict> verdicts;
+        std::atomic<bool> stopped { false };
+        std::atomic<bool> interrupted { false };
+        uint64_t dispatched = 0;
+    };
+
+    Dispatcher(unsigned num_lanes, const SFDAQConfig*);
+
+    bool start();
+    void lane_stopped();
+    void run();
+
+    unsigned select_lane(DAQ_Msg_h);
+    void dispatch(DAQ_Msg_h);
+    bool drain(bool all);
+
+private:
+    snort::SFDAQInstance* source = nullptr;
+    std::vector<Lane*> lanes;
+    std::thread* thread = nullptr;
+    std::mutex api_mutex;
+
+    std::mutex start_mutex;
+    bool started = false;
+    bool failed = false;
+
+    std::atomic<unsigned> running { 0 };
+    std::atomic<bool> eof { false };
+    std::atomic<DAQ_RecvStatus> final_status { DAQ_RSTAT_EOF };
+
+    unsigned timeout_ms;
+    bool hash_ports;
+    uint64_t stalls = 0;
+};
+
+#endif
+
@@ -25,8 +25,10 @@
 #include "modules.h"
 
 #include <sys/resource.h>
+#include <lua.hpp>
 
 #include "codecs/codec_module.h"
+#include "decompress/decompress_module.h"
 #include "detection/detection_module.h"
 #include "detection/fp_config.h"
 #include "detection/rules.h"
@@ -56,13 +58,16 @@
 #include "search_engines/pat_stats.h"
 #include "side_channel/side_channel_module.h"
 #include "sfip/sf_ipvar.h"
+#include "src/main.h"
 #include "stream/stream.h"
 #include "target_based/host_attributes.h"
 #include "target_based/snort_protocols.h"
 #include "trace/trace_module.h"
 
+#include "request.h"
 #include "snort_config.h"
 #include "snort_module.h"
+#include "swapper.h"
 #include "thread_config.h"
 
 using namespace snort;
@@ -189,6 +194,10 @@ static const Parameter search_engine_params[] =
     { "split_any_any", Parameter::PT_BOOL, nullptr, "true",
       "evaluate any-any rules separately to save memory" },
 
+    { "fuse_any_any", Parameter::PT_BOOL, nullptr, "false",
+      "with split_any_any, also build combined port group and any-any matchers "
+      "so buffers are searched once; uses more memory" },
+
     { "queue_limit", Parameter::PT_INT, "0:max32", "128",
       "maximum number of fast pattern matches to queue per packet (0 means no maximum)" },
 
@@ -213,6 +222,9 @@ const PegInfo mpse_pegs[] =
     { CountType::SUM, "non_qualified_events", "total non-qualified events" },
     { CountType::SUM, "qualified_events", "total qualified events" },
     { CountType::SUM, "searched_bytes", "total bytes searched" },
+    { CountType::SUM, "fused_searches", "port group and any-any searches done in one pass" },
+    { CountType::SUM, "fused_bytes", "bytes not searched again due to fused searches" },
+    { CountType::SUM, "fused_bypassed", "fused searches not done because the search engine has its own batch search" },
     { CountType::END, nullptr, nullptr }
 };
 
@@ -302,6 +314,9 @@ bool SearchEngineModule::set(const char*, Value& v, SnortConfig* sc)
     else if ( v.is("split_any_any") )
         fp->set_split_any_any(v.get_bool());
 
+    else if ( v.is("fuse_any_any") )
+        fp->set_fuse_any_any(v.get_bool());
+
     else if ( v.is("queue_limit") )
         fp->set_queue_limit(v.get_uint32());
 
@@ -378,6 +393,12 @@ static const Parameter profiler_params[] =
     { "rules", Parameter::PT_TABLE, profiler_rule_params, nullptr,
       "rule time profiling" },
 
+    { "sample", Parameter::PT_INT, "1:max32", "1",
+      "time modules and rules on 1 of every sample packets and scale the results" },
+
+    { "sample_random", Parameter::PT_BOOL, nullptr, "false",
+      "pick sampled packets at random instead of every sample-th packet" },
+
     { nullptr, Parameter::PT_MAX, nullptr, nullptr, nullptr }
 };
 
@@ -412,6 +433,54 @@ static bool s_profiler_module_set(T& config, Value& v)
     return true;
 }
 
+static int profiler_show(lua_State* L)
+{
+    bool from_shell = ( L != nullptr );
+    bool json = from_shell and lua_gettop(L) and lua_toboolean(L, 1);
+    Request& current_request = get_current_request();
+
+    if ( Swapper::get_reload_in_progress() )
+    {
+        current_request.respond("== reload pending; retry\n", from_shell);
+        return 0;
+    }
+    Profiler::show_snapshot(current_request, from_shell, json);
+    return 0;
+}
+
+static int profiler_reset(lua_State* L)
+{
+    bool from_shell = ( L != nullptr );
+    Request& current_request = get_current_request();
+
+    if ( Swapper::get_reload_in_progress() )
+    {
+        current_request.respond("== reload pending; retry\n", from_shell);
+        return 0;
+    }
+    Profiler::reset_snapshot(current_request, from_shell);
+    return 0;
+}
+
+static const Parameter profiler_show_params[] =
+{
+    { "json", Parameter::PT_BOOL, nullptr, "false",
+      "show stats as json instead of tables" },
+
+    { nullptr, Parameter::PT_MAX, nullptr, nullptr, nullptr }
+};
+
+static const Command profiler_cmds[] =
+{
+    { "show", profiler_show, profiler_show_params,
+      "show module and rule profiles from the running packet threads" },
+
+    { "reset", profiler_reset, nullptr,
+      "clear module time and rule profiles to start a new window" },
+
+    { nullptr, nullptr, nullptr, nullptr }
+};
+
 class ProfilerModule : public Module
 {
 public:
@@ -420,6 +489,9 @@ public:
     bool set(const char*, Value&, SnortConfig*) override;
     bool end(const char*, int, SnortConfig*) override;
 
+    const Command* get_commands() const override
+    { return profiler_cmds; }
+
     ProfileStats* get_profile(unsigned, const char*&, const char*&) const override;
 
     Usage get_usage() const override
@@ -441,7 +513,16 @@ bool ProfilerModule::set(const char* fqn, Value& v, SnortConfig* sc)
     else if ( !strncmp(fqn, spr, strlen(spr)) )
         return s_profiler_module_set(sc->profiler->rule, v);
 
-    return false;
+    else if ( v.is("sample") )
+        sc->profiler->sample = v.get_uint32();
+
+    else if ( v.is("sample_random") )
+        sc->profiler->sample_random = v.get_bool();
+
+    else
+        return false;
+
+    return true;
 }
 
 bool ProfilerModule::end(const char*, int, SnortConfig* sc)
@@ -2015,6 +2096,7 @@ void module_init()
     // these modules are not policy specific
     ModuleManager::add_module(new ClassificationsModule);
     ModuleManager::add_module(new CodecModule);
+    ModuleManager::add_module(new DecompressModule);
     ModuleManager::add_module(new DetectionModule);
     ModuleManager::add_module(new MemoryModule);
     ModuleManager::add_module(new PacketTracerModule);
@@ -247,6 +247,9 @@ public:
     unsigned offload_limit = 99999;  // disabled
     unsigned offload_threads = 0;    // disabled
 
+    unsigned batch_search_depth = 0;     // disabled
+    unsigned batch_search_latency = 500; // usecs
+
 #ifdef HAVE_HYPERSCAN
     bool hyperscan_literals = false;
     bool pcre_to_regex = false;
@@ -17,6 +17,7 @@
 //--------------------------------------------------------------------------
 // stubs.h author Ron Dempster <rdempste@cisco.com>
 
+#include "decompress/inflate_pool.h"
 #include "detection/context_switcher.h"
 #include "detection/detection_engine.h"
 #include "detection/detection_util.h"
@@ -29,6 +30,7 @@
 #include "filters/sfthreshold.h"
 #include "flow/ha.h"
 #include "framework/data_bus.h"
+#include "latency/latency_histogram.h"
 #include "latency/packet_latency.h"
 #include "latency/rule_latency.h"
 #include "log/messages.h"
@@ -65,6 +67,8 @@ THREAD_LOCAL DAQStats daq_stats;
 
 void Profiler::start() { }
 void Profiler::stop(uint64_t) { }
+void Profiler::sample() { }
+void Profiler::sample_other() { }
 void Profiler::consolidate_stats() { }
 void Swapper::apply(Analyzer&) { }
 Swapper::~Swapper() { }
@@ -91,6 +95,8 @@ void detection_filter_init(DetectionFilterConfig*) { }
 void detection_filter_term() { }
 void RuleLatency::tterm() { }
 void PacketLatency::tterm() { }
+void LatencyHistograms::tinit(const SnortConfig*) { }
+void LatencyHistograms::tterm() { }
 void SideChannelManager::thread_init() { }
 void SideChannelManager::thread_term() { }
 void CodecManager::thread_init(const snort::SnortConfig*) { }
@@ -140,11 +146,13 @@ SFDAQInstance::~SFDAQInstance() { }
 void SFDAQInstance::reload() { }
 bool SFDAQInstance::start() { return false; }
 bool SFDAQInstance::stop() { return false; }
+bool SFDAQInstance::was_started() const { return false; }
 const char* SFDAQInstance::get_error() { return nullptr; }
 bool SFDAQInstance::interrupt() { return false; }
 int SFDAQInstance::inject(DAQ_Msg_h, int, const uint8_t*, uint32_t) { return -1; }
 DAQ_RecvStatus SFDAQInstance::receive_messages(unsigned) { return DAQ_RSTAT_ERROR; }
 int SFDAQInstance::ioctl(DAQ_IoctlCmd, void*, size_t) { return -4; }
+const DAQ_Stats_t* SFDAQInstance::get_stats() { return nullptr; }
 void SFDAQ::set_local_instance(SFDAQInstance*) { }
 const char* SFDAQ::verdict_to_string(DAQ_Verdict) { return nullptr; }
 bool SFDAQ::forwarding_packet(const DAQ_PktHdr_t*) { return false; }
@@ -185,6 +193,8 @@ const uint8_t* PacketManager::encode_reject(UnreachResponse, EncodeFlags, const
 { return nullptr; }
 void FileService::thread_init() { }
 void FileService::thread_term() { }
+void InflatePool::tinit() { }
+void InflatePool::tterm() { }
 void ErrorMessage(const char*,...) { }
 void LogMessage(const char*,...) { }
 [[noreturn]] void FatalError(const char*,...) { exit(-1); }
@@ -120,6 +120,36 @@ void ThreadConfig::term()
     topology_support = nullptr;
 }
 
+void* ThreadConfig::alloc_local(size_t len)
+{
+    void* p = nullptr;
+
+    if ( topology_support->membind->alloc_membind and
+        topology_support->cpubind->get_thisthread_cpubind )
+    {
+        hwloc_cpuset_t cpuset = hwloc_bitmap_alloc();
+
+        if ( !hwloc_get_cpubind(topology, cpuset, HWLOC_CPUBIND_THREAD) )
+            p = hwloc_alloc_membind(topology, len, cpuset, HWLOC_MEMBIND_BIND, 0);
+
+        hwloc_bitmap_free(cpuset);
+    }
+
+    if ( !p )
+        p = hwloc_alloc(topology, len);
+
+    if ( !p )
+        FatalError("Failed to allocate %zu bytes of thread local memory\n", len);
+
+    return p;
+}
+
+void ThreadConfig::free_local(void* p, size_t len)
+{
+    if ( p )
+        hwloc_free(topology, p, len);
+}
+
 ThreadConfig::~ThreadConfig()
 {
     for (auto& iter : thread_affinity)
@@ -39,6 +39,11 @@ public:
     static unsigned get_instance_max();
     static void term();
 
+    // allocate memory bound to the NUMA node(s) the calling thread is pinned
+    // to; falls back to unbound memory when the platform can't bind
+    static void* alloc_local(size_t);
+    static void free_local(void*, size_t);
+
     ~ThreadConfig();
     void set_thread_affinity(SThreadType, unsigned id, CpuSet*);
     void set_named_thread_affinity(const std::string&, CpuSet*);
@@ -32,6 +32,7 @@
 #include "detection/detection_engine.h"
 #include "flow/flow.h"
 #include "flow/session.h"
+#include "latency/latency_histogram.h"
 #include "log/messages.h"
 #include "main/shell.h"
 #include "main/snort.h"
@@ -123,6 +124,7 @@ struct PHInstance
     {
         name = s;
         handler->set_alias_name(name.c_str());
+        handler->set_latency_id(LatencyHistograms::get_inspector_id(s));
     }
 
     void set_reloaded(ReloadType val)
@@ -1090,10 +1092,18 @@ static inline void execute(
         if ( p->type() == PktType::NONE )
         {
             if ( p->proto_bits & ppc.api.proto_bits )
+            {
+                LatencyHistogram::Context hist_ctx(
+                    LatencyHistograms::get_inspector((*prep)->handler->get_latency_id()));
                 (*prep)->handler->eval(p);
+            }
         }
         else if ( BIT((unsigned)p->type()) & ppc.api.proto_bits )
+        {
+            LatencyHistogram::Context hist_ctx(
+                LatencyHistograms::get_inspector((*prep)->handler->get_latency_id()));
             (*prep)->handler->eval(p);
+        }
 
         if ( T )
             trace_ulogf(snort_trace, TRACE_INSPECTOR_MANAGER, p,
@@ -1132,6 +1142,9 @@ void InspectorManager::full_inspection(Packet* p)
 
     else if ( flow->gadget && flow->gadget->likes(p) )
     {
+        LatencyHistogram::Context hist_ctx(
+            LatencyHistograms::get_inspector(flow->gadget->get_latency_id()));
+
         if ( !T )
             flow->gadget->eval(p);
         else
@@ -0,0 +1,241 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2020-2020 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// huge_pages.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "huge_pages.h"
+
+#include <sys/mman.h>
+
+#include <cassert>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+
+#include "utils/util.h"
+
+#include "memory_module.h"
+
+#ifdef UNIT_TEST
+#include "catch/snort_catch.h"
+#endif
+
+using namespace snort;
+
+namespace memory
+{
+
+namespace
+{
+
+enum class Backing : uint8_t { HUGETLB, TRANSPARENT, HEAP };
+
+struct Mapping
+{
+    size_t len;
+    Backing backing;
+};
+
+// tables are few and only allocated and freed at thread start and stop
+static std::mutex map_mutex;
+static std::unordered_map<void*, Mapping> mappings;
+
+inline size_t round_up(size_t n, size_t page)
+{ return (n + page - 1) & ~(page - 1); }
+
+void* map_hugetlb(size_t len, size_t page)
+{
+#ifdef MAP_HUGETLB
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB;
+
+#ifdef MAP_HUGE_SHIFT
+    flags |= (page == HugePages::SIZE_1G ? 30 : 21) << MAP_HUGE_SHIFT;
+#else
+    UNUSED(page);
+#endif
+
+    void* p = mmap(nullptr, len, PROT_READ | PROT_WRITE, flags, -1, 0);
+    return p == MAP_FAILED ? nullptr : p;
+#else
+    UNUSED(len);
+    UNUSED(page);
+    return nullptr;
+#endif
+}
+
+void* map_transparent(size_t len)
+{
+#ifdef MADV_HUGEPAGE
+    // over map so the table can start on a huge page boundary
+    const size_t span = len + HugePages::SIZE_2M;
+    void* p = mmap(nullptr, span, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if ( p == MAP_FAILED )
+        return nullptr;
+
+    uint8_t* base = (uint8_t*)p;
+    uint8_t* start = (uint8_t*)round_up((uintptr_t)base, HugePages::SIZE_2M);
+    uint8_t* end = start + len;
+
+    if ( start > base )
+        munmap(base, start - base);
+
+    if ( base + span > end )
+        munmap(end, base + span - end);
+
+    madvise(start, len, MADV_HUGEPAGE);
+    return start;
+#else
+    UNUSED(len);
+    return nullptr;
+#endif
+}
+
+} // namespace
+
+unsigned HugePages::users = 0;
+size_t HugePages::page_size = HugePages::SIZE_2M;
+
+void HugePages::configure(unsigned u, size_t size)
+{
+    assert(size == SIZE_2M or size == SIZE_1G);
+    users = u;
+    page_size = size;
+}
+
+bool HugePages::enabled(TableUser user)
+{ return user != TableUser::NONE and (users & (1u << (unsigned)user)); }
+
+// tables smaller than half a page are left on the heap since the padding
+// would cost more than the TLB misses saved
+void* HugePages::calloc(size_t n, TableUser user)
+{
+    if ( !enabled(user) )
+        return snort_calloc(n);
+
+    Mapping map { 0, Backing::HEAP };
+    void* p = nullptr;
+
+    if ( n >= page_size / 2 )
+    {
+        map.len = round_up(n, page_size);
+
+        if ( (p = map_hugetlb(map.len, page_size)) )
+        {
+            map.backing = Backing::HUGETLB;
+            mem_stats.huge_page_bytes += n;
+        }
+    }
+
+    if ( !p and n >= SIZE_2M / 2 )
+    {
+        map.len = round_up(n, SIZE_2M);
+
+        if ( (p = map_transparent(map.len)) )
+        {
+            map.backing = Backing::TRANSPARENT;
+            mem_stats.transparent_huge_bytes += n;
+        }
+    }
+
+    if ( !p )
+    {
+        mem_stats.small_page_bytes += n;
+        return snort_calloc(n);
+    }
+
+    std::lock_guard<std::mutex> lock(map_mutex);
+    mappings[p] = map;
+    return p;
+}
+
+void HugePages::free(void* p)
+{
+    if ( !p )
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(map_mutex);
+        auto it = mappings.find(p);
+
+        if ( it != mappings.end() )
+        {
+            munmap(p, it->second.len);
+            mappings.erase(it);
+            return;
+        }
+    }
+    snort_free(p);
+}
+
+} // namespace memory
+
+#ifdef UNIT_TEST
+
+using namespace memory;
+
+TEST_CASE( "huge pages", "[memory]" )
+{
+    SECTION( "disabled users stay on the heap" )
+    {
+        HugePages::configure(0, HugePages::SIZE_2M);
+        PegCount small = mem_stats.small_page_bytes;
+
+        uint8_t* p = (uint8_t*)HugePages::calloc(HugePages::SIZE_2M, TableUser::FLOW);
+        REQUIRE( p );
+        CHECK( p[HugePages::SIZE_2M - 1] == 0 );
+        CHECK( mem_stats.small_page_bytes == small );
+        HugePages::free(p);
+    }
+
+    SECTION( "small tables fall back" )
+    {
+        HugePages::configure(1u << (unsigned)TableUser::PORT_SCAN, HugePages::SIZE_2M);
+        PegCount small = mem_stats.small_page_bytes;
+
+        void* p = HugePages::calloc(4096, TableUser::PORT_SCAN);
+        REQUIRE( p );
+        CHECK( mem_stats.small_page_bytes == small + 4096 );
+        HugePages::free(p);
+    }
+
+    SECTION( "large tables are zeroed and covered" )
+    {
+        HugePages::configure(1u << (unsigned)TableUser::FLOW, HugePages::SIZE_2M);
+        PegCount huge = mem_stats.huge_page_bytes + mem_stats.transparent_huge_bytes;
+        PegCount small = mem_stats.small_page_bytes;
+        const size_t n = 3 * HugePages::SIZE_2M;
+
+        uint8_t* p = (uint8_t*)HugePages::calloc(n, TableUser::FLOW);
+        REQUIRE( p );
+        CHECK( p[0] == 0 );
+        CHECK( p[n - 1] == 0 );
+        memset(p, 0xff, n);
+
+        CHECK( mem_stats.huge_page_bytes + mem_stats.transparent_huge_bytes +
+            mem_stats.small_page_bytes == huge + small + n );
+        HugePages::free(p);
+    }
+    HugePages::configure(0, HugePages::SIZE_2M);
+}
+
+#endif
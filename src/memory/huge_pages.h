@@ -0,0 +1,64 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2020-2020 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// huge_pages.h
+
+#ifndef HUGE_PAGES_H
+#define HUGE_PAGES_H
+
+// large long-lived tables can be placed on huge pages to cut TLB misses
+// on lookup.  tables fall back to transparent huge pages and then to the
+// heap when huge pages are not available.
+
+#include <cstddef>
+#include <cstdint>
+
+#include "main/snort_types.h"
+
+namespace memory
+{
+
+// order must match memory.huge_pages
+enum class TableUser : uint8_t
+{
+    FLOW, PERF_MONITOR, PORT_SCAN, NONE
+};
+
+class SO_PUBLIC HugePages
+{
+public:
+    // zeroed table of n bytes, from huge pages if enabled for the user
+    static void* calloc(size_t n, TableUser);
+    static void free(void*);
+
+    static bool enabled(TableUser);
+
+    // call from main thread; users is a bitmask of TableUser
+    static void configure(unsigned users, size_t page_size);
+
+    static constexpr size_t SIZE_2M = 1 << 21;
+    static constexpr size_t SIZE_1G = 1 << 30;
+
+private:
+    static unsigned users;
+    static size_t page_size;
+};
+
+} // namespace memory
+
+#endif
@@ -22,6 +22,7 @@
 #include "config.h"
 #endif
 
+#include <atomic>
 #include <cassert>
 
 #include "memory_cap.h"
@@ -32,6 +33,7 @@
 #include "profiler/memory_profiler_active_context.h"
 #include "utils/stats.h"
 
+#include "huge_pages.h"
 #include "memory_config.h"
 #include "memory_module.h"
 #include "prune_handler.h"
@@ -74,6 +76,53 @@ struct Tracker
 
 static Tracker s_tracker;
 
+// Each thread keeps its usage per tag and publishes the accumulated change to
+// the shared totals only after PUBLISH_BYTES of churn so that the common path
+// never writes memory shared with other threads.
+constexpr unsigned num_tags = (unsigned)MemoryTag::MAX;
+constexpr uint64_t PUBLISH_BYTES = 64 * 1024;
+
+typedef std::atomic<int64_t> TagTotals[num_tags];
+
+struct TagTracker
+{
+    int64_t used[num_tags] = { };
+    int64_t pending[num_tags] = { };
+    uint64_t churn = 0;
+
+    void update(MemoryTag tag, int64_t n, TagTotals& totals)
+    {
+        unsigned i = (unsigned)tag;
+        assert(i < num_tags);
+
+        used[i] += n;
+        pending[i] += n;
+        churn += (n < 0) ? -n : n;
+
+        if ( churn >= PUBLISH_BYTES )
+            publish(totals);
+    }
+
+    void publish(TagTotals& totals)
+    {
+        for ( unsigned i = 0; i < num_tags; ++i )
+        {
+            if ( pending[i] )
+            {
+                totals[i].fetch_add(pending[i], std::memory_order_relaxed);
+                pending[i] = 0;
+            }
+        }
+        churn = 0;
+    }
+};
+
+static TagTotals s_tag_totals;
+static THREAD_LOCAL TagTracker s_tag_tracker;
+
+static const char* const tag_names[num_tags] =
+{ "other", "flow", "stream", "http", "appid", "file" };
+
 // -----------------------------------------------------------------------------
 // helpers
 // -----------------------------------------------------------------------------
@@ -150,7 +199,7 @@ static size_t fudge_it(size_t n)
     return ((n >> 7) + 1) << 7;
 }
 
-void MemoryCap::update_allocations(size_t n)
+void MemoryCap::update_allocations(size_t n, MemoryTag tag)
 {
     if (n == 0)
         return;
@@ -159,19 +208,21 @@ void MemoryCap::update_allocations(size_t n)
     n = fudge_it(n);
     mem_stats.total_fudge += (n - k);
     s_tracker.allocate(n);
+    s_tag_tracker.update(tag, (int64_t)n, s_tag_totals);
     auto in_use = s_tracker.used();
     if ( in_use > mem_stats.max_in_use )
         mem_stats.max_in_use = in_use;
     mp_active_context.update_allocs(n);
 }
 
-void MemoryCap::update_deallocations(size_t n)
+void MemoryCap::update_deallocations(size_t n, MemoryTag tag)
 {
     if (n == 0)
       return;
 
     n = fudge_it(n);
     s_tracker.deallocate(n);
+    s_tag_tracker.update(tag, -(int64_t)n, s_tag_totals);
     mp_active_context.update_deallocs(n);
 }
 
@@ -183,6 +234,33 @@ bool MemoryCap::over_threshold()
     return s_tracker.used() >= preemptive_threshold;
 }
 
+MemoryTag MemoryCap::top_consumer()
+{
+    unsigned top = 0;
+
+    for ( unsigned i = 1; i < num_tags; ++i )
+    {
+        if ( s_tag_tracker.used[i] > s_tag_tracker.used[top] )
+            top = i;
+    }
+    return (MemoryTag)top;
+}
+
+void MemoryCap::thread_term()
+{ s_tag_tracker.publish(s_tag_totals); }
+
+int64_t MemoryCap::get_usage(MemoryTag tag)
+{
+    assert((unsigned)tag < num_tags);
+    return s_tag_totals[(unsigned)tag].load(std::memory_order_relaxed);
+}
+
+const char* MemoryCap::get_tag_name(MemoryTag tag)
+{
+    assert((unsigned)tag < num_tags);
+    return tag_names[(unsigned)tag];
+}
+
 // FIXIT-L this should not be called while the packet threads are running.
 // once reload is implemented for the memory manager, the configuration
 // model will need to be updated
@@ -194,6 +272,7 @@ void MemoryCap::calculate()
 
     thread_cap = config.cap;
     preemptive_threshold = memory::calculate_threshold(thread_cap, config.threshold);
+    HugePages::configure(config.huge_tables, config.huge_page_size);
 }
 
 void MemoryCap::print()
@@ -210,6 +289,11 @@ void MemoryCap::print()
     {
         LogMessage("    thread cap: %zu\n", thread_cap);
         LogMessage("    thread preemptive threshold: %zu\n", preemptive_threshold);
+
+        const MemoryConfig& config = *SnortConfig::get_conf()->memory;
+
+        if ( config.huge_tables )
+            LogMessage("    huge page size: %zuM\n", config.huge_page_size >> 20);
     }
 
     if ( mem_stats.allocations )
@@ -217,6 +301,14 @@ void MemoryCap::print()
         LogMessage("    main thread usage: %zu\n", s_tracker.used());
         LogMessage("    allocations: %" PRIu64 "\n", mem_stats.allocations);
         LogMessage("    deallocations: %" PRIu64 "\n", mem_stats.deallocations);
+
+        for ( unsigned i = 0; i < num_tags; ++i )
+        {
+            int64_t used = get_usage((MemoryTag)i);
+
+            if ( used )
+                LogMessage("    %s usage: %" PRId64 "\n", tag_names[i], used);
+        }
     }
 }
 
@@ -256,6 +348,40 @@ struct HandlerSpy
 
 } // namespace t_memory_cap
 
+TEST_CASE( "memory cap tag tracking", "[memory]" )
+{
+    memory::TagTotals totals;
+
+    for ( auto& t : totals )
+        t = 0;
+
+    memory::TagTracker tracker;
+
+    SECTION( "small changes stay local" )
+    {
+        tracker.update(memory::MemoryTag::HTTP, 1024, totals);
+        tracker.update(memory::MemoryTag::HTTP, -512, totals);
+
+        CHECK( tracker.used[(unsigned)memory::MemoryTag::HTTP] == 512 );
+        CHECK( totals[(unsigned)memory::MemoryTag::HTTP] == 0 );
+    }
+
+    SECTION( "churn publishes every pending tag" )
+    {
+        tracker.update(memory::MemoryTag::FLOW, 128, totals);
+        tracker.update(memory::MemoryTag::STREAM, memory::PUBLISH_BYTES, totals);
+
+        CHECK( totals[(unsigned)memory::MemoryTag::FLOW] == 128 );
+        CHECK( totals[(unsigned)memory::MemoryTag::STREAM] == (int64_t)memory::PUBLISH_BYTES );
+        CHECK( tracker.churn == 0 );
+
+        tracker.update(memory::MemoryTag::FLOW, -128, totals);
+        tracker.publish(totals);
+
+        CHECK( totals[(unsigned)memory::MemoryTag::FLOW] == 0 );
+    }
+}
+
 TEST_CASE( "memory cap free space", "[memory]" )
 {
     using namespace t_memory_cap;
@@ -22,21 +22,38 @@
 #define MEMORY_CAP_H
 
 #include <cstddef>
+#include <cstdint>
 
 #include "main/thread.h"
 
 namespace memory
 {
 
+// subsystems whose usage is accounted separately
+enum class MemoryTag : uint8_t
+{
+    OTHER, FLOW, STREAM, HTTP, APPID, FILE, MAX
+};
+
 class SO_PUBLIC MemoryCap
 {
 public:
     static bool free_space(size_t);
-    static void update_allocations(size_t);
-    static void update_deallocations(size_t);
+    static void update_allocations(size_t, MemoryTag = MemoryTag::OTHER);
+    static void update_deallocations(size_t, MemoryTag = MemoryTag::OTHER);
 
     static bool over_threshold();
 
+    // tag holding the most memory in this thread
+    static MemoryTag top_consumer();
+
+    // call from packet thread at exit to publish remaining deltas
+    static void thread_term();
+
+    // usage of all packet threads as of their last publish
+    static int64_t get_usage(MemoryTag);
+    static const char* get_tag_name(MemoryTag);
+
     // call from main thread
     static void calculate();
 
@@ -27,6 +27,8 @@ struct MemoryConfig
 {
     size_t cap = 0;
     unsigned threshold = 0;
+    unsigned huge_tables = 0;
+    size_t huge_page_size = 1 << 21;
 
     constexpr MemoryConfig() = default;
 };
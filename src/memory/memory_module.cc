@@ -24,8 +24,15 @@
 
 #include "memory_module.h"
 
+#include <lua.hpp>
+#include <string>
+
+#include "main/request.h"
 #include "main/snort_config.h"
+#include "src/main.h"
 
+#include "huge_pages.h"
+#include "memory_cap.h"
 #include "memory_config.h"
 
 using namespace snort;
@@ -47,6 +54,12 @@ static const Parameter s_params[] =
         "set the per-packet-thread threshold for preemptive cleanup actions "
         "(percent, 0 to disable)" },
 
+    { "huge_pages", Parameter::PT_MULTI, "flow | perf_monitor | port_scan", nullptr,
+        "place the large tables of these subsystems on huge pages when available" },
+
+    { "huge_page_size", Parameter::PT_ENUM, "2M | 1G", "2M",
+        "size of explicit huge pages to request for tables" },
+
     { nullptr, Parameter::PT_MAX, nullptr, nullptr, nullptr }
 };
 
@@ -63,9 +76,39 @@ const PegInfo mem_pegs[] =
     { CountType::NOW, "reap_failures", "failures to reclaim memory" },
     { CountType::MAX, "max_in_use", "highest allocated - deallocated" },
     { CountType::NOW, "total_fudge", "sum of all adjustments" },
+    { CountType::SUM, "huge_page_bytes", "table bytes placed on explicit huge pages" },
+    { CountType::SUM, "transparent_huge_bytes", "table bytes placed on transparent huge pages" },
+    { CountType::SUM, "small_page_bytes", "table bytes enabled for huge pages left on small pages" },
     { CountType::END, nullptr, nullptr }
 };
 
+// -----------------------------------------------------------------------------
+// commands
+// -----------------------------------------------------------------------------
+
+static int dump_usage(lua_State* L)
+{
+    Request& request = get_current_request();
+    bool from_shell = ( L != nullptr );
+
+    request.respond("== memory usage by subsystem\n", from_shell);
+
+    for ( unsigned i = 0; i < (unsigned)memory::MemoryTag::MAX; ++i )
+    {
+        auto tag = (memory::MemoryTag)i;
+        std::string line = memory::MemoryCap::get_tag_name(tag);
+        line += ": " + std::to_string(memory::MemoryCap::get_usage(tag)) + "\n";
+        request.respond(line.c_str(), from_shell);
+    }
+    return 0;
+}
+
+static const Command s_commands[] =
+{
+    { "dump", dump_usage, nullptr, "show memory in use by each subsystem across packet threads" },
+    { nullptr, nullptr, nullptr, nullptr }
+};
+
 // -----------------------------------------------------------------------------
 // memory module
 // -----------------------------------------------------------------------------
@@ -84,6 +127,13 @@ bool MemoryModule::set(const char*, Value& v, SnortConfig* sc)
     else if ( v.is("threshold") )
         sc->memory->threshold = v.get_uint8();
 
+    else if ( v.is("huge_pages") )
+        sc->memory->huge_tables = v.get_uint32();
+
+    else if ( v.is("huge_page_size") )
+        sc->memory->huge_page_size = v.get_uint8() ? memory::HugePages::SIZE_1G :
+            memory::HugePages::SIZE_2M;
+
     else
         return false;
 
@@ -99,6 +149,9 @@ bool MemoryModule::end(const char*, int, SnortConfig*)
 bool MemoryModule::is_active()
 { return configured; }
 
+const Command* MemoryModule::get_commands() const
+{ return s_commands; }
+
 const PegInfo* MemoryModule::get_pegs() const
 { return mem_pegs; }
 
@@ -33,6 +33,9 @@ struct MemoryCounts
     PegCount reap_failures;
     PegCount max_in_use;
     PegCount total_fudge;
+    PegCount huge_page_bytes;
+    PegCount transparent_huge_bytes;
+    PegCount small_page_bytes;
 };
 
 extern THREAD_LOCAL MemoryCounts mem_stats;
@@ -42,6 +45,7 @@ class MemoryModule : public snort::Module
 public:
     MemoryModule();
 
+    const snort::Command* get_commands() const override;
     const PegInfo* get_pegs() const override;
     PegCount* get_counts() const override;
 
@@ -26,6 +26,8 @@
 
 #include "stream/stream.h"
 
+#include "memory_cap.h"
+
 using namespace snort;
 
 namespace memory
@@ -33,7 +35,7 @@ namespace memory
 
 void prune_handler()
 {
-    Stream::prune_flows();
+    Stream::prune_flows(MemoryCap::top_consumer());
 }
 
 } // namespace memory
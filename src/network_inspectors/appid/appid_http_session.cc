@@ -46,7 +46,7 @@ AppIdHttpSession::AppIdHttpSession(AppIdSession& asd, uint32_t http2_stream_id)
         meta_offset[i].first = 0;
         meta_offset[i].second = 0;
     }
-    memory::MemoryCap::update_allocations(sizeof(AppIdHttpSession));
+    memory::MemoryCap::update_allocations(sizeof(AppIdHttpSession), memory::MemoryTag::APPID);
 }
 
 AppIdHttpSession::~AppIdHttpSession()
@@ -55,7 +55,7 @@ AppIdHttpSession::~AppIdHttpSession()
         delete meta_data[i];
     if (tun_dest)
         delete tun_dest;
-    memory::MemoryCap::update_deallocations(sizeof(AppIdHttpSession));
+    memory::MemoryCap::update_deallocations(sizeof(AppIdHttpSession), memory::MemoryTag::APPID);
 }
 
 void AppIdHttpSession::free_chp_matches(ChpMatchDescriptor& cmd, unsigned num_matches)
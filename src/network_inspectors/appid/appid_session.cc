@@ -97,6 +97,7 @@ AppIdSession::AppIdSession(IpProtocol proto, const SfIp* ip, uint16_t port,
     : FlowData(inspector_id, &inspector), ctxt(inspector.get_ctxt()),
     protocol(proto)
 {
+    set_memory_tag(memory::MemoryTag::APPID);
     service_ip.clear();
     session_id = ++appid_flow_data_id;
     initiator_ip = *ip;
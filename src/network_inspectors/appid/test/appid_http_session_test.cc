@@ -152,8 +152,8 @@ void Profiler::show_stats() { }
 
 MemoryContext::MemoryContext(MemoryTracker&) { }
 MemoryContext::~MemoryContext() { }
-void memory::MemoryCap::update_allocations(size_t) { }
-void memory::MemoryCap::update_deallocations(size_t) { }
+void memory::MemoryCap::update_allocations(size_t, memory::MemoryTag) { }
+void memory::MemoryCap::update_deallocations(size_t, memory::MemoryTag) { }
 
 OdpContext::OdpContext(const AppIdConfig&, snort::SnortConfig*) { }
 OdpContext::~OdpContext() { }
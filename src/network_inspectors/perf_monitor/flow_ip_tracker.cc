@@ -36,17 +36,10 @@ using namespace snort;
 #define DEFAULT_XHASH_NROWS 1021
 #define TRACKER_NAME PERF_NAME "_flow_ip"
 
-struct FlowStateKey
-{
-    SfIp ipA;
-    SfIp ipB;
-};
-
 FlowStateValue* FlowIPTracker::find_stats(const SfIp* src_addr, const SfIp* dst_addr,
     int* swapped)
 {
     FlowStateKey key;
-    FlowStateValue* value = nullptr;
 
     if ( src_addr->less_than(*dst_addr) )
     {
@@ -61,16 +54,11 @@ FlowStateValue* FlowIPTracker::find_stats(const SfIp* src_addr, const SfIp* dst_
         *swapped = 1;
     }
 
-    value = (FlowStateValue*)ip_map->get_user_data(&key);
-    if ( !value )
-    {
-        if ( ip_map->insert(&key, nullptr) != HASH_OK )
-            return nullptr;
-        value = (FlowStateValue*)ip_map->get_user_data();
-        memset(value, 0, sizeof(FlowStateValue));
-    }
+    // a new entry starts zeroed
+    if ( ip_map->insert(key) == HASH_NOMEM )
+        return nullptr;
 
-    return value;
+    return ip_map->get_user_data();
 }
 
 bool FlowIPTracker::initialize(size_t new_memcap)
@@ -79,8 +67,8 @@ bool FlowIPTracker::initialize(size_t new_memcap)
 
     if ( !ip_map )
     {
-        ip_map = new XHash(DEFAULT_XHASH_NROWS, sizeof(FlowStateKey),
-            sizeof(FlowStateValue), new_memcap);
+        ip_map = new FlowIPMap(DEFAULT_XHASH_NROWS, new_memcap,
+            memory::TableUser::PERF_MONITOR);
     }
     else
     {
@@ -132,7 +120,7 @@ FlowIPTracker::FlowIPTracker(PerfConfig* perf) : PerfTracker(perf, TRACKER_NAME)
     stats.total_packets = stats.total_bytes = 0;
 
     memcap = perf->flowip_memcap;
-    ip_map = new XHash(DEFAULT_XHASH_NROWS, sizeof(FlowStateKey), sizeof(FlowStateValue), memcap);
+    ip_map = new FlowIPMap(DEFAULT_XHASH_NROWS, memcap, memory::TableUser::PERF_MONITOR);
 }
 
 FlowIPTracker::~FlowIPTracker()
@@ -189,12 +177,9 @@ void FlowIPTracker::process(bool)
 {
     for (auto node = ip_map->find_first_node(); node; node = ip_map->find_next_node())
     {
-        FlowStateKey* key = (FlowStateKey*)node->key;
-        FlowStateValue* cur_stats = (FlowStateValue*)node->data;
-
-        key->ipA.ntop(ip_a, sizeof(ip_a));
-        key->ipB.ntop(ip_b, sizeof(ip_b));
-        memcpy(&stats, cur_stats, sizeof(stats));
+        node->key.ipA.ntop(ip_a, sizeof(ip_a));
+        node->key.ipB.ntop(ip_b, sizeof(ip_b));
+        memcpy(&stats, &node->data, sizeof(stats));
 
         write();
     }
@@ -21,7 +21,7 @@
 #ifndef FLOW_IP_TRACKER_H
 #define FLOW_IP_TRACKER_H
 
-#include "hash/xhash.h"
+#include "hash/xhash_t.h"
 
 #include "perf_tracker.h"
 
@@ -49,6 +49,12 @@ struct TrafficStats
     PegCount  bytes_b_to_a;
 };
 
+struct FlowStateKey
+{
+    snort::SfIp ipA;
+    snort::SfIp ipB;
+};
+
 struct FlowStateValue
 {
     TrafficStats traffic_stats[SFS_TYPE_MAX];
@@ -57,6 +63,8 @@ struct FlowStateValue
     PegCount state_changes[SFS_STATE_MAX];
 };
 
+typedef snort::XHashT<FlowStateKey, FlowStateValue> FlowIPMap;
+
 class FlowIPTracker : public PerfTracker
 {
 public:
@@ -68,12 +76,12 @@ public:
     void update(snort::Packet*) override;
     void process(bool) override;
     int update_state(const snort::SfIp* src_addr, const snort::SfIp* dst_addr, FlowState);
-    snort::XHash* get_ip_map()
+    FlowIPMap* get_ip_map()
         { return ip_map; }
 
 private:
     FlowStateValue stats;
-    snort::XHash* ip_map;
+    FlowIPMap* ip_map;
     char ip_a[41], ip_b[41];
     int perf_flags;
     PerfConfig* perf_conf;
@@ -0,0 +1,126 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2020-2020 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// latency_tracker.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "latency_tracker.h"
+
+#include "latency/latency_histogram.h"
+#include "log/messages.h"
+
+#define TRACKER_NAME PERF_NAME "_latency"
+
+using namespace snort;
+
+struct LatencyTracker::Section
+{
+    const LatencyHistogram* source;
+    LatencyHistogram last;
+
+    PegCount count = 0;
+    PegCount p50 = 0;
+    PegCount p90 = 0;
+    PegCount p99 = 0;
+    PegCount p999 = 0;
+    PegCount max = 0;
+
+    Section(const LatencyHistogram* h) : source(h) { }
+
+    void update(const LatencyHistogram& h)
+    {
+        count = h.get_count();
+        p50 = h.get_percentile(50.0);
+        p90 = h.get_percentile(90.0);
+        p99 = h.get_percentile(99.0);
+        p999 = h.get_percentile(99.9);
+        max = h.get_max();
+    }
+};
+
+LatencyTracker::LatencyTracker(PerfConfig* perf) : PerfTracker(perf, TRACKER_NAME)
+{
+    window = new LatencyHistogram;
+
+    if ( !LatencyHistograms::get_packet() )
+    {
+        if ( !get_instance_id() )
+            WarningMessage("%s: latency.histograms is not enabled\n", TRACKER_NAME);
+    }
+    else
+    {
+        add_section("packet", LatencyHistograms::get_packet());
+        add_section("rule_tree", LatencyHistograms::get_rule());
+
+        std::vector<std::string> names = LatencyHistograms::get_inspector_names();
+
+        for ( unsigned id = 0; id < names.size(); ++id )
+            add_section(names[id], LatencyHistograms::get_inspector(id));
+    }
+    formatter->finalize_fields();
+}
+
+LatencyTracker::~LatencyTracker()
+{
+    for ( auto* s : sections )
+        delete s;
+
+    delete window;
+}
+
+void LatencyTracker::add_section(const std::string& name, const LatencyHistogram* h)
+{
+    Section* s = new Section(h);
+    sections.emplace_back(s);
+
+    formatter->register_section(name);
+    formatter->register_field("count", &s->count);
+    formatter->register_field("p50_nsecs", &s->p50);
+    formatter->register_field("p90_nsecs", &s->p90);
+    formatter->register_field("p99_nsecs", &s->p99);
+    formatter->register_field("p999_nsecs", &s->p999);
+    formatter->register_field("max_nsecs", &s->max);
+}
+
+void LatencyTracker::reset()
+{
+    for ( auto* s : sections )
+        s->last = *s->source;
+}
+
+void LatencyTracker::process(bool summary)
+{
+    for ( auto* s : sections )
+    {
+        if ( summary )
+            s->update(*s->source);
+
+        else
+        {
+            *window = *s->source;
+            window->subtract(s->last);
+            s->last = *s->source;
+            s->update(*window);
+        }
+    }
+    write();
+}
+
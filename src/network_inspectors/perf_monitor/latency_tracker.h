@@ -0,0 +1,52 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2020-2020 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// latency_tracker.h
+
+#ifndef LATENCY_TRACKER_H
+#define LATENCY_TRACKER_H
+
+// reports the packet, rule tree, and per-inspector latency percentiles of
+// this packet thread for each interval (or the totals in the summary).
+// the histograms are only collected if latency.histograms is enabled.
+
+#include <vector>
+
+#include "perf_tracker.h"
+
+class LatencyHistogram;
+
+class LatencyTracker : public PerfTracker
+{
+public:
+    LatencyTracker(PerfConfig*);
+    ~LatencyTracker() override;
+
+    void reset() override;
+    void process(bool) override;
+
+private:
+    struct Section;
+    std::vector<Section*> sections;
+    LatencyHistogram* window;
+
+    void add_section(const std::string&, const LatencyHistogram*);
+};
+
+#endif
+
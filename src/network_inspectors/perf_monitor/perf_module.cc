@@ -72,6 +72,9 @@ static const Parameter s_params[] =
     { "flow_ip", Parameter::PT_BOOL, nullptr, "false",
       "enable statistics on host pairs" },
 
+    { "latency", Parameter::PT_BOOL, nullptr, "false",
+      "enable latency percentiles (requires latency.histograms)" },
+
     { "packets", Parameter::PT_INT, "0:max32", "10000",
       "minimum packets to report" },
 
@@ -265,6 +268,11 @@ bool PerfMonModule::set(const char*, Value& v, SnortConfig*)
         if ( v.get_bool() )
             config->perf_flags |= PERF_FLOWIP;
     }
+    else if ( v.is("latency") )
+    {
+        if ( v.get_bool() )
+            config->perf_flags |= PERF_LATENCY;
+    }
     else if ( v.is("packets") )
     {
         config->pkt_cnt = v.get_uint32();
@@ -161,6 +161,7 @@ void PerfMonitor::show(const SnortConfig*) const
 {
     ConfigLogger::log_flag("base", config->perf_flags & PERF_BASE);
     ConfigLogger::log_flag("cpu", config->perf_flags & PERF_CPU);
+    ConfigLogger::log_flag("latency", config->perf_flags & PERF_LATENCY);
     ConfigLogger::log_flag("summary", config->perf_flags & PERF_SUMMARY);
 
     if ( ConfigLogger::log_flag("flow", config->perf_flags & PERF_FLOW) )
@@ -222,6 +223,9 @@ void PerfMonitor::tinit()
     if (config->perf_flags & PERF_CPU )
         trackers->emplace_back(new CPUTracker(config));
 
+    if (config->perf_flags & PERF_LATENCY )
+        trackers->emplace_back(new LatencyTracker(config));
+
     for (unsigned i = 0; i < trackers->size(); i++)
     {
         if (!(*trackers)[i]->open(true))
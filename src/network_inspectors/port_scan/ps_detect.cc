@@ -34,7 +34,7 @@
 #include "ps_detect.h"
 
 #include "hash/hash_defs.h"
-#include "hash/xhash.h"
+#include "hash/xhash_t.h"
 #include "log/messages.h"
 #include "protocols/icmp4.h"
 #include "protocols/packet.h"
@@ -58,16 +58,16 @@ struct PS_HASH_KEY
 };
 PADDING_GUARD_END
 
-class PortScanCache : public XHash
+class PortScanCache : public XHashT<PS_HASH_KEY, PS_TRACKER>
 {
 public:
-    PortScanCache(unsigned rows, unsigned key_len, unsigned datasize, unsigned memcap)
-        : XHash(rows, key_len, datasize, memcap)
+    PortScanCache(unsigned rows, unsigned memcap)
+        : XHashT(rows, memcap, memory::TableUser::PORT_SCAN)
     { }
 
-    bool is_node_recovery_ok(HashNode* hnode) override
+    bool is_node_recovery_ok(Node* hnode) override
     {
-        PS_TRACKER* tracker = (PS_TRACKER*)hnode->data;
+        PS_TRACKER* tracker = &hnode->data;
 
         if ( !tracker->priority_node )
             return true;
@@ -132,8 +132,7 @@ bool ps_init_hash(unsigned long memcap)
     }
 
     int rows = memcap / ps_node_size();
-    portscan_hash = new PortScanCache(rows, sizeof(PS_HASH_KEY), sizeof(PS_TRACKER),
-        memcap);
+    portscan_hash = new PortScanCache(rows, memcap);
 
     return false;
 }
@@ -292,25 +291,21 @@ bool PortScan::ps_filter_ignore(PS_PKT* ps_pkt)
 */
 static PS_TRACKER* ps_tracker_get(PS_HASH_KEY* key)
 {
-    PS_TRACKER* ht = (PS_TRACKER*)portscan_hash->get_user_data((void*)key);
+    auto prev_count = portscan_hash->get_num_nodes();
+    int rval = portscan_hash->insert(*key);
 
-    if ( ht )
-        return ht;
+    if ( rval == HASH_INTABLE )
+        return portscan_hash->get_user_data();
 
-    auto prev_count = portscan_hash->get_num_nodes();
-    if ( portscan_hash->insert((void*)key, nullptr) != HASH_OK )
+    if ( rval != HASH_OK )
         return nullptr;
 
     ++spstats.trackers;
     if ( prev_count == portscan_hash->get_num_nodes() )
         ++spstats.alloc_prunes;
 
-    ht = (PS_TRACKER*)portscan_hash->get_mru_user_data();
-
-    if ( ht )
-        memset(ht, 0x00, sizeof(PS_TRACKER));
-
-    return ht;
+    // new trackers start zeroed
+    return portscan_hash->get_user_data();
 }
 
 bool PortScan::ps_tracker_lookup(
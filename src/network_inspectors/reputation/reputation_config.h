@@ -24,6 +24,7 @@
 #include "main/thread.h"
 #include "sfrt/sfrt_flat.h"
 
+#include <ctime>
 #include <vector>
 #include <set>
 #include <string>
@@ -77,6 +78,33 @@ struct ListFile
 
 typedef std::vector<ListFile*> ListFiles;
 
+// What was loaded from a list file into a table.  Lets an update tell a
+// list that was only appended to from one that was rewritten.
+struct ListLoadState
+{
+    uint64_t size = 0;        // bytes loaded, up to the last complete line
+    uint64_t hash = 0;        // FNV-1a of those bytes
+    uint64_t file_size = 0;   // file size and mtime when loaded
+    time_t mtime = 0;
+};
+
+// IP lists built in segment memory.  A published table is never modified;
+// updates build a new table and swap it in.
+struct ReputationTable
+{
+    uint8_t* map = nullptr;        // compiled lists file, if mapped
+    size_t map_size = 0;
+    uint8_t* segment = nullptr;
+    uint32_t segment_size = 0;
+    uint32_t segment_used = 0;
+    table_flat_t* ip_list = nullptr;
+    bool memcap_reached = false;
+    unsigned reputation_id = 0;
+    std::vector<ListLoadState> list_state;
+
+    ~ReputationTable();
+};
+
 struct ReputationConfig
 {
     uint32_t memcap = 500;
@@ -86,10 +114,8 @@ struct ReputationConfig
     NestedIP nested_ip = INNER;
     WhiteAction white_action = UNBLACK;
     std::string blacklist_path;
+    std::string compiled_lists;
     std::string whitelist_path;
-    bool memcap_reached = false;
-    uint8_t* reputation_segment = nullptr;
-    table_flat_t* ip_list = nullptr;
     ListFiles list_files;
     std::string list_dir;
 
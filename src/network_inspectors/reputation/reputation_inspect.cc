@@ -29,6 +29,8 @@
 #include "detection/detection_engine.h"
 #include "events/event_queue.h"
 #include "log/messages.h"
+#include "main/analyzer_command.h"
+#include "main/request.h"
 #include "network_inspectors/packet_tracer/packet_tracer.h"
 #include "packet_io/active.h"
 #include "profiler/profiler.h"
@@ -71,9 +73,10 @@ const char* WhiteActionOption[] =
 /*
  * Function prototype(s)
  */
-static void snort_reputation(ReputationConfig* GlobalConf, Packet* p);
+static void snort_reputation(ReputationConfig* GlobalConf, const ReputationTable*, Packet* p);
 
-static inline IPrepInfo* reputation_lookup(ReputationConfig* config, const SfIp* ip)
+static inline IPrepInfo* reputation_lookup(ReputationConfig* config, const ReputationTable* table,
+    const SfIp* ip)
 {
     IPrepInfo* result;
 
@@ -85,18 +88,18 @@ static inline IPrepInfo* reputation_lookup(ReputationConfig* config, const SfIp*
         }
     }
 
-    result = (IPrepInfo*)sfrt_flat_dir8x_lookup(ip, config->ip_list);
+    result = (IPrepInfo*)sfrt_flat_dir8x_lookup(ip, table->ip_list, table->segment);
 
     return (result);
 }
 
-static inline IPdecision get_reputation(ReputationConfig* config, IPrepInfo* rep_info,
-    uint32_t* listid, uint32_t ingress_zone, uint32_t egress_zone)
+static inline IPdecision get_reputation(ReputationConfig* config, const ReputationTable* table,
+    IPrepInfo* rep_info, uint32_t* listid, uint32_t ingress_zone, uint32_t egress_zone)
 {
     IPdecision decision = DECISION_NULL;
 
     /*Walk through the IPrepInfo lists*/
-    uint8_t* base = (uint8_t*)config->ip_list;
+    uint8_t* base = table->segment;
     ListFiles& list_info =  config->list_files;
 
     while (rep_info)
@@ -135,7 +138,7 @@ static inline IPdecision get_reputation(ReputationConfig* config, IPrepInfo* rep
     return decision;
 }
 
-static bool decision_per_layer(ReputationConfig* config, Packet* p,
+static bool decision_per_layer(ReputationConfig* config, const ReputationTable* table, Packet* p,
     uint32_t ingressZone, uint32_t egressZone, const ip::IpApi& ip_api, IPdecision* decision_final)
 {
     const SfIp* ip;
@@ -143,10 +146,10 @@ static bool decision_per_layer(ReputationConfig* config, Packet* p,
     IPrepInfo* result;
 
     ip = ip_api.get_src();
-    result = reputation_lookup(config, ip);
+    result = reputation_lookup(config, table, ip);
     if (result)
     {
-        decision = get_reputation(config, result, &p->iplist_id, ingressZone, egressZone);
+        decision = get_reputation(config, table, result, &p->iplist_id, ingressZone, egressZone);
 
         if (decision == BLACKLISTED)
             *decision_final = BLACKLISTED_SRC;
@@ -162,10 +165,10 @@ static bool decision_per_layer(ReputationConfig* config, Packet* p,
     }
 
     ip = ip_api.get_dst();
-    result = reputation_lookup(config, ip);
+    result = reputation_lookup(config, table, ip);
     if (result)
     {
-        decision = get_reputation(config, result, &p->iplist_id, ingressZone, egressZone);
+        decision = get_reputation(config, table, result, &p->iplist_id, ingressZone, egressZone);
 
         if (decision == BLACKLISTED)
             *decision_final = BLACKLISTED_DST;
@@ -183,7 +186,8 @@ static bool decision_per_layer(ReputationConfig* config, Packet* p,
     return false;
 }
 
-static IPdecision reputation_decision(ReputationConfig* config, Packet* p)
+static IPdecision reputation_decision(ReputationConfig* config, const ReputationTable* table,
+    Packet* p)
 {
     IPdecision decision_final = DECISION_NULL;
     uint32_t ingress_zone = 0;
@@ -200,7 +204,8 @@ static IPdecision reputation_decision(ReputationConfig* config, Packet* p)
 
     if (config->nested_ip == INNER)
     {
-        decision_per_layer(config, p, ingress_zone, egress_zone, p->ptrs.ip_api, &decision_final);
+        decision_per_layer(config, table, p, ingress_zone, egress_zone, p->ptrs.ip_api,
+            &decision_final);
         return decision_final;
     }
 
@@ -213,7 +218,8 @@ static IPdecision reputation_decision(ReputationConfig* config, Packet* p)
     if (config->nested_ip == OUTER)
     {
         layer::set_outer_ip_api(p, p->ptrs.ip_api, p->ip_proto_next, num_layer);
-        decision_per_layer(config, p, ingress_zone, egress_zone, p->ptrs.ip_api, &decision_final);
+        decision_per_layer(config, table, p, ingress_zone, egress_zone, p->ptrs.ip_api,
+            &decision_final);
     }
     else if (config->nested_ip == ALL)
     {
@@ -222,7 +228,7 @@ static IPdecision reputation_decision(ReputationConfig* config, Packet* p)
 
         while (!done and layer::set_outer_ip_api(p, p->ptrs.ip_api, p->ip_proto_next, num_layer))
         {
-            done = decision_per_layer(config, p, ingress_zone, egress_zone, p->ptrs.ip_api,
+            done = decision_per_layer(config, table, p, ingress_zone, egress_zone, p->ptrs.ip_api,
                 &decision_current);
             if (decision_current != DECISION_NULL)
             {
@@ -245,14 +251,14 @@ static IPdecision reputation_decision(ReputationConfig* config, Packet* p)
     return decision_final;
 }
 
-static void snort_reputation(ReputationConfig* config, Packet* p)
+static void snort_reputation(ReputationConfig* config, const ReputationTable* table, Packet* p)
 {
     IPdecision decision;
 
-    if (!config->ip_list)
+    if (!table)
         return;
 
-    decision = reputation_decision(config, p);
+    decision = reputation_decision(config, table, p);
     Active* act = p->active;
 
     if (DECISION_NULL == decision)
@@ -380,11 +386,35 @@ static const char* to_string(IPdecision ipd)
     }
 }
 
+//-------------------------------------------------------------------------
+// table swap
+//-------------------------------------------------------------------------
+
+// Packet threads only use a table while evaluating a packet and commands
+// are run between packets, so once every packet thread has run this
+// command nothing can still refer to the retired table.
+class ACReputationRetire : public AnalyzerCommand
+{
+public:
+    ACReputationRetire(ReputationTable* table) : table(table) { }
+    ~ACReputationRetire() override
+    { delete table; }
+
+    bool execute(Analyzer&, void**) override
+    { return true; }
+
+    const char* stringify() override
+    { return "REPUTATION_RETIRE"; }
+
+private:
+    ReputationTable* table;
+};
+
 //-------------------------------------------------------------------------
 // class stuff
 //-------------------------------------------------------------------------
 
-Reputation::Reputation(ReputationConfig* pc)
+Reputation::Reputation(ReputationConfig* pc) : table(nullptr)
 {
     reputation_id = create_reputation_id();
     config = *pc;
@@ -393,21 +423,86 @@ Reputation::Reputation(ReputationConfig* pc)
         read_manifest(MANIFEST_FILENAME, conf);
 
     add_black_white_List(conf);
-    estimate_num_entries(conf);
-    if (conf->num_entries <= 0)
+
+    ReputationTable* rt = nullptr;
+
+    if ( !config.compiled_lists.empty() )
+        rt = ip_list_map(config.compiled_lists.c_str(), conf);
+
+    if ( !rt )
     {
-        ParseWarning(WARN_CONF,
-            "reputation: can't find any whitelist/blacklist entries; disabled.");
+        estimate_num_entries(conf);
+        if (conf->num_entries <= 0)
+        {
+            ParseWarning(WARN_CONF,
+                "reputation: can't find any whitelist/blacklist entries; disabled.");
+            return;
+        }
+
+        rt = ip_list_init(conf->num_entries + 1, conf);
+
+        // switch to the mapped file so its pages are shared with other processes
+        if ( rt and !config.compiled_lists.empty() and
+            ip_list_save(config.compiled_lists.c_str(), rt, conf) )
+        {
+            if ( ReputationTable* mapped = ip_list_map(config.compiled_lists.c_str(), conf) )
+            {
+                delete rt;
+                rt = mapped;
+            }
+        }
+    }
+
+    if ( rt )
+    {
+        rt->reputation_id = reputation_id;
+        reputationstats.memory_allocated = sfrt_flat_usage(rt->ip_list, rt->segment);
+    }
+    table.store(rt, std::memory_order_release);
+}
+
+Reputation::~Reputation()
+{
+    delete table.load(std::memory_order_acquire);
+}
+
+// Runs on the main thread.  The new table is built off to the side and
+// published with a single pointer store; packet threads never wait on it.
+void Reputation::update_lists(Request& request, bool from_shell)
+{
+    ReputationTable* cur = table.load(std::memory_order_acquire);
+    bool changed = false;
+
+    ReputationTable* rt = ip_list_update(cur, &config, changed);
+
+    if ( !changed )
+    {
+        request.respond("== reputation lists unchanged\n", from_shell);
+        return;
+    }
+
+    if ( !rt )
+    {
+        request.respond("== reputation update failed\n", from_shell);
         return;
     }
 
-    ip_list_init(conf->num_entries + 1, conf);
-    reputationstats.memory_allocated = sfrt_flat_usage(conf->ip_list);
+    // flows checked against the old lists get checked again
+    rt->reputation_id = create_reputation_id();
+    table.store(rt, std::memory_order_release);
+
+    if ( cur )
+        main_broadcast_command(new ACReputationRetire(cur), from_shell);
+
+    LogMessage("Reputation lists updated, %u entries, %u bytes\n",
+        sfrt_flat_num_entries(rt->ip_list), sfrt_flat_usage(rt->ip_list, rt->segment));
+    request.respond("== reputation lists updated\n", from_shell);
 }
 
 void Reputation::show(const SnortConfig*) const
 {
     ConfigLogger::log_value("blacklist", config.blacklist_path.c_str());
+    ConfigLogger::log_value("compiled_lists", config.compiled_lists.c_str());
     ConfigLogger::log_value("list_dir", config.list_dir.c_str());
     ConfigLogger::log_value("memcap", config.memcap);
     ConfigLogger::log_value("nested_ip", to_string(config.nested_ip));
@@ -427,15 +522,18 @@ void Reputation::eval(Packet* p)
     if (p->is_rebuilt())
         return;
 
+    const ReputationTable* rt = table.load(std::memory_order_acquire);
+    unsigned id = rt ? rt->reputation_id : reputation_id;
+
     if (p->flow)
     {
-        if (p->flow->reputation_id == reputation_id) // reputation previously checked
+        if (p->flow->reputation_id == id) // reputation previously checked
             return;
         else
-            p->flow->reputation_id = reputation_id; // disable future reputation checking
+            p->flow->reputation_id = id; // disable future reputation checking
     }
 
-    snort_reputation(&config, p);
+    snort_reputation(&config, rt, p);
     ++reputationstats.packets;
 }
 
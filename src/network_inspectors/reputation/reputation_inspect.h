@@ -19,21 +19,31 @@
 #ifndef REPUTATION_INSPECT_H
 #define REPUTATION_INSPECT_H
 
+#include <atomic>
+
 #include "flow/flow.h"
 
 #include "reputation_module.h"
 
+class Request;
+
 class Reputation : public snort::Inspector
 {
 public:
     Reputation(ReputationConfig*);
+    ~Reputation() override;
 
     void show(const snort::SnortConfig*) const override;
     void eval(snort::Packet*) override;
 
+    void update_lists(Request&, bool from_shell);
+
 private:
     ReputationConfig config;
     unsigned reputation_id;
+
+    // written by the main thread only; packet threads load it once per packet
+    std::atomic<ReputationTable*> table;
 };
 
 #endif
@@ -25,10 +25,16 @@
 #include "reputation_module.h"
 
 #include <cassert>
+#include <lua.hpp>
 
 #include "log/messages.h"
+#include "main/request.h"
+#include "main/swapper.h"
+#include "managers/inspector_manager.h"
+#include "src/main.h"
 #include "utils/util.h"
 
+#include "reputation_inspect.h"
 #include "reputation_parse.h"
 
 using namespace snort;
@@ -54,6 +60,9 @@ static const Parameter s_params[] =
     { "blacklist", Parameter::PT_STRING, nullptr, nullptr,
       "blacklist file name with IP lists" },
 
+    { "compiled_lists", Parameter::PT_STRING, nullptr, nullptr,
+      "file name for IP lists in compiled form; mapped at startup if current, else rewritten" },
+
     { "list_dir", Parameter::PT_STRING, nullptr, nullptr,
       "directory for IP lists and manifest file" },
 
@@ -91,6 +100,43 @@ static const RuleMap reputation_rules[] =
     { 0, nullptr }
 };
 
+//-------------------------------------------------------------------------
+// commands
+//-------------------------------------------------------------------------
+
+static int update_lists(lua_State* L)
+{
+    bool from_shell = ( L != nullptr );
+    Request& current_request = get_current_request();
+
+    if ( Swapper::get_reload_in_progress() )
+    {
+        current_request.respond("== reload pending; retry\n", from_shell);
+        return 0;
+    }
+
+    Reputation* inspector = (Reputation*)InspectorManager::get_inspector(REPUTATION_NAME);
+
+    if ( !inspector )
+    {
+        current_request.respond("== reputation update failed - reputation not enabled\n",
+            from_shell);
+        return 0;
+    }
+
+    current_request.respond(".. updating reputation lists\n", from_shell);
+    inspector->update_lists(current_request, from_shell);
+    return 0;
+}
+
+static const Command reputation_cmds[] =
+{
+    { "update_lists", update_lists, nullptr,
+      "reload changed IP lists without a configuration reload" },
+
+    { nullptr, nullptr, nullptr, nullptr }
+};
+
 //-------------------------------------------------------------------------
 // reputation module
 //-------------------------------------------------------------------------
@@ -106,6 +152,9 @@ ReputationModule::~ReputationModule()
         delete conf;
 }
 
+const Command* ReputationModule::get_commands() const
+{ return reputation_cmds; }
+
 const RuleMap* ReputationModule::get_rules() const
 { return reputation_rules; }
 
@@ -123,6 +172,9 @@ bool ReputationModule::set(const char*, Value& v, SnortConfig*)
     if ( v.is("blacklist") )
         conf->blacklist_path = v.get_string();
 
+    else if ( v.is("compiled_lists") )
+        conf->compiled_lists = v.get_string();
+
     else if ( v.is("list_dir") )
         conf->list_dir = v.get_string();
 
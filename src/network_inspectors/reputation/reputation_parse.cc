@@ -23,7 +23,11 @@
 
 #include "reputation_parse.h"
 
+#include <fcntl.h>
 #include <netinet/in.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include <cassert>
 #include <climits>
@@ -36,6 +40,12 @@
 #include "utils/util.h"
 #include "utils/util_cstring.h"
 
+#ifdef UNIT_TEST
+#include <cstdio>
+
+#include "catch/snort_catch.h"
+#endif
+
 using namespace snort;
 using namespace std;
 
@@ -68,18 +78,61 @@ static char monitor_info[] = "monitorlist";
 
 #define MAX_MSGS_TO_PRINT      20
 
+// compiled lists file: header, one CompiledList per list file, then the
+// segment image starting on a page boundary so it can be mapped as is
+#define COMPILED_LISTS_MAGIC        "SNORTREP"
+#define COMPILED_LISTS_VERSION      1
+#define COMPILED_LISTS_BYTE_ORDER   0x01020304
+#define COMPILED_LISTS_ALIGN        4096
+
+struct CompiledListsHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t num_lists;
+    uint32_t memcap;
+    uint32_t memcap_reached;
+    uint32_t segment_size;
+    uint32_t segment_used;
+    uint32_t ip_list_offset;
+    uint64_t data_offset;
+};
+
+struct CompiledList
+{
+    uint64_t name_hash;
+    uint64_t size;
+    uint64_t hash;
+    uint64_t file_size;
+    int64_t mtime;
+};
+
 unsigned long total_duplicates;
 unsigned long total_invalids;
 
 int totalNumEntries = 0;
 
-static void load_list_file(ListFile*, ReputationConfig* config);
+enum ListChange
+{
+    LIST_UNCHANGED,
+    LIST_APPENDED,
+    LIST_REWRITTEN
+};
+
+static void load_list_file(ListFile*, ListLoadState&, ReputationTable*, const ReputationConfig*);
 
-ReputationConfig::~ReputationConfig()
+ReputationTable::~ReputationTable()
 {
-    if (reputation_segment != nullptr)
-        snort_free(reputation_segment);
+    if (map != nullptr)
+        munmap(map, map_size);
+
+    else if (segment != nullptr)
+        snort_free(segment);
+}
 
+ReputationConfig::~ReputationConfig()
+{
     for (auto& file : list_files)
     {
         delete file;
@@ -111,47 +164,62 @@ static uint32_t estimate_size(uint32_t num_entries, uint32_t memcap)
     return (uint32_t)size;
 }
 
-void ip_list_init(uint32_t max_entries, ReputationConfig* config)
+static ReputationTable* new_table(uint32_t mem_size)
 {
-    if ( !config->ip_list )
-    {
-        uint32_t mem_size;
-        mem_size = estimate_size(max_entries, config->memcap);
-        config->reputation_segment = (uint8_t*)snort_alloc(mem_size);
+    ReputationTable* table = new ReputationTable;
 
-        segment_meminit(config->reputation_segment, mem_size);
+    table->segment = (uint8_t*)snort_alloc(mem_size);
+    table->segment_size = mem_size;
+    segment_meminit(table->segment, mem_size);
 
-        /*DIR_16x7_4x4 for performance, but memory usage is high
-         *Use  DIR_8x16 worst case IPV4 5K, IPV6 15K (bytes)
-         *Use  DIR_16x7_4x4 worst case IPV4 500, IPV6 2.5M
-         */
-        config->ip_list = sfrt_flat_new(DIR_8x16, IPv6, max_entries, config->memcap);
+    return table;
+}
 
-        if ( !config->ip_list )
+static void init_list_types(ReputationConfig* config)
+{
+    for (size_t i = 0; i < config->list_files.size(); i++)
+    {
+        config->list_files[i]->list_index = (uint8_t)i + 1;
+        if (config->list_files[i]->file_type == WHITE_LIST)
         {
-            ErrorMessage("Failed to create IP list.\n");
-            return;
+            if (config->white_action == UNBLACK)
+                config->list_files[i]->list_type = WHITELISTED_UNBLACK;
+            else
+                config->list_files[i]->list_type = WHITELISTED_TRUST;
         }
+        else if (config->list_files[i]->file_type == BLACK_LIST)
+            config->list_files[i]->list_type = BLACKLISTED;
+        else if (config->list_files[i]->file_type == MONITOR_LIST)
+            config->list_files[i]->list_type = MONITORED;
+    }
+}
 
-        total_duplicates = 0;
-        for (size_t i = 0; i < config->list_files.size(); i++)
-        {
-            config->list_files[i]->list_index = (uint8_t)i + 1;
-            if (config->list_files[i]->file_type == WHITE_LIST)
-            {
-                if (config->white_action == UNBLACK)
-                    config->list_files[i]->list_type = WHITELISTED_UNBLACK;
-                else
-                    config->list_files[i]->list_type = WHITELISTED_TRUST;
-            }
-            else if (config->list_files[i]->file_type == BLACK_LIST)
-                config->list_files[i]->list_type = BLACKLISTED;
-            else if (config->list_files[i]->file_type == MONITOR_LIST)
-                config->list_files[i]->list_type = MONITORED;
+ReputationTable* ip_list_init(uint32_t max_entries, ReputationConfig* config)
+{
+    ReputationTable* table = new_table(estimate_size(max_entries, config->memcap));
 
-            load_list_file(config->list_files[i], config);
-        }
+    /*DIR_16x7_4x4 for performance, but memory usage is high
+     *Use  DIR_8x16 worst case IPV4 5K, IPV6 15K (bytes)
+     *Use  DIR_16x7_4x4 worst case IPV4 500, IPV6 2.5M
+     */
+    table->ip_list = sfrt_flat_new(DIR_8x16, IPv6, max_entries, config->memcap);
+
+    if ( !table->ip_list )
+    {
+        ErrorMessage("Failed to create IP list.\n");
+        delete table;
+        return nullptr;
     }
+
+    init_list_types(config);
+    table->list_state.resize(config->list_files.size());
+    total_duplicates = 0;
+
+    for (size_t i = 0; i < config->list_files.size(); i++)
+        load_list_file(config->list_files[i], table->list_state[i], table, config);
+
+    table->segment_used = table->segment_size - segment_unusedmem();
+    return table;
 }
 
 static inline IPrepInfo* get_last_index(IPrepInfo* rep_info, uint8_t* base, int* last_index)
@@ -308,7 +376,7 @@ static int64_t update_entry_info(INFO* current, INFO new_entry, SaveDest save_de
     return bytes_allocated;
 }
 
-static int add_ip(SfCidr* ip_addr,INFO info_ptr, ReputationConfig* config)
+static int add_ip(SfCidr* ip_addr,INFO info_ptr, ReputationTable* table, uint32_t memcap)
 {
     int ret;
     int final_ret = IP_INSERT_SUCCESS;
@@ -318,16 +386,16 @@ static int add_ip(SfCidr* ip_addr,INFO info_ptr, ReputationConfig* config)
     uint32_t usage_before;
     uint32_t usage_after;
 
-    usage_before =  sfrt_flat_usage(config->ip_list);
+    usage_before =  sfrt_flat_usage(table->ip_list, table->segment);
 
     /*Check whether the same or more generic address is already in the table*/
-    if (nullptr != sfrt_flat_lookup(ip_addr->get_addr(), config->ip_list))
+    if (nullptr != sfrt_flat_lookup(ip_addr->get_addr(), table->ip_list, table->segment))
     {
         final_ret = IP_INSERT_DUPLICATE;
     }
 
     ret = sfrt_flat_insert(ip_addr, (unsigned char)ip_addr->get_bits(), info_ptr, RT_FAVOR_ALL,
-        config->ip_list, &update_entry_info);
+        table->ip_list, &update_entry_info, table->segment);
 
     if (RT_SUCCESS == ret)
     {
@@ -342,9 +410,9 @@ static int add_ip(SfCidr* ip_addr,INFO info_ptr, ReputationConfig* config)
         final_ret = IP_INSERT_FAILURE;
     }
 
-    usage_after = sfrt_flat_usage(config->ip_list);
+    usage_after = sfrt_flat_usage(table->ip_list, table->segment);
     /*Compare in the same scale*/
-    if (usage_after  > (config->memcap << 20))
+    if (usage_after  > (memcap << 20))
     {
         final_ret = IP_MEM_ALLOC_FAILURE;
     }
@@ -496,7 +564,7 @@ static int snort_pton(char const* src, SfCidr* dest)
     return 1;
 }
 
-static int process_line(char* line, INFO info, ReputationConfig* config)
+static int process_line(char* line, INFO info, ReputationTable* table, uint32_t memcap)
 {
     SfCidr address;
 
@@ -506,7 +574,7 @@ static int process_line(char* line, INFO info, ReputationConfig* config)
     if ( snort_pton(line, &address) < 1 )
         return IP_INVALID;
 
-    return add_ip(&address, info, config);
+    return add_ip(&address, info, table, memcap);
 }
 
 static int update_path_to_file(char* full_filename, unsigned int max_size, const char* filename)
@@ -568,7 +636,21 @@ static char* get_list_type_name(ListFile* list_info)
     }
 }
 
-static void load_list_file(ListFile* list_info, ReputationConfig* config)
+// FNV-1a; only used to tell whether a loaded part of a list has changed
+static inline uint64_t list_hash(uint64_t hash, const char* buf, size_t len)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        hash ^= (uint8_t)buf[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+// Loads the list from where the table's last load of it stopped; that is
+// the whole file for a new table and just the appended lines on an update.
+static void load_list_file(ListFile* list_info, ListLoadState& state, ReputationTable* table,
+    const ReputationConfig* config)
 {
     char linebuf[MAX_ADDR_LINE_LENGTH];
     char full_path_filename[PATH_MAX+1];
@@ -585,8 +667,11 @@ static void load_list_file(ListFile* list_info, ReputationConfig* config)
     unsigned int invalid_count = 0;   /*number of invalid entries in this file*/
     unsigned int fail_count = 0;   /*number of invalid entries in this file*/
     unsigned int num_loaded_before = 0;     /*number of valid entries loaded */
+    uint64_t offset = state.size;
+    uint64_t hash = state.hash;
+    struct stat st;
 
-    if (config->memcap_reached)
+    if (table->memcap_reached)
         return;
 
     update_path_to_file(full_path_filename, PATH_MAX, list_info->file_name.c_str());
@@ -602,7 +687,7 @@ static void load_list_file(ListFile* list_info, ReputationConfig* config)
     {
         return;
     }
-    base = (uint8_t*)config->ip_list;
+    base = table->segment;
     ip_info = ((IPrepInfo*)&base[ip_info_ptr]);
     ip_info->list_indexes[0] = list_info->list_index;
 
@@ -615,12 +700,38 @@ static void load_list_file(ListFile* list_info, ReputationConfig* config)
         return;
     }
 
-    num_loaded_before = sfrt_flat_num_entries(config->ip_list);
+    if ( !fstat(fileno(fp), &st) )
+    {
+        state.mtime = st.st_mtime;
+        state.file_size = st.st_size;
+    }
+
+    if ( offset and fseek(fp, offset, SEEK_SET) )
+    {
+        ErrorMessage("Unable to seek in address file %s, Error: %s\n", full_path_filename,
+            get_error(errno));
+        fclose(fp);
+        return;
+    }
+
+    num_loaded_before = sfrt_flat_num_entries(table->ip_list);
     while ( fgets(linebuf, MAX_ADDR_LINE_LENGTH, fp) )
     {
         int ret;
+        size_t len = strlen(linebuf);
         addrline++;
 
+        // only whole lines count as loaded; a partial last line is reread
+        // if the list is appended to
+        hash = list_hash(hash, linebuf, len);
+        offset += len;
+
+        if ( len and linebuf[len - 1] == '\n' )
+        {
+            state.size = offset;
+            state.hash = hash;
+        }
+
         // Remove comments
         if ( (cmt = strchr(linebuf, '#')) )
             *cmt = '\0';
@@ -630,7 +741,7 @@ static void load_list_file(ListFile* list_info, ReputationConfig* config)
             *cmt = '\0';
 
         /* process the line */
-        ret = process_line(linebuf, ip_info_ptr, config);
+        ret = process_line(linebuf, ip_info_ptr, table, config->memcap);
 
         if (IP_INSERT_SUCCESS == ret)
         {
@@ -654,7 +765,7 @@ static void load_list_file(ListFile* list_info, ReputationConfig* config)
                 "WARNING: %s(%d) => Memcap %u Mbytes reached when inserting IP Address: %s\n",
                 full_path_filename, addrline, config->memcap,linebuf);
 
-            config->memcap_reached = true;
+            table->memcap_reached = true;
             break;
         }
     }
@@ -670,40 +781,94 @@ static void load_list_file(ListFile* list_info, ReputationConfig* config)
         ErrorMessage("    Additional duplicate addresses were not listed.\n");
 
     LogMessage("    Reputation entries loaded: %u, invalid: %u, re-defined: %u (from file %s)\n",
-        sfrt_flat_num_entries(config->ip_list) - num_loaded_before,
+        sfrt_flat_num_entries(table->ip_list) - num_loaded_before,
         invalid_count, duplicate_count, full_path_filename);
 
     fclose(fp);
 }
 
-static int num_lines_in_file(char* fname)
+static int num_lines_in_file(FILE* fp)
 {
-    FILE* fp;
     int numlines = 0;
     char buf[MAX_ADDR_LINE_LENGTH];
 
-    fp = fopen(fname, "rb");
-
-    if (nullptr == fp)
-        return 0;
-
     while ((fgets(buf, MAX_ADDR_LINE_LENGTH, fp)) != nullptr)
     {
         if (buf[0] != '#')
         {
             numlines++;
             if (numlines == std::numeric_limits<int>::max())
-            {
-                fclose(fp);
                 return std::numeric_limits<int>::max();
-            }
         }
     }
 
+    return numlines;
+}
+
+static int num_lines_in_file(char* fname)
+{
+    FILE* fp = fopen(fname, "rb");
+
+    if (nullptr == fp)
+        return 0;
+
+    int numlines = num_lines_in_file(fp);
     fclose(fp);
     return numlines;
 }
 
+// Compares a list file with what was loaded from it.  Appended is only
+// reported if the loaded part is byte for byte the same; new_lines is the
+// number of lines appended.
+static ListChange check_list_file(const ListFile* list_info, const ListLoadState& state,
+    int& new_lines)
+{
+    char full_path_filename[PATH_MAX+1];
+    char buf[MAX_ADDR_LINE_LENGTH];
+    struct stat st;
+
+    update_path_to_file(full_path_filename, PATH_MAX, list_info->file_name.c_str());
+
+    if ( stat(full_path_filename, &st) )
+        return LIST_REWRITTEN;
+
+    if ( st.st_mtime == state.mtime and (uint64_t)st.st_size == state.file_size )
+        return LIST_UNCHANGED;
+
+    if ( (uint64_t)st.st_size < state.size )
+        return LIST_REWRITTEN;
+
+    FILE* fp = fopen(full_path_filename, "rb");
+
+    if ( !fp )
+        return LIST_REWRITTEN;
+
+    uint64_t remaining = state.size;
+    uint64_t hash = 0;
+
+    while ( remaining )
+    {
+        size_t n = remaining < sizeof(buf) ? remaining : sizeof(buf);
+
+        if ( fread(buf, 1, n, fp) != n )
+            break;
+
+        hash = list_hash(hash, buf, n);
+        remaining -= n;
+    }
+
+    if ( remaining or hash != state.hash )
+    {
+        fclose(fp);
+        return LIST_REWRITTEN;
+    }
+
+    new_lines = num_lines_in_file(fp);
+    fclose(fp);
+
+    return new_lines ? LIST_APPENDED : LIST_UNCHANGED;
+}
+
 static int load_file(int total_lines, const char* path)
 {
     int num_lines;
@@ -744,6 +909,238 @@ void estimate_num_entries(ReputationConfig* config)
     config->num_entries = total_lines;
 }
 
+ReputationTable* ip_list_update(const ReputationTable* cur, ReputationConfig* config,
+    bool& changed)
+{
+    size_t num_lists = config->list_files.size();
+    std::vector<ListChange> list_changes(num_lists, LIST_UNCHANGED);
+    bool rebuild = !cur or cur->list_state.size() != num_lists;
+    uint64_t new_lines = 0;
+
+    changed = rebuild;
+
+    for (size_t i = 0; !rebuild and i < num_lists; i++)
+    {
+        int lines = 0;
+        list_changes[i] = check_list_file(config->list_files[i], cur->list_state[i], lines);
+
+        if ( list_changes[i] == LIST_REWRITTEN )
+            rebuild = changed = true;
+
+        else if ( list_changes[i] == LIST_APPENDED )
+        {
+            changed = true;
+            new_lines += lines;
+        }
+    }
+
+    if ( !changed )
+        return nullptr;
+
+    // every inserted prefix takes a slot in the data array, which can't grow
+    if ( !rebuild and (cur->memcap_reached or
+        new_lines > cur->ip_list->max_size - cur->ip_list->num_ent) )
+        rebuild = true;
+
+    if ( !rebuild )
+    {
+        // copy on write: duplicate the published table and add the new lines
+        ReputationTable* table = new_table(cur->segment_size);
+
+        memcpy(table->segment, cur->segment, cur->segment_used);
+        segment_snort_alloc(cur->segment_used);
+
+        table->ip_list = (table_flat_t*)
+            (table->segment + ((const uint8_t*)cur->ip_list - cur->segment));
+        table->list_state = cur->list_state;
+        total_duplicates = 0;
+
+        for (size_t i = 0; i < num_lists; i++)
+        {
+            if ( list_changes[i] == LIST_APPENDED )
+                load_list_file(config->list_files[i], table->list_state[i], table, config);
+        }
+
+        if ( !table->memcap_reached )
+        {
+            table->segment_used = table->segment_size - segment_unusedmem();
+            return table;
+        }
+
+        delete table;
+    }
+
+    estimate_num_entries(config);
+    return ip_list_init(config->num_entries + 1, config);
+}
+
+static uint64_t list_name_hash(const ListFile* list_info)
+{
+    return list_hash(list_info->file_type, list_info->file_name.c_str(),
+        list_info->file_name.size());
+}
+
+// The compiled file is only used if it was built from the same lists with
+// the same memcap and none of the list files have changed since.
+ReputationTable* ip_list_map(const char* file_name, ReputationConfig* config)
+{
+    char full_path_filename[PATH_MAX+1];
+    struct stat st;
+
+    update_path_to_file(full_path_filename, PATH_MAX, file_name);
+
+    int fd = open(full_path_filename, O_RDONLY);
+
+    if ( fd < 0 )
+        return nullptr;
+
+    if ( fstat(fd, &st) or (size_t)st.st_size < sizeof(CompiledListsHeader) )
+    {
+        close(fd);
+        return nullptr;
+    }
+
+    size_t map_size = st.st_size;
+    uint8_t* map = (uint8_t*)mmap(nullptr, map_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if ( map == MAP_FAILED )
+    {
+        ErrorMessage("Unable to map compiled IP lists %s, Error: %s\n", full_path_filename,
+            get_error(errno));
+        return nullptr;
+    }
+
+    const CompiledListsHeader* hdr = (const CompiledListsHeader*)map;
+    const CompiledList* lists = (const CompiledList*)(hdr + 1);
+    size_t num_lists = config->list_files.size();
+    bool current = false;
+
+    if ( !memcmp(hdr->magic, COMPILED_LISTS_MAGIC, sizeof(hdr->magic)) and
+        hdr->version == COMPILED_LISTS_VERSION and
+        hdr->byte_order == COMPILED_LISTS_BYTE_ORDER and
+        hdr->num_lists == num_lists and hdr->memcap == config->memcap and
+        sizeof(*hdr) + num_lists * sizeof(*lists) <= hdr->data_offset and
+        hdr->data_offset + hdr->segment_used <= map_size and
+        hdr->segment_used <= hdr->segment_size and
+        hdr->ip_list_offset + sizeof(table_flat_t) <= hdr->segment_used )
+    {
+        current = true;
+
+        for (size_t i = 0; current and i < num_lists; i++)
+        {
+            const ListFile* list_info = config->list_files[i];
+            char list_filename[PATH_MAX+1];
+
+            update_path_to_file(list_filename, PATH_MAX, list_info->file_name.c_str());
+
+            if ( lists[i].name_hash != list_name_hash(list_info) or
+                stat(list_filename, &st) or
+                (uint64_t)st.st_size != lists[i].file_size or st.st_mtime != lists[i].mtime )
+                current = false;
+        }
+    }
+
+    if ( !current )
+    {
+        LogMessage("    Compiled IP lists %s are out of date\n", full_path_filename);
+        munmap(map, map_size);
+        return nullptr;
+    }
+
+    ReputationTable* table = new ReputationTable;
+
+    table->map = map;
+    table->map_size = map_size;
+    table->segment = map + hdr->data_offset;
+    table->segment_size = hdr->segment_size;
+    table->segment_used = hdr->segment_used;
+    table->ip_list = (table_flat_t*)(table->segment + hdr->ip_list_offset);
+    table->memcap_reached = hdr->memcap_reached;
+    table->list_state.resize(num_lists);
+
+    for (size_t i = 0; i < num_lists; i++)
+    {
+        table->list_state[i].size = lists[i].size;
+        table->list_state[i].hash = lists[i].hash;
+        table->list_state[i].file_size = lists[i].file_size;
+        table->list_state[i].mtime = lists[i].mtime;
+    }
+
+    init_list_types(config);
+
+    LogMessage("    Mapped compiled IP lists %s, %u entries\n", full_path_filename,
+        sfrt_flat_num_entries(table->ip_list));
+
+    return table;
+}
+
+// Written to a temporary file and renamed so that other processes mapping
+// the file never see a partial one.
+bool ip_list_save(const char* file_name, const ReputationTable* table,
+    const ReputationConfig* config)
+{
+    char full_path_filename[PATH_MAX+1];
+
+    update_path_to_file(full_path_filename, PATH_MAX, file_name);
+    std::string tmp_filename = full_path_filename;
+    tmp_filename += ".tmp." + std::to_string(getpid());
+
+    size_t num_lists = config->list_files.size();
+    size_t info_size = sizeof(CompiledListsHeader) + num_lists * sizeof(CompiledList);
+    size_t data_offset = (info_size + COMPILED_LISTS_ALIGN - 1) & ~(COMPILED_LISTS_ALIGN - 1);
+    std::vector<uint8_t> info(data_offset, 0);
+
+    CompiledListsHeader* hdr = (CompiledListsHeader*)info.data();
+    CompiledList* lists = (CompiledList*)(hdr + 1);
+
+    memcpy(hdr->magic, COMPILED_LISTS_MAGIC, sizeof(hdr->magic));
+    hdr->version = COMPILED_LISTS_VERSION;
+    hdr->byte_order = COMPILED_LISTS_BYTE_ORDER;
+    hdr->num_lists = num_lists;
+    hdr->memcap = config->memcap;
+    hdr->memcap_reached = table->memcap_reached;
+    hdr->segment_size = table->segment_size;
+    hdr->segment_used = table->segment_used;
+    hdr->ip_list_offset = (const uint8_t*)table->ip_list - table->segment;
+    hdr->data_offset = data_offset;
+
+    for (size_t i = 0; i < num_lists; i++)
+    {
+        lists[i].name_hash = list_name_hash(config->list_files[i]);
+        lists[i].size = table->list_state[i].size;
+        lists[i].hash = table->list_state[i].hash;
+        lists[i].file_size = table->list_state[i].file_size;
+        lists[i].mtime = table->list_state[i].mtime;
+    }
+
+    FILE* fp = fopen(tmp_filename.c_str(), "wb");
+
+    if ( !fp )
+    {
+        ErrorMessage("Unable to create compiled IP lists %s, Error: %s\n",
+            tmp_filename.c_str(), get_error(errno));
+        return false;
+    }
+
+    bool ok = fwrite(info.data(), 1, info.size(), fp) == info.size() and
+        fwrite(table->segment, 1, table->segment_used, fp) == table->segment_used;
+
+    if ( fclose(fp) )
+        ok = false;
+
+    if ( !ok or rename(tmp_filename.c_str(), full_path_filename) )
+    {
+        ErrorMessage("Unable to write compiled IP lists %s, Error: %s\n",
+            full_path_filename, get_error(errno));
+        unlink(tmp_filename.c_str());
+        return false;
+    }
+
+    LogMessage("    Saved compiled IP lists %s\n", full_path_filename);
+    return true;
+}
+
 void add_black_white_List(ReputationConfig* config)
 {
     if (config->blacklist_path.size())
@@ -959,3 +1356,74 @@ int read_manifest(const char* manifest_file, ReputationConfig* config)
     return 0;
 }
 
+#ifdef UNIT_TEST
+
+static std::string write_list(const char* dir, const char* name, const char* lines)
+{
+    std::string path = std::string(dir) + "/" + name;
+    FILE* fh = fopen(path.c_str(), "w");
+
+    if ( fh )
+    {
+        fputs(lines, fh);
+        fclose(fh);
+    }
+    return path;
+}
+
+static bool listed(const ReputationTable* table, const char* addr)
+{
+    SfIp ip;
+    ip.set(addr);
+    return sfrt_flat_dir8x_lookup(&ip, table->ip_list, table->segment) != nullptr;
+}
+
+TEST_CASE("lookup in mapped lists", "[Reputation]")
+{
+    char dir[] = "/tmp/reputation_XXXXXX";
+    REQUIRE(mkdtemp(dir));
+
+    std::string compiled = std::string(dir) + "/lists.bin";
+
+    ReputationConfig config;
+    config.memcap = 10;
+    config.blacklist_path = write_list(dir, "black.txt", "1.2.3.4\n10.0.0.0/8\n2001:db8::/32\n");
+    add_black_white_List(&config);
+    estimate_num_entries(&config);
+
+    ReputationTable* built = ip_list_init(config.num_entries + 1, &config);
+    REQUIRE(built);
+    CHECK(ip_list_save(compiled.c_str(), built, &config));
+
+    ReputationTable* mapped = ip_list_map(compiled.c_str(), &config);
+    REQUIRE(mapped);
+    delete built;
+
+    // building another table must not disturb lookups in the mapped one
+    ReputationConfig other_config;
+    other_config.memcap = 10;
+    other_config.blacklist_path = write_list(dir, "other.txt", "5.6.7.8\n");
+    add_black_white_List(&other_config);
+    estimate_num_entries(&other_config);
+
+    ReputationTable* other = ip_list_init(other_config.num_entries + 1, &other_config);
+    REQUIRE(other);
+
+    CHECK(listed(mapped, "1.2.3.4"));
+    CHECK(listed(mapped, "10.1.2.3"));
+    CHECK(listed(mapped, "2001:db8::1"));
+    CHECK(!listed(mapped, "5.6.7.8"));
+
+    CHECK(listed(other, "5.6.7.8"));
+    CHECK(!listed(other, "1.2.3.4"));
+
+    delete other;
+    delete mapped;
+
+    unlink(config.blacklist_path.c_str());
+    unlink(other_config.blacklist_path.c_str());
+    unlink(compiled.c_str());
+    rmdir(dir);
+}
+
+#endif
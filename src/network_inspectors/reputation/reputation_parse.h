@@ -24,7 +24,10 @@
 
 #define MANIFEST_FILENAME "zone.info"
 
-void ip_list_init(uint32_t,ReputationConfig *config);
+ReputationTable* ip_list_init(uint32_t,ReputationConfig *config);
+ReputationTable* ip_list_update(const ReputationTable*, ReputationConfig*, bool& changed);
+ReputationTable* ip_list_map(const char* filename, ReputationConfig*);
+bool ip_list_save(const char* filename, const ReputationTable*, const ReputationConfig*);
 void estimate_num_entries(ReputationConfig* config);
 int read_manifest(const char* filename, ReputationConfig* config);
 void add_black_white_List(ReputationConfig* config);
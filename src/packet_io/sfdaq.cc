@@ -234,7 +234,15 @@ bool SFDAQ::init(const SFDAQConfig* cfg, unsigned total_instances)
         return false;
     }
 
-    daq_config_set_msg_pool_size(daqcfg, cfg->get_batch_size() * 4);
+    // a dispatched input is one instance with a pool shared by all packet threads
+    unsigned pool_scale = 1;
+    if (cfg->dispatch)
+    {
+        pool_scale = total_instances;
+        total_instances = 1;
+    }
+
+    daq_config_set_msg_pool_size(daqcfg, cfg->get_batch_size() * 4 * pool_scale);
     daq_config_set_snaplen(daqcfg, cfg->get_mru_size());
     daq_config_set_timeout(daqcfg, cfg->timeout);
     if (total_instances > 1)
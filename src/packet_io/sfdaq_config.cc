@@ -128,4 +128,9 @@ void SFDAQConfig::overlay(const SFDAQConfig* other)
     if (other->mru_size != SNAPLEN_UNSET)
         mru_size = other->mru_size;
     timeout = other->timeout;
+
+    if (other->dispatch)
+        dispatch = true;
+    if (other->dispatch_ports)
+        dispatch_ports = true;
 }
@@ -71,6 +71,8 @@ struct SFDAQConfig
     uint32_t batch_size;
     int mru_size;
     unsigned int timeout;
+    bool dispatch = false;
+    bool dispatch_ports = false;
     std::vector<SFDAQModuleConfig*> module_configs;
 
     /* Constants */
@@ -239,6 +239,14 @@ void SFDAQInstance::get_tunnel_capabilities()
     }
 }
 
+// use another started instance's handle and datalink for capability queries
+void SFDAQInstance::share_instance(const SFDAQInstance& other)
+{
+    instance = other.instance;
+    dlt = other.dlt;
+    daq_tunnel_mask = other.daq_tunnel_mask;
+}
+
 bool SFDAQInstance::get_tunnel_bypass(uint16_t proto)
 {
     return (daq_tunnel_mask & proto) != 0;
@@ -314,7 +322,7 @@ int SFDAQInstance::modify_flow_opaque(DAQ_Msg_h msg, uint32_t opaque)
     d_sfo.msg = msg;
     d_sfo.value = opaque;
 
-    return daq_instance_ioctl(instance, DIOCTL_SET_FLOW_OPAQUE, &d_sfo, sizeof(d_sfo));
+    return ioctl(DIOCTL_SET_FLOW_OPAQUE, &d_sfo, sizeof(d_sfo));
 }
 
 int SFDAQInstance::set_packet_verdict_reason(DAQ_Msg_h msg, uint8_t verdict_reason)
@@ -324,7 +332,7 @@ int SFDAQInstance::set_packet_verdict_reason(DAQ_Msg_h msg, uint8_t verdict_reas
     d_spvr.msg = msg;
     d_spvr.verdict_reason = verdict_reason;
 
-    return daq_instance_ioctl(instance, DIOCTL_SET_PACKET_VERDICT_REASON, &d_spvr, sizeof(d_spvr));
+    return ioctl(DIOCTL_SET_PACKET_VERDICT_REASON, &d_spvr, sizeof(d_spvr));
 }
 
 int SFDAQInstance::set_packet_trace_data(DAQ_Msg_h msg, uint8_t* buff, uint32_t buff_len)
@@ -335,7 +343,7 @@ int SFDAQInstance::set_packet_trace_data(DAQ_Msg_h msg, uint8_t* buff, uint32_t
     d_sptd.trace_data_len = buff_len;
     d_sptd.trace_data = buff;
 
-    return daq_instance_ioctl(instance, DIOCTL_SET_PACKET_TRACE_DATA, &d_sptd, sizeof(d_sptd));
+    return ioctl(DIOCTL_SET_PACKET_TRACE_DATA, &d_sptd, sizeof(d_sptd));
 }
 
 // FIXIT-L X Add Snort flag definitions for callers to use and translate/pass them through to
@@ -401,5 +409,5 @@ int SFDAQInstance::add_expected(const Packet* ctrlPkt, const SfIp* cliIP, uint16
 
     daq_stats.expected_flows++;
 
-    return daq_instance_ioctl(instance, DIOCTL_CREATE_EXPECTED_FLOW, &d_cef, sizeof(d_cef));
+    return ioctl(DIOCTL_CREATE_EXPECTED_FLOW, &d_cef, sizeof(d_cef));
 }
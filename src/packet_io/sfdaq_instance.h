@@ -36,34 +36,37 @@ namespace snort
 struct Packet;
 struct SfIp;
 
+// the message and control paths are virtual so a dispatcher can stand in
+// front of a single instance shared by several packet threads
 class SFDAQInstance
 {
 public:
     SFDAQInstance(const char* intf, unsigned id, const SFDAQConfig*);
-    ~SFDAQInstance();
+    virtual ~SFDAQInstance();
 
     bool init(DAQ_Config_h, const std::string& bpf_string);
 
-    bool start();
-    bool was_started() const;
-    bool stop();
-    void reload();
+    virtual bool start();
+    virtual bool was_started() const;
+    virtual bool stop();
+    virtual void reload();
 
-    DAQ_RecvStatus receive_messages(unsigned max_recv);
+    virtual DAQ_RecvStatus receive_messages(unsigned max_recv);
     DAQ_Msg_h next_message()
     {
         if (curr_batch_idx < curr_batch_size)
             return daq_msgs[curr_batch_idx++];
         return nullptr;
     }
-    int finalize_message(DAQ_Msg_h msg, DAQ_Verdict verdict);
+    virtual int finalize_message(DAQ_Msg_h msg, DAQ_Verdict verdict);
     const char* get_error();
 
     int get_base_protocol() const;
     uint32_t get_batch_size() const { return batch_size; }
     uint32_t get_pool_available() const { return pool_available; }
+    uint32_t get_pool_size() const { return pool_size; }
     const char* get_input_spec() const;
-    const DAQ_Stats_t* get_stats();
+    virtual const DAQ_Stats_t* get_stats();
 
     bool can_inject() const;
     bool can_inject_raw() const;
@@ -71,10 +74,10 @@ public:
     bool can_start_unprivileged() const;
     SO_PUBLIC bool can_whitelist() const;
 
-    int inject(DAQ_Msg_h, int rev, const uint8_t* buf, uint32_t len);
-    bool interrupt();
+    virtual int inject(DAQ_Msg_h, int rev, const uint8_t* buf, uint32_t len);
+    virtual bool interrupt();
 
-    SO_PUBLIC int ioctl(DAQ_IoctlCmd cmd, void *arg, size_t arglen);
+    SO_PUBLIC virtual int ioctl(DAQ_IoctlCmd cmd, void *arg, size_t arglen);
     SO_PUBLIC int modify_flow_opaque(DAQ_Msg_h, uint32_t opaque);
     int set_packet_verdict_reason(DAQ_Msg_h msg, uint8_t verdict_reason);
     int set_packet_trace_data(DAQ_Msg_h, uint8_t* buff, uint32_t buff_len);
@@ -83,8 +86,9 @@ public:
             unsigned /* flags */);
     bool get_tunnel_bypass(uint16_t proto);
 
-private:
+protected:
     void get_tunnel_capabilities();
+    void share_instance(const SFDAQInstance&);
 
     std::string input_spec;
     uint32_t instance_id;
@@ -79,6 +79,8 @@ static const Parameter s_params[] =
     { "snaplen", Parameter::PT_INT, "0:65535", "1518", "set snap length (same as -s)" },
     { "batch_size", Parameter::PT_INT, "1:", "64", "set receive batch size (same as --daq-batch-size)" },
     { "modules", Parameter::PT_LIST, daq_module_param, nullptr, "DAQ modules to use" },
+    { "dispatch", Parameter::PT_BOOL, nullptr, "false", "distribute packets from a single DAQ instance to all packet threads by flow" },
+    { "dispatch_ports", Parameter::PT_BOOL, nullptr, "false", "include ports in the dispatch hash (fragmented flows may be split across packet threads)" },
 
     { nullptr, Parameter::PT_MAX, nullptr, nullptr, nullptr }
 };
@@ -122,6 +124,14 @@ bool SFDAQModule::set(const char* fqn, Value& v, SnortConfig*)
     {
         config->set_batch_size(v.get_long());
     }
+    else if (!strcmp(fqn, "daq.dispatch"))
+    {
+        config->dispatch = v.get_bool();
+    }
+    else if (!strcmp(fqn, "daq.dispatch_ports"))
+    {
+        config->dispatch_ports = v.get_bool();
+    }
     else if (!strcmp(fqn, "daq.modules.name"))
     {
         module_config->name = v.get_string();
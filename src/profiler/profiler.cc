@@ -25,11 +25,17 @@
 #include "profiler.h"
 
 #include <cassert>
+#include <sstream>
 
 #include "framework/module.h"
+#include "helpers/json_stream.h"
+#include "log/messages.h"
+#include "main/analyzer_command.h"
+#include "main/request.h"
 #include "main/snort_config.h"
 #include "main/thread_config.h"
 #include "time/stopwatch.h"
+#include "utils/stats.h"
 
 #include "memory_context.h"
 #include "memory_profiler.h"
@@ -49,8 +55,32 @@ THREAD_LOCAL ProfileStats otherPerfStats;
 THREAD_LOCAL TimeContext* ProfileContext::curr_time = nullptr;
 THREAD_LOCAL Stopwatch<SnortClock>* run_timer = nullptr;
 
+// packets analyzed before the last reset
+static THREAD_LOCAL uint64_t checks_base = 0;
+
+static THREAD_LOCAL unsigned sample_count = 0;
+static THREAD_LOCAL uint32_t sample_seed = 0;
+
 static ProfilerNodeMap s_profiler_nodes;
 
+// other is whatever total doesn't attribute to the top level modules
+static void set_other_stats(ProfilerNodeMap& nodes)
+{
+    const ProfilerNode& root = nodes.get_root();
+    auto children = root.get_children();
+
+    hr_duration runtime = root.get_stats().time.elapsed;
+    hr_duration sum = 0_ticks;
+
+    for ( auto pn : children )
+        sum += pn->get_stats().time.elapsed;
+
+    otherPerfStats.time.checks = root.get_stats().time.checks;
+    otherPerfStats.time.elapsed = (runtime > sum) ?  (runtime - sum) : 0_ticks;
+
+    nodes.accumulate_flex();
+}
+
 void Profiler::register_module(Module* m)
 {
     if ( m->get_profile() )
@@ -82,15 +112,62 @@ void Profiler::stop(uint64_t checks)
 {
     run_timer->stop();
     totalPerfStats.time.elapsed = run_timer->get();
-    totalPerfStats.time.checks = checks;
+    totalPerfStats.time.checks = checks - checks_base;
 
     delete run_timer;
     run_timer = nullptr;
 }
 
+static bool pick_random(unsigned sample)
+{
+    // xorshift32, seeded per thread so threads don't pick the same packets
+    if ( !sample_seed )
+        sample_seed = 0x9e3779b9 * (get_instance_id() + 1);
+
+    sample_seed ^= sample_seed << 13;
+    sample_seed ^= sample_seed >> 17;
+    sample_seed ^= sample_seed << 5;
+
+    return (sample_seed % sample) == 0;
+}
+
+void Profiler::sample()
+{
+    const ProfilerConfig* config = SnortConfig::get_conf()->get_profiler();
+
+    if ( config->sample <= 1 )
+    {
+        TimeProfilerStats::sampled = true;
+        return;
+    }
+
+    if ( config->sample_random )
+        TimeProfilerStats::sampled = pick_random(config->sample);
+
+    else
+    {
+        if ( ++sample_count >= config->sample )
+            sample_count = 0;
+
+        TimeProfilerStats::sampled = (sample_count == 0);
+    }
+}
+
+// other work is always picked at random; it comes in several kinds that
+// recur in fixed patterns, so every Nth could skip some of them entirely
+void Profiler::sample_other()
+{
+    const ProfilerConfig* config = SnortConfig::get_conf()->get_profiler();
+
+    if ( config->sample <= 1 )
+        TimeProfilerStats::sampled = true;
+    else
+        TimeProfilerStats::sampled = pick_random(config->sample);
+}
+
 void Profiler::consolidate_stats()
 {
-    s_profiler_nodes.accumulate_nodes();
+    s_profiler_nodes.accumulate_nodes(SnortConfig::get_conf()->get_profiler()->sample);
     MemoryProfiler::consolidate_fallthrough_stats();
 }
 
@@ -102,28 +179,135 @@ void Profiler::reset_stats()
 
 void Profiler::show_stats()
 {
-    const ProfilerNode& root = s_profiler_nodes.get_root();
-    auto children = root.get_children();
+    set_other_stats(s_profiler_nodes);
 
-    hr_duration runtime = root.get_stats().time.elapsed;
-    hr_duration sum = 0_ticks;
+    const auto* config = SnortConfig::get_conf()->get_profiler();
+    assert(config);
 
-    for ( auto pn : children )
-        sum += pn->get_stats().time.elapsed;
+    show_time_profiler_stats(s_profiler_nodes, config->time);
+    show_memory_profiler_stats(s_profiler_nodes, config->memory);
+    show_rule_profiler_stats(config->rule);
+}
 
-    otherPerfStats.time.checks = root.get_stats().time.checks;
-    otherPerfStats.time.elapsed = (runtime > sum) ?  (runtime - sum) : 0_ticks;
+//-------------------------------------------------------------------------
+// live snapshots
+//-------------------------------------------------------------------------
 
-    s_profiler_nodes.accumulate_flex();
+class ACProfilerShow : public AnalyzerCommand
+{
+public:
+    ACProfilerShow(Request& req, bool from_shell, bool json) :
+        request(req), from_shell(from_shell), json(json)
+    { nodes.clone_nodes(s_profiler_nodes); }
+
+    bool execute(Analyzer&, void**) override;
+    const char* stringify() override { return "PROFILER_SHOW"; }
+    ~ACProfilerShow() override;
+
+private:
+    ProfilerNodeMap nodes;
+    RuleProfilerSnapshot rules;
+    Request& request;
+    bool from_shell;
+    bool json;
+};
+
+bool ACProfilerShow::execute(Analyzer&, void**)
+{
+    if ( run_timer )
+    {
+        totalPerfStats.time.elapsed = run_timer->get();
+        totalPerfStats.time.checks = pc.analyzed_pkts - checks_base;
+    }
+    nodes.accumulate_nodes(SnortConfig::get_conf()->get_profiler()->sample);
+    rules.add_thread_states();
+    return true;
+}
 
+ACProfilerShow::~ACProfilerShow()
+{
     const auto* config = SnortConfig::get_conf()->get_profiler();
     assert(config);
 
-    show_time_profiler_stats(s_profiler_nodes, config->time);
-    show_memory_profiler_stats(s_profiler_nodes, config->memory);
-    show_rule_profiler_stats(config->rule);
+    set_other_stats(nodes);
+
+    // this thread's other is recomputed at exit
+    otherPerfStats.reset();
+
+    std::ostringstream ss;
+
+    if ( json )
+    {
+        JsonStream js(ss);
+        js.open();
+
+        if ( config->time.show )
+        {
+            js.open_array("modules");
+            json_time_profiler_stats(nodes, config->time, js);
+            js.close_array();
+        }
+        if ( config->rule.show )
+            rules.json(config->rule, js);
+
+        js.close();
+    }
+    else
+    {
+        show_time_profiler_stats(nodes, config->time, &ss);
+
+        if ( config->rule.show )
+            rules.show(config->rule, ss);
+    }
+
+    if ( ss.str().empty() )
+        ss << "== no profiler stats\n";
+
+    request.respond(ss.str().c_str(), from_shell);
+}
+
+class ACProfilerReset : public AnalyzerCommand
+{
+public:
+    ACProfilerReset(Request& req, bool from_shell) :
+        request(req), from_shell(from_shell) { }
+
+    bool execute(Analyzer&, void**) override;
+    const char* stringify() override { return "PROFILER_RESET"; }
+    ~ACProfilerReset() override;
+
+private:
+    RuleProfilerSnapshot rules;
+    Request& request;
+    bool from_shell;
+};
+
+bool ACProfilerReset::execute(Analyzer&, void**)
+{
+    s_profiler_nodes.reset_local_nodes();
+    rules.reset_thread_states();
+
+    if ( run_timer )
+    {
+        run_timer->reset();
+        run_timer->start();
+    }
+    checks_base = pc.analyzed_pkts;
+    return true;
 }
 
+ACProfilerReset::~ACProfilerReset()
+{
+    LogMessage("== profiler stats reset\n");
+    request.respond("== profiler stats reset\n", from_shell, true);
+}
+
+void Profiler::show_snapshot(Request& req, bool from_shell, bool json)
+{ main_broadcast_command(new ACProfilerShow(req, from_shell, json), from_shell); }
+
+void Profiler::reset_snapshot(Request& req, bool from_shell)
+{ main_broadcast_command(new ACProfilerReset(req, from_shell), from_shell); }
+
 #ifdef UNIT_TEST
 
 TEST_CASE( "profile stats", "[profiler]" )
@@ -24,6 +24,8 @@
 #include "main/thread.h"
 #include "profiler_defs.h"
 
+class Request;
+
 namespace snort
 {
 class Module;
@@ -38,10 +40,21 @@ public:
     static void start();
     static void stop(uint64_t);
 
+    // called by packet threads for each packet to select sampled packets
+    static void sample();
+
+    // called by packet threads before other work (timeouts, idle, onloads,
+    // commands) so it is sampled on its own rather than with the last packet
+    static void sample_other();
+
     static void consolidate_stats();
 
     static void reset_stats();
     static void show_stats();
+
+    // live stats from running packet threads; reset starts a new window
+    static void show_snapshot(Request&, bool from_shell, bool json);
+    static void reset_snapshot(Request&, bool from_shell);
 };
 
 extern THREAD_LOCAL snort::ProfileStats totalPerfStats;
@@ -38,6 +38,10 @@ struct ProfilerConfig
     TimeProfilerConfig time;
     RuleProfilerConfig rule;
     MemoryProfilerConfig memory;
+
+    // time and rule contexts run on 1 of every sample packets
+    unsigned sample = 1;
+    bool sample_random = false;
 };
 
 struct SO_PUBLIC ProfileStats
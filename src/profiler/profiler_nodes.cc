@@ -46,7 +46,7 @@ struct GetProfileFunctor
     GetProfileFunctor(const std::string& name) : name(name) { }
 
     virtual ~GetProfileFunctor() = default;
-    virtual const ProfileStats* operator()() = 0;
+    virtual ProfileStats* operator()() = 0;
 
     const std::string name;
 };
@@ -56,10 +56,10 @@ struct GetProfileFromModule : public GetProfileFunctor
     GetProfileFromModule(const std::string& pn, Module* m) :
         GetProfileFunctor(pn), m(m) { }
 
-    const ProfileStats* operator()() override
+    ProfileStats* operator()() override
     {
         // const auto *ps = m->get_profiler_stats();
-        const auto *ps = m->get_profile();
+        auto *ps = m->get_profile();
         if ( ps )
             return ps;
 
@@ -79,7 +79,7 @@ struct GetProfileFromFunction : public GetProfileFunctor
     GetProfileFromFunction(const std::string& pn, get_profile_stats_fn fn) :
         GetProfileFunctor(pn), fn(fn) { }
 
-    const ProfileStats* operator()() override
+    ProfileStats* operator()() override
     { return fn(name.c_str()); }
 
     get_profile_stats_fn fn;
@@ -108,7 +108,7 @@ void ProfilerNode::set(Module* m)
 void ProfilerNode::set(get_profile_stats_fn fn)
 { getter = std::make_shared<GetProfileFromFunction>(name, fn); }
 
-void ProfilerNode::accumulate()
+void ProfilerNode::accumulate(unsigned scale)
 {
     if ( is_set() )
     {
@@ -119,19 +119,56 @@ void ProfilerNode::accumulate()
 
         get_stats();
         stats += *local_stats;
+
+        // memory stats are not sampled
+        if ( scale > 1 )
+        {
+            stats.time.elapsed += local_stats->time.elapsed * (scale - 1);
+            stats.time.checks += local_stats->time.checks * (scale - 1);
+        }
+    }
+}
+
+void ProfilerNode::reset_local()
+{
+    if ( is_set() )
+    {
+        auto* local_stats = (*getter)();
+
+        // memory stats track usage so only time is windowed
+        if ( local_stats )
+            local_stats->time.reset();
     }
 }
 
 void ProfilerNodeMap::register_node(const std::string &n, const char* pn, Module* m)
 { setup_node(get_node(n), get_node(pn ? pn : ROOT_NODE), m); }
 
-void ProfilerNodeMap::accumulate_nodes()
+void ProfilerNodeMap::clone_nodes(const ProfilerNodeMap& other)
+{
+    for ( const auto& it : other.nodes )
+    {
+        ProfilerNode& node = get_node(it.first);
+
+        if ( it.second.is_set() )
+            node.set(it.second);
+
+        for ( auto* child : it.second.get_children() )
+            node.add_child(&get_node(child->name));
+    }
+}
+
+// total is measured on every packet and other is derived from it
+void ProfilerNodeMap::accumulate_nodes(unsigned scale)
 {
     static std::mutex stats_mutex;
     std::lock_guard<std::mutex> lock(stats_mutex);
 
     for ( auto it = nodes.begin(); it != nodes.end(); ++it )
-        it->second.accumulate();
+    {
+        bool exact = it->first == ROOT_NODE or it->first == FLEX_NODE;
+        it->second.accumulate(exact ? 1 : scale);
+    }
 }
 
 void ProfilerNodeMap::accumulate_flex()
@@ -148,6 +185,12 @@ void ProfilerNodeMap::reset_nodes()
         it->second.reset();
 }
 
+void ProfilerNodeMap::reset_local_nodes()
+{
+    for ( auto it = nodes.begin(); it != nodes.end(); ++it )
+        it->second.reset_local();
+}
+
 const ProfilerNode& ProfilerNodeMap::get_root()
 { return get_node(ROOT_NODE); }
 
@@ -271,6 +314,18 @@ TEST_CASE( "profiler node", "[profiler]" )
         CHECK( (result.time.checks == 2) );
     }
 
+    SECTION( "accumulate scaled" )
+    {
+        the_stats.time = { 2_ticks, 1 };
+
+        node.accumulate(10);
+
+        auto& result = node.get_stats();
+
+        CHECK( (result.time.elapsed == 20_ticks) );
+        CHECK( (result.time.checks == 10) );
+    }
+
     SECTION( "reset" )
     {
         the_stats.time = { 1_ticks, 1 };
@@ -284,6 +339,17 @@ TEST_CASE( "profiler node", "[profiler]" )
         auto& r2 = node.get_stats();
         CHECK( r2 == ProfileStats() );
     }
+
+    SECTION( "reset local" )
+    {
+        the_stats.time = { 1_ticks, 1 };
+
+        node.accumulate();
+        node.reset_local();
+
+        CHECK( !the_stats.time );
+        CHECK( node.get_stats() != ProfileStats() );
+    }
 }
 
 TEST_CASE( "profiler node map", "[profiler]" )
@@ -329,6 +395,30 @@ TEST_CASE( "profiler node map", "[profiler]" )
     {
         CHECK( tree.get_root().name == ROOT_NODE );
     }
+
+    SECTION( "clone" )
+    {
+        ProfileStats stats;
+        SpyModule m("foo", &stats, false);
+
+        tree.register_node("foo", "bar", &m);
+        stats.time = { 3_ticks, 3 };
+        tree.accumulate_nodes();
+
+        ProfilerNodeMap copy;
+        copy.clone_nodes(tree);
+
+        auto node = find_node(copy, "bar");
+        CHECK( !node.get_children().empty() );
+        CHECK( node.get_children().front()->name == "foo" );
+
+        auto foo = find_node(copy, "foo");
+        CHECK( foo.is_set() );
+        CHECK( foo.get_stats() == ProfileStats() );
+
+        copy.accumulate_nodes();
+        CHECK( find_node(copy, "foo").get_stats() == stats );
+    }
 }
 
 #endif
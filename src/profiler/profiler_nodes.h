@@ -42,12 +42,18 @@ public:
 
     void set(snort::Module* m);
     void set(snort::get_profile_stats_fn fn);
+    void set(const ProfilerNode& n)
+    { getter = n.getter; }
 
     bool is_set() const
     { return bool(getter); }
 
     // thread local call
-    void accumulate();
+    // scale > 1 estimates full time stats from sampled packets
+    void accumulate(unsigned scale = 1);
+
+    // thread local call; clears time stats only
+    void reset_local();
 
     const snort::ProfileStats& get_stats() const
     { return stats; }
@@ -91,10 +97,16 @@ public:
 
     void register_node(const std::string&, const char*, snort::Module*);
 
-    void accumulate_nodes();
+    // same nodes with zeroed stats, for live snapshots
+    void clone_nodes(const ProfilerNodeMap&);
+
+    void accumulate_nodes(unsigned scale = 1);
     void accumulate_flex();
     void reset_nodes();
 
+    // thread local call
+    void reset_local_nodes();
+
     const ProfilerNode& get_root();
 
 private:
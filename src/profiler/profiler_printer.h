@@ -62,8 +62,10 @@ public:
     using Sorter = ProfilerSorter<View>;
     using PrintFn = std::function<void(StatsTable&, const View&)>;
 
-    ProfilerPrinter(const StatsTable::Field* fields, const PrintFn print, const Sorter& sort) :
-        fields(fields), print(print), sort(sort) { }
+    // rows are logged unless an output stream is given
+    ProfilerPrinter(const StatsTable::Field* fields, const PrintFn print, const Sorter& sort,
+        std::ostream* out = nullptr) :
+        fields(fields), print(print), sort(sort), out(out) { }
 
     void print_table(const std::string& title, Entry& root, unsigned count, int max_depth = -1)
     {
@@ -91,7 +93,7 @@ public:
             table << StatsTable::HEADER;
         }
 
-        snort::LogMessage("%s", ss.str().c_str());
+        emit(ss);
 
         print_recursive(root, root, 1, count, max_depth);
         print_row(root, root, 0, 0);
@@ -165,13 +167,22 @@ public:
             }
         }
 
-        snort::LogMessage("%s", ss.str().c_str());
+        emit(ss);
     }
 
 private:
+    void emit(const std::ostringstream& ss)
+    {
+        if ( out )
+            *out << ss.str();
+        else
+            snort::LogMessage("%s", ss.str().c_str());
+    }
+
     const StatsTable::Field* fields;
     const PrintFn print;
     const Sorter& sort;
+    std::ostream* out;
     float total = 0;
 };
 
@@ -27,7 +27,9 @@
 #include <algorithm>
 #include <functional>
 #include <iostream>
+#include <mutex>
 #include <sstream>
+#include <unordered_map>
 #include <vector>
 
 // this include eventually leads to possible issues with std::chrono:
@@ -38,7 +40,11 @@
 
 #include "detection/treenodes.h"
 #include "hash/ghash.h"
+#include "hash/hash_defs.h"
+#include "hash/xhash.h"
+#include "helpers/json_stream.h"
 #include "main/snort_config.h"
+#include "main/thread.h"
 #include "main/thread_config.h"
 #include "parser/parser.h"
 #include "target_based/snort_protocols.h"
@@ -186,6 +192,23 @@ static const ProfilerSorter<View> sorters[] =
     }
 };
 
+// times and checks come from sampled packets; matches, alerts, and
+// latency counts are taken on every packet
+static OtnState scale_state(const OtnState& state)
+{
+    unsigned scale = SnortConfig::get_conf()->get_profiler()->sample;
+
+    if ( scale <= 1 )
+        return state;
+
+    OtnState s = state;
+    s.elapsed *= scale;
+    s.elapsed_match *= scale;
+    s.elapsed_no_match *= scale;
+    s.checks *= scale;
+    return s;
+}
+
 static void consolidate_otn_states(OtnState* states)
 {
     for ( unsigned i = 1; i < ThreadConfig::get_instance_max(); ++i )
@@ -216,14 +239,22 @@ static std::vector<View> build_entries()
             continue;
 
         // FIXIT-L should we assert(otn->sigInfo)?
-        entries.emplace_back(state, &otn->sigInfo);
+        entries.emplace_back(scale_state(state), &otn->sigInfo);
     }
 
     return entries;
 }
 
+static void emit(std::ostream* out, const std::ostringstream& ss)
+{
+    if ( out )
+        *out << ss.str();
+    else
+        LogMessage("%s", ss.str().c_str());
+}
+
 // FIXIT-L logic duplicated from ProfilerPrinter
-static void print_single_entry(const View& v, unsigned n)
+static void print_single_entry(const View& v, unsigned n, std::ostream* out)
 {
     using std::chrono::duration_cast;
     using std::chrono::microseconds;
@@ -254,11 +285,12 @@ static void print_single_entry(const View& v, unsigned n)
         table << v.suspends();
     }
 
-    LogMessage("%s", ss.str().c_str());
+    emit(out, ss);
 }
 
 // FIXIT-L logic duplicated from ProfilerPrinter
-static void print_entries(std::vector<View>& entries, ProfilerSorter<View>& sort, unsigned count)
+static void print_entries(std::vector<View>& entries, ProfilerSorter<View>& sort, unsigned count,
+    std::ostream* out = nullptr)
 {
     std::ostringstream ss;
 
@@ -281,7 +313,7 @@ static void print_entries(std::vector<View>& entries, ProfilerSorter<View>& sort
         table << StatsTable::HEADER;
     }
 
-    LogMessage("%s", ss.str().c_str());
+    emit(out, ss);
 
     if ( !count || count > entries.size() )
         count = entries.size();
@@ -290,7 +322,40 @@ static void print_entries(std::vector<View>& entries, ProfilerSorter<View>& sort
         std::partial_sort(entries.begin(), entries.begin() + count, entries.end(), sort);
 
     for ( unsigned i = 0; i < count; ++i )
-        print_single_entry(entries[i], i + 1);
+        print_single_entry(entries[i], i + 1, out);
+}
+
+static void json_entries(std::vector<View>& entries, ProfilerSorter<View>& sort, unsigned count,
+    JsonStream& json)
+{
+    if ( !count || count > entries.size() )
+        count = entries.size();
+
+    if ( sort )
+        std::partial_sort(entries.begin(), entries.begin() + count, entries.end(), sort);
+
+    json.open_array("rules");
+
+    for ( unsigned i = 0; i < count; ++i )
+    {
+        const View& v = entries[i];
+
+        json.open();
+        json.put("gid", v.sig_info.gid);
+        json.put("sid", v.sig_info.sid);
+        json.put("rev", v.sig_info.rev);
+        json.put("checks", v.checks());
+        json.put("matches", v.matches());
+        json.put("alerts", v.alerts());
+        json.put("time_us", clock_usecs(TO_USECS(v.elapsed())));
+        json.put("avg_check_us", clock_usecs(TO_USECS(v.avg_check())));
+        json.put("avg_match_us", clock_usecs(TO_USECS(v.avg_match())));
+        json.put("avg_no_match_us", clock_usecs(TO_USECS(v.avg_no_match())));
+        json.put("timeouts", v.timeouts());
+        json.put("suspends", v.suspends());
+        json.close();
+    }
+    json.close_array();
 }
 
 }
@@ -337,9 +402,235 @@ void reset_rule_profiler_stats()
     }
 }
 
+//-------------------------------------------------------------------------
+// live snapshots
+//-------------------------------------------------------------------------
+
+struct RuleProfilerSnapshot::Data
+{
+    struct Node
+    {
+        detection_option_tree_node_t* node;
+        std::vector<unsigned> children;
+        int rule = -1;
+        OtnState totals;  // summed over packet threads
+    };
+
+    std::vector<OptTreeNode*> otns;
+    std::vector<SigInfo> sigs;
+    std::vector<OtnState> rules;  // summed over packet threads
+
+    std::vector<Node> nodes;
+    std::vector<unsigned> tops;
+
+    std::unordered_map<OptTreeNode*, unsigned> rule_map;
+    std::unordered_map<detection_option_tree_node_t*, unsigned> node_map;
+
+    std::mutex mutex;
+    bool folded = false;
+
+    unsigned add_node(detection_option_tree_node_t*);
+    void fold(unsigned idx, const OtnState* parent, const OtnState& top);
+    std::vector<rule_stats::View> build_entries();
+};
+
+unsigned RuleProfilerSnapshot::Data::add_node(detection_option_tree_node_t* node)
+{
+    auto it = node_map.find(node);
+
+    if ( it != node_map.end() )
+        return it->second;
+
+    unsigned idx = nodes.size();
+    node_map[node] = idx;
+    nodes.emplace_back();
+    nodes[idx].node = node;
+
+    if ( node->option_type == RULE_OPTION_TYPE_LEAF_NODE )
+    {
+        auto r = rule_map.find((OptTreeNode*)node->option_data);
+
+        if ( r != rule_map.end() )
+            nodes[idx].rule = r->second;
+    }
+
+    for ( int i = 0; i < node->num_children; ++i )
+    {
+        unsigned child = add_node(node->children[i]);
+        nodes[idx].children.emplace_back(child);
+    }
+    return idx;
+}
+
+// same as detection_option_node_update_otn_stats() but from the snapshot
+void RuleProfilerSnapshot::Data::fold(unsigned idx, const OtnState* parent, const OtnState& top)
+{
+    const OtnState& node_stats = nodes[idx].totals;
+    OtnState local_stats;
+
+    local_stats.elapsed = node_stats.elapsed;
+    local_stats.elapsed_match = node_stats.elapsed_match;
+    local_stats.elapsed_no_match = node_stats.elapsed_no_match;
+    local_stats.checks = node_stats.checks;
+
+    if ( parent )
+    {
+        local_stats.elapsed += parent->elapsed;
+        local_stats.elapsed_match += parent->elapsed_match;
+        local_stats.elapsed_no_match += parent->elapsed_no_match;
+
+        if ( parent->checks > local_stats.checks )
+            local_stats.checks = parent->checks;
+    }
+
+    if ( nodes[idx].rule >= 0 )
+    {
+        auto& state = rules[nodes[idx].rule];
+
+        state.elapsed += local_stats.elapsed;
+        state.elapsed_match += local_stats.elapsed_match;
+        state.elapsed_no_match += local_stats.elapsed_no_match;
+
+        if ( local_stats.checks > state.checks )
+            state.checks = local_stats.checks;
+
+        state.latency_timeouts += top.latency_timeouts;
+        state.latency_suspends += top.latency_suspends;
+    }
+
+    for ( auto child : nodes[idx].children )
+        fold(child, &local_stats, top);
+}
+
+std::vector<rule_stats::View> RuleProfilerSnapshot::Data::build_entries()
+{
+    if ( !folded )
+    {
+        for ( auto top : tops )
+        {
+            if ( nodes[top].totals.checks )
+                fold(top, nullptr, nodes[top].totals);
+        }
+        folded = true;
+    }
+
+    std::vector<rule_stats::View> entries;
+
+    for ( unsigned i = 0; i < rules.size(); ++i )
+    {
+        if ( rules[i] )
+            entries.emplace_back(rule_stats::scale_state(rules[i]), &sigs[i]);
+    }
+    return entries;
+}
+
+RuleProfilerSnapshot::RuleProfilerSnapshot()
+{
+    const SnortConfig* sc = SnortConfig::get_conf();
+    assert(sc);
+
+    data = new Data;
+
+    auto* otn_map = sc->otn_map;
+
+    for ( auto* h = otn_map->find_first(); h; h = otn_map->find_next() )
+    {
+        auto* otn = static_cast<OptTreeNode*>(h->data);
+        assert(otn);
+
+        // only the ids are shown
+        SigInfo si;
+        si.gid = otn->sigInfo.gid;
+        si.sid = otn->sigInfo.sid;
+        si.rev = otn->sigInfo.rev;
+
+        data->rule_map[otn] = data->otns.size();
+        data->otns.emplace_back(otn);
+        data->sigs.emplace_back(si);
+    }
+    data->rules.resize(data->otns.size());
+
+    if ( XHash* doth = sc->detection_option_tree_hash_table )
+    {
+        for ( auto hnode = doth->find_first_node(); hnode; hnode = doth->find_next_node() )
+        {
+            auto* node = (detection_option_tree_node_t*)hnode->data;
+            assert(node);
+            data->tops.emplace_back(data->add_node(node));
+        }
+    }
+}
+
+RuleProfilerSnapshot::~RuleProfilerSnapshot()
+{ delete data; }
+
+void RuleProfilerSnapshot::add_thread_states()
+{
+    unsigned id = get_instance_id();
+    std::lock_guard<std::mutex> lock(data->mutex);
+
+    for ( unsigned i = 0; i < data->otns.size(); ++i )
+    {
+        const OtnState& state = data->otns[i]->state[id];
+        data->rules[i].matches += state.matches;
+        data->rules[i].alerts += state.alerts;
+    }
+
+    for ( auto& n : data->nodes )
+    {
+        const dot_node_state_t& state = n.node->state[id];
+
+        n.totals.elapsed += state.elapsed;
+        n.totals.elapsed_match += state.elapsed_match;
+        n.totals.elapsed_no_match += state.elapsed_no_match;
+        n.totals.checks += state.checks;
+        n.totals.latency_timeouts += state.latency_timeouts;
+        n.totals.latency_suspends += state.latency_suspends;
+    }
+}
+
+void RuleProfilerSnapshot::reset_thread_states()
+{
+    unsigned id = get_instance_id();
+
+    for ( auto* otn : data->otns )
+        otn->state[id] = OtnState();
+
+    // keep the cached results, only the profiling data is cleared
+    for ( auto& n : data->nodes )
+    {
+        dot_node_state_t& state = n.node->state[id];
+
+        state.elapsed = 0_ticks;
+        state.elapsed_match = 0_ticks;
+        state.elapsed_no_match = 0_ticks;
+        state.checks = 0;
+        state.latency_timeouts = 0;
+        state.latency_suspends = 0;
+    }
+}
+
+void RuleProfilerSnapshot::show(const RuleProfilerConfig& config, std::ostream& out)
+{
+    auto entries = data->build_entries();
+
+    if ( entries.empty() )
+        return;
+
+    auto sort = rule_stats::sorters[config.sort];
+    print_entries(entries, sort, config.count, &out);
+}
+
+void RuleProfilerSnapshot::json(const RuleProfilerConfig& config, JsonStream& json)
+{
+    auto entries = data->build_entries();
+    auto sort = rule_stats::sorters[config.sort];
+    json_entries(entries, sort, config.count, json);
+}
+
 void RuleContext::stop(bool match)
 {
-    if ( !enabled or finished )
+    if ( !on or finished )
         return;
 
     finished = true;
@@ -21,9 +21,33 @@
 #ifndef RULE_PROFILER_H
 #define RULE_PROFILER_H
 
+#include <iosfwd>
+
+class JsonStream;
 struct RuleProfilerConfig;
 
 void show_rule_profiler_stats(const RuleProfilerConfig&);
 void reset_rule_profiler_stats();
 
+// live snapshot of rule stats.  the main thread lists the rules and option
+// tree nodes, each packet thread adds or resets its own states, and the
+// main thread folds the option trees into per rule totals.
+class RuleProfilerSnapshot
+{
+public:
+    RuleProfilerSnapshot();
+    ~RuleProfilerSnapshot();
+
+    // packet thread calls
+    void add_thread_states();
+    void reset_thread_states();
+
+    void show(const RuleProfilerConfig&, std::ostream&);
+    void json(const RuleProfilerConfig&, JsonStream&);
+
+private:
+    struct Data;
+    Data* data;
+};
+
 #endif
@@ -24,6 +24,8 @@
 #include "time/clock_defs.h"
 #include "time/stopwatch.h"
 
+#include "time_profiler_defs.h"
+
 struct dot_node_state_t;
 
 struct RuleProfilerConfig
@@ -48,22 +50,26 @@ class RuleContext
 {
 public:
     RuleContext(dot_node_state_t& stats) :
-        stats(stats)
+        stats(stats), on(enabled and snort::TimeProfilerStats::sampled)
     { start(); }
 
     ~RuleContext()
     { stop(); }
 
     void start()
-    { if ( enabled ) sw.start(); }
+    { if ( on ) sw.start(); }
 
     void pause()
-    { if ( enabled ) sw.stop(); }
+    { if ( on ) sw.stop(); }
 
     void stop(bool = false);
 
     bool active() const
-    { return enabled and sw.active(); }
+    { return on and sw.active(); }
+
+    // false if rule profiling is off or the packet isn't sampled
+    bool is_on() const
+    { return on; }
 
     static void set_enabled(bool b)
     { enabled = b; }
@@ -71,6 +77,7 @@ public:
 private:
     dot_node_state_t& stats;
     Stopwatch<SnortClock> sw;
+    bool on;
     bool finished = false;
     static bool enabled;
 };
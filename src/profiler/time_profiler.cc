@@ -24,6 +24,8 @@
 
 #include "time_profiler.h"
 
+#include "helpers/json_stream.h"
+
 #include "profiler_nodes.h"
 #include "profiler_tree_builder.h"
 #include "profiler_printer.h"
@@ -42,6 +44,7 @@ using namespace snort;
 // enabled is not in TimeContext because declaring it SO_PUBLIC made TimeContext visible
 // putting enabled in TimeProfilerStats seems to be the best solution
 bool TimeProfilerStats::enabled = false;
+THREAD_LOCAL bool TimeProfilerStats::sampled = true;
 
 namespace time_stats
 {
@@ -140,9 +143,40 @@ static void print_fn(StatsTable& t, const View& v)
     t << clock_usecs(TO_USECS(v.avg_check()));
 }
 
+using Entry = ProfilerBuilder<View>::Entry;
+
+static void json_entry(JsonStream& json, Entry& entry, const ProfilerSorter<View>& sort,
+    unsigned count, int max_depth, int layer)
+{
+    json.open();
+    json.put("module", entry.view.name);
+    json.put("checks", entry.view.checks());
+    json.put("time_us", clock_usecs(TO_USECS(entry.view.elapsed())));
+    json.put("avg_check_us", clock_usecs(TO_USECS(entry.view.avg_check())));
+
+    auto& children = entry.children;
+
+    if ( !children.empty() and (max_depth < 0 or layer < max_depth) )
+    {
+        unsigned n = (!count or count > children.size()) ? children.size() : count;
+
+        if ( sort )
+            std::partial_sort(children.begin(), children.begin() + n, children.end(), sort);
+
+        json.open_array("children");
+
+        for ( unsigned i = 0; i < n; ++i )
+            json_entry(json, children[i], sort, count, max_depth, layer + 1);
+
+        json.close_array();
+    }
+    json.close();
+}
+
 } // namespace time_stats
 
-void show_time_profiler_stats(ProfilerNodeMap& nodes, const TimeProfilerConfig& config)
+void show_time_profiler_stats(ProfilerNodeMap& nodes, const TimeProfilerConfig& config,
+    std::ostream* out)
 {
     if ( !config.show )
         return;
@@ -155,10 +189,21 @@ void show_time_profiler_stats(ProfilerNodeMap& nodes, const TimeProfilerConfig&
 
     const auto& sorter = time_stats::sorters[config.sort];
 
-    ProfilerPrinter<time_stats::View> printer(time_stats::fields, time_stats::print_fn, sorter);
+    ProfilerPrinter<time_stats::View> printer(time_stats::fields, time_stats::print_fn, sorter,
+        out);
     printer.print_table(s_time_table_title, root, config.count, config.max_depth);
 }
 
+void json_time_profiler_stats(ProfilerNodeMap& nodes, const TimeProfilerConfig& config,
+    JsonStream& json)
+{
+    ProfilerBuilder<time_stats::View> builder(time_stats::include_fn);
+    auto root = builder.build(nodes.get_root());
+
+    const auto& sorter = time_stats::sorters[config.sort];
+    time_stats::json_entry(json, root, sorter, config.count, config.max_depth, 0);
+}
+
 #ifdef UNIT_TEST
 
 namespace
@@ -588,6 +633,20 @@ TEST_CASE( "time profiler time context", "[profiler][time_profiler]" )
         CHECK( stats.ref_count == 0 ); // ref_count restored
         CHECK( stats.checks == 1 ); // only updated once
     }
+
+    SECTION( "not sampled" )
+    {
+        TimeProfilerStats::sampled = false;
+        {
+            TimeContext ctx(stats);
+            CHECK( stats.ref_count == 0 );
+
+            // sampling is fixed at entry
+            TimeProfilerStats::sampled = true;
+        }
+        CHECK( stats.ref_count == 0 );
+        CHECK_FALSE( stats );
+    }
 }
 
 TEST_CASE( "time context exclude", "[profiler][time_profiler]" )
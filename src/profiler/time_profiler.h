@@ -21,9 +21,16 @@
 #ifndef TIME_PROFILER_H
 #define TIME_PROFILER_H
 
+#include <iosfwd>
+
+class JsonStream;
 class ProfilerNodeMap;
 struct TimeProfilerConfig;
 
-void show_time_profiler_stats(ProfilerNodeMap&, const TimeProfilerConfig&);
+// logs the table unless an output stream is given
+void show_time_profiler_stats(ProfilerNodeMap&, const TimeProfilerConfig&,
+    std::ostream* = nullptr);
+
+void json_time_profiler_stats(ProfilerNodeMap&, const TimeProfilerConfig&, JsonStream&);
 
 #endif
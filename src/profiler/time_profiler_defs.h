@@ -22,6 +22,7 @@
 #define TIME_PROFILER_DEFS_H
 
 #include "main/snort_types.h"
+#include "main/thread.h"
 #include "time/clock_defs.h"
 #include "time/stopwatch.h"
 
@@ -49,11 +50,14 @@ struct SO_PUBLIC TimeProfilerStats
     mutable unsigned int ref_count;
     static bool enabled;
 
+    // cleared for packets skipped by sampled profiling
+    static THREAD_LOCAL bool sampled;
+
     static void set_enabled(bool b)
     { enabled = b; }
 
     static bool is_enabled()
-    { return enabled; }
+    { return enabled and sampled; }
 
     void update(hr_duration delta)
     { elapsed += delta; ++checks; }
@@ -94,23 +98,24 @@ inline TimeProfilerStats& operator+=(TimeProfilerStats& lhs, const TimeProfilerS
 class TimeContext
 {
 public:
+    // sampling is fixed at entry so the ref count stays balanced
     TimeContext(TimeProfilerStats& stats) :
-        stats(stats)
+        stats(stats), on(stats.is_enabled())
     {
-        if ( stats.is_enabled() and stats.enter() )
+        if ( on and stats.enter() )
             sw.start();
     }
 
     ~TimeContext()
     {
-        if ( stats.is_enabled() )
+        if ( on )
             stop();
     }
 
     // Use this for finer grained control of the TimeContext "lifetime"
     void stop()
     {
-        if ( !stats.is_enabled() or stopped_once )
+        if ( !on or stopped_once )
             return; // stop() should only be executed once per context
 
         stopped_once = true;
@@ -132,6 +137,7 @@ public:
 private:
     TimeProfilerStats& stats;
     Stopwatch<SnortClock> sw;
+    bool on;
     bool stopped_once = false;
 };
 
@@ -24,6 +24,7 @@
 #include "packet_manager.h"
 
 #include <daq.h>
+#include <cstring>
 #include <mutex>
 
 #include "codecs/codec_module.h"
@@ -40,6 +41,13 @@
 #include "eth.h"
 #include "icmp4.h"
 #include "icmp6.h"
+#include "vlan.h"
+
+#ifdef UNIT_TEST
+#include <chrono>
+
+#include "catch/snort_catch.h"
+#endif
 
 using namespace snort;
 
@@ -56,14 +64,15 @@ CodecManager::s_protocols.size()> PacketManager::s_stats {
 //PacketManager::s_stats{{0}};
 std::array<PegCount, PacketManager::s_stats.size()> PacketManager::g_stats;
 
-// names which will be printed for the first three statistics
+// names which will be printed for the first four statistics
 // in s_stats/g_stats
 const std::array<const char*, PacketManager::stat_offset> PacketManager::stat_names =
 {
     {
         "total",
         "other",
-        "discards"
+        "discards",
+        "fast_path"
     }
 };
 
@@ -71,9 +80,33 @@ const std::array<const char*, PacketManager::stat_offset> PacketManager::stat_na
 static THREAD_LOCAL PegCount total_rebuilt_pkts = 0;
 static THREAD_LOCAL std::array<uint8_t, Codec::PKT_MAX>* s_pkt;
 
+// link layers handled by decode_link_fast() when the stock codecs are in use
+static THREAD_LOCAL bool s_fast_eth = false;
+static THREAD_LOCAL bool s_fast_vlan = false;
+
+static const ProtocolId vlan_ids[] =
+{
+    ProtocolId::ETHERTYPE_8021Q,
+    ProtocolId::ETHERTYPE_8021AD,
+    ProtocolId::ETHERTYPE_QINQ_NS1,
+    ProtocolId::ETHERTYPE_QINQ_NS2,
+};
+
 void PacketManager::thread_init()
 {
     s_pkt = new std::array<uint8_t, Codec::PKT_MAX>{ {0} };
+
+    const Codec* cd = CodecManager::s_protocols[CodecManager::grinder];
+    s_fast_eth = cd and !strcmp(cd->get_name(), "eth");
+    s_fast_vlan = s_fast_eth;
+
+    for ( auto id : vlan_ids )
+    {
+        cd = CodecManager::s_protocols[proto_idx(id)];
+
+        if ( !cd or strcmp(cd->get_name(), "vlan") )
+            s_fast_vlan = false;
+    }
 }
 
 void PacketManager::thread_term()
@@ -114,6 +147,124 @@ void PacketManager::pop_teredo(Packet* p, RawData& raw)
     raw.len += lyr_len;
 }
 
+//-------------------------------------------------------------------------
+// link layer fast path
+//-------------------------------------------------------------------------
+
+// ethernet and vlan layers are parsed here directly instead of through the
+// eth and vlan codecs.  a layer is only taken when the codec would accept
+// it without an event and with no special handling of the next protocol
+// (llc, fabricpath, ignored or reserved vlans).  the scan stops at the
+// first layer it can't take and the codec chain resumes from there.
+
+static const unsigned fast_vlan_max = 2;
+static const unsigned fast_layers_max = fast_vlan_max + 1;
+
+struct LinkScan
+{
+    ProtocolId next[fast_layers_max];
+};
+
+static inline bool is_vlan(ProtocolId id)
+{
+    for ( auto vid : vlan_ids )
+        if ( id == vid )
+            return true;
+
+    return false;
+}
+
+static inline bool is_fast_next(ProtocolId id, bool vlan)
+{
+    return id == ProtocolId::ETHERTYPE_IPV4 or id == ProtocolId::ETHERTYPE_IPV6 or
+        (vlan and is_vlan(id));
+}
+
+static inline uint16_t fast_layer_len(unsigned idx)
+{ return idx ? sizeof(vlan::VlanTagHdr) : eth::ETH_HEADER_LEN; }
+
+// returns the number of leading layers, ethernet then vlan tags, that can
+// be decoded here
+static unsigned scan_link(
+    const uint8_t* pkt, uint32_t len, bool vlan, bool ignore_vlan, LinkScan& scan)
+{
+    if ( len < eth::ETH_HEADER_LEN )
+        return 0;
+
+    const eth::EtherHdr* eh = reinterpret_cast<const eth::EtherHdr*>(pkt);
+    ProtocolId next = eh->ethertype();
+
+    if ( !is_fast_next(next, vlan) )
+        return 0;
+
+    scan.next[0] = next;
+    pkt += eth::ETH_HEADER_LEN;
+    len -= eth::ETH_HEADER_LEN;
+
+    if ( ignore_vlan )
+        return 1;
+
+    unsigned n = 1;
+
+    while ( n < fast_layers_max and is_vlan(next) and len >= sizeof(vlan::VlanTagHdr) )
+    {
+        const vlan::VlanTagHdr* vh = reinterpret_cast<const vlan::VlanTagHdr*>(pkt);
+        const uint16_t vid = vh->vid();
+
+        if ( vid == 0 or vid == 4095 )
+            break;
+
+        next = (ProtocolId)vh->proto();
+
+        if ( !is_fast_next(next, true) )
+            break;
+
+        scan.next[n++] = next;
+        pkt += sizeof(vlan::VlanTagHdr);
+        len -= sizeof(vlan::VlanTagHdr);
+    }
+    return n;
+}
+
+// leaves raw, mapped_prot, and prev_prot_id exactly as the decode loop
+// would have after running the eth and vlan codecs on the same layers
+void PacketManager::decode_link_fast(
+    Packet* p, RawData& raw, ProtocolIndex& mapped_prot, ProtocolId& prev_prot_id)
+{
+    const DAQ_PktHdr_t* pkth = daq_msg_get_pkthdr(raw.daq_msg);
+    const bool ignore_vlan = (pkth->flags & DAQ_PKT_FLAG_IGNORE_VLAN) != 0;
+
+    LinkScan scan;
+    unsigned n = scan_link(raw.data, raw.len, s_fast_vlan, ignore_vlan, scan);
+
+    if ( n > (unsigned)(CodecManager::max_layers - p->num_layers) )
+        n = CodecManager::max_layers - p->num_layers;
+
+    for ( unsigned i = 0; i < n; ++i )
+    {
+        const uint16_t len = fast_layer_len(i);
+        push_layer(p, prev_prot_id, raw.data, len);
+
+        if ( i )
+        {
+            p->vlan_idx = p->num_layers - 1;
+            p->proto_bits |= PROTO_BIT__VLAN;
+        }
+        else
+            p->proto_bits |= PROTO_BIT__ETH;
+
+        s_stats[mapped_prot + stat_offset]++;
+        mapped_prot = CodecManager::s_proto_map[to_utype(scan.next[i])];
+        prev_prot_id = scan.next[i];
+
+        raw.len -= len;
+        raw.data += len;
+    }
+
+    if ( n )
+        s_stats[fast_path]++;
+}
+
 static inline bool payload_offset_from_daq_mismatch(const uint8_t* pkt, const RawData& raw)
 {
     const DAQ_PktDecodeData_t* pdd =
@@ -167,6 +318,9 @@ void PacketManager::decode(
 
     s_stats[total_processed]++;
 
+    if ( s_fast_eth )
+        decode_link_fast(p, raw, mapped_prot, prev_prot_id);
+
     // loop until the protocol id is no longer valid
     while (CodecManager::s_protocols[mapped_prot]->decode(raw, codec_data, p->ptrs))
     {
@@ -868,7 +1022,7 @@ void PacketManager::dump_stats()
     std::vector<const char*> pkt_names;
 
     // zero out the default codecs
-    g_stats[3] = 0;
+    g_stats[stat_offset] = 0;
     g_stats[CodecManager::s_proto_map[to_utype(ProtocolId::FINISHED_DECODE)] + stat_offset] = 0;
 
     for (unsigned int i = 0; i < stat_names.size(); i++)
@@ -930,3 +1084,88 @@ void PacketManager::log_protocols(TextLog* const text_log,
         }
     }
 }
+
+#ifdef UNIT_TEST
+static const uint8_t eth_ip4[] =
+{
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 0x08, 0x00,
+    0x45, 0x00, 0x00, 0x14
+};
+
+static const uint8_t eth_qinq_ip6[] =
+{
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 0x88, 0xa8,
+    0x00, 0x0a, 0x81, 0x00,
+    0x00, 0x0b, 0x86, 0xdd,
+    0x60, 0x00, 0x00, 0x00
+};
+
+TEST_CASE("link fast path", "[PacketManager]")
+{
+    LinkScan scan;
+
+    SECTION("eth ip4")
+    {
+        CHECK(scan_link(eth_ip4, sizeof(eth_ip4), true, false, scan) == 1);
+        CHECK(scan.next[0] == ProtocolId::ETHERTYPE_IPV4);
+    }
+    SECTION("eth vlan vlan ip6")
+    {
+        CHECK(scan_link(eth_qinq_ip6, sizeof(eth_qinq_ip6), true, false, scan) == 3);
+        CHECK(scan.next[0] == ProtocolId::ETHERTYPE_8021AD);
+        CHECK(scan.next[1] == ProtocolId::ETHERTYPE_8021Q);
+        CHECK(scan.next[2] == ProtocolId::ETHERTYPE_IPV6);
+    }
+    SECTION("vlan disabled")
+    {
+        CHECK(scan_link(eth_qinq_ip6, sizeof(eth_qinq_ip6), false, false, scan) == 0);
+    }
+    SECTION("vlan ignored")
+    {
+        CHECK(scan_link(eth_qinq_ip6, sizeof(eth_qinq_ip6), true, true, scan) == 1);
+    }
+    SECTION("reserved vid")
+    {
+        uint8_t pkt[sizeof(eth_qinq_ip6)];
+        memcpy(pkt, eth_qinq_ip6, sizeof(pkt));
+        pkt[19] = 0;
+        CHECK(scan_link(pkt, sizeof(pkt), true, false, scan) == 2);
+    }
+    SECTION("llc")
+    {
+        uint8_t pkt[sizeof(eth_ip4)];
+        memcpy(pkt, eth_ip4, sizeof(pkt));
+        pkt[12] = 0x00;
+        pkt[13] = 0x40;
+        CHECK(scan_link(pkt, sizeof(pkt), true, false, scan) == 0);
+    }
+    SECTION("truncated")
+    {
+        CHECK(scan_link(eth_ip4, eth::ETH_HEADER_LEN - 1, true, false, scan) == 0);
+        CHECK(scan_link(eth_qinq_ip6, eth::ETH_HEADER_LEN + 2, true, false, scan) == 1);
+    }
+}
+
+// run with --catch-test "[bench]" to report the per packet cost
+TEST_CASE("link fast path cost", "[.][bench]")
+{
+    const unsigned iterations = 10000000;
+    unsigned layers = 0;
+    LinkScan scan;
+
+    auto start = std::chrono::steady_clock::now();
+
+    for ( unsigned i = 0; i < iterations; ++i )
+    {
+        if ( i & 1 )
+            layers += scan_link(eth_ip4, sizeof(eth_ip4), true, false, scan);
+        else
+            layers += scan_link(eth_qinq_ip6, sizeof(eth_qinq_ip6), true, false, scan);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    auto nsecs = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+
+    WARN("link fast path: " << (double)nsecs / iterations << " nsec/pkt");
+    CHECK(layers == iterations * 2);
+}
+#endif
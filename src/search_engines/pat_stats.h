@@ -36,6 +36,9 @@ struct PatMatQStat
     PegCount non_qualified_events;
     PegCount qualified_events;
     PegCount matched_bytes;
+    PegCount fused_searches;
+    PegCount fused_bytes;
+    PegCount fused_bypassed;
 };
 
 namespace snort
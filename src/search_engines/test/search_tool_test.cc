@@ -118,6 +118,8 @@ void Mpse::search(MpseBatch& batch, MpseType mpse_type)
     _search(batch, mpse_type);
 }
 
+void Mpse::_search(std::vector<MpseBatch*>&, MpseType) { }
+
 void Mpse::_search(MpseBatch& batch, MpseType mpse_type)
 {
     int start_state;
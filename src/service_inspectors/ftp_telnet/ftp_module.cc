@@ -27,6 +27,7 @@
 #include "ftp_cmd_lookup.h"
 #include "ftp_parse.h"
 #include "log/messages.h"
+#include "stream/stream.h"
 #include "utils/util.h"
 #include "ft_main.h"
 #include "ftpp_si.h"
@@ -344,6 +345,11 @@ static const PegInfo ftp_pegs[] =
     { CountType::SUM, "total_bytes", "total number of bytes processed" },
     { CountType::NOW, "concurrent_sessions", "total concurrent FTP sessions" },
     { CountType::MAX, "max_concurrent_sessions", "maximum concurrent FTP sessions" },
+    { CountType::SUM, "expected_flows", "data channels added to the expected cache" },
+    { CountType::SUM, "expected_realized", "expected data channels that arrived" },
+    { CountType::SUM, "expected_pruned", "expected data channels pruned for space" },
+    { CountType::SUM, "expected_expired", "expected data channels that timed out" },
+    { CountType::SUM, "expected_overflows", "data channels the expected cache had no room for" },
 
     { CountType::END, nullptr, nullptr }
 };
@@ -624,3 +630,6 @@ const PegInfo* FtpServerModule::get_pegs() const
 PegCount* FtpServerModule::get_counts() const
 { return (PegCount*)&ftstats; }
 
+void FtpServerModule::prep_counts()
+{ Stream::move_expect_stats(FtpDataFlowData::inspector_id, ftstats.expect); }
+
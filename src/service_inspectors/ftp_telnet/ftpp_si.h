@@ -37,6 +37,7 @@
 #define FTPP_SI_H
 
 #include "file_api/file_api.h"
+#include "flow/expect_cache.h"
 #include "flow/flow.h"
 #include "flow/flow_key.h"
 #include "framework/counts.h"
@@ -286,6 +287,7 @@ struct FtpStats
     PegCount total_bytes;
     PegCount concurrent_sessions;
     PegCount max_concurrent_sessions;
+    snort::ExpectStats expect;
 };
 
 struct TelnetStats
@@ -51,6 +51,7 @@ Http2FlowData::Http2FlowData(Flow* flow_) :
                     Http2HpackDecoder(this, SRC_SERVER, events[SRC_SERVER],
                         infractions[SRC_SERVER]) }
 {
+    set_memory_tag(memory::MemoryTag::HTTP);
     if (hi != nullptr)
     {
         hi_ss[SRC_CLIENT] = hi->get_splitter(true);
@@ -21,6 +21,8 @@
 #include "config.h"
 #endif
 
+#include "decompress/inflate_pool.h"
+
 #include "http_common.h"
 #include "http_cutter.h"
 #include "http_enum.h"
@@ -257,29 +259,19 @@ HttpBodyCutter::HttpBodyCutter(bool detained_inspection_, CompressId compression
 {
     if (detained_inspection && ((compression == CMP_GZIP) || (compression == CMP_DEFLATE)))
     {
-        compress_stream = new z_stream;
-        compress_stream->zalloc = Z_NULL;
-        compress_stream->zfree = Z_NULL;
-        compress_stream->next_in = Z_NULL;
-        compress_stream->avail_in = 0;
         const int window_bits = (compression == CMP_GZIP) ? GZIP_WINDOW_BITS : DEFLATE_WINDOW_BITS;
-        if (inflateInit2(compress_stream, window_bits) != Z_OK)
+        compress_stream = snort::InflatePool::acquire(window_bits);
+        if (compress_stream == nullptr)
         {
             assert(false);
             compression = CMP_NONE;
-            delete compress_stream;
-            compress_stream = nullptr;
         }
     }
 }
 
 HttpBodyCutter::~HttpBodyCutter()
 {
-    if (compress_stream != nullptr)
-    {
-        inflateEnd(compress_stream);
-        delete compress_stream;
-    }
+    snort::InflatePool::release(compress_stream);
 }
 
 ScanResult HttpBodyClCutter::cut(const uint8_t* buffer, uint32_t length, HttpInfractions*,
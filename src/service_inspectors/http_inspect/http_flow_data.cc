@@ -24,6 +24,7 @@
 #include "http_flow_data.h"
 
 #include "decompress/file_decomp.h"
+#include "decompress/inflate_pool.h"
 
 #include "http_cutter.h"
 #include "http_common.h"
@@ -52,6 +53,7 @@ const uint16_t HttpFlowData::memory_usage_estimate = sizeof(HttpFlowData) + size
 
 HttpFlowData::HttpFlowData() : FlowData(inspector_id)
 {
+    set_memory_tag(memory::MemoryTag::HTTP);
 #ifdef REG_TEST
     seq_num = ++instance_count;
     if (HttpTestManager::use_test_output(HttpTestManager::IN_HTTP) &&
@@ -88,11 +90,7 @@ HttpFlowData::~HttpFlowData()
         delete[] partial_buffer[k];
         HttpTransaction::delete_transaction(transaction[k], nullptr);
         delete cutter[k];
-        if (compress_stream[k] != nullptr)
-        {
-            inflateEnd(compress_stream[k]);
-            delete compress_stream[k];
-        }
+        InflatePool::release(compress_stream[k]);
         if (mime_state[k] != nullptr)
         {
             delete mime_state[k];
@@ -127,12 +125,8 @@ void HttpFlowData::half_reset(SourceId source_id)
     detection_status[source_id] = DET_REACTIVATING;
 
     compression[source_id] = CMP_NONE;
-    if (compress_stream[source_id] != nullptr)
-    {
-        inflateEnd(compress_stream[source_id]);
-        delete compress_stream[source_id];
-        compress_stream[source_id] = nullptr;
-    }
+    InflatePool::release(compress_stream[source_id]);
+    compress_stream[source_id] = nullptr;
     if (mime_state[source_id] != nullptr)
     {
         delete mime_state[source_id];
@@ -170,12 +164,8 @@ void HttpFlowData::trailer_prep(SourceId source_id)
 {
     type_expected[source_id] = SEC_TRAILER;
     compression[source_id] = CMP_NONE;
-    if (compress_stream[source_id] != nullptr)
-    {
-        inflateEnd(compress_stream[source_id]);
-        delete compress_stream[source_id];
-        compress_stream[source_id] = nullptr;
-    }
+    InflatePool::release(compress_stream[source_id]);
+    compress_stream[source_id] = nullptr;
     detection_status[source_id] = DET_REACTIVATING;
 }
 
@@ -21,6 +21,7 @@
 #include "config.h"
 #endif
 
+#include "decompress/inflate_pool.h"
 #include "protocols/packet.h"
 
 #include "http_inspect.h"
@@ -176,8 +177,7 @@ void HttpStreamSplitter::decompress_copy(uint8_t* buffer, uint32_t& offset, cons
                     events->create_event(EVENT_GZIP_OVERRUN);
                 }
                 compression = CMP_NONE;
-                inflateEnd(compress_stream);
-                delete compress_stream;
+                InflatePool::release(compress_stream);
                 compress_stream = nullptr;
             }
             return;
@@ -203,8 +203,7 @@ void HttpStreamSplitter::decompress_copy(uint8_t* buffer, uint32_t& offset, cons
             *infractions += INF_GZIP_FAILURE;
             events->create_event(EVENT_GZIP_FAILURE);
             compression = CMP_NONE;
-            inflateEnd(compress_stream);
-            delete compress_stream;
+            InflatePool::release(compress_stream);
             compress_stream = nullptr;
             // Since we failed to uncompress the data, fall through
         }
@@ -24,6 +24,7 @@
 
 // Configuration for SIP service inspector
 
+#include "flow/expect_cache.h"
 #include "framework/counts.h"
 #include "main/thread.h"
 #include "sip_common.h"
@@ -64,6 +65,7 @@ struct SipStats
     PegCount ignoreSessions;
     PegCount requests[NUM_OF_REQUEST_TYPES];
     PegCount responses[NUM_OF_RESPONSE_TYPES];
+    snort::ExpectStats expect;
 };
 
 extern THREAD_LOCAL SipStats sip_stats;
@@ -26,6 +26,10 @@
 
 #include <cassert>
 
+#include "stream/stream.h"
+
+#include "sip.h"
+
 using namespace snort;
 using namespace std;
 
@@ -165,6 +169,11 @@ static const PegInfo sip_pegs[] =
     { CountType::SUM, "code_7xx", "7xx" },
     { CountType::SUM, "code_8xx", "8xx" },
     { CountType::SUM, "code_9xx", "9xx" },
+    { CountType::SUM, "expected_flows", "media channels added to the expected cache" },
+    { CountType::SUM, "expected_realized", "expected media channels that arrived" },
+    { CountType::SUM, "expected_pruned", "expected media channels pruned for space" },
+    { CountType::SUM, "expected_expired", "expected media channels that timed out" },
+    { CountType::SUM, "expected_overflows", "media channels the expected cache had no room for" },
     { CountType::END, nullptr, nullptr }
 };
 
@@ -192,6 +201,9 @@ const PegInfo* SipModule::get_pegs() const
 PegCount* SipModule::get_counts() const
 { return (PegCount*)&sip_stats; }
 
+void SipModule::prep_counts()
+{ Stream::move_expect_stats(SipFlowData::inspector_id, sip_stats.expect); }
+
 ProfileStats* SipModule::get_profile() const
 { return &sipPerfStats; }
 
@@ -84,6 +84,11 @@ public:
     PegCount* get_counts() const override;
     snort::ProfileStats* get_profile() const override;
 
+    bool counts_need_prep() const override
+    { return true; }
+
+    void prep_counts() override;
+
     Usage get_usage() const override
     { return INSPECT; }
 
@@ -29,7 +29,7 @@ using namespace std;
 
 #define WILD 0x100
 
-bool HexBook::translate(const char* in, HexVector& out)
+static bool translate(const char* in, HexVector& out)
 {
     bool hex = false;
     string byte;
@@ -74,97 +74,21 @@ bool HexBook::translate(const char* in, HexVector& out)
 
 //-------------------------------------------------------------------------
 
-void HexBook::add_spell(
-    const char* key, const char* val, HexVector& hv, unsigned i, MagicPage* p)
-{
-    while ( i < hv.size() )
-    {
-        MagicPage* t = new MagicPage(*this);
-        int c = hv[i];
-
-        if ( c == WILD )
-            p->any = t;
-        else
-            p->next[c] = t;
-
-        p = t;
-        ++i;
-    }
-    p->key = key;
-    p->value = val;
-}
-
-bool HexBook::add_spell(const char* key, const char* val)
+bool MagicBook::add_hex(const char* key, const char* val)
 {
     HexVector hv;
 
     if ( !translate(key, hv) )
         return false;
 
-    unsigned i = 0;
-    MagicPage* p = root;
+    vector<Glyph> glyphs(hv.size());
 
-    while ( i < hv.size() )
+    for ( unsigned i = 0; i < hv.size(); ++i )
     {
-        int c = hv[i];
-
-        if ( c == WILD && p->any )
-            p = p->any;
-
-        else if ( p->next[c] )
-            p = p->next[c];
-
+        if ( hv[i] == WILD )
+            glyphs[i].bytes.set();
         else
-            break;
-
-        ++i;
+            glyphs[i].bytes.set((uint8_t)hv[i]);
     }
-    if ( p->key == key )
-        return false;
-
-    add_spell(key, val, hv, i, p);
-    return true;
+    return add(key, val, glyphs, true);
 }
-
-const MagicPage* HexBook::find_spell(
-    const uint8_t* s, unsigned n, const MagicPage* p, unsigned i) const
-{
-    while ( i < n )
-    {
-        int c = s[i];
-
-        if ( p->next[c] )
-        {
-            if ( p->any )
-            {
-                if ( const MagicPage* q = find_spell(s, n, p->next[c], i+1) )
-                    return q;
-            }
-            else
-            {
-                p = p->next[c];
-                ++i;
-                continue;
-            }
-        }
-        if ( p->any )
-        {
-            if ( const MagicPage* q = find_spell(s, n, p->any, i+1) )
-                return q;
-        }
-        break;
-    }
-    return p;
-}
-
-const char* HexBook::find_spell(
-    const uint8_t* data, unsigned len, const MagicPage*& p) const
-{
-    p = find_spell(data, len, p, 0);
-
-    if ( !p->value.empty() )
-        return p->value.c_str();
-
-    return nullptr;
-}
-
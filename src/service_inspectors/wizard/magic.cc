@@ -23,26 +23,212 @@
 
 #include "magic.h"
 
-MagicPage::MagicPage(const MagicBook& b) : book(b)
+#include <algorithm>
+#include <cassert>
+#include <map>
+
+#include "log/messages.h"
+
+using namespace snort;
+using namespace std;
+
+// each page is 1K of transitions; the default books need well under 1K pages
+#define MAX_PAGES 16384
+
+// hexes and spells only look this far into each segment
+#define MAX_SCAN 64
+
+// the page set marker for the very start of the flow where spells may
+// skip leading whitespace
+#define AT_START 0xFFFFFFFF
+
+MagicBook::MagicBook() = default;
+MagicBook::~MagicBook() = default;
+
+bool MagicBook::add(const char* key, const char* val, vector<Glyph>& glyphs, bool hex)
 {
-    for ( int i = 0; i < 256; ++i )
-        next[i] = nullptr;
-    any = nullptr;
+    // an empty pattern would make the start page accept every flow
+    if ( glyphs.empty() )
+        return false;
+
+    for ( const auto& s : spells )
+    {
+        if ( s.hex == hex and s.key == key )
+            return false;
+    }
+    spells.emplace_back(Spell{ key, val, std::move(glyphs), hex });
+    return true;
+}
+
+// a pattern position and any positions that follow from it without input
+static void add_page(vector<unsigned>& set, const vector<bool>& star, unsigned pos)
+{
+    set.emplace_back(pos);
+
+    while ( star[pos] )
+        set.emplace_back(++pos);
 }
 
-MagicPage::~MagicPage()
+// subset construction over the positions of all patterns laid end to end.
+// each pattern is followed by an accepting position with no glyph.  pages
+// that accept are final so the first pattern to complete wins.
+void MagicBook::compile()
 {
-    for ( int i = 0; i < 256; ++i )
+    assert(accept.empty());
+
+    // hexes first so they win ties
+    vector<const Spell*> order;
+
+    for ( const auto& s : spells )
+        if ( s.hex )
+            order.emplace_back(&s);
+
+    for ( const auto& s : spells )
+        if ( !s.hex )
+            order.emplace_back(&s);
+
+    vector<bitset<256>> bytes;
+    vector<bool> star;
+    vector<const char*> done;
+    vector<unsigned> spell_starts;
+    vector<unsigned> first;
+
+    for ( const Spell* s : order )
     {
-        if ( next[i] && next[i] != this )
-            delete next[i];
+        if ( s->hex )
+            first.emplace_back(bytes.size());
+        else
+            spell_starts.emplace_back(bytes.size());
+
+        for ( const auto& g : s->glyphs )
+        {
+            bytes.emplace_back(g.bytes);
+            star.emplace_back(g.star);
+            done.emplace_back(nullptr);
+        }
+        bytes.emplace_back();
+        star.emplace_back(false);
+        done.emplace_back(s->value.c_str());
+    }
+
+    vector<unsigned> set;
+
+    for ( auto pos : first )
+        add_page(set, star, pos);
+
+    for ( auto pos : spell_starts )
+        add_page(set, star, pos);
+
+    if ( !spell_starts.empty() )
+        set.emplace_back(AT_START);
+
+    // page 0 is the dead page
+    map<vector<unsigned>, unsigned> pages;
+    vector<const vector<unsigned>*> todo;
+
+    pages[vector<unsigned>()] = 0;
+    next.assign(256, 0);
+    accept.emplace_back(nullptr);
+
+    auto get_page = [&](vector<unsigned>& s) -> unsigned
+    {
+        sort(s.begin(), s.end());
+        s.erase(unique(s.begin(), s.end()), s.end());
+
+        auto it = pages.find(s);
+
+        if ( it != pages.end() )
+            return it->second;
+
+        if ( accept.size() >= MAX_PAGES )
+            return 0;
+
+        unsigned page = accept.size();
+        const char* hit = nullptr;
+
+        // positions are in rank order so the lowest accepting one wins
+        for ( auto pos : s )
+        {
+            if ( pos != AT_START and done[pos] )
+            {
+                hit = done[pos];
+                break;
+            }
+        }
+        accept.emplace_back(hit);
+        next.resize(next.size() + 256, 0);
+
+        it = pages.emplace(s, page).first;
+
+        if ( !hit )
+            todo.emplace_back(&it->first);
+
+        return page;
+    };
+
+    start = get_page(set);
+
+    for ( unsigned i = 0; i < todo.size(); ++i )
+    {
+        const vector<unsigned>& from = *todo[i];
+        unsigned page = pages[from];
+        bool at_start = from.back() == AT_START;
+
+        for ( unsigned c = 0; c < 256; ++c )
+        {
+            vector<unsigned> to;
+
+            for ( auto pos : from )
+            {
+                if ( pos == AT_START or done[pos] )
+                    continue;
+
+                if ( star[pos] )
+                    add_page(to, star, pos);
+
+                else if ( bytes[pos][c] )
+                    add_page(to, star, pos + 1);
+            }
+
+            if ( at_start and (c == ' ' or c == '\t' or c == '\r' or c == '\n') )
+            {
+                for ( auto pos : spell_starts )
+                    add_page(to, star, pos);
+
+                to.emplace_back(AT_START);
+            }
+
+            if ( !to.empty() )
+            {
+                // get_page() may grow next
+                unsigned to_page = get_page(to);
+                next[page * 256 + c] = to_page;
+            }
+        }
+    }
+
+    if ( accept.size() >= MAX_PAGES )
+        ParseWarning(WARN_CONF, "wizard: too many hexes and spells; some will never match");
+
+    for ( auto& s : spells )
+    {
+        s.glyphs.clear();
+        s.glyphs.shrink_to_fit();
     }
-    delete any;
 }
 
-MagicBook::MagicBook()
-{ root = new MagicPage(*this); }
+const char* MagicBook::find_spell(const uint8_t* data, unsigned len, unsigned& state) const
+{
+    assert(!accept.empty());
+
+    if ( len > MAX_SCAN )
+        len = MAX_SCAN;
+
+    unsigned page = state;
 
-MagicBook::~MagicBook()
-{ delete root; }
+    for ( unsigned i = 0; i < len and page and !accept[page]; ++i )
+        page = next[page * 256 + data[i]];
 
+    state = page;
+    return accept[page];
+}
@@ -20,85 +20,71 @@
 #ifndef MAGIC_H
 #define MAGIC_H
 
+#include <bitset>
+#include <cstdint>
 #include <string>
 #include <vector>
 
-class MagicBook;
-
-struct MagicPage
-{
-    std::string key;
-    std::string value;
-
-    MagicPage* next[256];
-    MagicPage* any;
-
-    const MagicBook& book;
-
-    MagicPage(const MagicBook&);
-    ~MagicPage();
-};
-
 typedef std::vector<uint16_t> HexVector;
 
-// MagicBook is a set of MagicPages implementing a trie
+// MagicBook holds the hexes and spells for one direction compiled into a
+// single dfa.  all patterns are anchored at the start of the flow and the
+// first one to complete wins; ties go to hexes and then to the order given.
+// the dfa state is carried across segments so each byte is looked at once.
 
 class MagicBook
 {
 public:
-    virtual ~MagicBook();
+    MagicBook();
+    ~MagicBook();
 
     MagicBook(const MagicBook&) = delete;
     MagicBook& operator=(const MagicBook&) = delete;
 
-    virtual bool add_spell(const char* key, const char* val) = 0;
-    virtual const char* find_spell(const uint8_t*, unsigned len, const MagicPage*&) const = 0;
+    // hexes - a sequence of pipe delimited hex, text literals, and wild chars
+    // designated by '?' (indicating one arbitrary byte)
+    bool add_hex(const char* key, const char* val);
 
-    const MagicPage* page1()
-    { return root; }
+    // spells - a sequence of case insensitive text strings with wild cards
+    // designated by * (indicating any number of arbitrary bytes)
+    bool add_spell(const char* key, const char* val);
 
-protected:
-    MagicBook();
-    MagicPage* root;
-};
+    // build the dfa; must be called once after all hexes and spells are added
+    void compile();
 
-//-------------------------------------------------------------------------
-// spells - a sequence of case insensitive text strings with wild cards
-// designated by * (indicating any number of arbitrary bytes)
-//-------------------------------------------------------------------------
+    // state 0 means no match is possible
+    unsigned page1() const
+    { return start; }
 
-class SpellBook : public MagicBook
-{
-public:
-    SpellBook();
-
-    bool add_spell(const char*, const char*) override;
-    const char* find_spell(const uint8_t*, unsigned len, const MagicPage*&) const override;
-
-private:
-    bool translate(const char*, HexVector&);
-    void add_spell(const char*, const char*, HexVector&, unsigned, MagicPage*);
-    const MagicPage* find_spell(const uint8_t*, unsigned, const MagicPage*, unsigned) const;
-};
+    // returns the service on a match; state is updated to continue with the
+    // next segment
+    const char* find_spell(const uint8_t*, unsigned len, unsigned& state) const;
 
-//-------------------------------------------------------------------------
-// hexes - a sequence of pipe delimited hex, text literals, and wild chars
-// designated by '?' (indicating one arbitrary byte)
-//-------------------------------------------------------------------------
-
-class HexBook : public MagicBook
-{
-public:
-    HexBook() = default;
-
-    bool add_spell(const char*, const char*) override;
-    const char* find_spell(const uint8_t*, unsigned len, const MagicPage*&) const override;
+    unsigned get_page_count() const
+    { return accept.size(); }
 
 private:
-    bool translate(const char*, HexVector&);
-    void add_spell(const char*, const char*, HexVector&, unsigned, MagicPage*);
-    const MagicPage* find_spell(const uint8_t*, unsigned, const MagicPage*, unsigned) const;
+    struct Glyph
+    {
+        std::bitset<256> bytes;
+        bool star = false;  // any number of arbitrary bytes
+    };
+
+    struct Spell
+    {
+        std::string key;
+        std::string value;
+        std::vector<Glyph> glyphs;
+        bool hex;
+    };
+
+    bool add(const char* key, const char* val, std::vector<Glyph>&, bool hex);
+
+    std::vector<Spell> spells;
+
+    std::vector<unsigned> next;        // page * 256 + byte -> page
+    std::vector<const char*> accept;   // page -> service or nullptr
+    unsigned start = 0;
 };
 
 #endif
-
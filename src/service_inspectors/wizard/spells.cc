@@ -21,7 +21,7 @@
 #include "config.h"
 #endif
 
-#include <cassert>
+#include <cctype>
 
 #include "magic.h"
 
@@ -29,16 +29,7 @@ using namespace std;
 
 #define WILD 0x100
 
-SpellBook::SpellBook()
-{
-    // allows skipping leading whitespace only
-    root->next[(int)' '] = root;
-    root->next[(int)'\t'] = root;
-    root->next[(int)'\r'] = root;
-    root->next[(int)'\n'] = root;
-}
-
-bool SpellBook::translate(const char* in, HexVector& out)
+static bool translate(const char* in, HexVector& out)
 {
     bool wild = false;
     unsigned i = 0;
@@ -65,109 +56,26 @@ bool SpellBook::translate(const char* in, HexVector& out)
     return true;
 }
 
-void SpellBook::add_spell(
-    const char* key, const char* val, HexVector& hv, unsigned i, MagicPage* p)
-{
-    while ( i < hv.size() )
-    {
-        MagicPage* t = new MagicPage(*this);
-
-        if ( hv[i] == WILD )
-            p->any = t;
-        else
-            p->next[toupper(hv[i])] = t;
-
-        p = t;
-        ++i;
-    }
-    p->key = key;
-    p->value = val;
-}
-
-bool SpellBook::add_spell(const char* key, const char* val)
+bool MagicBook::add_spell(const char* key, const char* val)
 {
     HexVector hv;
 
     if ( !translate(key, hv) )
         return false;
 
-    unsigned i = 0;
-    MagicPage* p = root;
+    vector<Glyph> glyphs(hv.size());
 
-    // Perform a longest prefix match before inserting the pattern.
-    while ( i < hv.size() )
+    for ( unsigned i = 0; i < hv.size(); ++i )
     {
-        int c = toupper(hv[i]);
-
-        if ( c == WILD && p->any )
-            p = p->any;
-
-        else if ( c != WILD && p->next[c] )
-            p = p->next[c];
+        if ( hv[i] == WILD )
+            glyphs[i].star = true;
 
         else
-            break;
-
-        ++i;
-    }
-    if ( p->key == key )
-        return false;
-
-    add_spell(key, val, hv, i, p);
-    return true;
-}
-
-const MagicPage* SpellBook::find_spell(
-    const uint8_t* s, unsigned n, const MagicPage* p, unsigned i) const
-{
-    while ( i < n )
-    {
-        int c = toupper(s[i]);
-
-        if ( p->next[c] )
         {
-            if ( p->any )
-            {
-                if ( const MagicPage* q = find_spell(s, n, p->next[c], i+1) )
-                    return q;
-            }
-            else
-            {
-                p = p->next[c];
-                ++i;
-                continue;
-            }
+            uint8_t c = (uint8_t)hv[i];
+            glyphs[i].bytes.set(toupper(c));
+            glyphs[i].bytes.set(tolower(c));
         }
-        if ( p->any )
-        {
-            while ( i < n )
-            {
-                if ( const MagicPage* q = find_spell(s, n, p->any, i) )
-                    return q;
-                ++i;
-            }
-            return p->any;
-        }
-        return p->value.empty() ? nullptr : p;
     }
-    return p;
+    return add(key, val, glyphs, false);
 }
-
-const char* SpellBook::find_spell(
-    const uint8_t* data, unsigned len, const MagicPage*& p) const
-{
-    // FIXIT-L make configurable upper bound to limit globbing
-    unsigned max = 64;
-    assert(p);
-
-    if ( len > max )
-        len = max;
-
-    p = find_spell(data, len, p, 0);
-
-    if ( p and !p->value.empty() )
-        return p->value.c_str();
-
-    return nullptr;
-}
-
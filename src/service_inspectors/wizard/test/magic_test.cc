@@ -0,0 +1,200 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2020-2020 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// magic_test.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "service_inspectors/wizard/magic.h"
+
+#include <cstring>
+
+#include "log/messages.h"
+
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness.h>
+
+namespace snort
+{
+void ParseWarning(WarningGroup, const char*, ...) { }
+}
+
+// feed the data all at once or a byte at a time to carry state across
+// segments
+static const char* cast(const MagicBook& book, const char* data, bool split = false)
+{
+    unsigned state = book.page1();
+    unsigned len = strlen(data);
+
+    if ( !split )
+        return book.find_spell((const uint8_t*)data, len, state);
+
+    const char* hit = nullptr;
+
+    for ( unsigned i = 0; i < len and !hit and state; ++i )
+        hit = book.find_spell((const uint8_t*)data + i, 1, state);
+
+    return hit;
+}
+
+static void check(const MagicBook& book, const char* data, const char* expected)
+{
+    for ( bool split : { false, true } )
+    {
+        const char* hit = cast(book, data, split);
+
+        if ( !expected )
+            CHECK(hit == nullptr);
+        else
+        {
+            CHECK(hit != nullptr);
+            STRCMP_EQUAL(expected, hit);
+        }
+    }
+}
+
+TEST_GROUP(magic_test)
+{
+};
+
+TEST(magic_test, wild_cards)
+{
+    MagicBook book;
+    CHECK(book.add_spell("220*FTP", "ftp"));
+    CHECK(book.add_spell("*SSH", "ssh"));
+    CHECK(book.add_spell("HTTP/*", "http"));
+    book.compile();
+
+    check(book, "220 ProFTPD ready", "ftp");
+    check(book, "220FTP", "ftp");
+    check(book, "SSH-2.0", "ssh");
+    check(book, "xx SSH-2.0", "ssh");
+    check(book, "HTTP/", "http");
+    check(book, "HTTP/1.1 200 OK", "http");
+    check(book, "220 ESMTP", nullptr);
+}
+
+TEST(magic_test, case_folding)
+{
+    MagicBook book;
+    CHECK(book.add_spell("GET", "http"));
+    CHECK(book.add_hex("|47 45 54|", "hex"));
+    CHECK(book.add_hex("PUT", "put"));
+    book.compile();
+
+    check(book, "GET /", "hex");
+    check(book, "get /", "http");
+    check(book, "gEt /", "http");
+    check(book, "PUT /", "put");
+    check(book, "put /", nullptr);
+}
+
+TEST(magic_test, leading_whitespace)
+{
+    MagicBook book;
+    CHECK(book.add_spell("POST", "http"));
+    CHECK(book.add_hex("|16 03|", "ssl"));
+    book.compile();
+
+    check(book, "  \r\n\tPOST /", "http");
+    check(book, "\x16\x03\x01", "ssl");
+    check(book, " \x16\x03\x01", nullptr);
+    check(book, "x POST /", nullptr);
+}
+
+TEST(magic_test, across_segments)
+{
+    MagicBook book;
+    CHECK(book.add_spell("RPC_CONNECT", "dce_http_proxy"));
+    CHECK(book.add_spell("RPC_DATA", "other"));
+    book.compile();
+
+    unsigned state = book.page1();
+    CHECK(book.find_spell((const uint8_t*)"RPC_", 4, state) == nullptr);
+    CHECK(state != 0);
+
+    CHECK(book.find_spell((const uint8_t*)"CONN", 4, state) == nullptr);
+    CHECK(state != 0);
+
+    const char* hit = book.find_spell((const uint8_t*)"ECT 1", 5, state);
+    CHECK(hit != nullptr);
+    STRCMP_EQUAL("dce_http_proxy", hit);
+}
+
+TEST(magic_test, ties)
+{
+    MagicBook book;
+    CHECK(book.add_spell("ABC", "first"));
+    CHECK(book.add_spell("A*C", "second"));
+    CHECK(book.add_spell("AB", "shorter"));
+    CHECK(book.add_spell("XYZ", "spell"));
+    CHECK(book.add_hex("|58 59 5A|", "hex"));
+    CHECK(book.add_spell("Q*R", "star"));
+    CHECK(book.add_spell("QR", "plain"));
+    CHECK_FALSE(book.add_spell("ABC", "dup"));
+    book.compile();
+
+    // the first pattern to complete wins regardless of order
+    check(book, "ABC", "shorter");
+    // hexes win over spells that complete on the same byte
+    check(book, "XYZ", "hex");
+    check(book, "xyz", "spell");
+    // then the order given
+    check(book, "QR", "star");
+    check(book, "AxC", "second");
+}
+
+TEST(magic_test, dead_page)
+{
+    MagicBook book;
+    CHECK(book.add_hex("|16 03|", "ssl"));
+    CHECK(book.add_spell("HTTP/", "http"));
+    book.compile();
+
+    unsigned state = book.page1();
+    CHECK(book.find_spell((const uint8_t*)"\x16\x04", 2, state) == nullptr);
+    CHECK(state == 0);
+
+    // nothing more is matched once dead
+    CHECK(book.find_spell((const uint8_t*)"HTTP/", 5, state) == nullptr);
+    CHECK(state == 0);
+
+    MagicBook empty;
+    empty.compile();
+    CHECK(empty.page1() == 0);
+}
+
+TEST(magic_test, empty_patterns)
+{
+    MagicBook book;
+    CHECK_FALSE(book.add_spell("", "none"));
+    CHECK_FALSE(book.add_spell("*", "any"));
+    CHECK_FALSE(book.add_hex("", "none"));
+    CHECK(book.add_spell("HELO", "smtp"));
+    book.compile();
+
+    check(book, "EHLO x", nullptr);
+    check(book, "HELO x", "smtp");
+}
+
+int main(int argc, char** argv)
+{
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
@@ -55,7 +55,7 @@ public:
     PegCount* get_counts() const override;
     snort::ProfileStats* get_profile() const override;
 
-    MagicBook* get_book(bool c2s, bool hex);
+    MagicBook* get_book(bool c2s);
     CurseBook* get_curse_book();
 
     Usage get_usage() const override
@@ -73,11 +73,8 @@ private:
     std::string service;
     std::vector<std::string> spells;
 
-    MagicBook* c2s_hexes;
-    MagicBook* s2c_hexes;
-
-    MagicBook* c2s_spells;
-    MagicBook* s2c_spells;
+    MagicBook* c2s_book;
+    MagicBook* s2c_book;
 
     CurseBook* curses;
 };
@@ -72,8 +72,8 @@ struct CurseServiceTracker
 
 struct Wand
 {
-    const MagicPage* hex;
-    const MagicPage* spell;
+    const MagicBook* book;
+    unsigned page;
     vector<CurseServiceTracker> curse_tracker;
 };
 
@@ -125,15 +125,12 @@ public:
     void reset(Wand&, bool tcp, bool c2s);
     bool finished(Wand&);
     bool cast_spell(Wand&, Flow*, const uint8_t*, unsigned);
-    bool spellbind(const MagicPage*&, Flow*, const uint8_t*, unsigned);
+    bool spellbind(Wand&, Flow*, const uint8_t*, unsigned);
     bool cursebind(const vector<CurseServiceTracker>&, Flow*, const uint8_t*, unsigned);
 
 public:
-    MagicBook* c2s_hexes;
-    MagicBook* s2c_hexes;
-
-    MagicBook* c2s_spells;
-    MagicBook* s2c_spells;
+    MagicBook* c2s_book;
+    MagicBook* s2c_book;
 
     CurseBook* curses;
 };
@@ -188,38 +185,27 @@ StreamSplitter::Status MagicSplitter::scan(
 
 Wizard::Wizard(WizardModule* m)
 {
-    c2s_hexes = m->get_book(true, true);
-    s2c_hexes = m->get_book(false, true);
+    c2s_book = m->get_book(true);
+    s2c_book = m->get_book(false);
 
-    c2s_spells = m->get_book(true, false);
-    s2c_spells = m->get_book(false, false);
+    c2s_book->compile();
+    s2c_book->compile();
 
     curses = m->get_curse_book();
 }
 
 Wizard::~Wizard()
 {
-    delete c2s_hexes;
-    delete s2c_hexes;
-
-    delete c2s_spells;
-    delete s2c_spells;
+    delete c2s_book;
+    delete s2c_book;
 
     delete curses;
 }
 
 void Wizard::reset(Wand& w, bool tcp, bool c2s)
 {
-    if ( c2s )
-    {
-        w.hex = c2s_hexes->page1();
-        w.spell = c2s_spells->page1();
-    }
-    else
-    {
-        w.hex = s2c_hexes->page1();
-        w.spell = s2c_spells->page1();
-    }
+    w.book = c2s ? c2s_book : s2c_book;
+    w.page = w.book->page1();
 
     if (w.curse_tracker.empty())
     {
@@ -262,9 +248,9 @@ StreamSplitter* Wizard::get_splitter(bool c2s)
 }
 
 bool Wizard::spellbind(
-    const MagicPage*& m, Flow* f, const uint8_t* data, unsigned len)
+    Wand& w, Flow* f, const uint8_t* data, unsigned len)
 {
-    f->service = m->book.find_spell(data, len, m);
+    f->service = w.book->find_spell(data, len, w.page);
     return ( f->service != nullptr );
 }
 
@@ -287,10 +273,7 @@ bool Wizard::cursebind(const vector<CurseServiceTracker>& curse_tracker, Flow* f
 bool Wizard::cast_spell(
     Wand& w, Flow* f, const uint8_t* data, unsigned len)
 {
-    if ( w.hex && spellbind(w.hex, f, data, len) )
-        return true;
-
-    if ( w.spell && spellbind(w.spell, f, data, len) )
+    if ( w.page && spellbind(w, f, data, len) )
         return true;
 
     if (cursebind(w.curse_tracker, f, data, len))
@@ -301,7 +284,7 @@ bool Wizard::cast_spell(
 
 bool Wizard::finished(Wand& w)
 {
-    if ( w.hex or w.spell )
+    if ( w.page )
         return false;
 
     // FIXIT-L how to know curses are done?
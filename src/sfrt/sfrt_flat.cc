@@ -154,9 +154,9 @@ table_flat_t* sfrt_flat_new(char table_flat_type, char ip_type,  long data_size,
     if ((!table->rt) || (!table->rt6))
     {
         if (table->rt)
-            sfrt_dir_flat_free(table->rt);
+            sfrt_dir_flat_free(table->rt, base);
         if (table->rt6)
-            sfrt_dir_flat_free(table->rt6);
+            sfrt_dir_flat_free(table->rt6, base);
         segment_free(table->data);
         segment_free(table_ptr);
         return nullptr;
@@ -166,10 +166,9 @@ table_flat_t* sfrt_flat_new(char table_flat_type, char ip_type,  long data_size,
 }
 
 /* Free lookup table */
-void sfrt_flat_free(TABLE_PTR table_ptr)
+void sfrt_flat_free(TABLE_PTR table_ptr, uint8_t* base)
 {
     table_flat_t* table;
-    uint8_t* base;
 
     if (!table_ptr)
     {
@@ -177,7 +176,6 @@ void sfrt_flat_free(TABLE_PTR table_ptr)
         return;
     }
 
-    base = (uint8_t*)segment_basePtr();
     table = (table_flat_t*)(&base[table_ptr]);
 
     if (!table->data)
@@ -195,7 +193,7 @@ void sfrt_flat_free(TABLE_PTR table_ptr)
     }
     else
     {
-        sfrt_dir_flat_free(table->rt);
+        sfrt_dir_flat_free(table->rt, base);
     }
 
     if (!table->rt6)
@@ -204,21 +202,20 @@ void sfrt_flat_free(TABLE_PTR table_ptr)
     }
     else
     {
-        sfrt_dir_flat_free(table->rt6);
+        sfrt_dir_flat_free(table->rt6, base);
     }
 
     segment_free(table_ptr);
 }
 
 /* Perform a lookup on value contained in "ip" */
-GENERIC sfrt_flat_lookup(const SfIp* ip, table_flat_t* table)
+GENERIC sfrt_flat_lookup(const SfIp* ip, table_flat_t* table, uint8_t* base)
 {
     tuple_flat_t tuple;
     const uint32_t* addr;
     int numAddrDwords;
     INFO* data;
     TABLE_PTR rt = 0;
-    uint8_t* base;
 
     if (!ip)
     {
@@ -245,13 +242,12 @@ GENERIC sfrt_flat_lookup(const SfIp* ip, table_flat_t* table)
     else
         return nullptr;
 
-    tuple = sfrt_dir_flat_lookup(addr, numAddrDwords, rt);
+    tuple = sfrt_dir_flat_lookup(addr, numAddrDwords, rt, base);
 
     if (tuple.index >= table->num_ent)
     {
         return nullptr;
     }
-    base = (uint8_t*)segment_basePtr();
     data = (INFO*)(&base[table->data]);
     if (data[tuple.index])
         return (GENERIC)&base[data[tuple.index]];
@@ -261,7 +257,7 @@ GENERIC sfrt_flat_lookup(const SfIp* ip, table_flat_t* table)
 
 /* Insert "ip", of length "len", into "table", and have it point to "ptr" */
 int sfrt_flat_insert(SfCidr* cidr, unsigned char len, INFO ptr,
-    int behavior, table_flat_t* table, updateEntryInfoFunc updateEntry)
+    int behavior, table_flat_t* table, updateEntryInfoFunc updateEntry, uint8_t* base)
 {
     const SfIp* ip;
     int index;
@@ -271,7 +267,6 @@ int sfrt_flat_insert(SfCidr* cidr, unsigned char len, INFO ptr,
     const uint32_t* addr;
     int numAddrDwords;
     TABLE_PTR rt;
-    uint8_t* base;
     int64_t bytesAllocated;
 
     if (!cidr)
@@ -311,9 +306,8 @@ int sfrt_flat_insert(SfCidr* cidr, unsigned char len, INFO ptr,
     else
         return RT_INSERT_FAILURE;
 
-    tuple = sfrt_dir_flat_lookup(addr, numAddrDwords, table->rt);
+    tuple = sfrt_dir_flat_lookup(addr, numAddrDwords, table->rt, base);
 
-    base = (uint8_t*)segment_basePtr();
     data = (INFO*)(&base[table->data]);
 
     if (tuple.length != len)
@@ -346,7 +340,8 @@ int sfrt_flat_insert(SfCidr* cidr, unsigned char len, INFO ptr,
 
     /* The actual value that is looked-up is an index
      * into the data table. */
-    res = sfrt_dir_flat_insert(addr, numAddrDwords, len, index, behavior, rt, updateEntry, data);
+    res = sfrt_dir_flat_insert(addr, numAddrDwords, len, index, behavior, rt, updateEntry, data,
+        base);
 
     /* Check if we ran out of memory. If so, need to decrement
      * table->num_ent */
@@ -379,7 +374,7 @@ uint32_t sfrt_flat_num_entries(table_flat_t* table)
     return table->num_ent - 1;
 }
 
-uint32_t sfrt_flat_usage(table_flat_t* table)
+uint32_t sfrt_flat_usage(table_flat_t* table, const uint8_t* base)
 {
     uint32_t usage;
     if (!table || !table->rt || !table->allocated )
@@ -387,11 +382,11 @@ uint32_t sfrt_flat_usage(table_flat_t* table)
         return 0;
     }
 
-    usage = table->allocated + sfrt_dir_flat_usage(table->rt);
+    usage = table->allocated + sfrt_dir_flat_usage(table->rt, base);
 
     if (table->rt6)
     {
-        usage += sfrt_dir_flat_usage(table->rt6);
+        usage += sfrt_dir_flat_usage(table->rt6, base);
     }
 
     return usage;
@@ -400,11 +395,10 @@ uint32_t sfrt_flat_usage(table_flat_t* table)
 /* Perform a lookup on value contained in "ip"
  * For performance reason, we use this simplified version instead of sfrt_lookup
  * Note: this only applied to table setting: DIR_8x16 (DIR_16_8_4x2 for IPV4), DIR_8x4*/
-GENERIC sfrt_flat_dir8x_lookup(const SfIp* ip, table_flat_t* table)
+GENERIC sfrt_flat_dir8x_lookup(const SfIp* ip, table_flat_t* table, uint8_t* base)
 {
     dir_sub_table_flat_t* subtable;
     DIR_Entry* entry;
-    uint8_t* base = (uint8_t*)table;
     int i;
     dir_table_flat_t* rt = nullptr;
     int index;
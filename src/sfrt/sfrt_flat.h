@@ -69,17 +69,20 @@ typedef struct
 } table_flat_t;
 /*******************************************************************/
 
-/* Abstracted routing table API */
+/* Abstracted routing table API
+ * base is the start of the segment holding the table.  new allocates in
+ * the segment set by segment_meminit(); everything else uses the base it
+ * is given so a table can be used while another one is being built. */
 table_flat_t* sfrt_flat_new(char table_flat_type, char ip_type,
     long data_size, uint32_t mem_cap);
-void sfrt_flat_free(TABLE_PTR table);
+void sfrt_flat_free(TABLE_PTR table, uint8_t* base);
 
-GENERIC sfrt_flat_lookup(const snort::SfIp* ip, table_flat_t* table);
-GENERIC sfrt_flat_dir8x_lookup(const snort::SfIp* ip, table_flat_t* table);
+GENERIC sfrt_flat_lookup(const snort::SfIp* ip, table_flat_t* table, uint8_t* base);
+GENERIC sfrt_flat_dir8x_lookup(const snort::SfIp* ip, table_flat_t* table, uint8_t* base);
 
 int sfrt_flat_insert(snort::SfCidr* cidr, unsigned char len, INFO ptr, int behavior,
-    table_flat_t* table, updateEntryInfoFunc updateEntry);
-uint32_t sfrt_flat_usage(table_flat_t* table);
+    table_flat_t* table, updateEntryInfoFunc updateEntry, uint8_t* base);
+uint32_t sfrt_flat_usage(table_flat_t* table, const uint8_t* base);
 uint32_t sfrt_flat_num_entries(table_flat_t* table);
 
 #endif
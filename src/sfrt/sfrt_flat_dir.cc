@@ -41,14 +41,13 @@ typedef struct
 
 /* Create new "sub" table of 2^width entries */
 static TABLE_PTR _sub_table_flat_new(dir_table_flat_t* root, uint32_t dimension,
-    uint32_t prefill, uint32_t bit_length)
+    uint32_t prefill, uint32_t bit_length, uint8_t* base)
 {
     int width = root->dimensions[dimension];
     int len = 1 << width;
     int index;
     dir_sub_table_flat_t* sub;
     TABLE_PTR sub_ptr;
-    uint8_t* base;
     DIR_Entry* entries;
 
     /* Check if creating this node will exceed the memory cap.
@@ -70,7 +69,6 @@ static TABLE_PTR _sub_table_flat_new(dir_table_flat_t* root, uint32_t dimension,
         return 0;
     }
 
-    base = (uint8_t*)segment_basePtr();
     sub = (dir_sub_table_flat_t*)(&base[sub_ptr]);
 
     /* This keeps the width readily available rather than recalculating it
@@ -146,7 +144,7 @@ TABLE_PTR sfrt_dir_flat_new(uint32_t mem_cap, int count,...)
 
     table->cur_num = 0;
 
-    table->sub_table = _sub_table_flat_new(table, 0, 0, 0);
+    table->sub_table = _sub_table_flat_new(table, 0, 0, 0, base);
 
     if (!table->sub_table)
     {
@@ -160,13 +158,11 @@ TABLE_PTR sfrt_dir_flat_new(uint32_t mem_cap, int count,...)
 }
 
 /* Traverse "sub" tables, freeing each */
-static void _sub_table_flat_free(uint32_t* allocated, SUB_TABLE_PTR sub_ptr)
+static void _sub_table_flat_free(uint32_t* allocated, SUB_TABLE_PTR sub_ptr, uint8_t* base)
 {
     int index;
     dir_sub_table_flat_t* sub;
-    uint8_t* base;
 
-    base = (uint8_t*)segment_basePtr();
     sub = (dir_sub_table_flat_t*)(&base[sub_ptr]);
 
     sub->cur_num--;
@@ -178,7 +174,7 @@ static void _sub_table_flat_free(uint32_t* allocated, SUB_TABLE_PTR sub_ptr)
         DIR_Entry* entry = (DIR_Entry*)(&base[sub->entries]);
         if ( !entry[index].length && entry[index].value )
         {
-            _sub_table_flat_free(allocated, entry[index].value);
+            _sub_table_flat_free(allocated, entry[index].value, base);
         }
     }
 
@@ -198,34 +194,30 @@ static void _sub_table_flat_free(uint32_t* allocated, SUB_TABLE_PTR sub_ptr)
 }
 
 /* Free the DIR-n-m structure */
-void sfrt_dir_flat_free(TABLE_PTR tbl_ptr)
+void sfrt_dir_flat_free(TABLE_PTR tbl_ptr, uint8_t* base)
 {
     dir_table_flat_t* table;
-    uint8_t* base;
 
     if (!tbl_ptr)
     {
         return;
     }
 
-    base = (uint8_t*)segment_basePtr();
     table = (dir_table_flat_t*)(&base[tbl_ptr]);
 
     if (table->sub_table)
     {
-        _sub_table_flat_free(&table->allocated, table->sub_table);
+        _sub_table_flat_free(&table->allocated, table->sub_table, base);
     }
 
     segment_free(tbl_ptr);
 }
 
 static inline void _dir_fill_all(uint32_t* allocated, uint32_t index, uint32_t fill,
-    word length, uint32_t val, SUB_TABLE_PTR sub_ptr)
+    word length, uint32_t val, SUB_TABLE_PTR sub_ptr, uint8_t* base)
 {
     dir_sub_table_flat_t* subtable;
-    uint8_t* base;
 
-    base = (uint8_t*)segment_basePtr();
     subtable = (dir_sub_table_flat_t*)(&base[sub_ptr]);
 
     /* Fill entries */
@@ -236,7 +228,7 @@ static inline void _dir_fill_all(uint32_t* allocated, uint32_t index, uint32_t f
         DIR_Entry* entry = (DIR_Entry*)(&base[subtable->entries]);
         if ( entry[index].value && !entry[index].length)
         {
-            _sub_table_flat_free(allocated, entry[index].value);
+            _sub_table_flat_free(allocated, entry[index].value, base);
         }
 
         entry[index].value = val;
@@ -245,12 +237,10 @@ static inline void _dir_fill_all(uint32_t* allocated, uint32_t index, uint32_t f
 }
 
 static inline void _dir_fill_less_specific(int index, int fill,
-    word length, uint32_t val, SUB_TABLE_PTR sub_ptr)
+    word length, uint32_t val, SUB_TABLE_PTR sub_ptr, uint8_t* base)
 {
     dir_sub_table_flat_t* subtable;
-    uint8_t* base;
 
-    base = (uint8_t*)segment_basePtr();
     subtable = (dir_sub_table_flat_t*)(&base[sub_ptr]);
 
     /* Fill entries */
@@ -271,7 +261,8 @@ static inline void _dir_fill_less_specific(int index, int fill,
         if ( entry[index].value && !entry[index].length)
         {
             dir_sub_table_flat_t* next = (dir_sub_table_flat_t*)(&base[entry[index].value]);
-            _dir_fill_less_specific(0, 1 << next->width, length, val, entry[index].value);
+            _dir_fill_less_specific(0, 1 << next->width, length, val, entry[index].value,
+                base);
         }
         else if (length >= (unsigned)entry[index].length)
         {
@@ -282,13 +273,12 @@ static inline void _dir_fill_less_specific(int index, int fill,
 }
 
 static inline int64_t _dir_update_info(int index, int fill,
-    word length, uint32_t val, SUB_TABLE_PTR sub_ptr, updateEntryInfoFunc updateEntry, INFO* data)
+    word length, uint32_t val, SUB_TABLE_PTR sub_ptr, updateEntryInfoFunc updateEntry, INFO* data,
+    uint8_t* base)
 {
     dir_sub_table_flat_t* subtable;
-    uint8_t* base;
     int64_t bytesAllocatedTotal = 0;
 
-    base = (uint8_t*)segment_basePtr();
     subtable = (dir_sub_table_flat_t*)(&base[sub_ptr]);
 
     /* Fill entries */
@@ -311,7 +301,7 @@ static inline int64_t _dir_update_info(int index, int fill,
             int64_t bytesAllocated;
             dir_sub_table_flat_t* next = (dir_sub_table_flat_t*)(&base[entry[index].value]);
             bytesAllocated = _dir_update_info(0, 1 << next->width, length, val,
-                    entry[index].value, updateEntry, data);
+                    entry[index].value, updateEntry, data, base);
             if (bytesAllocated < 0)
                 return bytesAllocated;
             else
@@ -359,10 +349,9 @@ static inline int64_t _dir_update_info(int index, int fill,
 static int _dir_sub_insert(IPLOOKUP* ip, int length, int cur_len, INFO ptr,
     int current_depth, int behavior,
     SUB_TABLE_PTR sub_ptr, dir_table_flat_t* root_table,updateEntryInfoFunc updateEntry,
-    INFO* data)
+    INFO* data, uint8_t* base)
 {
     word index;
-    uint8_t* base = (uint8_t*)segment_basePtr();
     dir_sub_table_flat_t* sub_table = (dir_sub_table_flat_t*)(&base[sub_ptr]);
 
     {
@@ -405,19 +394,19 @@ static int _dir_sub_insert(IPLOOKUP* ip, int length, int cur_len, INFO ptr,
         if (behavior == RT_FAVOR_TIME)
         {
             _dir_fill_all(&root_table->allocated, index, fill, length,
-                (word)ptr, sub_ptr);
+                (word)ptr, sub_ptr, base);
         }
         /* Fill over less specific CIDR */
         else if (behavior == RT_FAVOR_SPECIFIC)
         {
-            _dir_fill_less_specific(index, fill, length, (word)ptr, sub_ptr);
+            _dir_fill_less_specific(index, fill, length, (word)ptr, sub_ptr, base);
         }
         else if (behavior == RT_FAVOR_ALL)
         {
             int64_t bytesAllocated;
 
             bytesAllocated = _dir_update_info(index, fill, length, (word)ptr,
-                sub_ptr, updateEntry, data);
+                sub_ptr, updateEntry, data, base);
 
             if (bytesAllocated < 0)
                 return MEM_ALLOC_FAILURE;
@@ -445,7 +434,7 @@ static int _dir_sub_insert(IPLOOKUP* ip, int length, int cur_len, INFO ptr,
 
             entry[index].value =
                 (word)_sub_table_flat_new(root_table, current_depth+1,
-                (word)entry[index].value, entry[index].length);
+                (word)entry[index].value, entry[index].length, base);
 
             sub_table->cur_num++;
 
@@ -461,7 +450,7 @@ static int _dir_sub_insert(IPLOOKUP* ip, int length, int cur_len, INFO ptr,
         ip->bits += sub_table->width;
         return (_dir_sub_insert(ip, length,
                cur_len - sub_table->width, ptr, current_depth+1,
-               behavior, entry[index].value, root_table, updateEntry, data));
+               behavior, entry[index].value, root_table, updateEntry, data, base));
     }
 
     return RT_SUCCESS;
@@ -469,16 +458,15 @@ static int _dir_sub_insert(IPLOOKUP* ip, int length, int cur_len, INFO ptr,
 
 /* Insert entry into DIR-n-m tables */
 int sfrt_dir_flat_insert(const uint32_t* addr, int /* numAddrDwords */, int len, word data_index,
-    int behavior, TABLE_PTR table_ptr, updateEntryInfoFunc updateEntry, INFO* data)
+    int behavior, TABLE_PTR table_ptr, updateEntryInfoFunc updateEntry, INFO* data,
+    uint8_t* base)
 {
     dir_table_flat_t* root;
-    uint8_t* base;
     uint32_t h_addr[4];
     IPLOOKUP iplu;
     iplu.addr = h_addr;
     iplu.bits = 0;
 
-    base = (uint8_t*)segment_basePtr();
     root = (dir_table_flat_t*)(&base[table_ptr]);
     /* Validate arguments */
     if (!root || !root->sub_table)
@@ -514,17 +502,16 @@ int sfrt_dir_flat_insert(const uint32_t* addr, int /* numAddrDwords */, int len,
 
     /* Find the sub table in which to insert */
     return _dir_sub_insert(&iplu, len, len, data_index,
-        0, behavior, root->sub_table, root, updateEntry, data);
+        0, behavior, root->sub_table, root, updateEntry, data, base);
 }
 
 /* Traverse sub tables looking for match
    Called by dir_lookup and recursively */
-static tuple_flat_t _dir_sub_flat_lookup(IPLOOKUP* ip, TABLE_PTR table_ptr)
+static tuple_flat_t _dir_sub_flat_lookup(IPLOOKUP* ip, TABLE_PTR table_ptr, const uint8_t* base)
 {
     word index;
-    uint8_t* base = (uint8_t*)segment_basePtr();
-    DIR_Entry* entry;
-    dir_sub_table_flat_t* table = (dir_sub_table_flat_t*)(&base[table_ptr]);
+    const DIR_Entry* entry;
+    const dir_sub_table_flat_t* table = (const dir_sub_table_flat_t*)(&base[table_ptr]);
 
     {
         uint32_t local_index, i;
@@ -548,7 +535,7 @@ static tuple_flat_t _dir_sub_flat_lookup(IPLOOKUP* ip, TABLE_PTR table_ptr)
         local_index = ip->addr[i] << (ip->bits %32);
         index = local_index >> (ARCH_WIDTH - table->width);
     }
-    entry = (DIR_Entry*)(&base[table->entries]);
+    entry = (const DIR_Entry*)(&base[table->entries]);
 
     if ( !entry[index].value || entry[index].length )
     {
@@ -559,14 +546,14 @@ static tuple_flat_t _dir_sub_flat_lookup(IPLOOKUP* ip, TABLE_PTR table_ptr)
     }
 
     ip->bits += table->width;
-    return _dir_sub_flat_lookup(ip, entry[index].value);
+    return _dir_sub_flat_lookup(ip, entry[index].value, base);
 }
 
 /* Lookup information associated with the value "ip" */
-tuple_flat_t sfrt_dir_flat_lookup(const uint32_t* addr, int numAddrDwords, TABLE_PTR table_ptr)
+tuple_flat_t sfrt_dir_flat_lookup(const uint32_t* addr, int numAddrDwords, TABLE_PTR table_ptr,
+    const uint8_t* base)
 {
-    dir_table_flat_t* root;
-    uint8_t* base = (uint8_t*)segment_basePtr();
+    const dir_table_flat_t* root;
     uint32_t h_addr[4];
     int i;
     IPLOOKUP iplu;
@@ -579,7 +566,7 @@ tuple_flat_t sfrt_dir_flat_lookup(const uint32_t* addr, int numAddrDwords, TABLE
         return ret;
     }
 
-    root = (dir_table_flat_t*)(&base[table_ptr]);
+    root = (const dir_table_flat_t*)(&base[table_ptr]);
 
     if (!root->sub_table)
     {
@@ -592,19 +579,17 @@ tuple_flat_t sfrt_dir_flat_lookup(const uint32_t* addr, int numAddrDwords, TABLE
     while (i < 4)
         h_addr[i++] = 0;
 
-    return _dir_sub_flat_lookup(&iplu, root->sub_table);
+    return _dir_sub_flat_lookup(&iplu, root->sub_table, base);
 }
 
-uint32_t sfrt_dir_flat_usage(TABLE_PTR table_ptr)
+uint32_t sfrt_dir_flat_usage(TABLE_PTR table_ptr, const uint8_t* base)
 {
-    dir_table_flat_t* table;
-    uint8_t* base;
+    const dir_table_flat_t* table;
     if (!table_ptr)
     {
         return 0;
     }
-    base = (uint8_t*)segment_basePtr();
-    table = (dir_table_flat_t*)(&base[table_ptr]);
-    return ((dir_table_flat_t*)(table))->allocated;
+    table = (const dir_table_flat_t*)(&base[table_ptr]);
+    return table->allocated;
 }
 
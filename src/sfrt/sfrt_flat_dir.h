@@ -67,13 +67,17 @@ typedef struct
 } dir_table_flat_t;
 
 /******************************************************************
-   DIR-n-m functions, these are not intended to be called directly */
+   DIR-n-m functions, these are not intended to be called directly.
+   Offsets are resolved against the base of the segment holding the
+   table; new allocates in the segment set by segment_meminit(). */
 TABLE_PTR sfrt_dir_flat_new(uint32_t mem_cap, int count,...);
-void sfrt_dir_flat_free(TABLE_PTR);
-tuple_flat_t sfrt_dir_flat_lookup(const uint32_t* addr, int numAddrDwords, TABLE_PTR table);
+void sfrt_dir_flat_free(TABLE_PTR, uint8_t* base);
+tuple_flat_t sfrt_dir_flat_lookup(const uint32_t* addr, int numAddrDwords, TABLE_PTR table,
+                    const uint8_t* base);
 int sfrt_dir_flat_insert(const uint32_t* addr, int numAddrDwords, int len, word data_index,
-                    int behavior, TABLE_PTR, updateEntryInfoFunc updateEntry, INFO *data);
-uint32_t sfrt_dir_flat_usage(TABLE_PTR);
+                    int behavior, TABLE_PTR, updateEntryInfoFunc updateEntry, INFO *data,
+                    uint8_t* base);
+uint32_t sfrt_dir_flat_usage(TABLE_PTR, const uint8_t* base);
 
 #endif /* SFRT_FLAT_DIR_H */
 
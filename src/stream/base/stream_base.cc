@@ -67,6 +67,7 @@ const PegInfo base_pegs[] =
     { CountType::SUM, "expected_flows", "total expected flows created within snort" },
     { CountType::SUM, "expected_realized", "number of expected flows realized" },
     { CountType::SUM, "expected_pruned", "number of expected flows pruned" },
+    { CountType::SUM, "expected_expired", "number of expected flows that timed out" },
     { CountType::SUM, "expected_overflows", "number of expected cache overflows" },
     { CountType::SUM, "reload_tuning_idle", "number of times stream resource tuner called while idle" },
     { CountType::SUM, "reload_tuning_packets", "number of times stream resource tuner called while processing packets" },
@@ -105,6 +106,7 @@ void base_prep()
         stream_base_stats.expected_flows = exp_cache->get_expects();
         stream_base_stats.expected_realized = exp_cache->get_realized();
         stream_base_stats.expected_pruned = exp_cache->get_prunes();
+        stream_base_stats.expected_expired = exp_cache->get_expired();
         stream_base_stats.expected_overflows = exp_cache->get_overflows();
     }
 }
@@ -81,6 +81,9 @@ static const Parameter s_params[] =
     { "pruning_timeout", Parameter::PT_INT, "1:max32", "30",
                     "minimum inactive time before being eligible for pruning" },
 
+    { "preallocate_flows", Parameter::PT_BOOL, nullptr, "false",
+      "build all max_flows flows at startup in memory local to each packet thread's NUMA node" },
+
     { "held_packet_timeout", Parameter::PT_INT, "1:max32", "1000",
       "timeout in milliseconds for held packets" },
 
@@ -173,6 +176,11 @@ bool StreamModule::set(const char* fqn, Value& v, SnortConfig* c)
         config.flow_cache_cfg.pruning_timeout = v.get_uint32();
         return true;
     }
+    else if ( v.is("preallocate_flows") )
+    {
+        config.flow_cache_cfg.preallocate = v.get_bool();
+        return true;
+    }
     else if ( v.is("held_packet_timeout") )
     {
         config.held_packet_timeout = v.get_uint32();
@@ -242,6 +250,11 @@ bool StreamReloadResourceManager::initialize(const StreamModuleConfig& config_)
         return false;
     }
 #endif
+    if ( config.flow_cache_cfg.preallocate != config_.flow_cache_cfg.preallocate )
+    {
+        ReloadError("Changing stream.preallocate_flows requires a restart.\n");
+        return false;
+    }
     config = config_;
     return true;
 }
@@ -297,6 +310,7 @@ void StreamModuleConfig::show() const
 {
     ConfigLogger::log_value("max_flows", flow_cache_cfg.max_flows);
     ConfigLogger::log_value("pruning_timeout", flow_cache_cfg.pruning_timeout);
+    ConfigLogger::log_flag("preallocate_flows", flow_cache_cfg.preallocate);
 
     for (int i = to_utype(PktType::IP); i < to_utype(PktType::MAX); ++i)
     {
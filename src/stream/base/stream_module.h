@@ -58,6 +58,7 @@ struct BaseStats
      PegCount expected_flows;
      PegCount expected_realized;
      PegCount expected_pruned;
+     PegCount expected_expired;
      PegCount expected_overflows;
      PegCount reload_tuning_idle;
      PegCount reload_tuning_packets;
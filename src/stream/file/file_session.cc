@@ -44,10 +44,10 @@ static THREAD_LOCAL ProfileStats file_ssn_stats;
 //-------------------------------------------------------------------------
 
 FileSession::FileSession(Flow* f) : Session(f)
-{ memory::MemoryCap::update_allocations(sizeof(*this)); }
+{ memory::MemoryCap::update_allocations(sizeof(*this), memory::MemoryTag::STREAM); }
 
 FileSession::~FileSession()
-{ memory::MemoryCap::update_deallocations(sizeof(*this)); }
+{ memory::MemoryCap::update_deallocations(sizeof(*this), memory::MemoryTag::STREAM); }
 
 bool FileSession::setup(Packet*)
 {
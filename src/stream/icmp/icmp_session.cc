@@ -180,10 +180,10 @@ static int ProcessIcmpUnreach(Packet* p)
 //-------------------------------------------------------------------------
 
 IcmpSession::IcmpSession(Flow* f) : Session(f)
-{ memory::MemoryCap::update_allocations(sizeof(*this)); }
+{ memory::MemoryCap::update_allocations(sizeof(*this), memory::MemoryTag::STREAM); }
 
 IcmpSession::~IcmpSession()
-{ memory::MemoryCap::update_deallocations(sizeof(*this)); }
+{ memory::MemoryCap::update_deallocations(sizeof(*this), memory::MemoryTag::STREAM); }
 
 bool IcmpSession::setup(Packet*)
 {
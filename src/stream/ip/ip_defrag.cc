@@ -121,10 +121,23 @@ using namespace snort;
 
 struct Fragment
 {
-    Fragment(uint16_t flen, const uint8_t* fptr, int ord)
-    { init(flen, fptr, ord); }
+    ~Fragment()
+    { delete[] fptr; }
 
-    Fragment(Fragment* other, int ord)
+    void init(uint16_t flen, const uint8_t* fptr, int ord)
+    {
+        assert(flen > 0);
+        memcpy(this->fptr, fptr, flen);
+
+        data = this->fptr;
+        size = 0;
+        offset = 0;
+        prev = next = nullptr;
+        this->ord = ord;
+        last = 0;
+    }
+
+    void init(const Fragment* other, int ord)
     {
         init(other->flen, other->fptr, ord);
         data = fptr + (other->data - other->fptr);
@@ -133,41 +146,99 @@ struct Fragment
         last = other->last;
     }
 
-    ~Fragment()
-    {
-        delete[] fptr;
-        ip_stats.nodes_released++;
-        memory::MemoryCap::update_deallocations(sizeof(*this) + flen);
-    }
-
     uint8_t* data = nullptr;    /* ptr to adjusted start position */
     uint16_t size = 0;          /* adjusted frag size */
     uint16_t offset = 0;        /* adjusted offset position */
 
     uint8_t* fptr = nullptr;    /* free pointer */
     uint16_t flen = 0;          /* free len, unneeded? */
+    uint32_t fcap = 0;          /* allocated size of fptr */
 
     Fragment* prev = nullptr;
     Fragment* next = nullptr;
 
     int ord = 0;
     char last = 0;
+};
 
-private:
-    inline void init(uint16_t flen, const uint8_t* fptr, int ord)
+/*  F R A G M E N T   P O O L  **************************************/
+
+/*
+ * Released fragments are kept on a per packet thread free list, buffer
+ * included, so that a flood of fragments is served without going back to
+ * the heap for every node.  Buffers are allocated in FRAG_POOL_UNIT chunks
+ * so a recycled node usually fits the next (MTU sized) fragment as is.
+ * Nodes holding buffers larger than FRAG_POOL_MAX_CAP are not retained.
+ */
+#define FRAG_POOL_UNIT    2048
+#define FRAG_POOL_MAX_CAP (8 * FRAG_POOL_UNIT)
+
+struct FragmentPool
+{
+    Fragment* free_list = nullptr;
+    uint32_t count = 0;
+};
+
+static THREAD_LOCAL FragmentPool* frag_pool = nullptr;
+
+static Fragment* acquire_fragment(uint16_t flen)
+{
+    Fragment* f;
+
+    if ( frag_pool and frag_pool->free_list )
     {
-        assert(flen > 0);
-        memory::MemoryCap::update_allocations(sizeof(*this) + flen);
+        f = frag_pool->free_list;
+        frag_pool->free_list = f->next;
+        frag_pool->count--;
+        ip_stats.nodes_reused++;
+    }
+    else
+        f = new Fragment;
 
-        this->flen = flen;
-        this->fptr = new uint8_t[flen];
-        this->ord = ord;
+    if ( f->fcap < flen )
+    {
+        delete[] f->fptr;
+        f->fcap = (flen + FRAG_POOL_UNIT - 1) & ~(FRAG_POOL_UNIT - 1);
+        f->fptr = new uint8_t[f->fcap];
+    }
+    f->flen = flen;
 
-        memcpy(this->fptr, fptr, flen);
+    memory::MemoryCap::update_allocations(sizeof(*f) + flen, memory::MemoryTag::STREAM);
+    ip_stats.nodes_created++;
+
+    return f;
+}
+
+static Fragment* new_fragment(uint16_t flen, const uint8_t* fptr, int ord)
+{
+    Fragment* f = acquire_fragment(flen);
+    f->init(flen, fptr, ord);
+    return f;
+}
+
+static Fragment* new_fragment(const Fragment* other, int ord)
+{
+    Fragment* f = acquire_fragment(other->flen);
+    f->init(other, ord);
+    return f;
+}
+
+static void release_fragment(Fragment* f, const FragEngine* fe)
+{
+    ip_stats.nodes_released++;
+    memory::MemoryCap::update_deallocations(sizeof(*f) + f->flen, memory::MemoryTag::STREAM);
 
-        ip_stats.nodes_created++;
+    if ( frag_pool and fe and frag_pool->count < fe->frag_pool_size and
+        f->fcap <= FRAG_POOL_MAX_CAP )
+    {
+        f->prev = nullptr;
+        f->next = frag_pool->free_list;
+        frag_pool->free_list = f;
+        frag_pool->count++;
     }
-};
+    else
+        delete f;
+}
 
 /*  G L O B A L S  **************************************************/
 
@@ -784,7 +855,7 @@ static inline void delete_node(FragTracker* ft, Fragment* node)
         ft->fraglist_tail = node->prev;
     }
 
-    delete node;
+    release_fragment(node, ft->engine);
     ft->fraglist_count--;
 }
 
@@ -805,7 +876,7 @@ static void delete_tracker(FragTracker* ft)
     {
         dump_me = idx;
         idx = idx->next;
-        delete dump_me;
+        release_fragment(dump_me, ft->engine);
     }
     ft->fraglist = nullptr;
     if (ft->ip_options_data)
@@ -838,8 +909,26 @@ bool Defrag::configure(SnortConfig* sc)
     return true;
 }
 
+void Defrag::tinit()
+{
+    frag_pool = new FragmentPool;
+}
+
+void Defrag::tterm()
+{
+    while ( frag_pool->free_list )
+    {
+        Fragment* f = frag_pool->free_list;
+        frag_pool->free_list = f->next;
+        delete f;
+    }
+    delete frag_pool;
+    frag_pool = nullptr;
+}
+
 void Defrag::show() const
 {
+    ConfigLogger::log_value("frag_pool_size", engine.frag_pool_size);
     ConfigLogger::log_value("max_frags", engine.max_frags);
     ConfigLogger::log_value("max_overlaps", engine.max_overlaps);
     ConfigLogger::log_value("min_frag_length", engine.min_fragment_length);
@@ -1797,7 +1886,7 @@ int Defrag::new_tracker(Packet* p, FragTracker* ft)
     /* initialize the fragment list */
     ft->fraglist = nullptr;
 
-    f = new Fragment(fragLength, fragStart, ft->ordinal++);
+    f = new_fragment(fragLength, fragStart, ft->ordinal++);
 
     f->size = fragLength;
     f->offset = frag_off;
@@ -1915,7 +2004,7 @@ int Defrag::add_frag_node(
         return FRAG_INSERT_ANOMALY;
     }
 
-    newfrag = new Fragment(fragLength, fragStart, ft->ordinal++);
+    newfrag = new_fragment(fragLength, fragStart, ft->ordinal++);
 
     /*
      * twiddle the frag values for overlaps
@@ -1966,7 +2055,7 @@ int Defrag::add_frag_node(
  */
 int Defrag::dup_frag_node( FragTracker* ft, Fragment* left, Fragment** retFrag)
 {
-    Fragment* newfrag = new Fragment(left, ft->ordinal++);
+    Fragment* newfrag = new_fragment(left, ft->ordinal++);
 
     add_node(ft, left, newfrag);
 
@@ -47,6 +47,9 @@ public:
 
     static void init();
 
+    static void tinit();
+    static void tterm();
+
 private:
     int insert(snort::Packet*, FragTracker*, FragEngine*);
     int new_tracker(snort::Packet* p, FragTracker*);
@@ -103,6 +103,9 @@ static const RuleMap stream_ip_rules[] =
 
 static const Parameter s_params[] =
 {
+    { "frag_pool_size", Parameter::PT_INT, "0:max32", "1024",
+      "maximum number of released fragments kept for reuse per packet thread" },
+
     { "max_frags", Parameter::PT_INT, "1:max32", "8192",
       "maximum number of simultaneous fragments being tracked" },
 
@@ -159,7 +162,10 @@ StreamIpConfig* StreamIpModule::get_data()
 
 bool StreamIpModule::set(const char*, Value& v, SnortConfig*)
 {
-    if ( v.is("max_frags") )
+    if ( v.is("frag_pool_size") )
+        config->frag_engine.frag_pool_size = v.get_uint32();
+
+    else if ( v.is("max_frags") )
         config->frag_engine.max_frags = v.get_uint32();
 
     else if ( v.is("max_overlaps") )
@@ -79,6 +79,7 @@ struct IpStats
     PegCount trackers_completed;// iFragComplete
     PegCount nodes_created;     // iFragInserts tracked a similar stat (# calls to insert)
     PegCount nodes_released;
+    PegCount nodes_reused;      // nodes served from the per-thread pool
     PegCount reassembled_bytes; // total_ipreassembled_bytes
     PegCount fragmented_bytes;  // total_ipfragmented_bytes
 };
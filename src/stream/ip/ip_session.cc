@@ -58,6 +58,7 @@ const PegInfo ip_pegs[] =
     { CountType::SUM, "trackers_completed", "datagram trackers completed" },
     { CountType::SUM, "nodes_inserted", "fragments added to tracker" },
     { CountType::SUM, "nodes_deleted", "fragments deleted from tracker" },
+    { CountType::SUM, "nodes_reused", "fragment nodes reused from the thread pool" },
     { CountType::SUM, "reassembled_bytes", "total reassembled bytes" },
     { CountType::SUM, "fragmented_bytes", "total fragmented bytes" },
     { CountType::END, nullptr, nullptr }
@@ -130,10 +131,10 @@ static inline void update_session(Packet* p, Flow* lws)
 //-------------------------------------------------------------------------
 
 IpSession::IpSession(Flow* f) : Session(f)
-{ memory::MemoryCap::update_allocations(sizeof(*this)); }
+{ memory::MemoryCap::update_allocations(sizeof(*this), memory::MemoryTag::STREAM); }
 
 IpSession::~IpSession()
-{ memory::MemoryCap::update_deallocations(sizeof(*this)); }
+{ memory::MemoryCap::update_deallocations(sizeof(*this), memory::MemoryTag::STREAM); }
 
 void IpSession::clear()
 {
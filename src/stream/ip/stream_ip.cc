@@ -35,6 +35,9 @@ using namespace snort;
 /* max frags in a single frag tracker */
 #define DEFAULT_MAX_FRAGS 8192
 
+/* max released fragments retained per packet thread */
+#define DEFAULT_FRAG_POOL_SIZE 1024
+
 /* default frag timeout, 90-120 might be better values, can we do
  * engine-based quanta?  */
 #define FRAG_PRUNE_QUANTA  60
@@ -52,6 +55,7 @@ StreamIpConfig::StreamIpConfig()
 
     frag_engine.frag_policy = FRAG_POLICY_DEFAULT;
     frag_engine.max_frags = DEFAULT_MAX_FRAGS;
+    frag_engine.frag_pool_size = DEFAULT_FRAG_POOL_SIZE;
     frag_engine.frag_timeout = FRAG_PRUNE_QUANTA;
     frag_engine.min_ttl = FRAG_MIN_TTL;
 
@@ -137,11 +141,13 @@ static void mod_dtor(Module* m)
 static void ip_tinit()
 {
     IpHAManager::tinit();
+    Defrag::tinit();
 }
 
 static void ip_tterm()
 {
     IpHAManager::tterm();
+    Defrag::tterm();
 }
 
 static Inspector* ip_ctor(Module* m)
@@ -44,6 +44,7 @@ enum
 struct FragEngine
 {
     uint32_t max_frags;
+    uint32_t frag_pool_size; /* max released fragments kept for reuse */
     uint32_t max_overlaps;
     uint32_t min_fragment_length;
 
@@ -27,6 +27,7 @@
 #include <mutex>
 
 #include "detection/detection_engine.h"
+#include "flow/expect_cache.h"
 #include "flow/flow_control.h"
 #include "flow/flow_key.h"
 #include "flow/ha.h"
@@ -367,10 +368,10 @@ void Stream::handle_timeouts(bool idle)
     TcpStreamTracker::release_held_packets(cur_time, max_remove);
 }
 
-void Stream::prune_flows()
+void Stream::prune_flows(memory::MemoryTag tag)
 {
     if ( flow_con )
-        flow_con->prune_one(PruneReason::MEMCAP, false);
+        flow_con->prune_one(PruneReason::MEMCAP, false, tag);
 }
 
 bool Stream::expected_flow(Flow* f, Packet* p)
@@ -396,6 +397,12 @@ int Stream::set_snort_protocol_id_expected(
         ctrlPkt, type, ip_proto, srcIP, srcPort, dstIP, dstPort, snort_protocol_id, fd);
 }
 
+void Stream::move_expect_stats(unsigned flowdata_id, ExpectStats& stats)
+{
+    if ( flow_con and flow_con->get_exp_cache() )
+        flow_con->get_exp_cache()->move_stats(flowdata_id, stats);
+}
+
 void Stream::set_snort_protocol_id(
     Flow* flow, const HostAttributeEntry* host_entry, int /*direction*/)
 {
@@ -30,6 +30,7 @@ struct HostAttributeEntry;
 
 namespace snort
 {
+struct ExpectStats;
 class Flow;
 struct SfIp;
 class StreamSplitter;
@@ -72,7 +73,8 @@ public:
     static void purge_flows();
 
     static void handle_timeouts(bool idle);
-    static void prune_flows();
+    // prefer flows holding the most memory for the given subsystem
+    static void prune_flows(memory::MemoryTag = memory::MemoryTag::FLOW);
     static bool expected_flow(Flow*, Packet*);
 
     // Looks in the flow cache for flow session with specified key and returns
@@ -176,6 +178,10 @@ public:
         const Packet* ctrlPkt, PktType, IpProtocol, const snort::SfIp* srcIP, uint16_t srcPort,
         const snort::SfIp* dstIP, uint16_t dstPort, SnortProtocolId, FlowData*);
 
+    // Add this thread's expected flow counts for the given flow data id to the stats
+    // and clear them.  For inspectors to peg the expected flows they add.
+    static void move_expect_stats(unsigned flowdata_id, ExpectStats&);
+
     // Get pointer to application data for a flow based on the lookup tuples for cases where
     // Snort does not have an active packet that is relevant.
     static FlowData* get_flow_data(
@@ -57,7 +57,8 @@ void TcpSegmentNode::clear()
     {
         TcpSegmentNode* tsn = reserved;
         reserved = reserved->next;
-        memory::MemoryCap::update_deallocations(sizeof(*tsn) + tsn->size);
+        memory::MemoryCap::update_deallocations(sizeof(*tsn) + tsn->size,
+            memory::MemoryTag::STREAM);
         tcpStats.mem_in_use -= tsn->size;
         snort_free(tsn);
     }
@@ -85,7 +86,7 @@ TcpSegmentNode* TcpSegmentNode::create(
 #endif
     {
         size_t size = sizeof(*tsn) + len;
-        memory::MemoryCap::update_allocations(size);
+        memory::MemoryCap::update_allocations(size, memory::MemoryTag::STREAM);
         tsn = (TcpSegmentNode*)snort_alloc(size);
         tsn->size = len;
         tcpStats.mem_in_use += len;
@@ -124,7 +125,7 @@ void TcpSegmentNode::term()
     else
 #endif
     {
-        memory::MemoryCap::update_deallocations(sizeof(*this) + size);
+        memory::MemoryCap::update_deallocations(sizeof(*this) + size, memory::MemoryTag::STREAM);
         tcpStats.mem_in_use -= size;
         snort_free(this);
     }
@@ -87,13 +87,13 @@ TcpSession::TcpSession(Flow* f) : TcpStreamSession(f)
     server.session = this;
     tcpStats.instantiated++;
 
-    memory::MemoryCap::update_allocations(sizeof(*this));
+    memory::MemoryCap::update_allocations(sizeof(*this), memory::MemoryTag::STREAM);
 }
 
 TcpSession::~TcpSession()
 {
     clear_session(true, false, false);
-    memory::MemoryCap::update_deallocations(sizeof(*this));
+    memory::MemoryCap::update_deallocations(sizeof(*this), memory::MemoryTag::STREAM);
 }
 
 bool TcpSession::setup(Packet* p)
@@ -393,6 +393,12 @@ void TcpStreamSession::set_splitter(bool to_server, StreamSplitter* ss)
     trk.set_splitter(ss);
 }
 
+size_t TcpStreamSession::get_memory_in_use() const
+{
+    return client.reassembler.get_seg_bytes_total() +
+        server.reassembler.get_seg_bytes_total();
+}
+
 uint16_t TcpStreamSession::get_mss(bool to_server) const
 {
     const TcpStreamTracker& trk = (to_server) ? client : server;
@@ -57,6 +57,7 @@ public:
         uint32_t /*event_id*/, uint32_t /*event_second*/) override;
 
     bool set_packet_action_to_hold(snort::Packet*) override;
+    size_t get_memory_in_use() const override;
 
     uint16_t get_mss(bool to_server) const;
     uint8_t get_tcp_options_len(bool to_server) const;
@@ -57,7 +57,7 @@ UserSegment* UserSegment::init(const uint8_t* p, unsigned n)
     unsigned bucket = (n > BUCKET) ? n : BUCKET;
     unsigned size = sizeof(UserSegment) + bucket -1;
 
-    memory::MemoryCap::update_allocations(size);
+    memory::MemoryCap::update_allocations(size, memory::MemoryTag::STREAM);
     UserSegment* us = (UserSegment*)snort_alloc(size);
 
     us->size = size;
@@ -71,7 +71,7 @@ UserSegment* UserSegment::init(const uint8_t* p, unsigned n)
 
 void UserSegment::term(UserSegment* us)
 {
-    memory::MemoryCap::update_deallocations(us->size);
+    memory::MemoryCap::update_deallocations(us->size, memory::MemoryTag::STREAM);
     snort_free(us);
 }
 
@@ -423,10 +423,10 @@ void UserSession::restart(Packet* p)
 //-------------------------------------------------------------------------
 
 UserSession::UserSession(Flow* f) : Session(f)
-{ memory::MemoryCap::update_allocations(sizeof(*this)); }
+{ memory::MemoryCap::update_allocations(sizeof(*this), memory::MemoryTag::STREAM); }
 
 UserSession::~UserSession()
-{ memory::MemoryCap::update_deallocations(sizeof(*this)); }
+{ memory::MemoryCap::update_deallocations(sizeof(*this), memory::MemoryTag::STREAM); }
 
 bool UserSession::setup(Packet*)
 {
@@ -204,6 +204,11 @@ const PegInfo pc_names[] =
     { CountType::SUM, "offload_fallback", "fast pattern offload search fallback attempts" },
     { CountType::SUM, "offload_failures", "fast pattern offload search failures" },
     { CountType::SUM, "offload_suspends", "fast pattern search suspends due to offload context chains" },
+    { CountType::SUM, "offload_steals", "offload requests taken from another worker's queue" },
+    { CountType::MAX, "offload_queue_max", "maximum depth of an offload worker queue" },
+    { CountType::SUM, "batched_searches", "fast pattern searches deferred to a cross packet batch" },
+    { CountType::SUM, "search_batches", "cross packet batches of fast pattern searches submitted" },
+    { CountType::SUM, "batch_timeouts", "cross packet batches submitted due to batch_search_latency" },
     { CountType::SUM, "pcre_match_limit", "total number of times pcre hit the match limit" },
     { CountType::SUM, "pcre_recursion_limit", "total number of times pcre hit the recursion limit" },
     { CountType::SUM, "pcre_error", "total number of times pcre returns error" },
@@ -66,6 +66,11 @@ struct PacketCount
     PegCount offload_fallback;
     PegCount offload_failures;
     PegCount offload_suspends;
+    PegCount offload_steals;
+    PegCount offload_queue_max;
+    PegCount batched_searches;
+    PegCount search_batches;
+    PegCount batch_timeouts;
     PegCount pcre_match_limit;
     PegCount pcre_recursion_limit;
     PegCount pcre_error;
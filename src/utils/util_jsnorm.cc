@@ -29,6 +29,10 @@
 
 #include "main/thread.h"
 
+#ifdef UNIT_TEST
+#include "catch/snort_catch.h"
+#endif
+
 namespace snort
 {
 #define INVALID_HEX_VAL (-1)
@@ -1118,10 +1122,10 @@ static inline void WriteJSNormChar(JSNormState* s, int c, JSState* js)
     s->dest.len = dptr - dstart;
 }
 
-static void WriteJSNorm(JSNormState* s, char* copy_buf, uint16_t copy_len, JSState* js)
+static void WriteJSNorm(JSNormState* s, const char* copy_buf, uint16_t copy_len, JSState* js)
 {
-    const char* end, * dstart, * dend;
-    char* ptr, * dptr;
+    const char* ptr, * end, * dstart, * dend;
+    char* dptr;
 
     ptr = copy_buf;
     end = copy_buf + copy_len;
@@ -1228,8 +1232,73 @@ static int JSNorm_scan_fsm(JSNormState* s, int c, const char* src, uint16_t srcl
     return(JSNorm_exec(s, (ActionJSNorm)m->action, c, src, srclen, ptr, js));
 }
 
-int JSNormalizeDecode(const char* src, uint16_t srclen, char* dst, uint16_t destlen, const char** ptr,
-    int* bytes_copied, JSState* js, uint8_t* iis_unicode_map)
+// Bytes that can move the javascript_norm fsm out of its start state:
+// whitespace and the first characters of unescape, String.fromCharCode,
+// decodeURI and </script>.  Any other byte seen in state Z0 is just copied
+// to the output and leaves the fsm in Z0.
+static inline bool IsJSNormTrigger(char c)
+{
+    if (isspace(c))
+        return true;
+
+    int uc = toupper(c);
+    return (uc == 'U') || (uc == 'S') || (uc == 'D') || (uc == '<');
+}
+
+// Word at a time screen for a run of 8 bytes.  False positives are fine
+// (the caller rechecks byte by byte) but every trigger byte must be caught.
+// Control characters, space and non-ASCII are all flagged so that locale
+// dependent isspace() / toupper() results can't be missed.
+static inline bool MayHaveJSNormTrigger(uint64_t w)
+{
+    const uint64_t ones = 0x0101010101010101ULL;
+    const uint64_t highs = 0x8080808080808080ULL;
+
+    uint64_t folded = w | (ones * 0x20);
+    uint64_t u = folded ^ (ones * 'u');
+    uint64_t s = folded ^ (ones * 's');
+    uint64_t d = folded ^ (ones * 'd');
+    uint64_t lt = w ^ (ones * '<');
+
+    uint64_t hit = (w - ones * 0x21) & ~w;
+    hit |= w;
+    hit |= (u - ones) & ~u;
+    hit |= (s - ones) & ~s;
+    hit |= (d - ones) & ~d;
+    hit |= (lt - ones) & ~lt;
+
+    return (hit & highs) != 0;
+}
+
+// Returns the first byte in [ptr, end) that the fsm has to look at.
+static inline const char* SkipJSNormPlain(const char* ptr, const char* end)
+{
+    while ( true )
+    {
+        uint64_t w;
+
+        while ( (end - ptr) >= (int)sizeof(w) )
+        {
+            memcpy(&w, ptr, sizeof(w));
+
+            if ( MayHaveJSNormTrigger(w) )
+                break;
+
+            ptr += sizeof(w);
+        }
+
+        const char* stop = ((end - ptr) > (int)sizeof(w)) ? ptr + sizeof(w) : end;
+
+        while ( (ptr < stop) && !IsJSNormTrigger(*ptr) )
+            ptr++;
+
+        if ( (ptr < stop) || (ptr == end) )
+            return ptr;
+    }
+}
+
+static int JSNormalize(const char* src, uint16_t srclen, char* dst, uint16_t destlen, const char** ptr,
+    int* bytes_copied, JSState* js, uint8_t* iis_unicode_map, bool fast_path)
 {
     int iRet = RET_OK;
     const char* start, * end;
@@ -1254,6 +1323,20 @@ int JSNormalizeDecode(const char* src, uint16_t srclen, char* dst, uint16_t dest
 
     while (!outBounds(start, end, *ptr))
     {
+        if ( fast_path && (s.fsm == 0) )
+        {
+            // copy a run of plain bytes in one go; equivalent to ACT_NOP per byte
+            const char* run_end = SkipJSNormPlain(*ptr, end);
+
+            if ( run_end > *ptr )
+            {
+                WriteJSNorm(&s, *ptr, run_end - *ptr, js);
+                s.prev_event = *(run_end - 1);
+                *ptr = run_end;
+                continue;
+            }
+        }
+
         iRet = JSNorm_scan_fsm(&s, **ptr, src, srclen, ptr, js);
         if (iRet != RET_OK)
         {
@@ -1271,6 +1354,88 @@ int JSNormalizeDecode(const char* src, uint16_t srclen, char* dst, uint16_t dest
 
     return RET_OK;
 }
+
+int JSNormalizeDecode(const char* src, uint16_t srclen, char* dst, uint16_t destlen, const char** ptr,
+    int* bytes_copied, JSState* js, uint8_t* iis_unicode_map)
+{
+    return JSNormalize(src, srclen, dst, destlen, ptr, bytes_copied, js, iis_unicode_map, true);
+}
 }
 
+#ifdef UNIT_TEST
+
+#include <random>
+#include <string>
+
+using namespace snort;
+
+static void check_jsnorm(const std::string& in, uint16_t destlen = 4096)
+{
+    JSState js_fast = { 3, 1, 0 };
+    JSState js_ref = js_fast;
+
+    std::string fast_out(destlen, '\0');
+    std::string ref_out(destlen, '\0');
+
+    const char* fast_ptr = in.data();
+    const char* ref_ptr = in.data();
+    int fast_len = 0;
+    int ref_len = 0;
+
+    JSNormalize(in.data(), in.size(), &fast_out[0], destlen, &fast_ptr, &fast_len,
+        &js_fast, nullptr, true);
+    JSNormalize(in.data(), in.size(), &ref_out[0], destlen, &ref_ptr, &ref_len,
+        &js_ref, nullptr, false);
+
+    CHECK(fast_len == ref_len);
+    CHECK(fast_ptr == ref_ptr);
+    CHECK(js_fast.alerts == js_ref.alerts);
+    CHECK(fast_out.compare(0, fast_len, ref_out, 0, ref_len) == 0);
+}
+
+TEST_CASE("jsnorm fast path plain text", "[jsnorm]")
+{
+    check_jsnorm("var x=1;");
+    check_jsnorm("function f(a,b){return a+b;}var q=f(1,2);");
+    check_jsnorm("");
+    check_jsnorm("x");
+}
 
+TEST_CASE("jsnorm fast path triggers", "[jsnorm]")
+{
+    check_jsnorm("var a = unescape('%41%42%43'); document.write(a);");
+    check_jsnorm("x=String.fromCharCode(72,105);y=decodeURIComponent('%41')");
+    check_jsnorm("alert(1)</script>trailing text after the end tag");
+    check_jsnorm("a      =       b;\t\t\t\n\n\r\n       c");
+    check_jsnorm("UNESCAPE(\"%u0041%u0042\")+sTrInG.FrOmChArCoDe(0x41)");
+    check_jsnorm("eval(unescape(unescape('%2575%256e')))");
+}
+
+TEST_CASE("jsnorm fast path truncated output", "[jsnorm]")
+{
+    check_jsnorm("abcdefghijklmnopqrstuvwxyz0123456789abcdefghijklmnopqrstuvwxyz", 10);
+    check_jsnorm("0123456789abc   unescape('%41')0123456789", 16);
+    check_jsnorm("0123456789", 0);
+}
+
+TEST_CASE("jsnorm fast path random", "[jsnorm]")
+{
+    std::mt19937 gen(1234);
+    const std::string alphabet = "abcuUsSdD<>/()'\"%+,;=0123456789 \t\r\n\\x";
+    std::uniform_int_distribution<size_t> pick(0, alphabet.size() - 1);
+    std::uniform_int_distribution<int> any(0, 255);
+    std::uniform_int_distribution<size_t> len(0, 300);
+
+    for ( unsigned i = 0; i < 500; ++i )
+    {
+        std::string in;
+        size_t n = len(gen);
+
+        for ( size_t j = 0; j < n; ++j )
+            in += (i % 4) ? alphabet[pick(gen)] : (char)any(gen);
+
+        check_jsnorm(in, (i % 3) ? 4096 : 64);
+    }
+}
+
+#endif